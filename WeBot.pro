@@ -9,7 +9,7 @@ DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x050000
 
 # Windows specific configuration
 win32 {
-    LIBS += -luser32 -lkernel32 -lshell32 -ladvapi32 -lgdi32
+    LIBS += -luser32 -lkernel32 -lshell32 -ladvapi32 -lgdi32 -lpsapi
     QMAKE_CXXFLAGS += -D_USE_MATH_DEFINES
     DEFINES += NOMINMAX
     
@@ -17,12 +17,20 @@ win32 {
     OPENCV_DIR = C:/opencv/OpenCV-MinGW-Build-OpenCV-4.1.0-x64
     INCLUDEPATH += $${OPENCV_DIR}/include
     LIBS += -L$${OPENCV_DIR}/x64/mingw/lib
-    LIBS += -lopencv_core410 -lopencv_imgproc410 -lopencv_highgui410 -lopencv_imgcodecs410 -lopencv_features2d410
+    LIBS += -lopencv_core410 -lopencv_imgproc410 -lopencv_highgui410 -lopencv_imgcodecs410 -lopencv_features2d410 -lopencv_calib3d410
+
+    SOURCES += platform_win.cpp
+} else {
+    # 其他平台（Linux）只支持回放模式，OpenCV通过pkg-config查找
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+
+    SOURCES += platform_other.cpp
 }
 
-SOURCES = main.cpp mainwindow.cpp automator.cpp configmanager.cpp logger.cpp wechatcontroller.cpp imagerecognizer.cpp inputsimulator.cpp questionmanager.cpp recognitionoverlay.cpp clickcapturewidget.cpp
+SOURCES += main.cpp mainwindow.cpp automator.cpp configmanager.cpp logger.cpp wechatcontroller.cpp imagerecognizer.cpp inputsimulator.cpp questionmanager.cpp recognitionoverlay.cpp clickcapturewidget.cpp tracer.cpp metrics.cpp metricsserver.cpp headlessrunner.cpp controlserver.cpp jobjournal.cpp csvimporter.cpp questionbank.cpp questionsampler.cpp questiondedup.cpp questiongenerator.cpp matchdiagnostics.cpp recognitionprofile.cpp recognitioncalibrator.cpp featurematcher.cpp exactmatcher.cpp peakextractor.cpp tiledmatcher.cpp imagekernels.cpp
 
-HEADERS = mainwindow.h automator.h configmanager.h logger.h wechatcontroller.h imagerecognizer.h inputsimulator.h questionmanager.h recognitionoverlay.h clickcapturewidget.h
+HEADERS = platform.h mainwindow.h automator.h configmanager.h logger.h wechatcontroller.h imagerecognizer.h inputsimulator.h questionmanager.h recognitionoverlay.h clickcapturewidget.h tracer.h metrics.h metricsserver.h headlessrunner.h controlserver.h jobjournal.h csvimporter.h questionbank.h questionsampler.h questiondedup.h questiongenerator.h matchdiagnostics.h recognitionprofile.h recognitioncalibrator.h featurematcher.h exactmatcher.h peakextractor.h tiledmatcher.h imagekernels.h
 
 FORMS = mainwindow.ui
 
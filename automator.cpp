@@ -7,7 +7,22 @@
 #include <QDateTime>
 #include <QCoreApplication>
 #include <QRandomGenerator>
-#include <windows.h>
+#include <QDir>
+#include <QFileInfo>
+#include <utility>
+#include "tracer.h"
+#include "metrics.h"
+#include "matchdiagnostics.h"
+#include "imagekernels.h"
+#include "questionbank.h"
+#include "platform.h"
+
+namespace {
+
+// 查找图标时恢复操作（最大化窗口、滚动页面）后等待界面稳定的时间
+constexpr int kIconSettleDelayMs = 500;
+
+} // namespace
 
 Automator::Automator(QObject *parent)
     : QObject(parent)
@@ -18,6 +33,7 @@ Automator::Automator(QObject *parent)
     m_inputSimulator = new InputSimulator();
     m_questionManager = new QuestionManager();
     m_configManager = nullptr;  // 延迟初始化，避免在构造函数中访问未初始化的ConfigManager
+    m_journal = new JobJournal(this);
 
     // 连接日志信号，使用recordLog函数进行去重
     connect(m_weChatController, &WeChatController::logMessage,
@@ -28,8 +44,23 @@ Automator::Automator(QObject *parent)
             this, &Automator::recordLog);
     connect(m_questionManager, &QuestionManager::logMessage,
             this, &Automator::recordLog);
+    connect(m_journal, &JobJournal::logMessage,
+            this, &Automator::recordLog);
+
+    // 运行结束后导出时间线（排队执行，确保runAutomation中的所有区间都已结束）
+    connect(this, &Automator::automationCompleted,
+            this, &Automator::exportRunTrace, Qt::QueuedConnection);
+    connect(this, &Automator::automationCompleted,
+            this, &Automator::exportMatchDiagnostics, Qt::QueuedConnection);
+
+    // 同步进度到指标
+    connect(this, &Automator::progressUpdated, this, [](int current, int total) {
+        Metrics::setProgress(current, total);
+    });
     
-    // 删除识别区域信号连接，识别标识框功能已删除
+    // 转发识别区域，调试模式下由主窗口显示识别框
+    connect(m_imageRecognizer, &ImageRecognizer::recognitionAreaFound,
+            this, &Automator::recognitionAreaFound);
     
     // 连接模板未找到信号，不清除识别区域，让用户可以看到最后一次识别结果
     connect(m_imageRecognizer, &ImageRecognizer::templateNotFound,
@@ -86,6 +117,9 @@ bool Automator::start(int totalCount)
     m_totalCount = totalCount;
     m_currentCount = 0;
     m_stopRequested = false;
+    m_pauseRequested = false;
+    m_pendingLiveQuestions.clear();
+    m_pendingLibraryChanges.clear();
     // 重置ImageRecognizer的停止请求标志
     m_imageRecognizer->setStopRequested(false);
 
@@ -98,14 +132,52 @@ bool Automator::start(int totalCount)
     if (!m_configManager) {
         m_configManager = ConfigManager::getInstance();
     }
+    connect(m_configManager, &ConfigManager::questionLibraryReloaded,
+            this, &Automator::onQuestionLibraryReloaded, Qt::UniqueConnection);
+    connect(m_configManager, &ConfigManager::keywordLibraryReloaded,
+            this, &Automator::onKeywordLibraryReloaded, Qt::UniqueConnection);
     
     // 重新获取最新配置并应用到ImageRecognizer
     m_imageRecognizer->setRecognitionThreshold(m_configManager->getImageRecognitionThreshold());
     
+    // 按配置开启时间线追踪，并清空上次运行的记录
+    Tracer::setEnabled(m_configManager->getTraceEnabled());
+    Tracer::clear();
+    Metrics::increment(Metrics::RunsStarted);
+    
+    // 按配置开启模板匹配诊断，并清空上次运行的记录
+    MatchDiagnostics::configure(m_configManager->getMatchDiagnosticsEnabled(),
+                                m_configManager->getMatchDiagnosticsHistory(),
+                                m_configManager->getMatchDiagnosticsTopK());
+    MatchDiagnostics::clear();
+    
+    // 按配置选择图像内核的指令集，记录各内核实际使用的实现
+    ImageKernels::Level kernelLevel = ImageKernels::supportedLevel();
+    if (!ImageKernels::parseLevel(m_configManager->getImageKernelLevel(), &kernelLevel)) {
+        recordLog("[WARNING] 未知的图像内核指令集: " + m_configManager->getImageKernelLevel() + "，使用auto");
+    }
+    ImageKernels::setPreferredLevel(kernelLevel);
+    recordLog("图像内核: " + ImageKernels::describe());
+    
     // 初始化问题
-    m_questionManager->setPresetQuestions(m_configManager->getQuestionList());
+    // 二进制问题库只共享内存映射，启动耗时与问题数量无关
+    if (std::shared_ptr<const QuestionBank> bank = m_configManager->getQuestionBank()) {
+        m_questionManager->setQuestionBank(bank);
+    } else {
+        m_questionManager->setPresetQuestions(m_configManager->getQuestionList());
+    }
     m_questionManager->setKeywords(m_configManager->getKeywordList());
     
+    // 已发送问题索引与问题生成器状态（跨运行保存）
+    m_questionManager->openUsedIndex(QFileInfo(m_configManager->getConfigFilePath()).absolutePath() + "/used_questions.idx");
+    m_questionManager->openGeneratorState(QFileInfo(m_configManager->getConfigFilePath()).absolutePath() + "/generator.state");
+    
+    // 任务日志：确定从第几个问题开始
+    prepareJournal();
+    if (m_resumeFromCount > 0) {
+        emit progressUpdated(m_resumeFromCount, m_totalCount);
+    }
+    
     // 移动所有子对象到工作线程（仅在第一次启动时执行）
     static bool objectsMoved = false;
     if (!objectsMoved) {
@@ -173,6 +245,7 @@ void Automator::stop() {
 
 void Automator::runAutomation()
 {
+    TRACE_SCOPE("automation", "runAutomation");
     recordLog("[DEBUG] 开始执行自动化流程");
     
     try {
@@ -181,10 +254,12 @@ void Automator::runAutomation()
             m_configManager = ConfigManager::getInstance();
         }
         
+        // 取本次运行开始时的配置快照，之后每个问题边界重新取一次
+        m_config = m_configManager->snapshot();
+        recordLog(QString("[DEBUG] 使用配置版本 %1").arg(m_config->version));
+        
         // 设置图像识别阈值
-        m_imageRecognizer->setRecognitionThreshold(
-            m_configManager->getImageRecognitionThreshold()
-            );
+        m_imageRecognizer->setRecognitionThreshold(m_config->imageRecognitionThreshold);
         
         // 确保状态重置正确
         setState(Running);
@@ -200,6 +275,7 @@ void Automator::runAutomation()
     // 加载图像模板 - 移到工作线程中执行
     recordLog("[DEBUG] 开始加载图像模板");
     bool templatesLoaded = true;
+    qint64 loadTemplatesStartNs = Tracer::nowNs();
     
     // 检查是否请求停止
     if (m_stopRequested) {
@@ -209,7 +285,7 @@ void Automator::runAutomation()
     }
     
     recordLog("[DEBUG] 开始加载workbench模板");
-    templatesLoaded &= m_imageRecognizer->loadTemplate("workbench", m_configManager->getIconPath("workbench"));
+    templatesLoaded &= m_imageRecognizer->loadTemplate("workbench", m_config->iconPath("workbench"));
     recordLog(QString("[DEBUG] workbench模板加载完成，结果: %1").arg(templatesLoaded ? "成功" : "失败"));
     
     // 检查是否请求停止
@@ -220,7 +296,7 @@ void Automator::runAutomation()
     }
     
     recordLog("[DEBUG] 开始加载mindspark模板");
-    templatesLoaded &= m_imageRecognizer->loadTemplate("mindspark", m_configManager->getIconPath("mindspark"));
+    templatesLoaded &= m_imageRecognizer->loadTemplate("mindspark", m_config->iconPath("mindspark"));
     recordLog(QString("[DEBUG] mindspark模板加载完成，结果: %1").arg(templatesLoaded ? "成功" : "失败"));
     
     // 检查是否请求停止
@@ -231,7 +307,7 @@ void Automator::runAutomation()
     }
     
     recordLog("[DEBUG] 开始加载input_box模板");
-    templatesLoaded &= m_imageRecognizer->loadTemplate("input_box", m_configManager->getIconPath("input_box"));
+    templatesLoaded &= m_imageRecognizer->loadTemplate("input_box", m_config->iconPath("input_box"));
     recordLog(QString("[DEBUG] input_box模板加载完成，结果: %1").arg(templatesLoaded ? "成功" : "失败"));
     
     // 检查是否请求停止
@@ -242,7 +318,7 @@ void Automator::runAutomation()
     }
     
     recordLog("[DEBUG] 开始加载send_button模板");
-    templatesLoaded &= m_imageRecognizer->loadTemplate("send_button", m_configManager->getIconPath("send_button"));
+    templatesLoaded &= m_imageRecognizer->loadTemplate("send_button", m_config->iconPath("send_button"));
     recordLog(QString("[DEBUG] send_button模板加载完成，结果: %1").arg(templatesLoaded ? "成功" : "失败"));
     
     // 检查是否请求停止
@@ -254,11 +330,12 @@ void Automator::runAutomation()
     
     recordLog("[DEBUG] 开始加载历史对话模板");
     // 历史对话模板是可选的，如果加载失败不影响整体流程
-    bool historyLoaded = m_imageRecognizer->loadTemplate("history_dialog", m_configManager->getIconPath("history_dialog"));
+    bool historyLoaded = m_imageRecognizer->loadTemplate("history_dialog", m_config->iconPath("history_dialog"));
     // 尝试加载其他尺寸的历史对话模板
-    m_imageRecognizer->loadTemplate("history_dialog_small", m_configManager->getIconPath("history_dialog_small"));
-    m_imageRecognizer->loadTemplate("history_dialog_large", m_configManager->getIconPath("history_dialog_large"));
+    m_imageRecognizer->loadTemplate("history_dialog_small", m_config->iconPath("history_dialog_small"));
+    m_imageRecognizer->loadTemplate("history_dialog_large", m_config->iconPath("history_dialog_large"));
     recordLog(QString("[DEBUG] 历史对话模板加载完成，主要模板结果: %1").arg(historyLoaded ? "成功" : "失败"));
+    Tracer::record("loadTemplates", "automation", loadTemplatesStartNs, Tracer::nowNs());
 
     // 检查是否请求停止
     if (m_stopRequested) {
@@ -326,7 +403,7 @@ void Automator::runAutomation()
         
         QString errorMsg = "进入工作台失败";
         recordLog("[ERROR] " + errorMsg);
-        if (!m_configManager->getContinueOnError()) {
+        if (!m_config->continueOnError) {
             emit errorMessage(errorMsg);
             setState(Error);
             recordLog("[DEBUG] 状态已设置为Error");
@@ -360,7 +437,7 @@ void Automator::runAutomation()
         
         QString errorMsg = "打开MindSpark失败";
         recordLog("[ERROR] " + errorMsg);
-        if (!m_configManager->getContinueOnError()) {
+        if (!m_config->continueOnError) {
             emit errorMessage(errorMsg);
             setState(Error);
             recordLog("[DEBUG] 状态已设置为Error");
@@ -387,7 +464,7 @@ void Automator::runAutomation()
         
         QString errorMsg = "进入历史对话失败";
         recordLog("[ERROR] " + errorMsg);
-        if (!m_configManager->getContinueOnError()) {
+        if (!m_config->continueOnError) {
             emit errorMessage(errorMsg);
             setState(Error);
             recordLog("[DEBUG] 状态已设置为Error");
@@ -402,14 +479,14 @@ void Automator::runAutomation()
         recordLog("[DEBUG] 已成功进入历史对话界面");
     }
 
-    // 获取所有预设问题
+    // 获取预设问题数量（按需逐条读取，不拷贝整个问题列表）
     recordLog("[DEBUG] 开始获取所有预设问题");
-    QVector<QString> presetQuestions = m_questionManager->getPresetQuestions();
-    QStringList questions = presetQuestions.toList();
-    recordLog(QString("[DEBUG] 共获取到 %1 个预设问题").arg(questions.size()));
+    int presetCount = m_questionManager->presetCount();
+    recordLog(QString("[DEBUG] 共获取到 %1 个预设问题").arg(presetCount));
     
-    // 检查问题列表是否为空
-    if (questions.isEmpty()) {
+    // 检查问题列表是否为空（实时队列中有问题或保持会话时仍可继续）
+    const bool generateMode = m_questionManager->getQuestionMode() == QuestionManager::GenerateMode;
+    if (presetCount == 0 && !generateMode && pendingLiveQuestionCount() == 0 && !m_holdOpen) {
         recordLog("[WARNING] 预设问题列表为空，无法执行批量发送");
         onFinished();
         return;
@@ -417,7 +494,52 @@ void Automator::runAutomation()
     
     // 执行批量发送循环
     recordLog("[DEBUG] 开始执行批量发送，共 " + QString::number(m_totalCount) + " 个问题");
-    for (m_currentCount = 0; m_currentCount < m_totalCount; ++m_currentCount) {
+    m_questionManager->setCycleIndex(m_resumeCycleIndex);
+    for (m_currentCount = m_resumeFromCount; ; ++m_currentCount) {
+        // 在问题边界合并控制接口提交的问题，无需重新导航
+        drainLiveQueue();
+        
+        // 在问题边界应用问题库/关键词库文件的修改，循环位置不变
+        if (applyLibraryChanges()) {
+            presetCount = m_questionManager->presetCount();
+        }
+        
+        // 每个问题取一次配置快照，运行中修改的设置从下一个问题开始生效
+        std::shared_ptr<const ConfigSnapshot> config = m_configManager->snapshot();
+        if (config->version != m_config->version) {
+            recordLog(QString("[DEBUG] 配置已更新到版本 %1").arg(config->version));
+            if (config->imageRecognitionThreshold != m_config->imageRecognitionThreshold) {
+                m_imageRecognizer->setRecognitionThreshold(config->imageRecognitionThreshold);
+            }
+            m_config = std::move(config);
+        }
+        
+        // 计划的问题已发送完：保持会话时等待新问题，否则结束
+        if (m_currentCount >= m_totalCount) {
+            if (m_holdOpen && !m_stopRequested) {
+                recordLog("[INFO] 计划的问题已发送完，等待实时队列中的新问题");
+            }
+            while (m_holdOpen && !m_stopRequested && pendingLiveQuestionCount() == 0) {
+                nonBlockingDelay(200);
+            }
+            drainLiveQueue();
+            if (m_currentCount >= m_totalCount) {
+                break;
+            }
+        }
+        
+        // 暂停时在问题边界等待恢复
+        if (m_pauseRequested && !m_stopRequested) {
+            recordLog("[INFO] 自动化已暂停");
+            while (m_pauseRequested && !m_stopRequested) {
+                nonBlockingDelay(200);
+            }
+            if (!m_stopRequested) {
+                recordLog("[INFO] 自动化已恢复");
+            }
+        }
+        
+        TRACE_SCOPE_DETAIL("automation", "question", QString("#%1").arg(m_currentCount + 1));
         recordLog("[DEBUG] 开始发送第 " + QString::number(m_currentCount + 1) + "/" + QString::number(m_totalCount) + " 个问题");
         
         if (m_stopRequested) {
@@ -435,36 +557,60 @@ void Automator::runAutomation()
         QString question;
         int questionIndex;
         
-        if (questions.isEmpty()) {
+        m_currentQuestionLive = !m_pendingLiveQuestions.isEmpty();
+        if (m_currentQuestionLive) {
+            // 优先发送控制接口提交的问题
+            question = m_pendingLiveQuestions.takeFirst();
+        } else if (generateMode) {
+            // 生成模式：按模板×关键词空间的置换顺序生成问题，一轮内不重复
+            question = m_questionManager->generateUniqueQuestion();
+        } else if (presetCount == 0) {
             recordLog("[WARNING] 问题列表为空，跳过当前迭代");
             // 只在跳过当前迭代时手动增加计数，否则由for循环自动增加
             continue;
-        }
-        
-        // 根据问题模式获取问题
-        switch (m_questionManager->getQuestionMode()) {
-        case QuestionManager::RandomMode:
-            // 随机模式：每次随机选择一个问题
-            questionIndex = QRandomGenerator::global()->bounded(questions.size());
-            question = questions.at(questionIndex);
-            break;
-        case QuestionManager::CycleMode:
-        default:
-            // 循环模式：循环使用问题列表
-            questionIndex = m_currentCount % questions.size();
-            question = questions.at(questionIndex);
-            break;
+        } else {
+            // 根据问题模式获取问题
+            switch (m_questionManager->getQuestionMode()) {
+            case QuestionManager::RandomMode:
+                // 随机模式：按优先级权重随机选择一个问题
+                questionIndex = m_questionManager->samplePresetIndex();
+                question = m_questionManager->presetAt(questionIndex);
+                break;
+            case QuestionManager::ShuffleMode:
+                // 随机不重复模式：一轮内每个问题只发送一次
+                questionIndex = m_questionManager->nextShuffledPresetIndex();
+                question = m_questionManager->presetAt(questionIndex);
+                break;
+            case QuestionManager::CycleMode:
+            default:
+                // 循环模式：循环使用问题列表（问题库热加载后位置保持不变）
+                questionIndex = m_questionManager->nextCyclePresetIndex();
+                question = m_questionManager->presetAt(questionIndex);
+                break;
+            }
         }
         
         recordLog("[DEBUG] 准备发送问题: " + question);
         
-        bool sendResult = performQuestionAnswer(question);
+        bool sendResult;
+        {
+            MetricsStageTimer questionTimer(Metrics::StageQuestion);
+            sendResult = performQuestionAnswer(question);
+        }
         recordLog(QString("[DEBUG] 第 %1 个问题发送完成，结果: %2").arg(m_currentCount + 1).arg(sendResult ? "成功" : "失败"));
+        emit questionCompleted(m_currentCount + 1, question, sendResult);
+        if (sendResult) {
+            m_questionManager->markQuestionUsed(question);
+        }
 
         if (!sendResult) {
             recordLog(QString("[ERROR] 第 %1 个问题发送失败").arg(m_currentCount + 1));
+            Metrics::increment(Metrics::QuestionFailures);
+            if (!m_stopRequested) {
+                m_journal->recordQuestion(m_currentCount, JobJournal::Failed, QString(), m_currentQuestionLive);
+            }
 
-            if (!m_configManager->getContinueOnError()) {
+            if (!m_config->continueOnError) {
                 recordLog("[DEBUG] 配置为不继续错误，停止自动化");
                 setState(Error);
                 recordLog("[DEBUG] 状态已设置为Error");
@@ -486,11 +632,12 @@ void Automator::runAutomation()
         // 重置图像识别器状态
         m_imageRecognizer->setStopRequested(false);
         
-        // 如果不是最后一个问题，等待并处理事件
-        if (m_currentCount < m_totalCount - 1) {
+        // 如果不是最后一个问题（包括实时队列中待发送的问题），等待并处理事件
+        if (m_currentCount < m_totalCount - 1 || m_holdOpen || pendingLiveQuestionCount() > 0) {
             recordLog("[DEBUG] 开始等待，确保系统有足够时间处理当前请求");
             
             // 等待3秒，确保系统有足够时间响应
+            TRACE_SCOPE("automation", "interQuestionDelay");
             if (!waitWithESCDetection(3000)) {
                 recordLog("[INFO] 用户请求停止自动化");
                 break;
@@ -528,6 +675,14 @@ void Automator::onFinished()
         recordLog("[INFO] 自动化执行完成");
     }
     
+    // 记录运行结束：全部完成后下次重新开始，被停止则下次从中断处继续
+    if (m_journal->isOpen()) {
+        bool allDone = !m_stopRequested && m_currentCount >= m_totalCount;
+        m_journal->endRun(allDone ? "completed" : "stopped");
+    }
+    m_questionManager->flushUsedIndex();
+    m_questionManager->flushGeneratorState();
+    
     // 无论成功还是失败，都设置为Idle状态
     setState(Idle);
 
@@ -544,6 +699,12 @@ void Automator::onFinished()
 
 bool Automator::prepareWeChat()
 {
+    TRACE_SCOPE("automation", "prepareWeChat");
+    // 回放模式下没有真实的企业微信窗口，跳过此步骤
+    if (m_replayMode) {
+        return true;
+    }
+
     recordLog("[DEBUG] 开始执行prepareWeChat函数");
     // 获取企业微信路径
     QString weChatPath = m_configManager->getWeChatPath();
@@ -602,12 +763,18 @@ bool Automator::prepareWeChat()
 
 bool Automator::enterWeChatWorkbench()
 {
+    TRACE_SCOPE("automation", "enterWeChatWorkbench");
+    // 回放模式下没有真实的企业微信窗口，跳过此步骤
+    if (m_replayMode) {
+        return true;
+    }
+
     recordLog("[DEBUG] 开始执行enterWeChatWorkbench函数");
 
     try {
         // 获取企业微信窗口句柄
         recordLog("[DEBUG] 获取企业微信窗口句柄");
-        HWND hwnd = m_weChatController->getWeChatWindowHandle();
+        WindowHandle hwnd = m_weChatController->getWeChatWindowHandle();
         if (!hwnd) {
             recordLog("[ERROR] 无法获取企业微信窗口句柄");
             QString errorMsg = "无法获取企业微信窗口句柄，无法继续操作";
@@ -619,67 +786,37 @@ bool Automator::enterWeChatWorkbench()
     QPoint workbenchPos;
     bool found = false;
     
-    // 多次尝试查找工作台位置（仅使用图像识别）
-    const int maxAttempts = 5;
-    recordLog("[DEBUG] 开始查找工作台图标，最大尝试次数: " + QString::number(maxAttempts));
+    // 查找工作台图标：找不到时重新最大化窗口再找，最后用特征匹配兜底
+    recordLog("[DEBUG] 开始查找工作台图标");
+    const QString workbenchTemplate = locateIcon(hwnd, {"workbench"}, [this, hwnd]() {
+        recordLog("[DEBUG] 未找到工作台图标，重新最大化窗口");
+        Platform::showWindow(hwnd, Platform::ShowMaximized);
+    }, &workbenchPos);
+    if (m_stopRequested) {
+        recordLog("[INFO] 收到停止请求，退出enterWeChatWorkbench");
+        return false;
+    }
     
-    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
-        recordLog(QString("[DEBUG] 尝试 %1/%2 查找工作台图标").arg(attempt + 1).arg(maxAttempts));
+    if (!workbenchTemplate.isEmpty()) {
+        found = true;
+        recordLog(QString("[INFO] 图像识别找到工作台图标位置: (%1, %2)").arg(workbenchPos.x()).arg(workbenchPos.y()));
         
-        // 检查是否请求停止
-        if (m_stopRequested) {
-            recordLog("[INFO] 收到停止请求，退出enterWeChatWorkbench");
-            return false;
-        }
-        
-        // 1. 捕获企业微信首页截图
-        QImage windowImage = m_imageRecognizer->captureWindow(hwnd);
-        if (windowImage.isNull()) {
-            recordLog("[ERROR] 无法捕获企业微信窗口图像");
-            continue;
+        // 获取模板尺寸，计算点击位置为识别区域的中心点
+        ConfigManager* config = ConfigManager::getInstance();
+        QSize templateSize = config->getTemplateSize(workbenchTemplate);
+        if (templateSize.width() == 100 && templateSize.height() == 100) {
+            // 如果配置中没有保存尺寸，使用默认尺寸
+            templateSize = QSize(64, 64);
         }
         
-        // 2. 在截图左侧区域进行工作台识别
-        recordLog("[DEBUG] 在截图左侧区域进行工作台识别");
-        if (m_imageRecognizer->findTemplateInWindow(hwnd, "workbench", workbenchPos)) {
-            found = true;
-            recordLog(QString("[INFO] 图像识别找到工作台图标位置: (%1, %2)").arg(workbenchPos.x()).arg(workbenchPos.y()));
-            
-            // 获取模板尺寸，计算点击位置为识别区域的中心点
-            ConfigManager* config = ConfigManager::getInstance();
-            QSize templateSize = config->getTemplateSize("workbench");
-            if (templateSize.width() == 100 && templateSize.height() == 100) {
-                // 如果配置中没有保存尺寸，使用默认尺寸
-                templateSize = QSize(64, 64);
-            }
-            
-            // 计算中心点坐标
-            workbenchPos.setX(workbenchPos.x() + templateSize.width() / 2);
-            workbenchPos.setY(workbenchPos.y() + templateSize.height() / 2);
-            recordLog(QString("[DEBUG] 计算得到工作台图标中心点位置: (%1, %2)").arg(workbenchPos.x()).arg(workbenchPos.y()));
-            break;
-        }
-        
-        recordLog(QString("[DEBUG] 未找到工作台图标，尝试 %1/%2").arg(attempt + 1).arg(maxAttempts));
-        
-        // 如果是第一次尝试失败，尝试重新最大化窗口
-        if (attempt == 0) {
-            recordLog("[DEBUG] 第一次尝试失败，尝试重新最大化窗口");
-            // 重新最大化窗口，确保完全显示
-            ShowWindow(hwnd, SW_MAXIMIZE);
-            recordLog("[DEBUG] 已重新最大化窗口，重新尝试查找工作台图标");
-        }
-        
-        // 等待一段时间后重试，使用waitWithESCDetection
-        recordLog("[DEBUG] 等待1秒后重试");
-        if (!waitWithESCDetection(1000)) {
-            recordLog("[INFO] 收到停止请求，退出enterWeChatWorkbench");
-            return false;
-        }
+        // 计算中心点坐标
+        workbenchPos.setX(workbenchPos.x() + templateSize.width() / 2);
+        workbenchPos.setY(workbenchPos.y() + templateSize.height() / 2);
+        recordLog(QString("[DEBUG] 计算得到工作台图标中心点位置: (%1, %2)").arg(workbenchPos.x()).arg(workbenchPos.y()));
     }
 
     if (!found) {
-        recordLog("[ERROR] 多次尝试后仍未找到工作台图标，无法继续操作");
+        recordLog("[ERROR] 相关匹配和特征匹配都未找到工作台图标，无法继续操作");
         QString errorMsg = "无法识别工作台图标，请检查企业微信是否正常运行或调整识别参数";
         emit errorMessage(errorMsg);
         this->stop();
@@ -687,11 +824,8 @@ bool Automator::enterWeChatWorkbench()
     }
 
     // 转换为屏幕坐标
-            POINT clientPos = {workbenchPos.x(), workbenchPos.y()};
-            POINT screenPos;
-            ClientToScreen(hwnd, &clientPos);
-            screenPos = clientPos;
-            recordLog(QString("[DEBUG] 转换为屏幕坐标: (%1, %2)").arg(screenPos.x).arg(screenPos.y));
+            const QPoint screenPos = Platform::clientToScreen(hwnd, workbenchPos);
+            recordLog(QString("[DEBUG] 转换为屏幕坐标: (%1, %2)").arg(screenPos.x()).arg(screenPos.y()));
 
             // 等待识别框显示，确保用户能看到识别结果
             recordLog("[DEBUG] 等待200毫秒，确保识别框显示");
@@ -699,11 +833,11 @@ bool Automator::enterWeChatWorkbench()
 
             // 点击工作台图标
             recordLog("[DEBUG] 准备点击工作台图标");
-            m_inputSimulator->clickAt(screenPos.x, screenPos.y);
+            m_inputSimulator->clickAt(screenPos.x(), screenPos.y());
             recordLog("[DEBUG] 点击工作台图标完成");
     
     // 等待工作台加载，根据系统性能调整等待时间
-    int waitTime = m_configManager->getPageLoadTimeout();
+    int waitTime = m_config->pageLoadTimeout;
     recordLog(QString("[DEBUG] 开始等待工作台加载，等待时间: %1 毫秒").arg(waitTime));
     
     // 使用QThread::msleep代替事件循环，避免窗口焦点问题
@@ -735,12 +869,18 @@ bool Automator::enterWeChatWorkbench()
 
 bool Automator::openMindSpark()
 {
+    TRACE_SCOPE("automation", "openMindSpark");
+    // 回放模式下没有真实的企业微信窗口，跳过此步骤
+    if (m_replayMode) {
+        return true;
+    }
+
     recordLog("[DEBUG] 开始执行openMindSpark函数");
 
     try {
         // 获取企业微信窗口句柄
         recordLog("[DEBUG] 获取企业微信窗口句柄");
-        HWND hwnd = m_weChatController->getWeChatWindowHandle();
+        WindowHandle hwnd = m_weChatController->getWeChatWindowHandle();
         if (!hwnd) {
             recordLog("[ERROR] 无法获取企业微信窗口句柄");
             return false;
@@ -750,150 +890,38 @@ bool Automator::openMindSpark()
     QPoint mindsparkPos;
     bool found = false;
     
-    // 多次尝试查找MindSpark图标位置（仅使用图像识别）
-    const int maxAttempts = 5;
-    recordLog("[DEBUG] 开始查找MindSpark图标，最大尝试次数: " + QString::number(maxAttempts));
-    
-    // 定义模板优先级：先尝试小图标，再尝试大图标
-    QStringList smallIconTemplates = {"mindspark_small"};
-    QStringList largeIconTemplates = {"mindspark"};
-    
-    // 1. 先尝试识别小图标
-    recordLog("[DEBUG] 开始尝试识别MindSpark小图标");
-    for (int attempt = 0; attempt < maxAttempts && !found && !m_stopRequested; ++attempt) {
-        recordLog(QString("[DEBUG] 尝试 %1/%2 查找MindSpark小图标").arg(attempt + 1).arg(maxAttempts));
-        
-        // 尝试所有小图标模板
-        for (const QString& templateName : smallIconTemplates) {
-            recordLog(QString("[DEBUG] 使用模板 '%1' 查找MindSpark小图标").arg(templateName));
-            if (m_imageRecognizer->findTemplateInWindow(hwnd, templateName, mindsparkPos)) {
-                found = true;
-                recordLog(QString("[INFO] 使用模板 '%1' 找到MindSpark小图标，位置: (%2, %3)").arg(templateName).arg(mindsparkPos.x()).arg(mindsparkPos.y()));
-                
-                // 获取模板尺寸，计算点击位置为识别区域的中心点
-                ConfigManager* config = ConfigManager::getInstance();
-                QSize templateSize = config->getTemplateSize(templateName);
-                if (templateSize.width() == 100 && templateSize.height() == 100) {
-                    // 如果配置中没有保存尺寸，使用默认尺寸
-                    templateSize = QSize(48, 48);
-                }
-                
-                // 计算中心点坐标
-                mindsparkPos.setX(mindsparkPos.x() + templateSize.width() / 2);
-                mindsparkPos.setY(mindsparkPos.y() + templateSize.height() / 2);
-                recordLog(QString("[DEBUG] 计算得到MindSpark小图标中心点位置: (%1, %2)").arg(mindsparkPos.x()).arg(mindsparkPos.y()));
-                break;
-            }
-            recordLog(QString("[DEBUG] 使用模板 '%1' 未找到MindSpark小图标").arg(templateName));
-        }
-        
-        if (found) break;
-        
-        // 如果是第一次尝试失败，尝试滚动工作台页面
-        if (attempt == 0) {
-            recordLog("[DEBUG] 第一次尝试失败，尝试滚动工作台页面");
-            // 获取窗口客户区大小
-            RECT clientRect;
-            GetClientRect(hwnd, &clientRect);
-            int clientWidth = clientRect.right - clientRect.left;
-            int clientHeight = clientRect.bottom - clientRect.top;
-            recordLog(QString("[DEBUG] 客户区大小: %1x%2").arg(clientWidth).arg(clientHeight));
-            
-            // 计算滚动起点和终点（从中间向上滚动）
-            POINT startPos = {clientWidth / 2, clientHeight / 2};
-            POINT endPos = {clientWidth / 2, clientHeight / 4};
-            recordLog(QString("[DEBUG] 滚动起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x).arg(startPos.y).arg(endPos.x).arg(endPos.y));
-            
-            // 转换为屏幕坐标
-            ClientToScreen(hwnd, &startPos);
-            ClientToScreen(hwnd, &endPos);
-            recordLog(QString("[DEBUG] 转换为屏幕坐标 - 起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x).arg(startPos.y).arg(endPos.x).arg(endPos.y));
-            
-            // 执行滚动操作
-            recordLog("[DEBUG] 执行滚动操作");
-            m_inputSimulator->dragMouse(startPos.x, startPos.y, endPos.x, endPos.y);
-            recordLog("[DEBUG] 已滚动工作台页面，重新查找MindSpark小图标");
-        }
-        
-        // 等待一段时间后重试
-        recordLog("[DEBUG] 等待1秒后重试");
-        if (!waitWithESCDetection(1000)) {
-            recordLog("[INFO] 收到停止请求，退出openMindSpark");
-            return false;
-        }
+    // 查找MindSpark图标：小图标和大图标一起找，找不到时滚动工作台页面再找，最后用特征匹配兜底
+    recordLog("[DEBUG] 开始查找MindSpark图标");
+    const QString mindsparkTemplate = locateIcon(hwnd, {"mindspark_small", "mindspark"}, [this, hwnd]() {
+        recordLog("[DEBUG] 未找到MindSpark图标，滚动工作台页面");
+        scrollClientArea(hwnd);
+    }, &mindsparkPos);
+    if (m_stopRequested) {
+        recordLog("[INFO] 收到停止请求，退出openMindSpark");
+        return false;
     }
     
-    // 2. 如果未识别到小图标，尝试识别大图标
-    if (!found && !m_stopRequested) {
-        recordLog("[DEBUG] 未找到MindSpark小图标，开始尝试识别大图标");
+    if (!mindsparkTemplate.isEmpty()) {
+        found = true;
+        recordLog(QString("[INFO] 使用模板 '%1' 找到MindSpark图标，位置: (%2, %3)").arg(mindsparkTemplate).arg(mindsparkPos.x()).arg(mindsparkPos.y()));
         
-        for (int attempt = 0; attempt < maxAttempts && !found && !m_stopRequested; ++attempt) {
-            recordLog(QString("[DEBUG] 尝试 %1/%2 查找MindSpark大图标").arg(attempt + 1).arg(maxAttempts));
-            
-            // 尝试所有大图标模板
-            for (const QString& templateName : largeIconTemplates) {
-                recordLog(QString("[DEBUG] 使用模板 '%1' 查找MindSpark大图标").arg(templateName));
-                if (m_imageRecognizer->findTemplateInWindow(hwnd, templateName, mindsparkPos)) {
-                    found = true;
-                    recordLog(QString("[INFO] 使用模板 '%1' 找到MindSpark大图标，位置: (%2, %3)").arg(templateName).arg(mindsparkPos.x()).arg(mindsparkPos.y()));
-                    
-                    // 获取模板尺寸，计算点击位置为识别区域的中心点
-                    ConfigManager* config = ConfigManager::getInstance();
-                    QSize templateSize = config->getTemplateSize(templateName);
-                    if (templateSize.width() == 100 && templateSize.height() == 100) {
-                        // 如果配置中没有保存尺寸，使用默认尺寸
-                        templateSize = QSize(64, 64);
-                    }
-                    
-                    // 计算中心点坐标
-                    mindsparkPos.setX(mindsparkPos.x() + templateSize.width() / 2);
-                    mindsparkPos.setY(mindsparkPos.y() + templateSize.height() / 2);
-                    recordLog(QString("[DEBUG] 计算得到MindSpark大图标中心点位置: (%1, %2)").arg(mindsparkPos.x()).arg(mindsparkPos.y()));
-                    break;
-                }
-                recordLog(QString("[DEBUG] 使用模板 '%1' 未找到MindSpark大图标").arg(templateName));
-            }
-            
-            if (found) break;
-            
-            // 如果是第一次尝试失败，尝试滚动工作台页面
-            if (attempt == 0) {
-                recordLog("[DEBUG] 第一次尝试失败，尝试滚动工作台页面");
-                // 获取窗口客户区大小
-                RECT clientRect;
-                GetClientRect(hwnd, &clientRect);
-                int clientWidth = clientRect.right - clientRect.left;
-                int clientHeight = clientRect.bottom - clientRect.top;
-                recordLog(QString("[DEBUG] 客户区大小: %1x%2").arg(clientWidth).arg(clientHeight));
-                
-                // 计算滚动起点和终点（从中间向上滚动）
-                POINT startPos = {clientWidth / 2, clientHeight / 2};
-                POINT endPos = {clientWidth / 2, clientHeight / 4};
-                recordLog(QString("[DEBUG] 滚动起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x).arg(startPos.y).arg(endPos.x).arg(endPos.y));
-                
-                // 转换为屏幕坐标
-                ClientToScreen(hwnd, &startPos);
-                ClientToScreen(hwnd, &endPos);
-                recordLog(QString("[DEBUG] 转换为屏幕坐标 - 起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x).arg(startPos.y).arg(endPos.x).arg(endPos.y));
-                
-                // 执行滚动操作
-                recordLog("[DEBUG] 执行滚动操作");
-                m_inputSimulator->dragMouse(startPos.x, startPos.y, endPos.x, endPos.y);
-                recordLog("[DEBUG] 已滚动工作台页面，重新查找MindSpark大图标");
-            }
-            
-            // 等待一段时间后重试
-            recordLog("[DEBUG] 等待1秒后重试");
-            if (!waitWithESCDetection(1000)) {
-                recordLog("[INFO] 收到停止请求，退出openMindSpark");
-                return false;
-            }
+        // 获取模板尺寸，计算点击位置为识别区域的中心点
+        ConfigManager* config = ConfigManager::getInstance();
+        QSize templateSize = config->getTemplateSize(mindsparkTemplate);
+        if (templateSize.width() == 100 && templateSize.height() == 100) {
+            // 如果配置中没有保存尺寸，使用默认尺寸
+            templateSize = mindsparkTemplate == "mindspark_small" ? QSize(48, 48) : QSize(64, 64);
         }
+        
+        // 计算中心点坐标
+        mindsparkPos.setX(mindsparkPos.x() + templateSize.width() / 2);
+        mindsparkPos.setY(mindsparkPos.y() + templateSize.height() / 2);
+        recordLog(QString("[DEBUG] 计算得到MindSpark图标中心点位置: (%1, %2)").arg(mindsparkPos.x()).arg(mindsparkPos.y()));
     }
     
     // 3. 如果仍然没有找到，显示错误信息
     if (!found) {
-        recordLog("[ERROR] 多次尝试后仍未找到MindSpark图标，无法继续操作");
+        recordLog("[ERROR] 相关匹配和特征匹配都未找到MindSpark图标，无法继续操作");
         QString errorMsg = "无法识别MindSpark图标，请检查企业微信是否正常运行或调整识别参数";
         emit errorMessage(errorMsg);
         // 设置停止标志，让调用者处理后续逻辑，避免重复调用stop()导致崩溃
@@ -902,19 +930,16 @@ bool Automator::openMindSpark()
     }
 
     // 转换为屏幕坐标
-    POINT clientPos = {mindsparkPos.x(), mindsparkPos.y()};
-    POINT screenPos;
-    ClientToScreen(hwnd, &clientPos);
-    screenPos = clientPos;
-    recordLog(QString("[DEBUG] 转换为屏幕坐标: (%1, %2)").arg(screenPos.x).arg(screenPos.y));
+    const QPoint screenPos = Platform::clientToScreen(hwnd, mindsparkPos);
+    recordLog(QString("[DEBUG] 转换为屏幕坐标: (%1, %2)").arg(screenPos.x()).arg(screenPos.y()));
 
     // 点击MindSpark
     recordLog("[DEBUG] 准备点击MindSpark");
-    m_inputSimulator->clickAt(screenPos.x, screenPos.y);
+    m_inputSimulator->clickAt(screenPos.x(), screenPos.y());
     recordLog("[DEBUG] 点击完成");
     
     // 等待MindSpark加载，根据系统性能调整等待时间
-    int waitTime = m_configManager->getPageLoadTimeout();
+    int waitTime = m_config->pageLoadTimeout;
     recordLog(QString("[DEBUG] 开始等待MindSpark加载，等待时间: %1 毫秒").arg(waitTime));
     
     // 使用QThread::msleep代替事件循环，避免窗口焦点问题
@@ -981,12 +1006,18 @@ bool Automator::openMindSpark()
 
 bool Automator::enterHistoryDialog()
 {
+    TRACE_SCOPE("automation", "enterHistoryDialog");
+    // 回放模式下没有真实的企业微信窗口，跳过此步骤
+    if (m_replayMode) {
+        return true;
+    }
+
     recordLog("[DEBUG] 开始执行enterHistoryDialog函数");
 
     try {
         // 获取企业微信窗口句柄
         recordLog("[DEBUG] 获取企业微信窗口句柄");
-        HWND hwnd = m_weChatController->getWeChatWindowHandle();
+        WindowHandle hwnd = m_weChatController->getWeChatWindowHandle();
         if (!hwnd) {
             recordLog("[ERROR] 无法获取企业微信窗口句柄");
             return false;
@@ -996,97 +1027,37 @@ bool Automator::enterHistoryDialog()
     QPoint historyDialogPos;
     bool found = false;
     
-    // 多次尝试查找历史对话图标位置（仅使用图像识别）
-    const int maxAttempts = 5;
-    recordLog("[DEBUG] 开始查找历史对话图标，最大尝试次数: " + QString::number(maxAttempts));
-    
-    // 只使用默认的历史对话模板
-    QStringList templateNames = {"history_dialog"};
-    recordLog("[DEBUG] 准备尝试的模板: " + templateNames.join(", "));
+    // 查找历史对话图标：找不到时滚动页面再找，最后用特征匹配兜底
+    recordLog("[DEBUG] 开始查找历史对话图标");
+    const QString historyTemplate = locateIcon(hwnd, {"history_dialog"}, [this, hwnd]() {
+        recordLog("[DEBUG] 未找到历史对话图标，滚动页面");
+        scrollClientArea(hwnd);
+    }, &historyDialogPos);
+    if (m_stopRequested) {
+        recordLog("[INFO] 收到停止请求，退出enterHistoryDialog");
+        return false;
+    }
     
-    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
-        recordLog(QString("[DEBUG] 尝试 %1/%2 查找历史对话图标").arg(attempt + 1).arg(maxAttempts));
-        
-        // 检查是否请求停止
-        if (m_stopRequested) {
-            recordLog("[INFO] 收到停止请求，退出enterHistoryDialog");
-            return false;
-        }
+    if (!historyTemplate.isEmpty()) {
+        found = true;
+        recordLog(QString("[INFO] 使用模板 '%1' 找到历史对话图标，位置: (%2, %3)").arg(historyTemplate).arg(historyDialogPos.x()).arg(historyDialogPos.y()));
         
-        // 1. 捕获MindSpark界面截图
-        QImage mindsparkImage = m_imageRecognizer->captureWindow(hwnd);
-    
-        // 2. 尝试图像识别查找历史对话图标
-        recordLog("[DEBUG] 尝试图像识别查找历史对话图标");
-        // 尝试所有可能的模板
-        bool templateFound = false;
-        for (const QString& templateName : templateNames) {
-            recordLog(QString("[DEBUG] 使用模板 '%1' 查找历史对话图标").arg(templateName));
-            if (m_imageRecognizer->findTemplateInWindow(hwnd, templateName, historyDialogPos)) {
-                found = true;
-                templateFound = true;
-                recordLog(QString("[INFO] 使用模板 '%1' 找到历史对话图标，位置: (%2, %3)").arg(templateName).arg(historyDialogPos.x()).arg(historyDialogPos.y()));
-                
-                // 获取模板尺寸，计算点击位置为识别区域的中心点
-                ConfigManager* config = ConfigManager::getInstance();
-                QSize templateSize = config->getTemplateSize(templateName);
-                if (templateSize.width() == 100 && templateSize.height() == 100) {
-                    // 如果配置中没有保存尺寸，使用默认尺寸
-                    templateSize = QSize(64, 64);
-                }
-                
-                // 计算中心点坐标
-                historyDialogPos.setX(historyDialogPos.x() + templateSize.width() / 2);
-                historyDialogPos.setY(historyDialogPos.y() + templateSize.height() / 2);
-                recordLog(QString("[DEBUG] 计算得到历史对话图标中心点位置: (%1, %2)").arg(historyDialogPos.x()).arg(historyDialogPos.y()));
-                break;
-            }
-            recordLog(QString("[DEBUG] 使用模板 '%1' 未找到历史对话图标").arg(templateName));
+        // 获取模板尺寸，计算点击位置为识别区域的中心点
+        ConfigManager* config = ConfigManager::getInstance();
+        QSize templateSize = config->getTemplateSize(historyTemplate);
+        if (templateSize.width() == 100 && templateSize.height() == 100) {
+            // 如果配置中没有保存尺寸，使用默认尺寸
+            templateSize = QSize(64, 64);
         }
         
-        if (templateFound) break;
-        
-        recordLog(QString("[DEBUG] 未找到历史对话图标，尝试 %1/%2").arg(attempt + 1).arg(maxAttempts));
-        
-        // 如果是第一次尝试失败，尝试滚动页面
-        if (attempt == 0 || attempt == 2) {
-            recordLog("[DEBUG] 尝试滚动页面");
-            // 获取窗口客户区大小
-            RECT clientRect;
-            GetClientRect(hwnd, &clientRect);
-            int clientWidth = clientRect.right - clientRect.left;
-            int clientHeight = clientRect.bottom - clientRect.top;
-            recordLog(QString("[DEBUG] 客户区大小: %1x%2").arg(clientWidth).arg(clientHeight));
-            
-            // 计算滚动起点和终点（从中间向上滚动）
-            POINT startPos = {clientWidth / 2, clientHeight / 2};
-            POINT endPos = {clientWidth / 2, clientHeight / 4};
-            recordLog(QString("[DEBUG] 滚动起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x).arg(startPos.y).arg(endPos.x).arg(endPos.y));
-            
-            // 转换为屏幕坐标
-            ClientToScreen(hwnd, &startPos);
-            ClientToScreen(hwnd, &endPos);
-            recordLog(QString("[DEBUG] 转换为屏幕坐标 - 起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x).arg(startPos.y).arg(endPos.x).arg(endPos.y));
-            
-            // 执行滚动操作
-            recordLog("[DEBUG] 执行滚动操作");
-            m_inputSimulator->dragMouse(startPos.x, startPos.y, endPos.x, endPos.y);
-            recordLog("[DEBUG] 已滚动页面，重新查找历史对话图标");
-        }
-        
-        // 等待一段时间后重试，使用QThread::msleep
-        recordLog("[DEBUG] 等待1秒后重试");
-        QThread::msleep(1000);
-        
-        // 检查是否请求停止
-        if (m_stopRequested) {
-            recordLog("[INFO] 收到停止请求，退出enterHistoryDialog");
-            return false;
-        }
+        // 计算中心点坐标
+        historyDialogPos.setX(historyDialogPos.x() + templateSize.width() / 2);
+        historyDialogPos.setY(historyDialogPos.y() + templateSize.height() / 2);
+        recordLog(QString("[DEBUG] 计算得到历史对话图标中心点位置: (%1, %2)").arg(historyDialogPos.x()).arg(historyDialogPos.y()));
     }
 
     if (!found) {
-        recordLog("[ERROR] 多次尝试后仍未找到历史对话图标，无法继续操作");
+        recordLog("[ERROR] 相关匹配和特征匹配都未找到历史对话图标，无法继续操作");
         QString errorMsg = "无法识别历史对话图标，请检查企业微信是否正常运行或调整识别参数";
         emit errorMessage(errorMsg);
         this->stop();
@@ -1094,19 +1065,16 @@ bool Automator::enterHistoryDialog()
     }
 
     // 转换为屏幕坐标
-    POINT clientPos = {historyDialogPos.x(), historyDialogPos.y()};
-    POINT screenPos;
-    ClientToScreen(hwnd, &clientPos);
-    screenPos = clientPos;
-    recordLog(QString("[DEBUG] 转换为屏幕坐标: (%1, %2)").arg(screenPos.x).arg(screenPos.y));
+    const QPoint screenPos = Platform::clientToScreen(hwnd, historyDialogPos);
+    recordLog(QString("[DEBUG] 转换为屏幕坐标: (%1, %2)").arg(screenPos.x()).arg(screenPos.y()));
 
     // 点击历史对话图标
     recordLog("[DEBUG] 准备点击历史对话图标");
-    m_inputSimulator->clickAt(screenPos.x, screenPos.y);
+    m_inputSimulator->clickAt(screenPos.x(), screenPos.y());
     recordLog("[DEBUG] 点击完成");
     
     // 等待历史对话界面加载，根据系统性能调整等待时间
-    int waitTime = m_configManager->getPageLoadTimeout();
+    int waitTime = m_config->pageLoadTimeout;
     recordLog(QString("[DEBUG] 开始等待历史对话界面加载，等待时间: %1 毫秒").arg(waitTime));
     
     // 使用waitWithESCDetection代替QThread::msleep，支持ESC按键检测
@@ -1130,9 +1098,10 @@ bool Automator::enterHistoryDialog()
 
     bool Automator::performQuestionAnswer(const QString& question)
 {    
+    TRACE_SCOPE("automation", "performQuestionAnswer");
     try {
         // 获取企业微信窗口句柄
-        HWND hwnd = m_weChatController->getWeChatWindowHandle();
+        WindowHandle hwnd = targetWindowHandle();
         if (!hwnd) {
             recordLog("[ERROR] 无法获取企业微信窗口句柄");
             return false;
@@ -1187,7 +1156,7 @@ bool Automator::enterHistoryDialog()
         
         // 如果没找到，短暂延时后重试
         if (!foundInputBox && retry < maxRetries - 1) {
-            QThread::msleep(500);
+            settleDelay(500);
             recordLog(QString("[DEBUG] 输入框识别失败，%1毫秒后重试").arg(500));
         }
     }
@@ -1197,10 +1166,9 @@ bool Automator::enterHistoryDialog()
         
         // 获取窗口客户区大小
         recordLog("[DEBUG] 获取窗口客户区大小");
-        RECT clientRect;
-        GetClientRect(hwnd, &clientRect);
-        int clientWidth = clientRect.right - clientRect.left;
-        int clientHeight = clientRect.bottom - clientRect.top;
+        const QSize clientSize = Platform::clientSize(hwnd);
+        int clientWidth = clientSize.width();
+        int clientHeight = clientSize.height();
         recordLog(QString("[DEBUG] 客户区大小: %1x%2").arg(clientWidth).arg(clientHeight));
         
         // 优化：使用更精确的固定位置计算
@@ -1211,11 +1179,8 @@ bool Automator::enterHistoryDialog()
     }
 
     // 转换为屏幕坐标
-    POINT clientPos = {inputBoxPos.x(), inputBoxPos.y()};
-    POINT inputScreenPos;
-    ClientToScreen(hwnd, &clientPos);
-    inputScreenPos = clientPos;
-    recordLog(QString("[DEBUG] 输入框屏幕坐标: (%1, %2)").arg(inputScreenPos.x).arg(inputScreenPos.y));
+    const QPoint inputScreenPos = Platform::clientToScreen(hwnd, inputBoxPos);
+    recordLog(QString("[DEBUG] 输入框屏幕坐标: (%1, %2)").arg(inputScreenPos.x()).arg(inputScreenPos.y()));
 
     // 使用传入的问题
      recordLog("[DEBUG] 准备发送问题: " + question);
@@ -1227,32 +1192,32 @@ bool Automator::enterHistoryDialog()
      recordLog(QString("[DEBUG] 最终发送问题: %1").arg(finalQuestion));
 
      // 确保企业微信窗口在前台
-     SetForegroundWindow(hwnd);
-     QThread::msleep(500);
+     Platform::setForegroundWindow(hwnd);
+     settleDelay(500);
      
      // 确保输入框获得焦点 - 更可靠的点击方式
      recordLog("[DEBUG] 第一次点击输入框，确保获得焦点");
-     m_inputSimulator->clickAt(inputScreenPos.x, inputScreenPos.y);
+     m_inputSimulator->clickAt(inputScreenPos.x(), inputScreenPos.y());
      
      // 短暂延时后再次点击，确保焦点获取
-     QThread::msleep(300);
+     settleDelay(300);
      recordLog("[DEBUG] 第二次点击输入框，确保获得焦点");
-     m_inputSimulator->clickAt(inputScreenPos.x, inputScreenPos.y);
+     m_inputSimulator->clickAt(inputScreenPos.x(), inputScreenPos.y());
      
      // 增加更长的延时，确保输入框完全获得焦点
-     QThread::msleep(1500); 
+     settleDelay(1500); 
      
      // 简化焦点验证，直接检查前台窗口
-     HWND focusedHwnd = GetForegroundWindow();
+     WindowHandle focusedHwnd = Platform::foregroundWindow();
      if (focusedHwnd != hwnd) {
          recordLog(QString("[WARNING] 前台窗口不是企业微信窗口，尝试再次激活"));
-         SetForegroundWindow(hwnd);
-         QThread::msleep(500);
+         Platform::setForegroundWindow(hwnd);
+         settleDelay(500);
          
          // 第三次点击输入框
          recordLog("[DEBUG] 第三次点击输入框，确保获得焦点");
-         m_inputSimulator->clickAt(inputScreenPos.x, inputScreenPos.y);
-         QThread::msleep(1000);
+         m_inputSimulator->clickAt(inputScreenPos.x(), inputScreenPos.y());
+         settleDelay(1000);
      }
      
      recordLog("[DEBUG] 输入框焦点处理完成，准备输入文字");
@@ -1279,7 +1244,7 @@ bool Automator::enterHistoryDialog()
      recordLog("[DEBUG] 问题输入完成");
      
      // 等待500ms，确保输入完成
-     QThread::msleep(500);
+     settleDelay(500);
 
     // 3. 点击发送按钮，尝试多个模板变体
     QPoint sendBtnPos;
@@ -1319,59 +1284,67 @@ bool Automator::enterHistoryDialog()
     
     if (foundSendButton) {
          recordLog("[DEBUG] 准备点击发送按钮");
-         POINT clientPos = {sendBtnPos.x(), sendBtnPos.y()};
-         POINT sendScreenPos;
-         ClientToScreen(hwnd, &clientPos);
-         sendScreenPos = clientPos;
-         recordLog(QString("[DEBUG] 发送按钮屏幕坐标: (%1, %2)").arg(sendScreenPos.x).arg(sendScreenPos.y));
+         const QPoint sendScreenPos = Platform::clientToScreen(hwnd, sendBtnPos);
+         recordLog(QString("[DEBUG] 发送按钮屏幕坐标: (%1, %2)").arg(sendScreenPos.x()).arg(sendScreenPos.y()));
          
          // 单次点击发送按钮
-         m_inputSimulator->clickAt(sendScreenPos.x, sendScreenPos.y);
+         m_inputSimulator->clickAt(sendScreenPos.x(), sendScreenPos.y());
          recordLog("[DEBUG] 发送按钮点击完成");
          
          // 等待500毫秒，确保发送操作完成
-         QThread::msleep(500); 
+         settleDelay(500); 
      } else if (m_hasLastSendButtonPos) {
          // 如果找不到发送按钮，使用上次的位置点击两次
          recordLog(QString("[WARNING] 未找到发送按钮，使用上次位置 (%1, %2) 点击两次发送").arg(m_lastSendButtonPos.x()).arg(m_lastSendButtonPos.y()));
          
          // 转换为屏幕坐标
-         POINT clientPos = {m_lastSendButtonPos.x(), m_lastSendButtonPos.y()};
-         POINT sendScreenPos;
-         ClientToScreen(hwnd, &clientPos);
-         sendScreenPos = clientPos;
-         recordLog(QString("[DEBUG] 上次发送按钮屏幕坐标: (%1, %2)").arg(sendScreenPos.x).arg(sendScreenPos.y));
+         const QPoint sendScreenPos = Platform::clientToScreen(hwnd, m_lastSendButtonPos);
+         recordLog(QString("[DEBUG] 上次发送按钮屏幕坐标: (%1, %2)").arg(sendScreenPos.x()).arg(sendScreenPos.y()));
          
          // 第一次点击
-         m_inputSimulator->clickAt(sendScreenPos.x, sendScreenPos.y);
+         m_inputSimulator->clickAt(sendScreenPos.x(), sendScreenPos.y());
          recordLog("[DEBUG] 第一次点击发送按钮完成");
-         QThread::msleep(200);
+         settleDelay(200);
          
          // 第二次点击
-         m_inputSimulator->clickAt(sendScreenPos.x, sendScreenPos.y);
+         m_inputSimulator->clickAt(sendScreenPos.x(), sendScreenPos.y());
          recordLog("[DEBUG] 第二次点击发送按钮完成");
-         QThread::msleep(500);
+         settleDelay(500);
      } else {
          recordLog("[WARNING] 未找到发送按钮，尝试用Enter发送");
          
          // 单次Enter键发送
-         m_inputSimulator->pressKey(VK_RETURN);
+         m_inputSimulator->pressKey(Platform::KeyReturn);
          recordLog("[DEBUG] Enter键发送完成");
          
          // 等待500毫秒，确保发送操作完成
-         QThread::msleep(500); 
+         settleDelay(500); 
      }
 
+    Metrics::increment(Metrics::QuestionsSent);
+    m_journal->recordQuestion(m_currentCount, JobJournal::Sent, question, m_currentQuestionLive);
+
     // 等待回答完成
     recordLog("[DEBUG] 开始等待回答完成");
-    if (!waitForAnswerCompletion(hwnd)) {
+    bool answerCompleted;
+    {
+        MetricsStageTimer answerTimer(Metrics::StageAnswerWait);
+        answerCompleted = waitForAnswerCompletion(hwnd);
+    }
+    if (!answerCompleted) {
+        if (!m_stopRequested) {
+            Metrics::increment(Metrics::AnswerTimeouts);
+            m_journal->recordQuestion(m_currentCount, JobJournal::TimedOut, QString(), m_currentQuestionLive);
+        }
         recordLog("[WARNING] 等待回答超时");
-        if (!m_configManager->getContinueOnTimeout()) {
+        if (!m_config->continueOnTimeout) {
             recordLog("[DEBUG] 配置为不继续超时，返回失败");
             return false;
         }
         recordLog("[DEBUG] 配置为继续超时，返回成功");
     } else {
+        Metrics::increment(Metrics::AnswersCompleted);
+        m_journal->recordQuestion(m_currentCount, JobJournal::Answered, QString(), m_currentQuestionLive);
         recordLog("[DEBUG] 回答已完成");
     }
 
@@ -1388,10 +1361,11 @@ bool Automator::enterHistoryDialog()
     }
 }
 
-bool Automator::waitForAnswerCompletion(HWND hwnd)
+bool Automator::waitForAnswerCompletion(WindowHandle hwnd)
 {
+    TRACE_SCOPE("automation", "waitForAnswerCompletion");
     recordLog("[DEBUG] 开始执行waitForAnswerCompletion函数");
-    int answerTimeout = m_configManager->getAnswerTimeout();
+    int answerTimeout = m_config->answerTimeout;
     recordLog(QString("[DEBUG] 等待回答完成（固定 %1 秒）").arg(answerTimeout));
 
     // 使用传入的窗口句柄，不重新获取
@@ -1408,15 +1382,20 @@ bool Automator::waitForAnswerCompletion(HWND hwnd)
     return result;
 }
 
-bool Automator::waitWithESCDetection(int delayMs, HWND weChatHwnd)
+bool Automator::waitWithESCDetection(int delayMs, WindowHandle weChatHwnd)
 {
+    // 回放模式下不等待，直接返回
+    if (m_replayMode) {
+        return !m_stopRequested;
+    }
+
     recordLog(QString("[DEBUG] 开始执行waitWithESCDetection函数，等待时间: %1 毫秒").arg(delayMs));
     
     // 获取WeBot窗口句柄（用于接收ESC按键）
-    HWND weBotHwnd = FindWindowW(L"WeBotWindowClass", nullptr);
+    WindowHandle weBotHwnd = Platform::findWindow("WeBotWindowClass", QString());
     if (!weBotHwnd) {
         // 如果找不到WeBot窗口，尝试通过窗口标题查找
-        weBotHwnd = FindWindowW(nullptr, L"WeBot");
+        weBotHwnd = Platform::findWindow(QString(), "WeBot");
     }
     recordLog(QString("[DEBUG] WeBot窗口句柄: %1").arg((quintptr)weBotHwnd, 0, 16));
     
@@ -1427,17 +1406,8 @@ bool Automator::waitWithESCDetection(int delayMs, HWND weChatHwnd)
     while (elapsedTime < delayMs && !m_stopRequested) {
         // 在等待期间，将焦点放在WeBot窗口上，但不置顶显示
         if (weBotHwnd) {
-            // 使用AttachThreadInput和SetFocus，避免置顶
-            DWORD foregroundThreadId = GetWindowThreadProcessId(GetForegroundWindow(), nullptr);
-            DWORD currentThreadId = GetCurrentThreadId();
-            
-            if (foregroundThreadId != currentThreadId) {
-                AttachThreadInput(currentThreadId, foregroundThreadId, TRUE);
-                SetFocus(weBotHwnd);
-                AttachThreadInput(currentThreadId, foregroundThreadId, FALSE);
-            } else {
-                SetFocus(weBotHwnd);
-            }
+            // 只设置键盘焦点，避免置顶
+            Platform::focusWindow(weBotHwnd);
         }
         
         // 等待检查间隔，期间处理事件
@@ -1448,12 +1418,12 @@ bool Automator::waitWithESCDetection(int delayMs, HWND weChatHwnd)
     
     // 等待时间到了，将焦点切换回企业微信窗口（如果提供了窗口句柄）
     if (weChatHwnd) {
-        SetForegroundWindow(weChatHwnd);
+        Platform::setForegroundWindow(weChatHwnd);
         recordLog("[DEBUG] 将焦点切换回企业微信窗口");
         QThread::msleep(100); // 短暂延时，确保焦点切换完成
     } else if (weBotHwnd) {
         // 如果没有提供企业微信窗口句柄，则将焦点切换回WeBot窗口
-        SetForegroundWindow(weBotHwnd);
+        Platform::setForegroundWindow(weBotHwnd);
         recordLog("[DEBUG] 将焦点切换回WeBot窗口");
         QThread::msleep(100); // 短暂延时，确保焦点切换完成
     }
@@ -1508,9 +1478,253 @@ void Automator::recordLog(const QString& message)
     emit logMessage(message);
 }
 
+int Automator::setReplayMode(const QString &replayDirectory)
+{
+    int frameCount = m_imageRecognizer->setReplayDirectory(replayDirectory);
+    m_replayMode = frameCount > 0;
+    m_inputSimulator->setDryRun(m_replayMode);
+    if (m_replayMode) {
+        recordLog(QString("[INFO] 已进入回放模式，共 %1 帧").arg(frameCount));
+    }
+    return frameCount;
+}
+
+int Automator::enqueueQuestions(const QStringList &questions)
+{
+    QMutexLocker locker(&m_liveQueueMutex);
+    for (const QString &question : questions) {
+        QString trimmed = question.trimmed();
+        if (!trimmed.isEmpty()) {
+            m_liveQueue.append(trimmed);
+        }
+    }
+    return m_liveQueue.size();
+}
+
+int Automator::pendingLiveQuestionCount() const
+{
+    QMutexLocker locker(&m_liveQueueMutex);
+    return m_liveQueue.size();
+}
+
+void Automator::drainLiveQueue()
+{
+    QStringList incoming;
+    {
+        QMutexLocker locker(&m_liveQueueMutex);
+        incoming.swap(m_liveQueue);
+    }
+    if (incoming.isEmpty()) {
+        return;
+    }
+
+    m_pendingLiveQuestions.append(incoming);
+    m_totalCount += incoming.size();
+    m_journal->recordLiveQuestions(incoming);
+    recordLog(QString("[INFO] 已从实时队列加入 %1 个问题，总数更新为 %2").arg(incoming.size()).arg(m_totalCount));
+    emit progressUpdated(qMin(m_currentCount + 1, m_totalCount), m_totalCount);
+}
+
+void Automator::onQuestionLibraryReloaded(const QStringList &added, const QStringList &removed)
+{
+    // 未运行时下次启动会重新读取完整的问题库
+    if (m_state == Starting || m_state == Running) {
+        m_pendingLibraryChanges.append({false, added, removed});
+    }
+}
+
+void Automator::onKeywordLibraryReloaded(const QStringList &added, const QStringList &removed)
+{
+    if (m_state == Starting || m_state == Running) {
+        m_pendingLibraryChanges.append({true, added, removed});
+    }
+}
+
+bool Automator::applyLibraryChanges()
+{
+    if (m_pendingLibraryChanges.isEmpty()) {
+        return false;
+    }
+
+    const QVector<LibraryChange> changes = std::exchange(m_pendingLibraryChanges, {});
+    for (const LibraryChange &change : changes) {
+        if (change.keywords) {
+            m_questionManager->applyKeywordChanges(change.added, change.removed);
+        } else {
+            m_questionManager->applyPresetChanges(change.added, change.removed);
+        }
+    }
+    return true;
+}
+
+void Automator::prepareJournal()
+{
+    m_resumeFromCount = 0;
+    m_resumeCycleIndex = 0;
+
+    if (!m_configManager->getResumeInterruptedRuns()) {
+        m_journal->close();
+        return;
+    }
+
+    QString journalPath = QFileInfo(m_configManager->getConfigFilePath()).absolutePath() + "/jobs.journal";
+    if (!m_journal->open(journalPath)) {
+        return;
+    }
+
+    int mode = m_questionManager->getQuestionMode();
+    QString signature = JobJournal::runSignature(m_questionManager->presetSignature(), mode, m_totalCount);
+    JobJournal::ResumePoint point = m_journal->findResumePoint(signature);
+    // 日志序号是计划问题与实时问题合计的发送顺序，其中 liveDone 个是已完成的实时问题
+    const int plannedDone = point.nextIndex - point.liveDone;
+    if (point.valid && (plannedDone < m_totalCount || !point.pendingLive.isEmpty())) {
+        // 序号沿用日志中的合计顺序，总数加上已完成的实时问题，剩余次数正好是未发送的计划问题
+        m_resumeFromCount = point.nextIndex;
+        m_resumeCycleIndex = qMin(plannedDone, m_totalCount);
+        m_totalCount += point.liveDone;
+        m_journal->resumeRun(point);
+        if (!point.pendingLive.isEmpty()) {
+            enqueueQuestions(point.pendingLive);
+        }
+        recordLog(QString("[INFO] 检测到未完成的运行，从第 %1/%2 个计划问题继续（已完成 %3 个实时问题，另有 %4 个待发送）")
+                      .arg(m_resumeCycleIndex + 1).arg(m_totalCount - point.liveDone)
+                      .arg(point.liveDone).arg(point.pendingLive.size()));
+    } else {
+        m_journal->beginRun(signature, m_totalCount, mode);
+    }
+}
+
+void Automator::pause()
+{
+    if (!m_pauseRequested.exchange(true)) {
+        emit pausedChanged(true);
+    }
+}
+
+void Automator::resume()
+{
+    if (m_pauseRequested.exchange(false)) {
+        emit pausedChanged(false);
+    }
+}
+
+WindowHandle Automator::targetWindowHandle()
+{
+    if (m_replayMode) {
+        return Platform::desktopWindow();
+    }
+    return m_weChatController->getWeChatWindowHandle();
+}
+
+void Automator::settleDelay(int delayMs)
+{
+    if (!m_replayMode) {
+        QThread::msleep(delayMs);
+    }
+}
+
+QString Automator::locateIcon(WindowHandle hwnd, const QStringList &templateNames, const std::function<void()> &recover, QPoint *pos)
+{
+    // 第一次：只做相关匹配
+    for (const QString &templateName : templateNames) {
+        if (m_imageRecognizer->findTemplateInWindow(hwnd, templateName, *pos)) {
+            return templateName;
+        }
+    }
+    if (m_stopRequested) {
+        return QString();
+    }
+
+    // 第二次：执行恢复操作（最大化窗口、滚动页面），等界面稳定后再匹配；
+    // 仍找不到时用特征匹配兜底，应对缩放和深浅色主题变化，不再固定间隔盲目重试
+    if (recover) {
+        recover();
+    }
+    if (!waitWithESCDetection(kIconSettleDelayMs)) {
+        return QString();
+    }
+    for (const QString &templateName : templateNames) {
+        if (m_imageRecognizer->findTemplateInWindow(hwnd, templateName, *pos)) {
+            return templateName;
+        }
+    }
+    for (const QString &templateName : templateNames) {
+        if (m_stopRequested) {
+            return QString();
+        }
+        recordLog(QString("[DEBUG] 相关匹配未找到 '%1'，使用特征匹配").arg(templateName));
+        if (m_imageRecognizer->findTemplateInWindow(hwnd, templateName, *pos, true)) {
+            return templateName;
+        }
+    }
+    return QString();
+}
+
+void Automator::scrollClientArea(WindowHandle hwnd)
+{
+    // 从客户区中间向上拖动四分之一高度
+    const QSize clientSize = Platform::clientSize(hwnd);
+    const QPoint startPos = Platform::clientToScreen(hwnd, QPoint(clientSize.width() / 2, clientSize.height() / 2));
+    const QPoint endPos = Platform::clientToScreen(hwnd, QPoint(clientSize.width() / 2, clientSize.height() / 4));
+    recordLog(QString("[DEBUG] 滚动页面 - 起点: (%1, %2), 终点: (%3, %4)").arg(startPos.x()).arg(startPos.y()).arg(endPos.x()).arg(endPos.y()));
+    m_inputSimulator->dragMouse(startPos.x(), startPos.y(), endPos.x(), endPos.y());
+}
+
+void Automator::exportRunTrace()
+{
+    if (!Tracer::isEnabled()) {
+        return;
+    }
+
+    if (!m_configManager) {
+        m_configManager = ConfigManager::getInstance();
+    }
+
+    QString traceDir = m_configManager->getLogPath();
+    if (traceDir.isEmpty()) {
+        traceDir = QCoreApplication::applicationDirPath() + "/logs";
+    }
+    QString tracePath = QDir(traceDir).filePath(
+        QString("trace_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")));
+
+    if (Tracer::exportChromeTrace(tracePath)) {
+        recordLog(QString("[INFO] 运行时间线已导出: %1（可用 chrome://tracing 或 Perfetto 打开）").arg(tracePath));
+    } else {
+        recordLog(QString("[WARNING] 运行时间线导出失败: %1").arg(tracePath));
+    }
+    Tracer::clear();
+}
+
+void Automator::exportMatchDiagnostics()
+{
+    if (!MatchDiagnostics::isEnabled()) {
+        return;
+    }
+
+    if (!m_configManager) {
+        m_configManager = ConfigManager::getInstance();
+    }
+
+    QString logDir = m_configManager->getLogPath();
+    if (logDir.isEmpty()) {
+        logDir = QCoreApplication::applicationDirPath() + "/logs";
+    }
+    QString diagnosticsDir = QDir(logDir).filePath(
+        QString("match_heatmaps_%1").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")));
+
+    int exported = MatchDiagnostics::exportAll(diagnosticsDir);
+    if (exported > 0) {
+        recordLog(QString("[INFO] 模板匹配热力图已导出: %1 条记录 -> %2").arg(exported).arg(diagnosticsDir));
+    } else {
+        recordLog("[INFO] 没有可导出的模板匹配诊断记录");
+    }
+    MatchDiagnostics::clear();
+}
+
 void Automator::setState(State state)
 {
     m_state = state;
+    Metrics::setRunning(state == Starting || state == Running);
     emit stateChanged(state);
 }
 
@@ -3,13 +3,17 @@
 
 #include <QObject>
 #include <QThread>
+#include <QMutex>
+#include <QStringList>
 #include <atomic>
+#include <functional>
 #include "wechatcontroller.h"
 #include "imagerecognizer.h"  // 现在使用我们自己的ImageRecognizer
 #include "inputsimulator.h"
 #include "questionmanager.h"
 #include "configmanager.h"
 #include "recognitionoverlay.h"
+#include "jobjournal.h"
 
 class Automator : public QObject
 {
@@ -45,6 +49,27 @@ public:
     // 获取当前状态
     State getCurrentState() const { return m_state; }
     
+    // 设置回放模式：截图来自回放目录，键鼠输入空运行，跳过企业微信准备与导航（返回回放帧数）
+    int setReplayMode(const QString &replayDirectory);
+    
+    // 是否处于回放模式
+    bool isReplayMode() const { return m_replayMode; }
+    
+    // 追加问题到实时队列（线程安全，运行中调用会在下一个问题边界生效，返回队列长度）
+    int enqueueQuestions(const QStringList &questions);
+    
+    // 实时队列中等待发送的问题数（线程安全）
+    int pendingLiveQuestionCount() const;
+    
+    // 暂停/恢复（在问题边界生效，线程安全）
+    void pause();
+    void resume();
+    bool isPaused() const { return m_pauseRequested; }
+    
+    // 保持会话：计划的问题发送完后不结束，继续等待实时队列中的新问题（线程安全）
+    void setHoldOpen(bool holdOpen) { m_holdOpen = holdOpen; }
+    bool isHoldOpen() const { return m_holdOpen; }
+    
 
 
 signals:
@@ -62,6 +87,15 @@ signals:
     
     // 错误提示信号，用于显示弹窗
     void errorMessage(const QString &message);
+    
+    // 单个问题完成信号（序号从1开始）
+    void questionCompleted(int index, const QString &question, bool success);
+    
+    // 暂停状态变化信号
+    void pausedChanged(bool paused);
+    
+    // 识别到的图标区域（屏幕坐标），调试模式下主窗口用覆盖层显示
+    void recognitionAreaFound(const QRect &area, const QString &templateName);
 
 private slots:
     // 自动化核心逻辑（在子线程中运行）
@@ -70,6 +104,16 @@ private slots:
     // 自动化完成处理
     void onFinished();
 
+    // 导出本次运行的时间线（Chrome trace-event JSON）
+    void exportRunTrace();
+
+    // 导出本次运行的模板匹配热力图和候选点
+    void exportMatchDiagnostics();
+
+    // 问题库/关键词库热加载：运行中先记下差异，在问题边界应用
+    void onQuestionLibraryReloaded(const QStringList &added, const QStringList &removed);
+    void onKeywordLibraryReloaded(const QStringList &added, const QStringList &removed);
+
 private:
     // 准备企业微信（启动、激活、置顶）
     bool prepareWeChat();
@@ -87,7 +131,7 @@ private:
     bool performQuestionAnswer(const QString& question);
 
     // 等待回答完成
-    bool waitForAnswerCompletion(HWND hwnd);
+    bool waitForAnswerCompletion(WindowHandle hwnd);
 
     // 更新状态（线程安全）
     void setState(State state);
@@ -96,7 +140,29 @@ private:
     void nonBlockingDelay(int delayMs);
     
     // 带ESC按键检测的等待函数
-    bool waitWithESCDetection(int delayMs, HWND weChatHwnd = nullptr);
+    bool waitWithESCDetection(int delayMs, WindowHandle weChatHwnd = nullptr);
+    
+    // 获取目标窗口句柄（回放模式下使用桌面窗口）
+    WindowHandle targetWindowHandle();
+    
+    // 界面稳定等待（回放模式下不等待）
+    void settleDelay(int delayMs);
+    
+    // 查找图标：先相关匹配；找不到时执行一次恢复操作（最大化窗口、滚动页面）并等界面稳定后再匹配，
+    // 仍找不到时用特征匹配兜底。返回找到的模板名，pos 为其左上角；找不到或被停止时返回空
+    QString locateIcon(WindowHandle hwnd, const QStringList &templateNames, const std::function<void()> &recover, QPoint *pos);
+    
+    // 从窗口客户区中间向上拖动，滚动页面
+    void scrollClientArea(WindowHandle hwnd);
+    
+    // 将实时队列中的问题移入本次运行的待发送列表，并增加总次数
+    void drainLiveQueue();
+    
+    // 打开任务日志并确定本次运行的起始位置（开始新运行或继续中断的运行）
+    void prepareJournal();
+
+    // 应用等待中的库文件差异，有变化时返回true
+    bool applyLibraryChanges();
 
 private:
     // 子线程（避免阻塞UI）
@@ -108,10 +174,40 @@ private:
     InputSimulator *m_inputSimulator = nullptr;
     QuestionManager *m_questionManager = nullptr;
     ConfigManager *m_configManager = nullptr;
+    
+    // 当前使用的配置快照（每个问题边界更新一次）
+    std::shared_ptr<const ConfigSnapshot> m_config;
 
     // 状态变量（原子类型，线程安全）
     std::atomic<State> m_state = Idle;
     std::atomic<bool> m_stopRequested = false;
+    
+    // 回放模式
+    bool m_replayMode = false;
+    
+    // 实时问题队列（控制接口线程写入，自动化流程读取）
+    mutable QMutex m_liveQueueMutex;
+    QStringList m_liveQueue;
+    // 已并入本次运行、等待发送的实时问题（仅自动化流程访问）
+    QStringList m_pendingLiveQuestions;
+
+    // 等待应用的库文件差异（ConfigManager在GUI线程发出，自动化流程在问题边界应用）
+    struct LibraryChange {
+        bool keywords;
+        QStringList added;
+        QStringList removed;
+    };
+    QVector<LibraryChange> m_pendingLibraryChanges;
+    
+    // 任务日志（中断后继续运行）
+    JobJournal *m_journal = nullptr;
+    int m_resumeFromCount = 0;      // 本次运行的起始序号（计划问题与实时问题合计）
+    int m_resumeCycleIndex = 0;     // 继续运行时计划问题的起始位置（不含已完成的实时问题）
+    bool m_currentQuestionLive = false; // 当前问题是否来自实时队列
+    
+    // 暂停与保持会话标志
+    std::atomic<bool> m_pauseRequested = false;
+    std::atomic<bool> m_holdOpen = false;
 
     // 计数变量
     int m_currentCount = 0;  // 当前完成次数
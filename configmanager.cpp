@@ -1,10 +1,59 @@
 #include "configmanager.h"
+#include "csvimporter.h"
+#include "questionbank.h"
+#include "questiondedup.h"
 #include <QCoreApplication>
 #include <QStandardPaths>
 #include <QDir>
 #include <QFile>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QHash>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QDateTime>
 #include <QDebug>
+#include <QPointer>
+#include <cstdio>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+// 库文件变化后等待的时间，编辑器保存时常常连续写入多次
+constexpr int kLibraryReloadDelayMs = 300;
+
+// 设置修改后延迟写回配置文件的时间
+constexpr int kPersistDelayMs = 500;
+
+// 按条目计数比较两个列表（允许重复条目），得到增加和删除的条目
+void diffLibraryLists(const QStringList &before, const QStringList &after,
+                      QStringList *added, QStringList *removed)
+{
+    QHash<QString, int> counts;
+    counts.reserve(before.size());
+    for (const QString &item : before) {
+        ++counts[item];
+    }
+    for (const QString &item : after) {
+        auto it = counts.find(item);
+        if (it != counts.end() && it.value() > 0) {
+            --it.value();
+        } else {
+            added->append(item);
+        }
+    }
+    for (const QString &item : before) {
+        auto it = counts.find(item);
+        if (it.value() > 0) {
+            --it.value();
+            removed->append(item);
+        }
+    }
+}
+
+} // namespace
 
 // 初始化静态成员
 ConfigManager *ConfigManager::instance = nullptr;
@@ -13,6 +62,7 @@ QMutex ConfigManager::mutex;
 ConfigManager::ConfigManager(QObject *parent) : QObject(parent)
 {
     // 构造函数中只做最基本的初始化，不触发任何信号
+    m_snapshot = std::make_shared<const ConfigSnapshot>();
 }
 
 void ConfigManager::initialize()
@@ -22,6 +72,160 @@ void ConfigManager::initialize()
     loadConfig();
     loadQuestionLibrary();
     loadKeywordLibrary();
+    watchLibraryFiles();
+
+    // 设置修改后延迟写回，短时间内的多次修改合并为一次写入
+    m_persistTimer = new QTimer(this);
+    m_persistTimer->setSingleShot(true);
+    m_persistTimer->setInterval(kPersistDelayMs);
+    connect(m_persistTimer, &QTimer::timeout, this, &ConfigManager::persistPending);
+}
+
+void ConfigManager::notifyKeysChanged(const QStringList &keys)
+{
+    publishSnapshot();
+
+    // 问题和关键词列表保存在各自的库文件中，不写入配置文件
+    for (const QString &key : keys) {
+        if (!key.startsWith("Library/")) {
+            schedulePersist();
+            break;
+        }
+    }
+
+    emit configKeysChanged(keys);
+    emit configChanged();
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigManager::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void ConfigManager::publishSnapshot()
+{
+    auto next = std::make_shared<ConfigSnapshot>();
+    next->imageRecognitionThreshold = imageRecognitionThreshold;
+    next->maxRecognitionAttempts = maxRecognitionAttempts;
+    next->pageLoadTimeout = pageLoadTimeout;
+    next->recognitionTimeout = recognitionTimeout;
+    next->recognitionTechnique = recognitionTechnique;
+    next->featureFallback = m_featureFallback;
+    next->recognitionHitCache = m_recognitionHitCache;
+    next->pyramidMatching = m_pyramidMatching;
+    next->answerTimeout = answerTimeout;
+    next->delayBetweenRounds = delayBetweenRounds;
+    next->continueOnError = continueOnError;
+    next->continueOnTimeout = continueOnTimeout;
+    next->mouseClickDelay = mouseClickDelay;
+    next->keyboardInputDelay = keyboardInputDelay;
+    next->windowTopMost = windowTopMost;
+    next->logPath = logPath;
+    next->iconPaths = iconPaths;
+    next->recognitionProfiles = m_recognitionProfiles;
+
+    QMutexLocker locker(&m_snapshotMutex);
+    next->templateSizes = templateSizes;
+    next->measuredTemplateSizes = m_measuredTemplateSizes;
+    next->version = ++m_snapshotVersion;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const ConfigSnapshot>(std::move(next)));
+}
+
+void ConfigManager::watchLibraryFiles()
+{
+    if (!m_libraryWatcher) {
+        m_libraryWatcher = new QFileSystemWatcher(this);
+        m_libraryReloadTimer = new QTimer(this);
+        m_libraryReloadTimer->setSingleShot(true);
+        m_libraryReloadTimer->setInterval(kLibraryReloadDelayMs);
+        connect(m_libraryWatcher, &QFileSystemWatcher::fileChanged, this, &ConfigManager::onLibraryFileChanged);
+        connect(m_libraryReloadTimer, &QTimer::timeout, this, &ConfigManager::reloadChangedLibraries);
+    }
+
+    const QStringList watched = m_libraryWatcher->files();
+    if (!watched.isEmpty()) {
+        m_libraryWatcher->removePaths(watched);
+    }
+    // 优先级、分类和难度保存在问题库旁的属性文件中，修改后同样需要重新生成问题库
+    for (const QString &path : {questionLibraryPath, QuestionBank::attributesPathFor(questionLibraryPath), keywordLibraryPath}) {
+        if (!path.isEmpty() && QFile::exists(path)) {
+            m_libraryWatcher->addPath(path);
+        }
+    }
+}
+
+void ConfigManager::onLibraryFileChanged(const QString &path)
+{
+    if (QFileInfo(path) == QFileInfo(questionLibraryPath)
+        || QFileInfo(path) == QFileInfo(QuestionBank::attributesPathFor(questionLibraryPath))) {
+        m_questionLibraryChanged = true;
+    }
+    if (QFileInfo(path) == QFileInfo(keywordLibraryPath)) {
+        m_keywordLibraryChanged = true;
+    }
+
+    // 编辑器先写临时文件再替换时监视会失效，需要重新添加
+    if (QFile::exists(path) && !m_libraryWatcher->files().contains(path)) {
+        m_libraryWatcher->addPath(path);
+    }
+    m_libraryReloadTimer->start();
+}
+
+void ConfigManager::reloadChangedLibraries()
+{
+    // 文件替换过程中可能暂时不存在，稍后再试（不创建默认库覆盖用户文件）
+    if ((m_questionLibraryChanged && !QFile::exists(questionLibraryPath))
+        || (m_keywordLibraryChanged && !QFile::exists(keywordLibraryPath))) {
+        m_libraryReloadTimer->start();
+        return;
+    }
+
+    if (m_questionLibraryChanged) {
+        m_questionLibraryChanged = false;
+        // 新问题库生成到另一个文件，旧问题库保持映射到比较完成；两边都是二进制问题库时直接比较映射的内容
+        const std::shared_ptr<const QuestionBank> beforeBank = questionBank;
+        const QStringList beforeList = questionList;
+        loadQuestionLibrary();
+        QStringList added;
+        QStringList removed;
+        if (beforeBank && questionBank) {
+            QuestionBank::diff(*beforeBank, *questionBank, &added, &removed);
+        } else {
+            // 二进制问题库生成失败时退回文本列表，才需要逐条比较字符串列表
+            diffLibraryLists(beforeBank ? beforeBank->toStringList() : beforeList, getQuestionList(), &added, &removed);
+        }
+        // 问题不变时检查优先级列是否修改（运行中只更新受影响的抽样权重）
+        bool prioritiesChanged = false;
+        if (added.isEmpty() && removed.isEmpty() && beforeBank && questionBank
+            && beforeBank->count() == questionBank->count()) {
+            for (int i = 0; i < questionBank->count() && !prioritiesChanged; ++i) {
+                prioritiesChanged = beforeBank->priority(i) != questionBank->priority(i);
+            }
+        }
+        if (!added.isEmpty() || !removed.isEmpty()) {
+            emit logMessage(QString("问题库已更新：增加 %1 个，删除 %2 个").arg(added.size()).arg(removed.size()));
+            emit questionLibraryReloaded(added, removed);
+        } else if (prioritiesChanged) {
+            emit logMessage("问题库优先级已更新");
+            emit questionLibraryReloaded(added, removed);
+        }
+    }
+
+    if (m_keywordLibraryChanged) {
+        m_keywordLibraryChanged = false;
+        const QStringList before = keywordList;
+        loadKeywordLibrary();
+        QStringList added;
+        QStringList removed;
+        diffLibraryLists(before, keywordList, &added, &removed);
+        if (!added.isEmpty() || !removed.isEmpty()) {
+            emit logMessage(QString("关键词库已更新：增加 %1 个，删除 %2 个").arg(added.size()).arg(removed.size()));
+            emit keywordLibraryReloaded(added, removed);
+        }
+    }
+
+    // 删除后重新创建的文件需要重新加入监视
+    watchLibraryFiles();
 }
 
 ConfigManager::~ConfigManager()
@@ -76,6 +280,10 @@ void ConfigManager::initDefaultConfig()
     pageLoadTimeout = 2000; // 默认2000毫秒
     recognitionTimeout = 3000; // 默认3000毫秒
     recognitionTechnique = "NCC"; // 默认使用NCC算法
+    m_featureFallback = true; // NCC失败时用ORB特征匹配兜底
+    m_recognitionHitCache = true; // 上次找到的位置图块未变时沿用结果
+    m_pyramidMatching = true; // 先在半分辨率截图上粗匹配
+    m_imageKernelLevel = "auto"; // 图像内核使用CPU支持的最高指令集
 
     // 多显示器适配配置
     m_multiMonitorSupport = false;
@@ -115,6 +323,28 @@ void ConfigManager::initDefaultConfig()
     // 输入方式默认值
     inputMethod = 0; // 0表示键盘输入，1表示复制粘贴输入
     
+    // 运行时间线追踪默认开启，运行结束后导出到日志目录
+    m_traceEnabled = true;
+    
+    // 模板匹配诊断默认关闭，调阈值时再开启
+    m_matchDiagnosticsEnabled = false;
+    m_matchDiagnosticsHistory = 8;
+    m_matchDiagnosticsTopK = 5;
+    
+    // 默认记录任务日志，中断后从上次位置继续
+    m_resumeInterruptedRuns = true;
+    
+    // 指标服务默认关闭，开启后只监听本机
+    m_metricsEnabled = false;
+    m_metricsBindAddress = "127.0.0.1";
+    m_metricsPort = 9464;
+    
+    // 控制接口默认关闭，开启后只监听本机
+    m_controlEnabled = false;
+    m_controlBindAddress = "127.0.0.1";
+    m_controlPort = 9465;
+    m_controlToken = "";
+    
     // 新配置项默认值
     mouseClickDelay = 100; // 100毫秒
     keyboardInputDelay = 50; // 50毫秒
@@ -177,6 +407,10 @@ bool ConfigManager::loadConfig()
         pageLoadTimeout = settings.value("ImageRecognition/PageLoadTimeout", pageLoadTimeout).toInt();
         recognitionTimeout = settings.value("ImageRecognition/RecognitionTimeout", recognitionTimeout).toInt();
         recognitionTechnique = settings.value("ImageRecognition/RecognitionTechnique", recognitionTechnique).toString();
+        m_featureFallback = settings.value("ImageRecognition/FeatureFallback", m_featureFallback).toBool();
+        m_recognitionHitCache = settings.value("ImageRecognition/HitCache", m_recognitionHitCache).toBool();
+        m_pyramidMatching = settings.value("ImageRecognition/PyramidMatching", m_pyramidMatching).toBool();
+        m_imageKernelLevel = settings.value("ImageRecognition/KernelLevel", m_imageKernelLevel).toString();
 
         // 读取路径配置，确保路径使用正确的基准路径
         QString defaultConfigPath = weBotPath + "/config.ini";
@@ -212,11 +446,31 @@ bool ConfigManager::loadConfig()
             if (sizeParts.size() == 2) {
                 int width = sizeParts[0].toInt();
                 int height = sizeParts[1].toInt();
+                QMutexLocker locker(&m_snapshotMutex);
                 templateSizes[key] = QSize(width, height);
             }
         }
         settings.endGroup();
         
+        // 读取按模板配置的识别参数，未写的键使用内置默认值
+        // 先清空旧表，文件中已删除的模板重新加载后回到内置默认
+        m_recognitionProfiles.clear();
+        settings.beginGroup("RecognitionProfiles");
+        const QStringList profileNames = settings.childGroups();
+        for (const QString &name : profileNames) {
+            RecognitionProfile profile = RecognitionProfile::builtin(name, imageRecognitionThreshold, recognitionTechnique);
+            settings.beginGroup(name);
+            profile.method = RecognitionProfile::methodFromName(settings.value("Method").toString(), profile.method);
+            profile.threshold = settings.value("Threshold", profile.threshold).toDouble();
+            profile.roi = RecognitionProfile::roiFromText(settings.value("Roi").toString());
+            profile.scales = RecognitionProfile::scalesFromText(settings.value("Scales").toString());
+            profile.preprocess = RecognitionProfile::preprocessFromName(settings.value("Preprocess").toString(), profile.preprocess);
+            profile.firstHit = settings.value("FirstHit", profile.firstHit).toBool();
+            settings.endGroup();
+            m_recognitionProfiles[name] = profile;
+        }
+        settings.endGroup();
+        
         // 读取图像识别开关配置
         m_useImageRecognition = settings.value("ImageRecognition/UseImageRecognition", m_useImageRecognition).toBool();
         
@@ -234,12 +488,31 @@ bool ConfigManager::loadConfig()
         // 读取输入方式设置
         inputMethod = settings.value("Advanced/InputMethod", inputMethod).toInt();
         
+        // 读取运行时间线追踪设置
+        m_traceEnabled = settings.value("Advanced/TraceEnabled", m_traceEnabled).toBool();
+        m_matchDiagnosticsEnabled = settings.value("Diagnostics/MatchHeatmaps", m_matchDiagnosticsEnabled).toBool();
+        m_matchDiagnosticsHistory = settings.value("Diagnostics/MatchHistory", m_matchDiagnosticsHistory).toInt();
+        m_matchDiagnosticsTopK = settings.value("Diagnostics/MatchTopK", m_matchDiagnosticsTopK).toInt();
+        m_resumeInterruptedRuns = settings.value("Advanced/ResumeInterruptedRuns", m_resumeInterruptedRuns).toBool();
+        
+        // 读取指标服务设置
+        m_metricsEnabled = settings.value("Metrics/Enabled", m_metricsEnabled).toBool();
+        m_metricsBindAddress = settings.value("Metrics/BindAddress", m_metricsBindAddress).toString();
+        m_metricsPort = settings.value("Metrics/Port", m_metricsPort).toInt();
+        
+        // 读取控制接口设置
+        m_controlEnabled = settings.value("Control/Enabled", m_controlEnabled).toBool();
+        m_controlBindAddress = settings.value("Control/BindAddress", m_controlBindAddress).toString();
+        m_controlPort = settings.value("Control/Port", m_controlPort).toInt();
+        m_controlToken = settings.value("Control/Token", m_controlToken).toString();
+        
         if (settings.status() != QSettings::NoError) {
             qDebug() << "加载配置时发生错误";
             emit logMessage("加载配置时发生错误");
             return false;
         }
         
+        publishSnapshot();
         emit logMessage("配置已成功加载");
         return true;
     } catch (const std::exception& e) {
@@ -253,98 +526,120 @@ bool ConfigManager::loadConfig()
     }
 }
 
+QVector<QPair<QString, QVariant>> ConfigManager::collectSettings() const
+{
+    QVector<QPair<QString, QVariant>> values;
+
+    // 写入企业微信配置
+    values.append({"WeChat/Path", wechatPath});
+    values.append({"WeChat/WindowTopMost", windowTopMost});
+
+    // 写入问答设置
+    values.append({"QA/AnswerTimeout", answerTimeout});
+    values.append({"QA/DelayBetweenRounds", delayBetweenRounds});
+    values.append({"QA/LoopCount", loopCount});
+    values.append({"QA/ContinueOnError", continueOnError});
+    values.append({"QA/ContinueOnTimeout", continueOnTimeout});
+    values.append({"QA/AnswerLimitPrompt", answerLimitPrompt});
+    values.append({"QA/QuestionMode", questionMode});
+
+    // 保存图像识别配置
+    values.append({"ImageRecognition/UseImageRecognition", m_useImageRecognition});
+    values.append({"ImageRecognition/Threshold", imageRecognitionThreshold});
+    values.append({"ImageRecognition/MaxAttempts", maxRecognitionAttempts});
+    values.append({"ImageRecognition/PageLoadTimeout", pageLoadTimeout});
+    values.append({"ImageRecognition/RecognitionTimeout", recognitionTimeout});
+    values.append({"ImageRecognition/RecognitionTechnique", recognitionTechnique});
+    values.append({"ImageRecognition/FeatureFallback", m_featureFallback});
+    values.append({"ImageRecognition/HitCache", m_recognitionHitCache});
+    values.append({"ImageRecognition/PyramidMatching", m_pyramidMatching});
+    values.append({"ImageRecognition/KernelLevel", m_imageKernelLevel});
+
+    // 写入路径配置
+    values.append({"Paths/ConfigFilePath", configFilePath});
+    values.append({"Paths/QuestionFilePath", questionFilePath});
+    values.append({"Paths/KeywordFilePath", keywordFilePath});
+    values.append({"Paths/LogFilePath", logFilePath});
+    values.append({"Paths/TemplateFilePath", templateFilePath});
+    
+    // 写入图标路径配置
+    for (auto it = iconPaths.cbegin(); it != iconPaths.cend(); ++it) {
+        values.append({"IconPaths/" + it.key(), it.value()});
+    }
+    
+    // 写入模板尺寸配置
+    const QMap<QString, QSize> sizes = getAllTemplateSizes();
+    for (auto it = sizes.cbegin(); it != sizes.cend(); ++it) {
+        values.append({"TemplateSizes/" + it.key(), QString("%1,%2").arg(it.value().width()).arg(it.value().height())});
+    }
+    
+    // 写入按模板配置的识别参数
+    for (auto it = m_recognitionProfiles.cbegin(); it != m_recognitionProfiles.cend(); ++it) {
+        const QString prefix = "RecognitionProfiles/" + it.key() + "/";
+        values.append({prefix + "Method", RecognitionProfile::methodName(it.value().method)});
+        values.append({prefix + "Threshold", it.value().threshold});
+        values.append({prefix + "Roi", it.value().roiText()});
+        values.append({prefix + "Scales", it.value().scalesText()});
+        values.append({prefix + "Preprocess", RecognitionProfile::preprocessName(it.value().preprocess)});
+        values.append({prefix + "FirstHit", it.value().firstHit});
+    }
+    
+    // 写入新配置项
+    values.append({"Advanced/MouseClickDelay", mouseClickDelay});
+    values.append({"Advanced/KeyboardInputDelay", keyboardInputDelay});
+    values.append({"Advanced/LogLevel", logLevel});
+    values.append({"Advanced/AutoCheckUpdates", autoCheckUpdates});
+    values.append({"Advanced/DebugMode", debugMode});
+    
+    // 写入鼠标移动检测设置
+    values.append({"Advanced/MouseMovementStopAutomation", m_mouseMovementStopAutomation});
+    values.append({"Advanced/MouseInactivityTimeout", m_mouseInactivityTimeout});
+    
+    // 写入输入方式设置
+    values.append({"Advanced/InputMethod", inputMethod});
+    
+    // 写入运行时间线追踪设置
+    values.append({"Advanced/TraceEnabled", m_traceEnabled});
+    values.append({"Diagnostics/MatchHeatmaps", m_matchDiagnosticsEnabled});
+    values.append({"Diagnostics/MatchHistory", m_matchDiagnosticsHistory});
+    values.append({"Diagnostics/MatchTopK", m_matchDiagnosticsTopK});
+    values.append({"Advanced/ResumeInterruptedRuns", m_resumeInterruptedRuns});
+    
+    // 写入指标服务设置
+    values.append({"Metrics/Enabled", m_metricsEnabled});
+    values.append({"Metrics/BindAddress", m_metricsBindAddress});
+    values.append({"Metrics/Port", m_metricsPort});
+    
+    // 写入控制接口设置
+    values.append({"Control/Enabled", m_controlEnabled});
+    values.append({"Control/BindAddress", m_controlBindAddress});
+    values.append({"Control/Port", m_controlPort});
+    values.append({"Control/Token", m_controlToken});
+
+    return values;
+}
+
+QString ConfigManager::settingsFilePath()
+{
+    QString documentsPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    return documentsPath + "/WeBot/config.ini";
+}
+
 bool ConfigManager::saveConfig()
 {
+    // 同步保存：取消等待中的延迟写入，直接写入当前设置
+    if (m_persistTimer) {
+        m_persistTimer->stop();
+    }
+
     try {
-        QString documentsPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
-        QString weBotPath = documentsPath + "/WeBot";
-        QString configPath = weBotPath + "/config.ini";
-        
-        // 确保目录存在
-        QDir dir;
-        if (!dir.exists(QFileInfo(configPath).path())) {
-            if (!dir.mkpath(QFileInfo(configPath).path())) {
-                qDebug() << "无法创建配置目录: " << QFileInfo(configPath).path();
-                emit logMessage("无法创建配置目录: " + QFileInfo(configPath).path());
-                return false;
-            }
-        }
-        
-        // 创建QSettings对象
-        QSettings settings(configPath, QSettings::IniFormat);
-        if (settings.status() != QSettings::NoError) {
-            qDebug() << "无法创建配置文件: " << configPath;
-            emit logMessage("无法创建配置文件: " + configPath);
-            return false;
-        }
-        
-        // 写入企业微信配置
-        settings.setValue("WeChat/Path", wechatPath);
-        settings.setValue("WeChat/WindowTopMost", windowTopMost);
-
-        // 写入问答设置
-        settings.setValue("QA/AnswerTimeout", answerTimeout);
-        settings.setValue("QA/DelayBetweenRounds", delayBetweenRounds);
-        settings.setValue("QA/LoopCount", loopCount);
-        settings.setValue("QA/ContinueOnError", continueOnError);
-        settings.setValue("QA/ContinueOnTimeout", continueOnTimeout);
-        settings.setValue("QA/AnswerLimitPrompt", answerLimitPrompt);
-        settings.setValue("QA/QuestionMode", questionMode);
-
-        // 保存图像识别配置
-        settings.setValue("ImageRecognition/UseImageRecognition", m_useImageRecognition);
-        settings.setValue("ImageRecognition/Threshold", imageRecognitionThreshold);
-        settings.setValue("ImageRecognition/MaxAttempts", maxRecognitionAttempts);
-        settings.setValue("ImageRecognition/PageLoadTimeout", pageLoadTimeout);
-        settings.setValue("ImageRecognition/RecognitionTimeout", recognitionTimeout);
-        settings.setValue("ImageRecognition/RecognitionTechnique", recognitionTechnique);
-
-        // 写入路径配置
-        settings.setValue("Paths/ConfigFilePath", configFilePath);
-        settings.setValue("Paths/QuestionFilePath", questionFilePath);
-        settings.setValue("Paths/KeywordFilePath", keywordFilePath);
-        settings.setValue("Paths/LogFilePath", logFilePath);
-        settings.setValue("Paths/TemplateFilePath", templateFilePath);
-        
-        // 写入图标路径配置
-        settings.beginGroup("IconPaths");
-        foreach (const QString &key, iconPaths.keys()) {
-            settings.setValue(key, iconPaths.value(key));
-        }
-        settings.endGroup();
-        
-        // 写入模板尺寸配置
-        settings.beginGroup("TemplateSizes");
-        foreach (const QString &key, templateSizes.keys()) {
-            QSize size = templateSizes.value(key);
-            QString sizeStr = QString("%1,%2").arg(size.width()).arg(size.height());
-            settings.setValue(key, sizeStr);
-        }
-        settings.endGroup();
-        
-        // 写入新配置项
-        settings.setValue("Advanced/MouseClickDelay", mouseClickDelay);
-        settings.setValue("Advanced/KeyboardInputDelay", keyboardInputDelay);
-        settings.setValue("Advanced/LogLevel", logLevel);
-        settings.setValue("Advanced/AutoCheckUpdates", autoCheckUpdates);
-        settings.setValue("Advanced/DebugMode", debugMode);
-        
-        // 写入鼠标移动检测设置
-        settings.setValue("Advanced/MouseMovementStopAutomation", m_mouseMovementStopAutomation);
-        settings.setValue("Advanced/MouseInactivityTimeout", m_mouseInactivityTimeout);
-        
-        // 写入输入方式设置
-        settings.setValue("Advanced/InputMethod", inputMethod);
-        
-        // 同步设置到文件
-        settings.sync();
-        
-        if (settings.status() != QSettings::NoError) {
-            qDebug() << "保存配置时发生错误";
-            emit logMessage("保存配置时发生错误");
+        QString errorString;
+        if (!writeSettings(m_persistState, ++m_persistState->requested, settingsFilePath(), collectSettings(), &errorString)) {
+            qDebug() << "保存配置时发生错误:" << errorString;
+            emit logMessage("保存配置时发生错误: " + errorString);
             return false;
         }
-        
+
         emit logMessage("配置已成功保存");
         return true;
     } catch (const std::exception& e) {
@@ -358,15 +653,119 @@ bool ConfigManager::saveConfig()
     }
 }
 
+void ConfigManager::schedulePersist()
+{
+    // 初始化完成前（加载配置期间）不写回
+    if (m_persistTimer) {
+        m_persistTimer->start();
+    }
+}
+
+void ConfigManager::persistPending()
+{
+    // 在GUI线程取设置的副本，写文件交给后台线程
+    const std::shared_ptr<PersistState> state = m_persistState;
+    const quint64 generation = ++state->requested;
+    const QString configPath = settingsFilePath();
+    const QVector<QPair<QString, QVariant>> values = collectSettings();
+    QPointer<ConfigManager> self(this);
+    QThreadPool::globalInstance()->start([state, generation, configPath, values, self]() {
+        QString errorString;
+        if (!writeSettings(state, generation, configPath, values, &errorString) && self) {
+            ConfigManager *manager = self.data();
+            QMetaObject::invokeMethod(manager, [manager, errorString]() {
+                emit manager->logMessage("[WARNING] 自动保存配置失败: " + errorString);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+bool ConfigManager::writeSettings(const std::shared_ptr<PersistState> &state, quint64 generation,
+                                  const QString &configPath, const QVector<QPair<QString, QVariant>> &values,
+                                  QString *errorString)
+{
+    // 写入串行执行；更新的版本已经写入时跳过旧版本
+    QMutexLocker locker(&state->mutex);
+    if (generation <= state->written) {
+        return true;
+    }
+
+    if (!QDir().mkpath(QFileInfo(configPath).path())) {
+        *errorString = "无法创建配置目录: " + QFileInfo(configPath).path();
+        return false;
+    }
+
+    // 先写临时文件（保留原文件中的其他键），再原子替换原文件，写入中途崩溃不会留下损坏的配置
+    const QString tempPath = configPath + ".tmp";
+    QFile::remove(tempPath);
+    if (QFile::exists(configPath) && !QFile::copy(configPath, tempPath)) {
+        *errorString = "无法创建临时配置文件: " + tempPath;
+        return false;
+    }
+    {
+        QSettings settings(tempPath, QSettings::IniFormat);
+        for (const auto &value : values) {
+            settings.setValue(value.first, value.second);
+        }
+        settings.sync();
+        if (settings.status() != QSettings::NoError) {
+            *errorString = "无法写入临时配置文件: " + tempPath;
+            QFile::remove(tempPath);
+            return false;
+        }
+    }
+
+#ifdef Q_OS_WIN
+    const QString nativeTemp = QDir::toNativeSeparators(tempPath);
+    const QString nativeTarget = QDir::toNativeSeparators(configPath);
+    if (!MoveFileExW(reinterpret_cast<LPCWSTR>(nativeTemp.utf16()), reinterpret_cast<LPCWSTR>(nativeTarget.utf16()),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        *errorString = QString("无法替换配置文件（错误码 %1）: %2").arg(GetLastError()).arg(configPath);
+        QFile::remove(tempPath);
+        return false;
+    }
+#else
+    if (std::rename(QFile::encodeName(tempPath).constData(), QFile::encodeName(configPath).constData()) != 0) {
+        *errorString = "无法替换配置文件: " + configPath;
+        QFile::remove(tempPath);
+        return false;
+    }
+#endif
+
+    state->written = generation;
+    return true;
+}
+
 bool ConfigManager::loadQuestionLibrary()
 {
     questionList.clear();
+    questionBank.reset();
 
     // 如果文件不存在，创建默认问题库
     if (!QFile::exists(questionLibraryPath)) {
         createDefaultQuestionLibrary();
     }
 
+    // 优先使用内存映射的二进制问题库，启动时不逐条读取问题
+    if (loadQuestionBank()) {
+        emit logMessage(QString("已加载 %1 个预设问题").arg(questionBank->count()));
+        return true;
+    }
+
+    // CSV问题库按列映射读取问题列
+    if (questionLibraryPath.endsWith(".csv", Qt::CaseInsensitive)) {
+        CsvImporter::Result result = CsvImporter::parse(questionLibraryPath, [this](const CsvImporter::Record &record) {
+            questionList.append(record.question);
+            return true;
+        });
+        if (!result.ok) {
+            emit logMessage("无法打开问题库文件: " + questionLibraryPath);
+            return false;
+        }
+        emit logMessage(QString("已加载 %1 个预设问题").arg(questionList.size()));
+        return true;
+    }
+
     QFile file(questionLibraryPath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         emit logMessage("无法打开问题库文件: " + questionLibraryPath);
@@ -386,6 +785,27 @@ bool ConfigManager::loadQuestionLibrary()
     return true;
 }
 
+bool ConfigManager::loadQuestionBank()
+{
+    // 二进制问题库记录了源文件的路径、大小和修改时间，一致时直接映射；
+    // 源文件修改后生成到新文件名，旧问题库在比较完成前保持映射
+    const QString bankDir = QFileInfo(configFilePath).absolutePath();
+    QString errorString;
+    bool built = false;
+    std::shared_ptr<QuestionBank> bank = QuestionBank::openForSource(questionLibraryPath, bankDir, &errorString, &built);
+    if (!bank) {
+        emit logMessage("[WARNING] 生成二进制问题库失败，使用文本问题库: " + errorString);
+        return false;
+    }
+    if (built) {
+        emit logMessage(QString("已生成二进制问题库: %1").arg(bank->path()));
+    }
+
+    questionBank = bank;
+    QuestionBank::removeStaleBanks(bankDir, bank->path());
+    return true;
+}
+
 bool ConfigManager::saveQuestionLibrary()
 {
     QFile file(questionLibraryPath);
@@ -395,7 +815,8 @@ bool ConfigManager::saveQuestionLibrary()
     }
 
     QTextStream out(&file);
-    for (const QString& question : questionList) {
+    const QStringList questions = getQuestionList();
+    for (const QString& question : questions) {
         out << question << "\n";
     }
 
@@ -500,51 +921,50 @@ void ConfigManager::createDefaultKeywordLibrary()
 
 bool ConfigManager::importQuestionsFromCSV(const QString &csvPath) {
     try {
-        QFile file(csvPath);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            emit logMessage("无法打开CSV文件: " + csvPath);
+        if (questionLibraryPath.endsWith(".csv", Qt::CaseInsensitive)) {
+            emit logMessage("当前问题库为CSV文件，可直接使用，无需导入");
             return false;
         }
 
-        QTextStream in(&file);
-        QStringList newQuestions;
+        // 流式解析CSV并直接追加到问题库文件，不在内存中保存全部问题；
+        // 优先级、分类和难度列写入问题库旁的属性文件
+        const QString attributesPath = QuestionBank::attributesPathFor(questionLibraryPath);
 
-        // 读取CSV文件
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (line.isEmpty()) {
-                continue;
+        // 用现有问题建立临时去重索引，跳过与问题库或文件内其他问题重复的条目
+        QuestionDedupIndex dedup;
+        if (questionBank) {
+            for (int i = 0; i < questionBank->count(); ++i) {
+                dedup.insert(questionBank->questionView(i));
             }
-
-            // 简单的CSV解析，支持逗号分隔
-            QStringList fields = line.split(",");
-            if (!fields.isEmpty()) {
-                // 取第一个字段作为问题
-                QString question = fields.first().trimmed();
-                if (!question.isEmpty()) {
-                    newQuestions.append(question);
-                }
+        } else {
+            for (const QString &question : std::as_const(questionList)) {
+                dedup.insert(question);
             }
         }
+        CsvImporter::Result result = CsvImporter::importToLibrary(csvPath, questionLibraryPath, attributesPath,
+                                                                  nullptr, &dedup);
 
-        file.close();
-
-        if (newQuestions.isEmpty()) {
-            emit logMessage("CSV文件中没有找到有效的问题");
+        if (!result.ok) {
+            emit logMessage("导入CSV文件失败: " + result.errorString);
             return false;
         }
 
-        // 将新问题添加到问题列表
-        questionList.append(newQuestions);
-        emit logMessage(QString("从CSV文件导入了 %1 个问题").arg(newQuestions.size()));
-
-        // 保存更新后的问题库
-        if (!saveQuestionLibrary()) {
-            emit logMessage("保存问题库失败");
+        if (result.imported == 0) {
+            emit logMessage(result.duplicates > 0 ? "CSV文件中的问题都已存在于问题库中" : "CSV文件中没有找到有效的问题");
             return false;
         }
 
-        return true;
+        emit logMessage(QString("从CSV文件导入了 %1 个问题（%2编码，跳过 %3 行空问题、%4 个重复问题，耗时 %5 ms）")
+                            .arg(result.imported)
+                            .arg(result.encoding == CsvReader::Utf8 ? "UTF-8" : "GBK")
+                            .arg(result.skipped)
+                            .arg(result.duplicates)
+                            .arg(result.elapsedMs));
+
+        // 重新加载问题库，新建的属性文件也加入监视
+        const bool loaded = loadQuestionLibrary();
+        watchLibraryFiles();
+        return loaded;
     } catch (const std::exception& e) {
         emit logMessage(QString("导入CSV文件时发生异常: %1").arg(e.what()));
         return false;
@@ -556,104 +976,37 @@ bool ConfigManager::importQuestionsFromCSV(const QString &csvPath) {
 
 QStringList ConfigManager::previewCSVFile(const QString &csvPath, int maxLines) {
     QStringList previewLines;
-    QString encoding = "";
-    int totalLines = 0;
 
     try {
-        QFile file(csvPath);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        // 只解析前maxLines条记录，编码由采样判断，不读取整个文件
+        CsvImporter::Preview preview = CsvImporter::preview(csvPath, maxLines);
+        if (!preview.ok) {
             previewLines.append("无法打开CSV文件: " + csvPath);
             return previewLines;
         }
 
-        // 先统计总行数
-        QTextStream in_total(&file);
-        while (!in_total.atEnd()) {
-            in_total.readLine();
-            totalLines++;
-        }
+        // 总行数在后台统计，完成后通过 csvLineCountReady 通知
+        QThreadPool::globalInstance()->start([this, csvPath]() {
+            emit csvLineCountReady(csvPath, CsvReader::countLines(csvPath));
+        });
 
-        // 尝试使用UTF-8读取文件
-        file.reset(); // 重置文件指针到开头
-        QTextStream in(&file);
-        in.setEncoding(QStringConverter::Utf8);
-        
-        int lineCount = 0;
-        previewLines.clear();
-        
-        // 读取CSV文件前maxLines行
-        while (!in.atEnd() && lineCount < maxLines) {
-            QString line = in.readLine().trimmed();
-            if (!line.isEmpty()) {
-                // 检查是否有乱码字符
-                if (!line.contains("\uFFFD")) {
-                    previewLines.append(line);
-                    lineCount++;
-                } else {
-                    // 如果有乱码，尝试使用GBK编码重新读取
-                    previewLines.clear();
-                    break;
-                }
-            }
-        }
-        
-        if (!previewLines.isEmpty()) {
-            encoding = "UTF-8";
-        } else {
-            // 如果UTF-8读取失败，尝试使用GBK编码
-            file.reset(); // 重置文件指针到开头
-            
-            // 使用二进制方式读取文件内容
-            QByteArray fileContent = file.readAll();
-            
-            // 尝试使用GBK编码
-            QString decodedContent = QString::fromLocal8Bit(fileContent);
-            
-            // 按行分割内容
-            QStringList lines = decodedContent.split("\n");
-            
-            lineCount = 0;
-            previewLines.clear();
-            
-            // 只取前maxLines行
-            for (const QString& line : lines) {
-                if (lineCount >= maxLines) {
-                    break;
-                }
-                QString trimmedLine = line.trimmed();
-                if (!trimmedLine.isEmpty()) {
-                    // 检查是否有乱码字符
-                    if (!trimmedLine.contains("\uFFFD")) {
-                        previewLines.append(trimmedLine);
-                        lineCount++;
-                    }
-                }
-            }
-            
-            if (!previewLines.isEmpty()) {
-                encoding = "GBK";
-            }
-        }
-        
-        // 插入文件信息行
-        if (!previewLines.isEmpty()) {
-            QString infoLine = QString("[文件信息] 编码: %1, 总行数: %2, 预览行数: %3").arg(encoding).arg(totalLines).arg(previewLines.size());
-            previewLines.insert(0, infoLine);
-            previewLines.insert(1, "[分隔符] 使用逗号(,)分隔字段，第一行为标题行");
-            previewLines.insert(2, "-------------------------------");
-        }
-        
-        // 如果还是读取失败，显示错误信息
-        if (previewLines.isEmpty()) {
-            previewLines.append("无法正确读取CSV文件，可能是编码问题");
-            previewLines.append("请确保文件为UTF-8或GBK编码的CSV格式");
+        if (preview.rows.isEmpty()) {
+            previewLines.append("CSV文件为空");
+            return previewLines;
         }
 
-        file.close();
-
-        if (previewLines.isEmpty()) {
-            previewLines.append("CSV文件为空");
+        QString encoding = preview.encoding == CsvReader::Utf8 ? "UTF-8" : "GBK";
+        if (!preview.encodingConfident) {
+            encoding += "（不确定）";
         }
+        previewLines = preview.rows;
+
+        // 插入文件信息行
+        QString infoLine = QString("[文件信息] 编码: %1, 大小: %2 KB, 预览行数: %3")
+                               .arg(encoding).arg((preview.fileSize + 1023) / 1024).arg(previewLines.size());
+        previewLines.insert(0, infoLine);
+        previewLines.insert(1, "[分隔符] 使用逗号(,)分隔字段，第一行为标题行");
+        previewLines.insert(2, "-------------------------------");
     } catch (const std::exception& e) {
         previewLines.append(QString("预览CSV文件时发生异常: %1").arg(e.what()));
     } catch (...) {
@@ -666,56 +1019,83 @@ QStringList ConfigManager::previewCSVFile(const QString &csvPath, int maxLines)
 // 各种getter和setter方法
 QString ConfigManager::getWeChatPath() const { return wechatPath; }
 void ConfigManager::setWeChatPath(const QString &path) { 
+    if (wechatPath == path) {
+        return;
+    }
     wechatPath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"WeChat/Path"});
 }
 
 bool ConfigManager::getWindowTopMost() const { return windowTopMost; }
 void ConfigManager::setWindowTopMost(bool topMost) { 
+    if (windowTopMost == topMost) {
+        return;
+    }
     windowTopMost = topMost; 
-    emit configChanged(); 
+    notifyKeysChanged({"WeChat/WindowTopMost"});
 }
 
 int ConfigManager::getAnswerTimeout() const { return answerTimeout; }
 void ConfigManager::setAnswerTimeout(int timeout) { 
+    if (answerTimeout == timeout) {
+        return;
+    }
     answerTimeout = timeout; 
-    emit configChanged(); 
+    notifyKeysChanged({"QA/AnswerTimeout"});
 }
 
 int ConfigManager::getDelayBetweenRounds() const { return delayBetweenRounds; }
 void ConfigManager::setDelayBetweenRounds(int delay) { 
+    if (delayBetweenRounds == delay) {
+        return;
+    }
     delayBetweenRounds = delay; 
-    emit configChanged(); 
+    notifyKeysChanged({"QA/DelayBetweenRounds"});
 }
 
 bool ConfigManager::getContinueOnError() const { return continueOnError; }
 void ConfigManager::setContinueOnError(bool continueFlag) { 
+    if (continueOnError == continueFlag) {
+        return;
+    }
     continueOnError = continueFlag; 
-    emit configChanged(); 
+    notifyKeysChanged({"QA/ContinueOnError"});
 }
 
 bool ConfigManager::getContinueOnTimeout() const { return continueOnTimeout; }
 void ConfigManager::setContinueOnTimeout(bool continueFlag) { 
+    if (continueOnTimeout == continueFlag) {
+        return;
+    }
     continueOnTimeout = continueFlag; 
-    emit configChanged(); 
+    notifyKeysChanged({"QA/ContinueOnTimeout"});
 }
 
 QString ConfigManager::getAnswerLimitPrompt() const { return answerLimitPrompt; }
 void ConfigManager::setAnswerLimitPrompt(const QString &prompt) { 
+    if (answerLimitPrompt == prompt) {
+        return;
+    }
     answerLimitPrompt = prompt; 
-    emit configChanged(); 
+    notifyKeysChanged({"QA/AnswerLimitPrompt"});
 }
 
 double ConfigManager::getImageRecognitionThreshold() const { return imageRecognitionThreshold; }
 void ConfigManager::setImageRecognitionThreshold(double threshold) { 
+    if (imageRecognitionThreshold == threshold) {
+        return;
+    }
     imageRecognitionThreshold = threshold; 
-    emit configChanged(); 
+    notifyKeysChanged({"ImageRecognition/Threshold"});
 }
 
 int ConfigManager::getMaxRecognitionAttempts() const { return maxRecognitionAttempts; }
 void ConfigManager::setMaxRecognitionAttempts(int attempts) { 
+    if (maxRecognitionAttempts == attempts) {
+        return;
+    }
     maxRecognitionAttempts = attempts; 
-    emit configChanged(); 
+    notifyKeysChanged({"ImageRecognition/MaxAttempts"});
 }
 
 int ConfigManager::getPageLoadTimeout() const
@@ -725,8 +1105,11 @@ int ConfigManager::getPageLoadTimeout() const
 
 void ConfigManager::setPageLoadTimeout(int timeout)
 {
+    if (pageLoadTimeout == timeout) {
+        return;
+    }
     pageLoadTimeout = timeout;
-    emit configChanged();
+    notifyKeysChanged({"ImageRecognition/PageLoadTimeout"});
 }
 
 // 识别超时时间的getter和setter方法
@@ -737,11 +1120,75 @@ int ConfigManager::getRecognitionTimeout() const
 
 void ConfigManager::setRecognitionTimeout(int timeout)
 {
+    if (recognitionTimeout == timeout) {
+        return;
+    }
     recognitionTimeout = timeout;
-    emit configChanged();
+    notifyKeysChanged({"ImageRecognition/RecognitionTimeout"});
 }
 
 // 识别技术的getter和setter方法
+bool ConfigManager::getFeatureFallback() const
+{
+    return m_featureFallback;
+}
+
+void ConfigManager::setFeatureFallback(bool enabled)
+{
+    if (m_featureFallback == enabled) {
+        return;
+    }
+    m_featureFallback = enabled;
+    notifyKeysChanged({"ImageRecognition/FeatureFallback"});
+}
+
+bool ConfigManager::getRecognitionHitCache() const
+{
+    return m_recognitionHitCache;
+}
+
+void ConfigManager::setRecognitionHitCache(bool enabled)
+{
+    if (m_recognitionHitCache == enabled) {
+        return;
+    }
+    m_recognitionHitCache = enabled;
+    notifyKeysChanged({"ImageRecognition/HitCache"});
+}
+
+QString ConfigManager::getImageKernelLevel() const
+{
+    return m_imageKernelLevel;
+}
+
+void ConfigManager::setImageKernelLevel(const QString &level)
+{
+    if (m_imageKernelLevel == level) {
+        return;
+    }
+    m_imageKernelLevel = level;
+    notifyKeysChanged({"ImageRecognition/KernelLevel"});
+}
+
+RecognitionProfile ConfigManager::getRecognitionProfile(const QString &templateName) const
+{
+    return snapshot()->recognitionProfile(templateName);
+}
+
+QMap<QString, RecognitionProfile> ConfigManager::getRecognitionProfiles() const
+{
+    return m_recognitionProfiles;
+}
+
+void ConfigManager::setRecognitionProfile(const QString &templateName, const RecognitionProfile &profile)
+{
+    if (m_recognitionProfiles.contains(templateName) && m_recognitionProfiles.value(templateName) == profile) {
+        return;
+    }
+    m_recognitionProfiles[templateName] = profile;
+    notifyKeysChanged({"RecognitionProfiles/" + templateName});
+}
+
 QString ConfigManager::getRecognitionTechnique() const
 {
     return recognitionTechnique;
@@ -749,94 +1196,147 @@ QString ConfigManager::getRecognitionTechnique() const
 
 void ConfigManager::setRecognitionTechnique(const QString &technique)
 {
+    if (recognitionTechnique == technique) {
+        return;
+    }
     recognitionTechnique = technique;
-    emit configChanged();
+    notifyKeysChanged({"ImageRecognition/RecognitionTechnique"});
 }
 
 QString ConfigManager::getLogPath() const { return logPath; }
 void ConfigManager::setLogPath(const QString &path) { 
+    if (logPath == path) {
+        return;
+    }
     logPath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"Paths/LogPath"});
 }
 
 QString ConfigManager::getQuestionLibraryPath() const { return questionLibraryPath; }
 void ConfigManager::setQuestionLibraryPath(const QString &path) { 
+    if (questionLibraryPath == path) {
+        return;
+    }
     questionLibraryPath = path; 
-    emit configChanged(); 
+    if (m_libraryWatcher) {
+        watchLibraryFiles();
+    }
+    notifyKeysChanged({"Paths/QuestionLibraryPath"});
 }
 
 QString ConfigManager::getKeywordLibraryPath() const { return keywordLibraryPath; }
 void ConfigManager::setKeywordLibraryPath(const QString &path) { 
+    if (keywordLibraryPath == path) {
+        return;
+    }
     keywordLibraryPath = path; 
-    emit configChanged(); 
+    if (m_libraryWatcher) {
+        watchLibraryFiles();
+    }
+    notifyKeysChanged({"Paths/KeywordLibraryPath"});
 }
 
 // 文件路径管理方法
 QString ConfigManager::getConfigFilePath() const { return configFilePath; }
 void ConfigManager::setConfigFilePath(const QString &path) { 
+    if (configFilePath == path) {
+        return;
+    }
     configFilePath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"Paths/ConfigFilePath"});
 }
 
 QString ConfigManager::getQuestionFilePath() const { return questionFilePath; }
 void ConfigManager::setQuestionFilePath(const QString &path) { 
+    if (questionFilePath == path) {
+        return;
+    }
     questionFilePath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"Paths/QuestionFilePath"});
 }
 
 QString ConfigManager::getKeywordFilePath() const { return keywordFilePath; }
 void ConfigManager::setKeywordFilePath(const QString &path) { 
+    if (keywordFilePath == path) {
+        return;
+    }
     keywordFilePath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"Paths/KeywordFilePath"});
 }
 
 QString ConfigManager::getLogFilePath() const { return logFilePath; }
 void ConfigManager::setLogFilePath(const QString &path) { 
+    if (logFilePath == path) {
+        return;
+    }
     logFilePath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"Paths/LogFilePath"});
 }
 
 QString ConfigManager::getTemplateFilePath() const { return templateFilePath; }
 void ConfigManager::setTemplateFilePath(const QString &path) { 
+    if (templateFilePath == path) {
+        return;
+    }
     templateFilePath = path; 
-    emit configChanged(); 
+    notifyKeysChanged({"Paths/TemplateFilePath"});
 }
 
-QStringList ConfigManager::getQuestionList() const { return questionList; }
+QStringList ConfigManager::getQuestionList() const {
+    if (questionList.isEmpty() && questionBank) {
+        return questionBank->toStringList();
+    }
+    return questionList;
+}
 void ConfigManager::setQuestionList(const QStringList &list) { 
     questionList = list; 
-    emit configChanged(); 
+    questionBank.reset();
+    notifyKeysChanged({"Library/QuestionList"});
 }
 
+std::shared_ptr<const QuestionBank> ConfigManager::getQuestionBank() const { return questionBank; }
+
 QStringList ConfigManager::getKeywordList() const { return keywordList; }
 void ConfigManager::setKeywordList(const QStringList &list) { 
     keywordList = list; 
-    emit configChanged(); 
+    notifyKeysChanged({"Library/KeywordList"});
 }
 
 bool ConfigManager::getMultiMonitorSupport() const { return m_multiMonitorSupport; }
 void ConfigManager::setMultiMonitorSupport(bool support) { 
+    if (m_multiMonitorSupport == support) {
+        return;
+    }
     m_multiMonitorSupport = support; 
-    emit configChanged();
+    notifyKeysChanged({"Display/MultiMonitorSupport"});
 }
 
 int ConfigManager::getPrimaryMonitorIndex() const { return m_primaryMonitorIndex; }
 void ConfigManager::setPrimaryMonitorIndex(int index) { 
+    if (m_primaryMonitorIndex == index) {
+        return;
+    }
     m_primaryMonitorIndex = index; 
-    emit configChanged();
+    notifyKeysChanged({"Display/PrimaryMonitorIndex"});
 }
 
 // 鼠标移动检测设置
 bool ConfigManager::getMouseMovementStopAutomation() const { return m_mouseMovementStopAutomation; }
 void ConfigManager::setMouseMovementStopAutomation(bool enabled) {
+    if (m_mouseMovementStopAutomation == enabled) {
+        return;
+    }
     m_mouseMovementStopAutomation = enabled;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/MouseMovementStopAutomation"});
 }
 
 int ConfigManager::getMouseInactivityTimeout() const { return m_mouseInactivityTimeout; }
 void ConfigManager::setMouseInactivityTimeout(int timeout) {
+    if (m_mouseInactivityTimeout == timeout) {
+        return;
+    }
     m_mouseInactivityTimeout = timeout;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/MouseInactivityTimeout"});
 }
 
 // 图标路径管理方法实现
@@ -849,8 +1349,11 @@ QString ConfigManager::getIconPath(const QString &iconName) const {
 }
 
 void ConfigManager::setIconPath(const QString &iconName, const QString &path) {
+    if (iconPaths.contains(iconName) && iconPaths.value(iconName) == path) {
+        return;
+    }
     iconPaths[iconName] = path;
-    emit configChanged();
+    notifyKeysChanged({"IconPaths/" + iconName});
 }
 
 QMap<QString, QString> ConfigManager::getAllIconPaths() const {
@@ -858,29 +1361,66 @@ QMap<QString, QString> ConfigManager::getAllIconPaths() const {
 }
 
 void ConfigManager::setAllIconPaths(const QMap<QString, QString> &paths) {
+    // 只通知路径有变化的图标
+    QStringList changed;
+    for (auto it = paths.cbegin(); it != paths.cend(); ++it) {
+        if (!iconPaths.contains(it.key()) || iconPaths.value(it.key()) != it.value()) {
+            changed.append("IconPaths/" + it.key());
+        }
+    }
+    for (auto it = iconPaths.cbegin(); it != iconPaths.cend(); ++it) {
+        if (!paths.contains(it.key())) {
+            changed.append("IconPaths/" + it.key());
+        }
+    }
     iconPaths = paths;
+    if (changed.isEmpty()) {
+        publishSnapshot();
+    } else {
+        notifyKeysChanged(changed);
+    }
 }
 
 // 模板尺寸管理方法实现
 QSize ConfigManager::getTemplateSize(const QString &templateName) const {
-    if (templateSizes.contains(templateName)) {
-        return templateSizes.value(templateName);
-    }
-    // 返回默认尺寸
-    return QSize(100, 100);
+    return snapshot()->templateSize(templateName);
 }
 
 void ConfigManager::setTemplateSize(const QString &templateName, const QSize &size) {
-    templateSizes[templateName] = size;
-    emit configChanged();
+    {
+        QMutexLocker locker(&m_snapshotMutex);
+        if (templateSizes.contains(templateName) && templateSizes.value(templateName) == size) {
+            return;
+        }
+        templateSizes[templateName] = size;
+    }
+    notifyKeysChanged({"TemplateSizes/" + templateName});
+}
+
+void ConfigManager::setMeasuredTemplateSize(const QString &templateName, const QSize &size) {
+    // 识别线程调用：在上一版快照的基础上只修改实测尺寸，不读取GUI线程的设置，不写入配置文件
+    QMutexLocker locker(&m_snapshotMutex);
+    if (m_measuredTemplateSizes.value(templateName) == size) {
+        return;
+    }
+    m_measuredTemplateSizes[templateName] = size;
+    auto next = std::make_shared<ConfigSnapshot>(*std::atomic_load(&m_snapshot));
+    next->measuredTemplateSizes[templateName] = size;
+    next->version = ++m_snapshotVersion;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const ConfigSnapshot>(std::move(next)));
 }
 
 QMap<QString, QSize> ConfigManager::getAllTemplateSizes() const {
-    return templateSizes;
+    return snapshot()->templateSizes;
 }
 
 void ConfigManager::setAllTemplateSizes(const QMap<QString, QSize> &sizes) {
-    templateSizes = sizes;
+    {
+        QMutexLocker locker(&m_snapshotMutex);
+        templateSizes = sizes;
+    }
+    publishSnapshot();
+    schedulePersist();
 }
 
 // 图像识别开关 getter 和 setter 方法
@@ -889,8 +1429,11 @@ bool ConfigManager::getUseImageRecognition() const {
 }
 
 void ConfigManager::setUseImageRecognition(bool useImage) {
+    if (m_useImageRecognition == useImage) {
+        return;
+    }
     m_useImageRecognition = useImage;
-    emit configChanged();
+    notifyKeysChanged({"ImageRecognition/UseImageRecognition"});
 }
 
 
@@ -901,8 +1444,11 @@ int ConfigManager::getQuestionMode() const {
 }
 
 void ConfigManager::setQuestionMode(int mode) {
+    if (questionMode == mode) {
+        return;
+    }
     questionMode = mode;
-    emit configChanged();
+    notifyKeysChanged({"QA/QuestionMode"});
 }
 
 // 循环次数的getter和setter方法
@@ -911,8 +1457,11 @@ int ConfigManager::getLoopCount() const {
 }
 
 void ConfigManager::setLoopCount(int count) {
+    if (loopCount == count) {
+        return;
+    }
     loopCount = count;
-    emit configChanged();
+    notifyKeysChanged({"QA/LoopCount"});
 }
 
 // 鼠标点击延迟的getter和setter方法
@@ -921,8 +1470,11 @@ int ConfigManager::getMouseClickDelay() const {
 }
 
 void ConfigManager::setMouseClickDelay(int delay) {
+    if (mouseClickDelay == delay) {
+        return;
+    }
     mouseClickDelay = delay;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/MouseClickDelay"});
 }
 
 // 键盘输入延迟的getter和setter方法
@@ -931,8 +1483,11 @@ int ConfigManager::getKeyboardInputDelay() const {
 }
 
 void ConfigManager::setKeyboardInputDelay(int delay) {
+    if (keyboardInputDelay == delay) {
+        return;
+    }
     keyboardInputDelay = delay;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/KeyboardInputDelay"});
 }
 
 // 日志级别的getter和setter方法
@@ -941,8 +1496,11 @@ int ConfigManager::getLogLevel() const {
 }
 
 void ConfigManager::setLogLevel(int level) {
+    if (logLevel == level) {
+        return;
+    }
     logLevel = level;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/LogLevel"});
 }
 
 // 自动更新检查的getter和setter方法
@@ -951,8 +1509,11 @@ bool ConfigManager::getAutoCheckUpdates() const {
 }
 
 void ConfigManager::setAutoCheckUpdates(bool autoCheck) {
+    if (autoCheckUpdates == autoCheck) {
+        return;
+    }
     autoCheckUpdates = autoCheck;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/AutoCheckUpdates"});
 }
 
 // 调试模式的getter和setter方法
@@ -961,8 +1522,11 @@ bool ConfigManager::getDebugMode() const {
 }
 
 void ConfigManager::setDebugMode(bool debugMode) {
+    if (this->debugMode == debugMode) {
+        return;
+    }
     this->debugMode = debugMode;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/DebugMode"});
 }
 
 // 输入方式的getter和setter方法
@@ -971,6 +1535,158 @@ int ConfigManager::getInputMethod() const {
 }
 
 void ConfigManager::setInputMethod(int method) {
+    if (inputMethod == method) {
+        return;
+    }
     inputMethod = method;
-    emit configChanged();
+    notifyKeysChanged({"Advanced/InputMethod"});
+}
+
+// 运行时间线追踪的getter和setter方法
+bool ConfigManager::getTraceEnabled() const {
+    return m_traceEnabled;
+}
+
+void ConfigManager::setTraceEnabled(bool enabled) {
+    if (m_traceEnabled == enabled) {
+        return;
+    }
+    m_traceEnabled = enabled;
+    notifyKeysChanged({"Advanced/TraceEnabled"});
+}
+
+// 模板匹配诊断的getter和setter方法
+bool ConfigManager::getMatchDiagnosticsEnabled() const {
+    return m_matchDiagnosticsEnabled;
+}
+
+void ConfigManager::setMatchDiagnosticsEnabled(bool enabled) {
+    if (m_matchDiagnosticsEnabled == enabled) {
+        return;
+    }
+    m_matchDiagnosticsEnabled = enabled;
+    notifyKeysChanged({"Diagnostics/MatchHeatmaps"});
+}
+
+int ConfigManager::getMatchDiagnosticsHistory() const {
+    return m_matchDiagnosticsHistory;
+}
+
+void ConfigManager::setMatchDiagnosticsHistory(int history) {
+    if (m_matchDiagnosticsHistory == history) {
+        return;
+    }
+    m_matchDiagnosticsHistory = history;
+    notifyKeysChanged({"Diagnostics/MatchHistory"});
+}
+
+int ConfigManager::getMatchDiagnosticsTopK() const {
+    return m_matchDiagnosticsTopK;
+}
+
+void ConfigManager::setMatchDiagnosticsTopK(int topK) {
+    if (m_matchDiagnosticsTopK == topK) {
+        return;
+    }
+    m_matchDiagnosticsTopK = topK;
+    notifyKeysChanged({"Diagnostics/MatchTopK"});
+}
+
+// 中断后继续运行的getter和setter方法
+bool ConfigManager::getResumeInterruptedRuns() const {
+    return m_resumeInterruptedRuns;
+}
+
+void ConfigManager::setResumeInterruptedRuns(bool enabled) {
+    if (m_resumeInterruptedRuns == enabled) {
+        return;
+    }
+    m_resumeInterruptedRuns = enabled;
+    notifyKeysChanged({"Advanced/ResumeInterruptedRuns"});
+}
+
+// 指标服务的getter和setter方法
+bool ConfigManager::getMetricsEnabled() const {
+    return m_metricsEnabled;
+}
+
+void ConfigManager::setMetricsEnabled(bool enabled) {
+    if (m_metricsEnabled == enabled) {
+        return;
+    }
+    m_metricsEnabled = enabled;
+    notifyKeysChanged({"Metrics/Enabled"});
+}
+
+QString ConfigManager::getMetricsBindAddress() const {
+    return m_metricsBindAddress;
+}
+
+void ConfigManager::setMetricsBindAddress(const QString &address) {
+    if (m_metricsBindAddress == address) {
+        return;
+    }
+    m_metricsBindAddress = address;
+    notifyKeysChanged({"Metrics/BindAddress"});
+}
+
+int ConfigManager::getMetricsPort() const {
+    return m_metricsPort;
+}
+
+void ConfigManager::setMetricsPort(int port) {
+    if (m_metricsPort == port) {
+        return;
+    }
+    m_metricsPort = port;
+    notifyKeysChanged({"Metrics/Port"});
+}
+
+// 控制接口的getter和setter方法
+bool ConfigManager::getControlEnabled() const {
+    return m_controlEnabled;
+}
+
+void ConfigManager::setControlEnabled(bool enabled) {
+    if (m_controlEnabled == enabled) {
+        return;
+    }
+    m_controlEnabled = enabled;
+    notifyKeysChanged({"Control/Enabled"});
+}
+
+QString ConfigManager::getControlBindAddress() const {
+    return m_controlBindAddress;
+}
+
+void ConfigManager::setControlBindAddress(const QString &address) {
+    if (m_controlBindAddress == address) {
+        return;
+    }
+    m_controlBindAddress = address;
+    notifyKeysChanged({"Control/BindAddress"});
+}
+
+int ConfigManager::getControlPort() const {
+    return m_controlPort;
+}
+
+void ConfigManager::setControlPort(int port) {
+    if (m_controlPort == port) {
+        return;
+    }
+    m_controlPort = port;
+    notifyKeysChanged({"Control/Port"});
+}
+
+QString ConfigManager::getControlToken() const {
+    return m_controlToken;
+}
+
+void ConfigManager::setControlToken(const QString &token) {
+    if (m_controlToken == token) {
+        return;
+    }
+    m_controlToken = token;
+    notifyKeysChanged({"Control/Token"});
 }
@@ -8,6 +8,62 @@
 #include <QPoint>
 #include <QSize>
 #include <QMap>
+#include <QVector>
+#include <QPair>
+#include <QVariant>
+#include <memory>
+#include "recognitionprofile.h"
+
+class QuestionBank;
+class QFileSystemWatcher;
+class QTimer;
+
+// 不可变的配置快照
+// 工作线程每个周期取一次快照并只读使用，读取时不加锁；设置变化时发布新版本
+struct ConfigSnapshot {
+    quint64 version = 0;
+
+    double imageRecognitionThreshold = 0.8;
+    int maxRecognitionAttempts = 3;
+    int pageLoadTimeout = 0;
+    int recognitionTimeout = 0;
+    QString recognitionTechnique;
+    bool featureFallback = true;
+    bool recognitionHitCache = true;
+    bool pyramidMatching = true;
+    int answerTimeout = 0;
+    int delayBetweenRounds = 0;
+    bool continueOnError = false;
+    bool continueOnTimeout = false;
+    int mouseClickDelay = 0;
+    int keyboardInputDelay = 0;
+    bool windowTopMost = false;
+    QString logPath;
+    QMap<QString, QString> iconPaths;
+    QMap<QString, QSize> templateSizes;
+    QMap<QString, QSize> measuredTemplateSizes;   // 识别时实测的尺寸（不保存）
+    QMap<QString, RecognitionProfile> recognitionProfiles;  // 配置文件中的识别参数
+
+    // 优先使用本次加载模板时的实测尺寸，其次是配置的尺寸，都没有时的默认值与ConfigManager的getter一致
+    QSize templateSize(const QString &templateName) const {
+        auto it = measuredTemplateSizes.constFind(templateName);
+        if (it != measuredTemplateSizes.constEnd()) {
+            return it.value();
+        }
+        return templateSizes.value(templateName, QSize(100, 100));
+    }
+    QString iconPath(const QString &iconName) const {
+        return iconPaths.value(iconName, QString(":/templates/%1.svg").arg(iconName));
+    }
+    // 未配置的模板使用内置默认值
+    RecognitionProfile recognitionProfile(const QString &templateName) const {
+        auto it = recognitionProfiles.constFind(templateName);
+        if (it != recognitionProfiles.constEnd()) {
+            return it.value();
+        }
+        return RecognitionProfile::builtin(templateName, imageRecognitionThreshold, recognitionTechnique);
+    }
+};
 
 class ConfigManager : public QObject {
     Q_OBJECT
@@ -20,6 +76,9 @@ public:
     // 延迟初始化方法，用于在信号连接后执行初始化
     void initialize();
 
+    // 当前配置快照（任意线程可调用，无锁读取）
+    std::shared_ptr<const ConfigSnapshot> snapshot() const;
+
     // 加载配置
     bool loadConfig();
 
@@ -47,7 +106,7 @@ public:
     // 从CSV文件导入问题
     bool importQuestionsFromCSV(const QString &csvPath);
     
-    // 预览CSV文件内容
+    // 预览CSV文件内容（立即返回前maxLines行，总行数通过 csvLineCountReady 异步返回）
     QStringList previewCSVFile(const QString &csvPath, int maxLines = 20);
 
     // 获取企业微信路径
@@ -134,6 +193,23 @@ public:
     // 设置识别技术
     void setRecognitionTechnique(const QString &technique);
 
+    // 相关匹配失败时是否使用ORB特征匹配兜底
+    bool getFeatureFallback() const;
+    void setFeatureFallback(bool enabled);
+
+    // 图块未变化时是否直接沿用上次的识别结果
+    bool getRecognitionHitCache() const;
+    void setRecognitionHitCache(bool enabled);
+
+    // 图像内核使用的指令集：auto、scalar、sse4.1、avx2、avx512（用于基准测试对比）
+    QString getImageKernelLevel() const;
+    void setImageKernelLevel(const QString &level);
+
+    // 单个模板的识别参数（未配置时返回内置默认值）
+    RecognitionProfile getRecognitionProfile(const QString &templateName) const;
+    QMap<QString, RecognitionProfile> getRecognitionProfiles() const;
+    void setRecognitionProfile(const QString &templateName, const RecognitionProfile &profile);
+
     // 获取日志路径
     QString getLogPath() const;
 
@@ -182,12 +258,15 @@ public:
     // 设置关键词库路径
     void setKeywordLibraryPath(const QString &path);
 
-    // 获取问题列表
+    // 获取问题列表（使用二进制问题库时会拷贝全部问题，运行时请使用 getQuestionBank）
     QStringList getQuestionList() const;
 
-    // 设置问题列表
+    // 设置问题列表（覆盖问题库，不再使用二进制问题库）
     void setQuestionList(const QStringList &list);
 
+    // 获取内存映射的二进制问题库，未生成时返回空
+    std::shared_ptr<const QuestionBank> getQuestionBank() const;
+
     // 获取关键词列表
     QStringList getKeywordList() const;
 
@@ -227,6 +306,8 @@ public:
     // 模板尺寸管理
     QSize getTemplateSize(const QString &templateName) const;
     void setTemplateSize(const QString &templateName, const QSize &size);
+    // 识别时实测的模板尺寸（任意线程可调用，只进入配置快照，不写入配置文件）
+    void setMeasuredTemplateSize(const QString &templateName, const QSize &size);
     QMap<QString, QSize> getAllTemplateSizes() const;
     void setAllTemplateSizes(const QMap<QString, QSize> &sizes);
     
@@ -243,14 +324,94 @@ public:
     // 输入方式设置
     int getInputMethod() const;
     void setInputMethod(int method);
+    
+    // 运行时间线追踪设置
+    bool getTraceEnabled() const;
+    void setTraceEnabled(bool enabled);
+    
+    // 模板匹配诊断设置（保留得分图和候选点，运行结束后导出热力图）
+    bool getMatchDiagnosticsEnabled() const;
+    void setMatchDiagnosticsEnabled(bool enabled);
+    int getMatchDiagnosticsHistory() const;
+    void setMatchDiagnosticsHistory(int history);
+    int getMatchDiagnosticsTopK() const;
+    void setMatchDiagnosticsTopK(int topK);
+    
+    // 中断后继续运行设置（任务日志）
+    bool getResumeInterruptedRuns() const;
+    void setResumeInterruptedRuns(bool enabled);
+    
+    // 指标服务设置
+    bool getMetricsEnabled() const;
+    void setMetricsEnabled(bool enabled);
+    QString getMetricsBindAddress() const;
+    void setMetricsBindAddress(const QString &address);
+    int getMetricsPort() const;
+    void setMetricsPort(int port);
+    
+    // 控制接口设置
+    bool getControlEnabled() const;
+    void setControlEnabled(bool enabled);
+    QString getControlBindAddress() const;
+    void setControlBindAddress(const QString &address);
+    int getControlPort() const;
+    void setControlPort(int port);
+    QString getControlToken() const;
+    void setControlToken(const QString &token);
 
 signals:
     void logMessage(const QString &message);
     void configChanged();
 
+    // 配置变化的具体键（"分组/键名"，与配置文件一致；图标路径和模板尺寸为"IconPaths/名称"、
+    // "TemplateSizes/名称"，问题和关键词列表为"Library/QuestionList"、"Library/KeywordList"）。
+    // 与configChanged同时发出，值未变化时都不发出
+    void configKeysChanged(const QStringList &keys);
+
+    // CSV文件总行数统计完成（在后台线程中发出，lines为-1表示读取失败）
+    void csvLineCountReady(const QString &csvPath, qint64 lines);
+
+    // 问题库/关键词库文件被外部修改并重新加载后发出，只包含增加和删除的条目
+    // （问题库只修改了优先级时两个列表都为空）
+    void questionLibraryReloaded(const QStringList &added, const QStringList &removed);
+    void keywordLibraryReloaded(const QStringList &added, const QStringList &removed);
+
 private:
     void initDefaultConfig();
 
+    // 打开问题库对应的二进制缓存，源文件有变化时重新生成
+    bool loadQuestionBank();
+
+    // 监视问题库和关键词库文件（路径变化后重新设置）
+    void watchLibraryFiles();
+
+    // 库文件变化：合并短时间内的多次写入后再重新加载
+    void onLibraryFileChanged(const QString &path);
+
+    // 重新加载有变化的库文件并发出增删差异
+    void reloadChangedLibraries();
+
+    // 用当前设置生成新版本的快照并发布（设置只在GUI线程修改）
+    void publishSnapshot();
+
+    // 发布快照并通知哪些键发生了变化
+    void notifyKeysChanged(const QStringList &keys);
+
+    // 延迟写回：合并短时间内的修改，在后台线程写入配置文件
+    struct PersistState {
+        QMutex mutex;          // 串行化写入
+        quint64 requested = 0; // 已请求的版本（仅GUI线程修改）
+        quint64 written = 0;   // 已写入的版本
+    };
+    void schedulePersist();
+    void persistPending();
+    QVector<QPair<QString, QVariant>> collectSettings() const;
+    static QString settingsFilePath();
+    // 写入临时文件后原子替换配置文件
+    static bool writeSettings(const std::shared_ptr<PersistState> &state, quint64 generation,
+                              const QString &configPath, const QVector<QPair<QString, QVariant>> &values,
+                              QString *errorString);
+
     // 企业微信路径
     QString wechatPath;
 
@@ -293,6 +454,21 @@ private:
     // 识别技术
     QString recognitionTechnique;
 
+    // 特征匹配兜底
+    bool m_featureFallback;
+
+    // 识别结果缓存
+    bool m_recognitionHitCache;
+
+    // 先在半分辨率截图上粗匹配，再在候选点附近全分辨率匹配
+    bool m_pyramidMatching;
+
+    // 图像内核指令集
+    QString m_imageKernelLevel;
+
+    // 按模板配置的识别参数
+    QMap<QString, RecognitionProfile> m_recognitionProfiles;
+
     // 日志路径
     QString logPath;
     
@@ -327,9 +503,18 @@ private:
     // 问题列表
     QStringList questionList;
 
+    // 二进制问题库（问题列表为空时使用）
+    std::shared_ptr<QuestionBank> questionBank;
+
     // 关键词列表
     QStringList keywordList;
 
+    // 库文件热加载
+    QFileSystemWatcher *m_libraryWatcher = nullptr;
+    QTimer *m_libraryReloadTimer = nullptr;
+    bool m_questionLibraryChanged = false;
+    bool m_keywordLibraryChanged = false;
+
     // 添加缺失的成员变量声明
     bool m_multiMonitorSupport;
     int m_primaryMonitorIndex;
@@ -337,8 +522,20 @@ private:
     // 图标路径配置
     QMap<QString, QString> iconPaths;
     
-    // 模板尺寸配置
+    // 模板尺寸配置（识别线程也会写入，由m_snapshotMutex保护）
     QMap<QString, QSize> templateSizes;
+
+    // 识别时实测的模板尺寸（由m_snapshotMutex保护）
+    QMap<QString, QSize> m_measuredTemplateSizes;
+
+    // 延迟写回状态（后台写入任务共享）
+    std::shared_ptr<PersistState> m_persistState = std::make_shared<PersistState>();
+    QTimer *m_persistTimer = nullptr;
+
+    // 已发布的配置快照（通过std::atomic_load/atomic_store读写）
+    std::shared_ptr<const ConfigSnapshot> m_snapshot;
+    QMutex m_snapshotMutex;
+    quint64 m_snapshotVersion = 0;
     
     // 图像识别开关
     bool m_useImageRecognition;
@@ -349,6 +546,28 @@ private:
     
     // 输入方式设置
     int inputMethod;
+    
+    // 运行时间线追踪
+    bool m_traceEnabled;
+    
+    // 模板匹配诊断
+    bool m_matchDiagnosticsEnabled;
+    int m_matchDiagnosticsHistory;
+    int m_matchDiagnosticsTopK;
+    
+    // 中断后继续运行
+    bool m_resumeInterruptedRuns;
+    
+    // 指标服务设置
+    bool m_metricsEnabled;
+    QString m_metricsBindAddress;
+    int m_metricsPort;
+    
+    // 控制接口设置
+    bool m_controlEnabled;
+    QString m_controlBindAddress;
+    int m_controlPort;
+    QString m_controlToken;
 
     QSettings *settings;
 
@@ -0,0 +1,290 @@
+#include "controlserver.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QMetaEnum>
+#include <QDateTime>
+
+namespace {
+
+// 单行请求最大长度
+constexpr int kMaxLineSize = 1024 * 1024;
+
+} // namespace
+
+ControlServer::ControlServer(Automator *automator, QObject *parent)
+    : QObject(parent)
+    , m_automator(automator)
+{
+    m_thread.setObjectName("ControlThread");
+}
+
+ControlServer::~ControlServer()
+{
+    stop();
+}
+
+bool ControlServer::start(const QString &bindAddress, quint16 port, const QString &token)
+{
+    if (m_server) {
+        return true;
+    }
+    if (!m_automator) {
+        emit logMessage("[ERROR] 控制接口启动失败：自动化对象为空");
+        return false;
+    }
+
+    QHostAddress address(bindAddress.isEmpty() ? QString("127.0.0.1") : bindAddress);
+    if (address.isNull()) {
+        emit logMessage(QString("[ERROR] 控制接口监听地址无效: %1").arg(bindAddress));
+        return false;
+    }
+    m_token = token;
+
+    m_thread.start();
+
+    // 服务器对象归属监听线程，请求解析与事件推送都在该线程中完成
+    QTcpServer *server = new QTcpServer();
+    server->moveToThread(&m_thread);
+    m_server = server;
+
+    bool listening = false;
+    QString errorString;
+    QMetaObject::invokeMethod(server, [this, server, address, port, &listening, &errorString]() {
+        connect(server, &QTcpServer::newConnection, server, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection()) {
+                handleConnection(socket);
+            }
+        });
+        connectAutomatorSignals();
+        listening = server->listen(address, port);
+        if (!listening) {
+            errorString = server->errorString();
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listening) {
+        emit logMessage(QString("[ERROR] 控制接口启动失败 %1:%2 - %3")
+                            .arg(address.toString()).arg(port).arg(errorString));
+        stop();
+        return false;
+    }
+
+    emit logMessage(QString("[INFO] 控制接口已启动: %1:%2").arg(address.toString()).arg(port));
+    return true;
+}
+
+void ControlServer::stop()
+{
+    if (!m_server) {
+        return;
+    }
+
+    QTcpServer *server = m_server;
+    m_server = nullptr;
+    QMetaObject::invokeMethod(server, [this, server]() {
+        for (const QPointer<QTcpSocket> &socket : m_subscribers) {
+            if (socket) {
+                socket->abort();
+            }
+        }
+        m_subscribers.clear();
+        server->close();
+        // 断开在监听线程中建立的自动化信号连接
+        disconnect(m_automator, nullptr, server, nullptr);
+        delete server;
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ControlServer::connectAutomatorSignals()
+{
+    // 以服务器对象为上下文，信号排队到监听线程处理，不阻塞自动化流程
+    connect(m_automator, &Automator::progressUpdated, m_server, [this](int current, int total) {
+        m_lastCurrent = current;
+        m_lastTotal = total;
+        QJsonObject event;
+        event["event"] = "progress";
+        event["current"] = current;
+        event["total"] = total;
+        broadcast(event);
+    });
+
+    connect(m_automator, &Automator::questionCompleted, m_server,
+            [this](int index, const QString &question, bool success) {
+        QJsonObject event;
+        event["event"] = "question";
+        event["index"] = index;
+        event["question"] = question;
+        event["success"] = success;
+        broadcast(event);
+    });
+
+    connect(m_automator, &Automator::stateChanged, m_server, [this](Automator::State state) {
+        m_lastState = QString::fromLatin1(QMetaEnum::fromType<Automator::State>().valueToKey(state));
+        QJsonObject event;
+        event["event"] = "state";
+        event["state"] = m_lastState;
+        broadcast(event);
+    });
+
+    connect(m_automator, &Automator::pausedChanged, m_server, [this](bool paused) {
+        QJsonObject event;
+        event["event"] = "paused";
+        event["paused"] = paused;
+        broadcast(event);
+    });
+
+    connect(m_automator, &Automator::automationCompleted, m_server, [this]() {
+        QJsonObject event;
+        event["event"] = "completed";
+        event["current"] = m_lastCurrent;
+        event["total"] = m_lastTotal;
+        broadcast(event);
+    });
+}
+
+void ControlServer::handleConnection(QTcpSocket *socket)
+{
+    socket->setParent(nullptr);
+    socket->setProperty("authenticated", m_token.isEmpty());
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+    connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+        while (socket->canReadLine()) {
+            QByteArray line = socket->readLine().trimmed();
+            if (!line.isEmpty()) {
+                handleLine(socket, line);
+            }
+        }
+        // 防止客户端发送超长的无换行数据
+        if (socket->bytesAvailable() > kMaxLineSize) {
+            QJsonObject error;
+            error["ok"] = false;
+            error["error"] = "request too large";
+            sendJson(socket, error);
+            socket->disconnectFromHost();
+        }
+    });
+}
+
+void ControlServer::handleLine(QTcpSocket *socket, const QByteArray &line)
+{
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        QJsonObject error;
+        error["ok"] = false;
+        error["error"] = "invalid json: " + parseError.errorString();
+        sendJson(socket, error);
+        return;
+    }
+
+    QJsonObject request = document.object();
+    QJsonObject response = executeCommand(socket, request);
+    if (request.contains("id")) {
+        response["id"] = request.value("id");
+    }
+    sendJson(socket, response);
+}
+
+QJsonObject ControlServer::executeCommand(QTcpSocket *socket, const QJsonObject &request)
+{
+    QJsonObject response;
+    const QString command = request.value("cmd").toString();
+
+    // 认证
+    if (command == "auth") {
+        bool accepted = m_token.isEmpty() || request.value("token").toString() == m_token;
+        socket->setProperty("authenticated", accepted);
+        response["ok"] = accepted;
+        if (!accepted) {
+            response["error"] = "invalid token";
+        }
+        return response;
+    }
+    if (!socket->property("authenticated").toBool()) {
+        response["ok"] = false;
+        response["error"] = "authentication required";
+        return response;
+    }
+
+    if (command == "enqueue") {
+        QStringList questions;
+        const QJsonArray array = request.value("questions").toArray();
+        for (const QJsonValue &value : array) {
+            if (value.isString()) {
+                questions.append(value.toString());
+            }
+        }
+        if (questions.isEmpty()) {
+            response["ok"] = false;
+            response["error"] = "questions must be a non-empty array of strings";
+            return response;
+        }
+        response["ok"] = true;
+        response["pending"] = m_automator->enqueueQuestions(questions);
+        emit logMessage(QString("[INFO] 控制接口提交了 %1 个问题").arg(questions.size()));
+    } else if (command == "pause") {
+        m_automator->pause();
+        response["ok"] = true;
+    } else if (command == "resume") {
+        m_automator->resume();
+        response["ok"] = true;
+    } else if (command == "stop") {
+        // stop() 需要在自动化对象所在线程执行
+        Automator *automator = m_automator;
+        QMetaObject::invokeMethod(automator, [automator]() { automator->stop(); }, Qt::QueuedConnection);
+        response["ok"] = true;
+    } else if (command == "hold") {
+        m_automator->setHoldOpen(request.value("enabled").toBool(true));
+        response["ok"] = true;
+        response["hold"] = m_automator->isHoldOpen();
+    } else if (command == "status") {
+        response["ok"] = true;
+        response["state"] = m_lastState;
+        response["current"] = m_lastCurrent;
+        response["total"] = m_lastTotal;
+        response["paused"] = m_automator->isPaused();
+        response["hold"] = m_automator->isHoldOpen();
+        response["pending"] = m_automator->pendingLiveQuestionCount();
+    } else if (command == "subscribe") {
+        if (!m_subscribers.contains(socket)) {
+            m_subscribers.append(socket);
+        }
+        response["ok"] = true;
+    } else {
+        response["ok"] = false;
+        response["error"] = "unknown command: " + command;
+    }
+    return response;
+}
+
+void ControlServer::sendJson(QTcpSocket *socket, const QJsonObject &object)
+{
+    if (!socket || socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    socket->write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
+
+void ControlServer::broadcast(const QJsonObject &event)
+{
+    QJsonObject stamped = event;
+    stamped["time"] = QDateTime::currentMSecsSinceEpoch();
+
+    for (int i = m_subscribers.size() - 1; i >= 0; --i) {
+        QTcpSocket *socket = m_subscribers.at(i);
+        if (!socket || socket->state() != QAbstractSocket::ConnectedState) {
+            m_subscribers.removeAt(i);
+            continue;
+        }
+        sendJson(socket, stamped);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QThread>
+#include <QString>
+#include <QList>
+#include <QPointer>
+#include <QJsonObject>
+#include "automator.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+// 本地控制接口
+// 基于TCP的按行分隔JSON协议，每行一个请求，例如：
+//   {"id":1,"cmd":"enqueue","questions":["问题1","问题2"]}
+//   {"id":2,"cmd":"pause"} / {"cmd":"resume"} / {"cmd":"stop"}
+//   {"cmd":"hold","enabled":true} / {"cmd":"status"} / {"cmd":"subscribe"}
+// 订阅后服务端推送 progress、question、state、paused、completed 事件。
+// 配置了令牌时，连接后需先发送 {"cmd":"auth","token":"..."}。
+class ControlServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ControlServer(Automator *automator, QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    // 启动监听（地址为空时使用127.0.0.1）
+    bool start(const QString &bindAddress, quint16 port, const QString &token = QString());
+
+    // 停止监听并断开所有客户端
+    void stop();
+
+    // 是否正在监听
+    bool isListening() const { return m_server != nullptr; }
+
+signals:
+    void logMessage(const QString &message);
+
+private:
+    // 以下函数均在监听线程中执行
+    void handleConnection(QTcpSocket *socket);
+    void handleLine(QTcpSocket *socket, const QByteArray &line);
+    QJsonObject executeCommand(QTcpSocket *socket, const QJsonObject &request);
+    void sendJson(QTcpSocket *socket, const QJsonObject &object);
+    void broadcast(const QJsonObject &event);
+    void connectAutomatorSignals();
+
+private:
+    Automator *m_automator = nullptr;
+    QThread m_thread;
+    QTcpServer *m_server = nullptr;
+    QString m_token;
+
+    // 订阅事件的客户端（仅在监听线程中访问）
+    QList<QPointer<QTcpSocket>> m_subscribers;
+
+    // 最近一次进度与状态（仅在监听线程中访问）
+    int m_lastCurrent = 0;
+    int m_lastTotal = 0;
+    QString m_lastState = "Idle";
+};
+
+#endif // CONTROLSERVER_H
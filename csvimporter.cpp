@@ -0,0 +1,726 @@
+#include "csvimporter.h"
+#include "questiondedup.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QStringList>
+#include <QtAlgorithms>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define CSV_USE_SSE2
+#endif
+
+namespace {
+
+// 编码识别采样：文件头、中部、尾部各取一段
+constexpr qint64 kEncodingWindowSize = 32 * 1024;
+
+// GBK合法双字节占全部高位字节的比例达到该值时认为判断可靠
+constexpr double kGbkConfidentRatio = 0.95;
+
+// 问题库写入缓冲区大小
+constexpr int kWriteChunkSize = 1024 * 1024;
+
+// 查找未加引号字段的结束位置（分隔符、\r 或 \n），找不到时返回end
+const char *scanUnquoted(const char *p, const char *end, char delimiter)
+{
+#ifdef CSV_USE_SSE2
+    // 每次比较16字节，三个比较结果合并后用掩码定位第一个命中字节
+    const __m128i delimiterMask = _mm_set1_epi8(delimiter);
+    const __m128i newlineMask = _mm_set1_epi8('\n');
+    const __m128i returnMask = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, delimiterMask),
+                                                       _mm_cmpeq_epi8(chunk, newlineMask)),
+                                          _mm_cmpeq_epi8(chunk, returnMask));
+        const int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return p + qCountTrailingZeroBits(static_cast<quint32>(mask));
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != delimiter && *p != '\n' && *p != '\r') {
+        ++p;
+    }
+    return p;
+}
+
+// 检查UTF-8合法性；allowTruncatedTail为true时允许末尾字符被采样截断
+bool isValidUtf8(const unsigned char *s, qint64 size, bool allowTruncatedTail)
+{
+    qint64 i = 0;
+    while (i < size) {
+        // ASCII快速路径：一次检查8字节
+        if (size - i >= 8) {
+            quint64 word;
+            std::memcpy(&word, s + i, sizeof(word));
+            if ((word & Q_UINT64_C(0x8080808080808080)) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+
+        const unsigned char c = s[i];
+        int length = 0;
+        if (c < 0x80) {
+            ++i;
+            continue;
+        } else if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+        } else {
+            return false;
+        }
+
+        if (i + length > size) {
+            return allowTruncatedTail;
+        }
+        for (int k = 1; k < length; ++k) {
+            if ((s[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        // 排除过长编码与代理区
+        if ((c == 0xE0 && s[i + 1] < 0xA0) || (c == 0xED && s[i + 1] >= 0xA0)
+            || (c == 0xF0 && s[i + 1] < 0x90) || (c == 0xF4 && s[i + 1] >= 0x90)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+// 问题库每行一个问题：字段中的换行和制表符替换为空格，并去掉首尾空白
+QByteArray normalizedUtf8(CsvReader &reader, int index)
+{
+    if (index < 0 || index >= reader.fieldCount()) {
+        return QByteArray();
+    }
+    if (reader.encoding() != CsvReader::Utf8) {
+        QString text = reader.fieldText(index);
+        text.replace(QLatin1Char('\r'), QLatin1Char(' '))
+            .replace(QLatin1Char('\n'), QLatin1Char(' '))
+            .replace(QLatin1Char('\t'), QLatin1Char(' '));
+        return text.trimmed().toUtf8();
+    }
+
+    // UTF-8文件直接拷贝字节，避免解码再编码
+    QByteArray bytes = reader.fieldBytes(index).trimmed().toByteArray();
+    if (bytes.contains('\n') || bytes.contains('\r') || bytes.contains('\t')) {
+        bytes.replace('\r', ' ').replace('\n', ' ').replace('\t', ' ');
+        bytes = bytes.trimmed();
+    }
+    return bytes;
+}
+
+// 列名匹配（不区分大小写）
+int findColumn(const QStringList &header, const QStringList &aliases)
+{
+    for (int i = 0; i < header.size(); ++i) {
+        if (aliases.contains(header.at(i), Qt::CaseInsensitive)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+CsvReader::CsvReader(char delimiter)
+    : m_delimiter(delimiter)
+    , m_localDecoder(QStringConverter::System)
+{
+}
+
+CsvReader::~CsvReader()
+{
+    close();
+}
+
+bool CsvReader::open(const QString &path, QString *errorString)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = m_file.errorString();
+        }
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size > 0) {
+        m_data = reinterpret_cast<const char *>(m_file.map(0, m_size));
+        if (!m_data) {
+            if (errorString) {
+                *errorString = "内存映射失败: " + m_file.errorString();
+            }
+            m_file.close();
+            m_size = 0;
+            return false;
+        }
+    }
+
+    m_pos = 0;
+    m_encodingConfident = true;
+    if (m_size >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0) {
+        m_encoding = Utf8;
+        m_pos = 3;
+    } else {
+        m_encoding = detectEncoding(m_data, m_size, &m_encodingConfident);
+    }
+    m_dataStart = m_pos;
+    return true;
+}
+
+void CsvReader::close()
+{
+    if (m_data) {
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_size = 0;
+    m_pos = 0;
+    m_dataStart = 0;
+    m_fields.clear();
+    m_scratch.clear();
+}
+
+void CsvReader::rewind()
+{
+    m_pos = m_dataStart;
+    m_fields.clear();
+    m_scratch.clear();
+}
+
+CsvReader::Encoding CsvReader::detectEncoding(const char *data, qint64 size, bool *confident)
+{
+    if (confident) {
+        *confident = true;
+    }
+    if (!data || size <= 0) {
+        return Utf8;
+    }
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        return Utf8;
+    }
+
+    // 采样窗口：小文件整体检查，大文件只检查头、中、尾三段
+    QVector<QPair<qint64, qint64>> windows;
+    if (size <= kEncodingWindowSize * 3) {
+        windows.append(qMakePair(qint64(0), size));
+    } else {
+        windows.append(qMakePair(qint64(0), kEncodingWindowSize));
+        windows.append(qMakePair((size - kEncodingWindowSize) / 2, kEncodingWindowSize));
+        windows.append(qMakePair(size - kEncodingWindowSize, kEncodingWindowSize));
+    }
+
+    bool utf8 = true;
+    qint64 gbkPairs = 0;
+    qint64 invalidHighBytes = 0;
+    for (const auto &window : windows) {
+        const unsigned char *begin = reinterpret_cast<const unsigned char *>(data) + window.first;
+        qint64 length = window.second;
+        // 窗口从字符中间开始时跳过UTF-8后续字节（最多3个）
+        if (window.first > 0) {
+            for (int skipped = 0; skipped < 3 && length > 0 && (*begin & 0xC0) == 0x80; ++skipped) {
+                ++begin;
+                --length;
+            }
+        }
+        const bool truncated = window.first + window.second < size;
+        if (utf8 && !isValidUtf8(begin, length, truncated)) {
+            utf8 = false;
+        }
+
+        // GBK统计：首字节0x81-0xFE，尾字节0x40-0xFE且不为0x7F
+        for (qint64 i = 0; i < length; ++i) {
+            const unsigned char c = begin[i];
+            if (c < 0x80) {
+                continue;
+            }
+            if (c >= 0x81 && c <= 0xFE && i + 1 < length) {
+                const unsigned char next = begin[i + 1];
+                if (next >= 0x40 && next <= 0xFE && next != 0x7F) {
+                    ++gbkPairs;
+                    ++i;
+                    continue;
+                }
+            }
+            ++invalidHighBytes;
+        }
+    }
+
+    if (utf8) {
+        return Utf8;
+    }
+    if (confident) {
+        const qint64 highBytes = gbkPairs + invalidHighBytes;
+        *confident = highBytes > 0 && double(gbkPairs) / highBytes >= kGbkConfidentRatio;
+    }
+    return Gbk;
+}
+
+qint64 CsvReader::countLines(const char *data, qint64 size)
+{
+    if (!data || size <= 0) {
+        return 0;
+    }
+
+    qint64 count = 0;
+    const char *p = data;
+    const char *end = data + size;
+#ifdef CSV_USE_SSE2
+    // 每次比较16字节，命中掩码的置位数即换行数
+    const __m128i newlineMask = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        count += qPopulationCount(static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlineMask))));
+        p += 16;
+    }
+#endif
+    while (p < end) {
+        const char *newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!newline) {
+            break;
+        }
+        ++count;
+        p = newline + 1;
+    }
+
+    // 最后一行没有换行符
+    if (data[size - 1] != '\n') {
+        ++count;
+    }
+    return count;
+}
+
+qint64 CsvReader::countLines(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const qint64 size = file.size();
+    if (size == 0) {
+        return 0;
+    }
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        return -1;
+    }
+    const qint64 count = countLines(reinterpret_cast<const char *>(data), size);
+    file.unmap(const_cast<uchar *>(data));
+    return count;
+}
+
+bool CsvReader::readRecord()
+{
+    m_fields.clear();
+    m_scratch.clear();
+    if (m_pos >= m_size) {
+        return false;
+    }
+
+    const char *p = m_data + m_pos;
+    const char *end = m_data + m_size;
+
+    // 逗号、引号、换行都是ASCII字符，GBK双字节的尾字节不会落在这些值上，
+    // 因此可以直接在原始字节上解析，两种编码通用
+    while (true) {
+        Field field;
+        if (p < end && *p == '"') {
+            // 带引号字段：查找下一个引号，""为转义的引号
+            ++p;
+            const char *start = p;
+            const char *fieldEnd = end;
+            bool escaped = false;
+            qsizetype scratchStart = m_scratch.size();
+            while (true) {
+                const char *quote = static_cast<const char *>(std::memchr(p, '"', end - p));
+                if (!quote) {
+                    // 引号未闭合：取到文件末尾
+                    if (escaped) {
+                        m_scratch.append(p, end - p);
+                    }
+                    p = end;
+                    break;
+                }
+                if (quote + 1 < end && quote[1] == '"') {
+                    m_scratch.append(escaped ? p : start, quote + 1 - (escaped ? p : start));
+                    escaped = true;
+                    p = quote + 2;
+                    continue;
+                }
+                if (escaped) {
+                    m_scratch.append(p, quote - p);
+                }
+                fieldEnd = quote;
+                p = quote + 1;
+                break;
+            }
+
+            if (escaped) {
+                field.offset = scratchStart;
+                field.size = m_scratch.size() - scratchStart;
+                field.unescaped = true;
+            } else {
+                field.offset = start - m_data;
+                field.size = fieldEnd - start;
+            }
+            // 闭合引号与分隔符之间的多余内容忽略
+            p = scanUnquoted(p, end, m_delimiter);
+        } else {
+            const char *fieldEnd = scanUnquoted(p, end, m_delimiter);
+            field.offset = p - m_data;
+            field.size = fieldEnd - p;
+            p = fieldEnd;
+        }
+        m_fields.append(field);
+
+        if (p >= end) {
+            break;
+        }
+        const char c = *p++;
+        if (c == m_delimiter) {
+            continue;
+        }
+        if (c == '\r' && p < end && *p == '\n') {
+            ++p;
+        }
+        break;
+    }
+
+    m_pos = p - m_data;
+    return true;
+}
+
+QByteArrayView CsvReader::fieldBytes(int index) const
+{
+    if (index < 0 || index >= m_fields.size()) {
+        return QByteArrayView();
+    }
+    const Field &field = m_fields.at(index);
+    const char *base = field.unescaped ? m_scratch.constData() : m_data;
+    return QByteArrayView(base + field.offset, field.size);
+}
+
+QString CsvReader::fieldText(int index)
+{
+    return decode(fieldBytes(index));
+}
+
+QString CsvReader::decode(QByteArrayView bytes)
+{
+    if (m_encoding == Utf8) {
+        return QString::fromUtf8(bytes);
+    }
+    return m_localDecoder.decode(bytes);
+}
+
+CsvImporter::Preview CsvImporter::preview(const QString &csvPath, int maxRows)
+{
+    Preview result;
+
+    CsvReader reader;
+    if (!reader.open(csvPath, &result.errorString)) {
+        return result;
+    }
+    result.ok = true;
+    result.encoding = reader.encoding();
+    result.encodingConfident = reader.isEncodingConfident();
+    result.fileSize = reader.size();
+
+    // 只解析前maxRows条记录，与文件大小无关
+    while (result.rows.size() < maxRows && reader.readRecord()) {
+        if (reader.fieldCount() == 1 && reader.fieldBytes(0).isEmpty()) {
+            continue;
+        }
+        QStringList fields;
+        for (int i = 0; i < reader.fieldCount(); ++i) {
+            QString field = reader.fieldText(i).trimmed();
+            field.replace(QLatin1Char('\r'), QLatin1Char(' ')).replace(QLatin1Char('\n'), QLatin1Char(' '));
+            fields.append(field);
+        }
+        result.rows.append(fields.join(","));
+    }
+    return result;
+}
+
+CsvColumnMapping CsvImporter::detectMapping(CsvReader &reader)
+{
+    CsvColumnMapping mapping;
+    reader.rewind();
+    if (!reader.readRecord()) {
+        reader.rewind();
+        return mapping;
+    }
+
+    QStringList header;
+    for (int i = 0; i < reader.fieldCount(); ++i) {
+        header.append(reader.fieldText(i).trimmed());
+    }
+
+    const int question = findColumn(header, {"问题", "题目", "question", "questions", "prompt"});
+    const int priority = findColumn(header, {"优先级", "权重", "priority", "weight"});
+    const int category = findColumn(header, {"分类", "类别", "类型", "category"});
+    const int difficulty = findColumn(header, {"难度", "difficulty", "level"});
+
+    mapping.hasHeader = question >= 0 || priority >= 0 || category >= 0 || difficulty >= 0;
+    mapping.question = question >= 0 ? question : 0;
+    mapping.priority = priority;
+    mapping.category = category;
+    mapping.difficulty = difficulty;
+
+    // 没有标题行时第一行也是数据
+    if (!mapping.hasHeader) {
+        reader.rewind();
+    }
+    return mapping;
+}
+
+CsvImporter::Result CsvImporter::parse(const QString &csvPath, const RecordHandler &handler,
+                                       const CsvColumnMapping *mapping)
+{
+    Result result;
+    QElapsedTimer timer;
+    timer.start();
+
+    CsvReader reader;
+    if (!reader.open(csvPath, &result.errorString)) {
+        return result;
+    }
+    result.encoding = reader.encoding();
+
+    CsvColumnMapping columns;
+    if (mapping) {
+        columns = *mapping;
+        if (columns.hasHeader) {
+            reader.readRecord();
+        }
+    } else {
+        columns = detectMapping(reader);
+    }
+
+    Record record;
+    while (reader.readRecord()) {
+        // 空行只有一个空字段
+        if (reader.fieldCount() == 1 && reader.fieldBytes(0).isEmpty()) {
+            continue;
+        }
+        ++result.rows;
+
+        record.question = reader.fieldText(columns.question).trimmed();
+        if (record.question.isEmpty()) {
+            ++result.skipped;
+            continue;
+        }
+        record.priority = columns.priority >= 0 ? reader.fieldText(columns.priority).trimmed() : QString();
+        record.category = columns.category >= 0 ? reader.fieldText(columns.category).trimmed() : QString();
+        record.difficulty = columns.difficulty >= 0 ? reader.fieldText(columns.difficulty).trimmed() : QString();
+
+        ++result.imported;
+        if (!handler(record)) {
+            break;
+        }
+    }
+
+    result.ok = true;
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+CsvImporter::Result CsvImporter::importToLibrary(const QString &csvPath, const QString &libraryPath,
+                                                 const QString &attributesPath,
+                                                 const CsvColumnMapping *mapping,
+                                                 QuestionDedupIndex *dedup)
+{
+    Result result;
+    QElapsedTimer timer;
+    timer.start();
+
+    CsvReader reader;
+    if (!reader.open(csvPath, &result.errorString)) {
+        return result;
+    }
+    result.encoding = reader.encoding();
+
+    CsvColumnMapping columns;
+    if (mapping) {
+        columns = *mapping;
+        if (columns.hasHeader) {
+            reader.readRecord();
+        }
+    } else {
+        columns = detectMapping(reader);
+    }
+
+    // 问题库末尾没有换行时先补一个，避免与最后一个问题连在一起
+    bool needNewline = false;
+    {
+        QFile existing(libraryPath);
+        if (existing.open(QIODevice::ReadOnly) && existing.size() > 0) {
+            existing.seek(existing.size() - 1);
+            needNewline = existing.read(1) != "\n";
+        }
+    }
+
+    QFile library(libraryPath);
+    if (!library.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        result.errorString = "无法写入问题库文件: " + libraryPath;
+        return result;
+    }
+
+    QFile attributes(attributesPath);
+    const bool writeAttributes = !attributesPath.isEmpty() && (columns.priority >= 0 || columns.category >= 0 || columns.difficulty >= 0);
+    if (writeAttributes && !attributes.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        result.errorString = "无法写入问题属性文件: " + attributesPath;
+        return result;
+    }
+
+    // 输出按块写入，内存占用固定
+    QByteArray libraryBuffer;
+    QByteArray attributesBuffer;
+    libraryBuffer.reserve(kWriteChunkSize + 4096);
+    if (needNewline) {
+        libraryBuffer.append('\n');
+    }
+    if (writeAttributes) {
+        attributesBuffer.reserve(kWriteChunkSize + 4096);
+    }
+
+    auto writeBuffer = [&result](QFile &file, QByteArray &buffer) {
+        if (buffer.isEmpty()) {
+            return true;
+        }
+        if (file.write(buffer) != buffer.size()) {
+            result.errorString = "写入失败: " + file.errorString();
+            return false;
+        }
+        buffer.clear();
+        return true;
+    };
+
+    while (reader.readRecord()) {
+        if (reader.fieldCount() == 1 && reader.fieldBytes(0).isEmpty()) {
+            continue;
+        }
+        ++result.rows;
+
+        const QByteArray question = normalizedUtf8(reader, columns.question);
+        if (question.isEmpty()) {
+            ++result.skipped;
+            continue;
+        }
+        if (dedup) {
+            const QString text = QString::fromUtf8(question);
+            if (dedup->find(text) != QuestionDedupIndex::NoMatch) {
+                ++result.duplicates;
+                continue;
+            }
+            dedup->insert(text);
+        }
+        libraryBuffer.append(question);
+        libraryBuffer.append('\n');
+
+        if (writeAttributes) {
+            attributesBuffer.append(question);
+            attributesBuffer.append('\t');
+            attributesBuffer.append(normalizedUtf8(reader, columns.priority));
+            attributesBuffer.append('\t');
+            attributesBuffer.append(normalizedUtf8(reader, columns.category));
+            attributesBuffer.append('\t');
+            attributesBuffer.append(normalizedUtf8(reader, columns.difficulty));
+            attributesBuffer.append('\n');
+        }
+        ++result.imported;
+
+        if (libraryBuffer.size() >= kWriteChunkSize && !writeBuffer(library, libraryBuffer)) {
+            return result;
+        }
+        if (attributesBuffer.size() >= kWriteChunkSize && !writeBuffer(attributes, attributesBuffer)) {
+            return result;
+        }
+    }
+
+    if (!writeBuffer(library, libraryBuffer) || !writeBuffer(attributes, attributesBuffer)) {
+        return result;
+    }
+
+    result.ok = true;
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+QString CsvImporter::benchmark(const QString &csvPath)
+{
+    QStringList report;
+    QFile file(csvPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return "无法打开CSV文件: " + csvPath;
+    }
+    const qint64 fileSize = file.size();
+    file.close();
+
+    auto throughput = [fileSize](qint64 ms) {
+        return ms > 0 ? QString::number(fileSize / 1048576.0 / (ms / 1000.0), 'f', 1) : QString("-");
+    };
+
+    // 旧实现：逐行读取，按逗号拆分后取第一个字段，全部问题保存在列表中
+    QElapsedTimer timer;
+    timer.start();
+    qint64 legacyCount = 0;
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&file);
+        QStringList questions;
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (line.isEmpty()) {
+                continue;
+            }
+            QStringList fields = line.split(",");
+            if (!fields.isEmpty()) {
+                QString question = fields.first().trimmed();
+                if (!question.isEmpty()) {
+                    questions.append(question);
+                }
+            }
+        }
+        legacyCount = questions.size();
+        file.close();
+    }
+    const qint64 legacyMs = timer.elapsed();
+
+    // 新实现：只解析不写文件，统计解析本身的耗时
+    qint64 checksum = 0;
+    Result result = parse(csvPath, [&checksum](const Record &record) {
+        checksum += record.question.size();
+        return true;
+    });
+
+    report.append(QString("文件: %1 (%2 MB)").arg(csvPath).arg(fileSize / 1048576.0, 0, 'f', 1));
+    report.append(QString("旧解析器(split): %1 个问题, %2 ms, %3 MB/s")
+                      .arg(legacyCount).arg(legacyMs).arg(throughput(legacyMs)));
+    if (!result.ok) {
+        report.append("新解析器失败: " + result.errorString);
+    } else {
+        report.append(QString("新解析器(RFC 4180): %1 个问题, %2 ms, %3 MB/s, 编码 %4, 跳过 %5 行")
+                          .arg(result.imported).arg(result.elapsedMs).arg(throughput(result.elapsedMs))
+                          .arg(result.encoding == CsvReader::Utf8 ? "UTF-8" : "GBK")
+                          .arg(result.skipped));
+        if (legacyMs > 0 && result.elapsedMs > 0) {
+            report.append(QString("加速比: %1x").arg(double(legacyMs) / result.elapsedMs, 0, 'f', 2));
+        }
+    }
+    Q_UNUSED(checksum);
+    return report.join('\n');
+}
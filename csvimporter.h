@@ -0,0 +1,154 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+#include <QStringList>
+#include <QStringDecoder>
+#include <functional>
+
+class QuestionDedupIndex;
+
+// CSV读取器
+// 按RFC 4180解析：支持带引号的字段（字段内可含逗号、换行和""转义的引号）、
+// UTF-8 BOM、UTF-8/GBK编码。文件通过内存映射读取，未加引号的字段用SIMD
+// 扫描分隔符；字段直接指向映射内存，只有含转义引号的字段才复制，
+// 因此内存占用与文件大小无关。
+class CsvReader
+{
+public:
+    // 文本编码
+    enum Encoding {
+        Utf8,
+        Gbk     // 系统本地编码（中文Windows下为GBK）
+    };
+
+    // 字段在映射内存或转义缓冲区中的位置
+    struct Field {
+        qsizetype offset = 0;
+        qsizetype size = 0;
+        bool unescaped = false;   // true表示位于转义缓冲区
+    };
+
+    explicit CsvReader(char delimiter = ',');
+    ~CsvReader();
+
+    // 打开并映射文件，自动识别BOM与编码
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+
+    // 回到第一条记录（BOM之后）
+    void rewind();
+
+    // 读取下一条记录，文件结束时返回false
+    bool readRecord();
+
+    // 当前记录的字段
+    int fieldCount() const { return m_fields.size(); }
+    QByteArrayView fieldBytes(int index) const;
+    QString fieldText(int index);
+
+    // 解码任意字节（按文件编码）
+    QString decode(QByteArrayView bytes);
+
+    Encoding encoding() const { return m_encoding; }
+    bool isEncodingConfident() const { return m_encodingConfident; }
+    qint64 position() const { return m_pos; }
+    qint64 size() const { return m_size; }
+
+    // 根据采样字节判断编码：先检查BOM，再检查文件头、中、尾三段采样是否为合法UTF-8，
+    // 否则视为GBK；confident返回GBK双字节统计是否足以确认
+    static Encoding detectEncoding(const char *data, qint64 size, bool *confident = nullptr);
+
+    // 统计行数（按换行符计数，SIMD扫描）
+    static qint64 countLines(const char *data, qint64 size);
+    static qint64 countLines(const QString &path);
+
+private:
+    QFile m_file;
+    const char *m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_pos = 0;
+    qint64 m_dataStart = 0;
+    char m_delimiter = ',';
+    Encoding m_encoding = Utf8;
+    bool m_encodingConfident = true;
+    QStringDecoder m_localDecoder;
+
+    QVector<Field> m_fields;
+    QByteArray m_scratch;
+};
+
+// 问题列映射（列号从0开始，-1表示不存在）
+struct CsvColumnMapping {
+    int question = 0;
+    int priority = -1;
+    int category = -1;
+    int difficulty = -1;
+    bool hasHeader = false;
+};
+
+// CSV问题导入器
+// 逐条读取记录并直接写入问题库文件，不在内存中保留全部问题。
+class CsvImporter
+{
+public:
+    // 一条问题记录
+    struct Record {
+        QString question;
+        QString priority;
+        QString category;
+        QString difficulty;
+    };
+
+    // 导入结果
+    struct Result {
+        bool ok = false;
+        qint64 rows = 0;          // 数据行数（不含标题行）
+        qint64 imported = 0;      // 导入的问题数
+        qint64 skipped = 0;       // 问题为空而跳过的行数
+        qint64 duplicates = 0;    // 与问题库或已导入问题重复（含近似重复）而跳过的行数
+        qint64 elapsedMs = 0;
+        CsvReader::Encoding encoding = CsvReader::Utf8;
+        QString errorString;
+    };
+
+    // 预览结果
+    struct Preview {
+        bool ok = false;
+        CsvReader::Encoding encoding = CsvReader::Utf8;
+        bool encodingConfident = true;
+        qint64 fileSize = 0;
+        QStringList rows;         // 前N条记录，字段以逗号连接
+        QString errorString;
+    };
+
+    // 记录回调，返回false时停止导入
+    using RecordHandler = std::function<bool(const Record &record)>;
+
+    // 根据标题行识别列映射（问题/优先级/分类/难度，支持中英文列名）；
+    // 未识别出问题列时视为无标题行，第一列为问题
+    static CsvColumnMapping detectMapping(CsvReader &reader);
+
+    // 读取前maxRows条记录用于预览，不统计总行数
+    static Preview preview(const QString &csvPath, int maxRows);
+
+    // 逐条解析CSV，mapping为空指针时自动识别
+    static Result parse(const QString &csvPath, const RecordHandler &handler,
+                        const CsvColumnMapping *mapping = nullptr);
+
+    // 将CSV中的问题追加到问题库文件（每行一个问题）；
+    // 存在优先级、分类或难度列时写入 attributesPath（问题\t优先级\t分类\t难度）；
+    // 传入dedup时跳过索引中已有的完全/近似重复问题，导入的问题同时加入索引
+    static Result importToLibrary(const QString &csvPath, const QString &libraryPath,
+                                  const QString &attributesPath = QString(),
+                                  const CsvColumnMapping *mapping = nullptr,
+                                  QuestionDedupIndex *dedup = nullptr);
+
+    // 对比旧的按行split解析与新解析器的耗时，返回报告文本
+    static QString benchmark(const QString &csvPath);
+};
+
+#endif // CSVIMPORTER_H
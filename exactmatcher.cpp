@@ -0,0 +1,128 @@
+#include "exactmatcher.h"
+#include "imagekernels.h"
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+// 下界使用的横带数（越多下界越紧，但每个位置的计算量也越大）
+constexpr int kMaxBands = 4;
+
+} // namespace
+
+bool ExactMatcher::find(const uchar *source, int sourceStride, const QSize &sourceSize,
+                        const uchar *templ, int templStride, const QSize &templSize,
+                        double maxMeanDiff, Mode mode, Hit *hit, Stats *stats)
+{
+    const int sw = sourceSize.width();
+    const int sh = sourceSize.height();
+    const int tw = templSize.width();
+    const int th = templSize.height();
+    if (tw <= 0 || th <= 0 || tw > sw || th > sh) {
+        return false;
+    }
+
+    // 积分图（32位无符号，窗口和不超过 255*tw*th，按模2^32相减结果仍然正确）。
+    // 只保留当前候选行需要的 th+1 行，逐行滚动计算：找到即返回时后面的行不再计算，
+    // 缓冲区按线程复用，每次调用不再分配整帧大小的积分图
+    const int iw = sw + 1;
+    const int ringRows = th + 1;
+    thread_local QVector<quint32> ring;
+    if (ring.size() < ringRows * iw) {
+        ring.resize(ringRows * iw);
+    }
+    quint32 *ringData = ring.data();
+    const auto ringRow = [ringData, ringRows, iw](int row) {
+        return ringData + qint64(row % ringRows) * iw;
+    };
+    // 第0行和每行的第0列恒为0（integralRow不写第0列，缓冲区可能留有上次调用的数据）
+    std::fill(ringData, ringData + iw, 0u);
+    for (int row = 1; row < ringRows; ++row) {
+        ringData[qint64(row) * iw] = 0;
+    }
+    for (int y = 0; y < th; ++y) {
+        ImageKernels::integralRow(source + qint64(y) * sourceStride, ringRow(y), ringRow(y + 1), sw);
+    }
+
+    // 模板横带划分及每条横带的像素和
+    const int bands = qMin(kMaxBands, th);
+    int bandTop[kMaxBands + 1];
+    quint32 templateBandSum[kMaxBands];
+    for (int b = 0; b <= bands; ++b) {
+        bandTop[b] = th * b / bands;
+    }
+    for (int b = 0; b < bands; ++b) {
+        quint32 sum = 0;
+        for (int y = bandTop[b]; y < bandTop[b + 1]; ++y) {
+            const uchar *row = templ + qint64(y) * templStride;
+            for (int x = 0; x < tw; ++x) {
+                sum += row[x];
+            }
+        }
+        templateBandSum[b] = sum;
+    }
+
+    const quint64 maxSad = quint64(maxMeanDiff * tw * th);
+    quint64 limit = maxSad;
+    bool found = false;
+    Stats localStats;
+
+    const quint32 *bandRows[kMaxBands + 1];
+    for (int y = 0; y + th <= sh; ++y) {
+        // 移到下一候选行时补算积分图的第 y+th 行，覆盖不再需要的第 y-1 行
+        if (y > 0) {
+            ImageKernels::integralRow(source + qint64(y + th - 1) * sourceStride, ringRow(y + th - 1),
+                                      ringRow(y + th), sw);
+        }
+        for (int b = 0; b <= bands; ++b) {
+            bandRows[b] = ringRow(y + bandTop[b]);
+        }
+
+        for (int x = 0; x + tw <= sw; ++x) {
+            ++localStats.positions;
+
+            // 横带和下界
+            quint64 bound = 0;
+            for (int b = 0; b < bands && bound <= limit; ++b) {
+                const quint32 *top = bandRows[b];
+                const quint32 *bottom = bandRows[b + 1];
+                const quint32 windowSum = bottom[x + tw] - bottom[x] - top[x + tw] + top[x];
+                bound += windowSum > templateBandSum[b] ? windowSum - templateBandSum[b]
+                                                        : templateBandSum[b] - windowSum;
+            }
+            if (bound > limit) {
+                ++localStats.eliminated;
+                continue;
+            }
+
+            // 逐行累加SAD，超过容许值立即放弃
+            quint64 sad = 0;
+            int row = 0;
+            for (; row < th && sad <= limit; ++row) {
+                sad += ImageKernels::sadRow(source + qint64(y + row) * sourceStride + x, templ + qint64(row) * templStride, tw);
+            }
+            localStats.rowsCompared += row;
+            if (sad > limit) {
+                continue;
+            }
+
+            found = true;
+            hit->point = QPoint(x, y);
+            hit->sad = sad;
+            hit->meanDiff = double(sad) / (qint64(tw) * th);
+            if (mode == FirstHit || sad == 0) {
+                if (stats) {
+                    *stats = localStats;
+                }
+                return true;
+            }
+            // 之后只接受更小的SAD
+            limit = sad - 1;
+        }
+    }
+
+    if (stats) {
+        *stats = localStats;
+    }
+    return found;
+}
@@ -0,0 +1,45 @@
+#ifndef EXACTMATCHER_H
+#define EXACTMATCHER_H
+
+#include <QPoint>
+#include <QSize>
+#include <QtGlobal>
+
+// 逐次消除（successive elimination）精确匹配
+// 用于渲染结果逐像素一致的UI图标：按模板分成若干横带，用积分图求出每个位置各横带的像素和，
+// 由 Σ|源横带和 - 模板横带和| ≤ SAD 得到下界，下界已超过容许值的位置直接跳过；
+// 剩下的位置逐行累加SAD（按CPU支持的指令集向量化），超过当前容许值立即放弃。
+// 找不到时由调用方退回相关匹配。
+class ExactMatcher
+{
+public:
+    // 查找模式
+    enum Mode {
+        BestHit,    // 扫描全部位置，返回SAD最小的位置
+        FirstHit    // 返回第一个满足容许值的位置（图标在窗口中只出现一次时使用）
+    };
+
+    // 默认容许的平均每像素灰度差（抗锯齿、压缩带来的微小差异）
+    static constexpr double kDefaultMaxMeanDiff = 2.0;
+
+    // 匹配结果
+    struct Hit {
+        QPoint point;           // 模板左上角在源图像中的位置
+        quint64 sad = 0;        // 绝对差之和
+        double meanDiff = 0.0;  // 平均每像素灰度差
+    };
+
+    // 统计信息（用于日志和评估消除效果）
+    struct Stats {
+        quint64 positions = 0;  // 候选位置总数
+        quint64 eliminated = 0; // 被下界排除的位置数
+        quint64 rowsCompared = 0;   // 实际比较的模板行数
+    };
+
+    // 在8位灰度源图像中查找模板，找到时返回true
+    static bool find(const uchar *source, int sourceStride, const QSize &sourceSize,
+                     const uchar *templ, int templStride, const QSize &templSize,
+                     double maxMeanDiff, Mode mode, Hit *hit, Stats *stats = nullptr);
+};
+
+#endif // EXACTMATCHER_H
@@ -0,0 +1,193 @@
+#include "featurematcher.h"
+#include "imagekernels.h"
+#include <QMutexLocker>
+#include <QtMath>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace {
+
+// 图标通常只有几十像素，小于该尺寸的模板先放大再提取特征
+constexpr int kMinTemplateSide = 96;
+
+// ORB参数：图标较小，缩小描述子邻域，否则边缘的关键点全部被丢弃
+constexpr int kTemplateFeatures = 500;
+constexpr int kSourceFeatures = 4000;
+constexpr int kPatchSize = 15;
+constexpr int kPyramidLevels = 8;
+constexpr float kPyramidScale = 1.2f;
+
+// 比值检验和单应矩阵验证
+constexpr float kRatioTest = 0.75f;
+constexpr int kMinGoodMatches = 8;
+constexpr int kMinInliers = 6;
+constexpr double kMinInlierRatio = 0.4;
+constexpr double kRansacReprojThreshold = 3.0;
+
+// 允许的缩放范围和形状偏差（投影后的四边形应接近与模板等比例的矩形）
+constexpr double kMinScale = 0.4;
+constexpr double kMaxScale = 3.0;
+constexpr double kMaxAspectDeviation = 0.25;
+
+cv::Ptr<cv::ORB> createOrb(int features)
+{
+    return cv::ORB::create(features, kPyramidScale, kPyramidLevels, kPatchSize, 0, 2,
+                           cv::ORB::HARRIS_SCORE, kPatchSize);
+}
+
+cv::Mat wrapGray(const QImage &gray)
+{
+    return cv::Mat(gray.height(), gray.width(), CV_8UC1,
+                   const_cast<uchar *>(gray.constBits()), gray.bytesPerLine());
+}
+
+} // namespace
+
+// 模板特征（只读，匹配时无需加锁）
+struct FeatureMatcher::TemplateFeatures {
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;
+    qint64 imageKey = 0;    // 模板图像的cacheKey
+    QSize size;             // 模板原始尺寸
+    double upscale = 1.0;   // 提取特征前的放大倍数
+    int padding = 0;        // 放大后四周补边的像素
+};
+
+FeatureMatcher::FeatureMatcher() = default;
+
+FeatureMatcher::~FeatureMatcher() = default;
+
+void FeatureMatcher::prepareTemplate(const QString &name, const QImage &templateImage)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_templates.constFind(name);
+        if (it != m_templates.constEnd() && it.value()->imageKey == templateImage.cacheKey()) {
+            return;
+        }
+    }
+
+    auto features = std::make_shared<TemplateFeatures>();
+    features->imageKey = templateImage.cacheKey();
+    features->size = templateImage.size();
+
+    const QImage templateGray = ImageKernels::toGray(templateImage);
+    cv::Mat image = wrapGray(templateGray);
+    const int minSide = qMin(templateGray.width(), templateGray.height());
+    if (minSide > 0 && minSide < kMinTemplateSide) {
+        features->upscale = double(kMinTemplateSide) / minSide;
+        cv::resize(image, image, cv::Size(), features->upscale, features->upscale, cv::INTER_CUBIC);
+    }
+
+    // 补边后边缘附近也能取到完整的描述子邻域
+    features->padding = kPatchSize;
+    cv::copyMakeBorder(image, image, features->padding, features->padding, features->padding, features->padding,
+                       cv::BORDER_REPLICATE);
+
+    createOrb(kTemplateFeatures)->detectAndCompute(image, cv::noArray(), features->keypoints, features->descriptors);
+
+    QMutexLocker locker(&m_mutex);
+    m_templates.insert(name, std::move(features));
+}
+
+bool FeatureMatcher::hasUsableTemplate(const QString &name) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_templates.constFind(name);
+    return it != m_templates.constEnd() && int(it.value()->keypoints.size()) >= kMinGoodMatches;
+}
+
+FeatureMatcher::Result FeatureMatcher::match(const QImage &sourceGray, const QString &name, const QRect &searchRect) const
+{
+    Result result;
+
+    std::shared_ptr<const TemplateFeatures> features;
+    {
+        QMutexLocker locker(&m_mutex);
+        features = m_templates.value(name);
+    }
+    if (!features || int(features->keypoints.size()) < kMinGoodMatches) {
+        return result;
+    }
+
+    const QRect area = searchRect.isEmpty() ? sourceGray.rect() : searchRect.intersected(sourceGray.rect());
+    if (area.isEmpty()) {
+        return result;
+    }
+    const cv::Mat source = wrapGray(sourceGray)(cv::Rect(area.x(), area.y(), area.width(), area.height()));
+
+    std::vector<cv::KeyPoint> sourceKeypoints;
+    cv::Mat sourceDescriptors;
+    createOrb(kSourceFeatures)->detectAndCompute(source, cv::noArray(), sourceKeypoints, sourceDescriptors);
+    if (int(sourceKeypoints.size()) < kMinGoodMatches) {
+        return result;
+    }
+
+    // 最近邻比值检验
+    std::vector<std::vector<cv::DMatch>> knnMatches;
+    cv::BFMatcher(cv::NORM_HAMMING).knnMatch(features->descriptors, sourceDescriptors, knnMatches, 2);
+    std::vector<cv::Point2f> templatePoints;
+    std::vector<cv::Point2f> sourcePoints;
+    for (const std::vector<cv::DMatch> &pair : knnMatches) {
+        if (pair.size() == 2 && pair[0].distance < kRatioTest * pair[1].distance) {
+            templatePoints.push_back(features->keypoints[pair[0].queryIdx].pt);
+            sourcePoints.push_back(sourceKeypoints[pair[0].trainIdx].pt);
+        }
+    }
+    result.goodMatches = int(templatePoints.size());
+    if (result.goodMatches < kMinGoodMatches) {
+        return result;
+    }
+
+    // RANSAC估计单应矩阵
+    std::vector<uchar> inlierMask;
+    const cv::Mat homography = cv::findHomography(templatePoints, sourcePoints, cv::RANSAC,
+                                                  kRansacReprojThreshold, inlierMask);
+    if (homography.empty()) {
+        return result;
+    }
+    result.inliers = cv::countNonZero(inlierMask);
+    if (result.inliers < kMinInliers || result.inliers < kMinInlierRatio * result.goodMatches) {
+        return result;
+    }
+
+    // 把模板四角（放大、补边后的坐标）投影到源图像
+    const double pad = features->padding;
+    const double width = features->size.width() * features->upscale;
+    const double height = features->size.height() * features->upscale;
+    const std::vector<cv::Point2f> corners = {
+        cv::Point2f(pad, pad), cv::Point2f(pad + width, pad),
+        cv::Point2f(pad + width, pad + height), cv::Point2f(pad, pad + height)
+    };
+    std::vector<cv::Point2f> projected;
+    cv::perspectiveTransform(corners, projected, homography);
+
+    // 形状验证：凸四边形、缩放在范围内、宽高比与模板一致
+    if (!cv::isContourConvex(projected)) {
+        return result;
+    }
+    const double top = cv::norm(projected[1] - projected[0]);
+    const double bottom = cv::norm(projected[2] - projected[3]);
+    const double left = cv::norm(projected[3] - projected[0]);
+    const double right = cv::norm(projected[2] - projected[1]);
+    const double scaleX = (top + bottom) / 2.0 / features->size.width();
+    const double scaleY = (left + right) / 2.0 / features->size.height();
+    const double scale = (scaleX + scaleY) / 2.0;
+    if (scale < kMinScale || scale > kMaxScale ||
+        qAbs(scaleX - scaleY) / scale > kMaxAspectDeviation ||
+        qAbs(top - bottom) / qMax(top, bottom) > kMaxAspectDeviation ||
+        qAbs(left - right) / qMax(left, right) > kMaxAspectDeviation) {
+        return result;
+    }
+
+    const cv::Rect bounds = cv::boundingRect(projected);
+    result.rect = QRect(area.x() + bounds.x, area.y() + bounds.y, bounds.width, bounds.height)
+                      .intersected(sourceGray.rect());
+    result.scale = scale;
+    result.found = !result.rect.isEmpty();
+    return result;
+}
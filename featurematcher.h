@@ -0,0 +1,46 @@
+#ifndef FEATUREMATCHER_H
+#define FEATUREMATCHER_H
+
+#include <QString>
+#include <QImage>
+#include <QRect>
+#include <QMap>
+#include <QMutex>
+#include <memory>
+
+// 基于ORB特征的模板匹配
+// 模板的关键点和描述子在第一次使用时计算并缓存；匹配时只对截图提取一次特征，
+// 经比值检验筛选后用RANSAC估计单应矩阵，内点足够且投影后的四边形形状合理才算找到。
+// 对缩放和深浅色主题变化比灰度相关匹配稳健，作为相关匹配失败后的第二级后备。
+class FeatureMatcher
+{
+public:
+    // 匹配结果
+    struct Result {
+        bool found = false;
+        QRect rect;             // 模板在源图像中的外接矩形
+        int inliers = 0;        // 单应矩阵的内点数
+        int goodMatches = 0;    // 通过比值检验的匹配数
+        double scale = 1.0;     // 相对模板原始尺寸的缩放
+    };
+
+    FeatureMatcher();
+    ~FeatureMatcher();
+
+    // 准备模板特征：同一幅模板图像（按QImage::cacheKey判断）只计算一次，模板替换后重新计算
+    void prepareTemplate(const QString &name, const QImage &templateImage);
+
+    // 是否已缓存该模板，且模板能提取出足够的特征
+    bool hasUsableTemplate(const QString &name) const;
+
+    // 在源图像（灰度）的搜索区域内查找模板，searchRect为空时搜索全图
+    Result match(const QImage &sourceGray, const QString &name, const QRect &searchRect = QRect()) const;
+
+private:
+    struct TemplateFeatures;
+
+    mutable QMutex m_mutex;
+    QMap<QString, std::shared_ptr<const TemplateFeatures>> m_templates;
+};
+
+#endif // FEATUREMATCHER_H
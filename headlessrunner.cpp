@@ -0,0 +1,275 @@
+#include "headlessrunner.h"
+#include "configmanager.h"
+#include "logger.h"
+#include "platform.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFile>
+#include <QTextStream>
+#include <cstring>
+
+HeadlessRunner::HeadlessRunner(QObject *parent)
+    : QObject(parent)
+{
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+    if (m_controlServer) {
+        m_controlServer->stop();
+        delete m_controlServer;
+        m_controlServer = nullptr;
+    }
+    if (m_automator) {
+        m_automator->stop();
+        delete m_automator;
+        m_automator = nullptr;
+    }
+}
+
+bool HeadlessRunner::isHeadlessRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HeadlessRunner::isReplayRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--replay") == 0 || strncmp(argv[i], "--replay=", 9) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int HeadlessRunner::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("WeBot 无界面运行模式");
+    parser.addHelpOption();
+
+    QCommandLineOption headlessOption("headless", "以无界面模式运行");
+    QCommandLineOption questionsOption(QStringList() << "q" << "questions",
+                                       "问题文件（每行一个问题），默认使用配置中的问题库", "file");
+    QCommandLineOption countOption(QStringList() << "n" << "count",
+                                   "循环次数，默认使用配置中的循环次数", "count");
+    QCommandLineOption modeOption(QStringList() << "m" << "mode",
+                                  "问题模式：cycle、random、generate、shuffle（或 0、1、2、3）", "mode");
+    QCommandLineOption replayOption("replay",
+                                    "回放目录：截图从该目录读取，键鼠输入不实际发送", "dir");
+    QCommandLineOption intervalOption("progress-interval",
+                                      "进度打印间隔（秒），默认5秒", "seconds", "5");
+    QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "将运行日志输出到标准错误");
+    parser.addOption(headlessOption);
+    parser.addOption(questionsOption);
+    parser.addOption(countOption);
+    parser.addOption(modeOption);
+    parser.addOption(replayOption);
+    parser.addOption(intervalOption);
+    parser.addOption(verboseOption);
+
+    if (!parser.parse(arguments)) {
+        printError(parser.errorText());
+        printError(parser.helpText());
+        return ExitUsageError;
+    }
+    if (parser.isSet("help")) {
+        printLine(parser.helpText());
+        return ExitSuccess;
+    }
+
+    m_verbose = parser.isSet(verboseOption);
+    bool intervalOk = false;
+    double intervalSeconds = parser.value(intervalOption).toDouble(&intervalOk);
+    if (!intervalOk || intervalSeconds < 0) {
+        printError("无效的进度打印间隔: " + parser.value(intervalOption));
+        return ExitUsageError;
+    }
+    m_progressIntervalMs = static_cast<int>(intervalSeconds * 1000);
+
+    // 初始化日志和配置（与主窗口相同的顺序）
+    Logger::getInstance();
+    ConfigManager *config = ConfigManager::getInstance();
+    connect(config, &ConfigManager::logMessage, this, [this](const QString &message) {
+        if (m_verbose) {
+            printError(message);
+        }
+    });
+    config->initialize();
+    Logger::getInstance()->setLogPath(config->getLogPath());
+
+    // 问题文件
+    if (parser.isSet(questionsOption)) {
+        QStringList questions;
+        if (!loadQuestionFile(parser.value(questionsOption), questions)) {
+            return ExitUsageError;
+        }
+        config->setQuestionList(questions);
+    }
+
+    // 循环次数
+    int count = config->getLoopCount();
+    if (parser.isSet(countOption)) {
+        bool countOk = false;
+        count = parser.value(countOption).toInt(&countOk);
+        if (!countOk) {
+            printError("无效的循环次数: " + parser.value(countOption));
+            return ExitUsageError;
+        }
+    }
+    if (count <= 0) {
+        printError("循环次数必须大于0");
+        return ExitUsageError;
+    }
+
+    // 问题模式
+    int mode = config->getQuestionMode();
+    if (parser.isSet(modeOption) && !parseQuestionMode(parser.value(modeOption), mode)) {
+        printError("无效的问题模式: " + parser.value(modeOption));
+        return ExitUsageError;
+    }
+
+    m_automator = new Automator();
+    connect(m_automator, &Automator::logMessage, this, [this](const QString &message) {
+        LOG_INFO(message);
+        if (m_verbose) {
+            printError(message);
+        }
+    });
+    connect(m_automator, &Automator::errorMessage, this, [this](const QString &message) {
+        printError("错误: " + message);
+    });
+    connect(m_automator, &Automator::progressUpdated, this, &HeadlessRunner::onProgressUpdated);
+    // 排队处理，确保自动化流程完全返回后再退出事件循环
+    connect(m_automator, &Automator::automationCompleted,
+            this, &HeadlessRunner::onAutomationCompleted, Qt::QueuedConnection);
+
+    // 回放模式
+    if (parser.isSet(replayOption)) {
+        int frameCount = m_automator->setReplayMode(parser.value(replayOption));
+        if (frameCount <= 0) {
+            printError("回放目录中没有可用的图像: " + parser.value(replayOption));
+            return ExitUsageError;
+        }
+        printLine(QString("回放模式：%1 帧").arg(frameCount));
+    } else if (!Platform::isSupported()) {
+        printError("当前平台不能操作企业微信窗口，只支持回放模式（--replay）");
+        return ExitUsageError;
+    }
+
+    // 按配置启动本地控制接口，便于运行中追加问题
+    if (config->getControlEnabled()) {
+        m_controlServer = new ControlServer(m_automator);
+        connect(m_controlServer, &ControlServer::logMessage, this, [this](const QString &message) {
+            printLine(message);
+        });
+        m_controlServer->start(config->getControlBindAddress(),
+                               static_cast<quint16>(config->getControlPort()),
+                               config->getControlToken());
+    }
+
+    m_automator->setQuestionMode(static_cast<Automator::QuestionMode>(mode));
+    m_total = count;
+    m_elapsed.start();
+
+    printLine(QString("开始无界面运行，共 %1 次，问题模式 %2").arg(count).arg(mode));
+    if (!m_automator->start(count)) {
+        printError("自动化启动失败");
+        return ExitUsageError;
+    }
+
+    return QCoreApplication::exec();
+}
+
+void HeadlessRunner::onProgressUpdated(int current, int total)
+{
+    m_lastCurrent = current;
+    m_total = total;
+
+    // 按间隔限频打印，最后一个问题总是打印
+    qint64 now = m_elapsed.elapsed();
+    if (m_lastPrintMs >= 0 && now - m_lastPrintMs < m_progressIntervalMs && current < total) {
+        return;
+    }
+    m_lastPrintMs = now;
+
+    double seconds = now / 1000.0;
+    double rate = seconds > 0 ? current * 60.0 / seconds : 0.0;
+    printLine(QString("进度: %1/%2  已用时 %3 秒  速率 %4 个/分钟")
+                  .arg(current).arg(total)
+                  .arg(seconds, 0, 'f', 1)
+                  .arg(rate, 0, 'f', 2));
+}
+
+void HeadlessRunner::onAutomationCompleted()
+{
+    double seconds = m_elapsed.elapsed() / 1000.0;
+    bool failed = m_automator && m_automator->getCurrentState() == Automator::Error;
+
+    printLine(QString("运行%1：%2/%3，用时 %4 秒")
+                  .arg(failed ? "出错" : "完成")
+                  .arg(m_lastCurrent).arg(m_total)
+                  .arg(seconds, 0, 'f', 1));
+
+    QCoreApplication::exit(failed ? ExitRunFailed : ExitSuccess);
+}
+
+bool HeadlessRunner::loadQuestionFile(const QString &path, QStringList &questions)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        printError("无法打开问题文件: " + path);
+        return false;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (!line.isEmpty()) {
+            questions.append(line);
+        }
+    }
+    file.close();
+
+    if (questions.isEmpty()) {
+        printError("问题文件为空: " + path);
+        return false;
+    }
+    printLine(QString("已加载 %1 个问题: %2").arg(questions.size()).arg(path));
+    return true;
+}
+
+bool HeadlessRunner::parseQuestionMode(const QString &text, int &mode)
+{
+    const QString value = text.trimmed().toLower();
+    if (value == "cycle" || value == "0") {
+        mode = QuestionManager::CycleMode;
+    } else if (value == "random" || value == "1") {
+        mode = QuestionManager::RandomMode;
+    } else if (value == "generate" || value == "2") {
+        mode = QuestionManager::GenerateMode;
+    } else if (value == "shuffle" || value == "3") {
+        mode = QuestionManager::ShuffleMode;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void HeadlessRunner::printLine(const QString &line)
+{
+    QTextStream out(stdout);
+    out << line << Qt::endl;
+}
+
+void HeadlessRunner::printError(const QString &line)
+{
+    QTextStream err(stderr);
+    err << line << Qt::endl;
+}
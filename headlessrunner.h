@@ -0,0 +1,66 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include "automator.h"
+#include "controlserver.h"
+
+// 无界面运行器
+// 通过命令行参数启动自动化，不创建任何窗口部件，
+// 定期向标准输出打印进度，结束时返回退出码。
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+public:
+    // 退出码
+    enum ExitCode {
+        ExitSuccess = 0,     // 运行完成
+        ExitRunFailed = 1,   // 运行出错
+        ExitUsageError = 2   // 参数或启动错误
+    };
+
+    explicit HeadlessRunner(QObject *parent = nullptr);
+    ~HeadlessRunner() override;
+
+    // 命令行中是否包含 --headless（在创建QApplication之前调用）
+    static bool isHeadlessRequested(int argc, char *argv[]);
+
+    // 命令行中是否包含 --replay（回放模式可使用offscreen平台）
+    static bool isReplayRequested(int argc, char *argv[]);
+
+    // 解析参数并运行，返回退出码
+    int run(const QStringList &arguments);
+
+private slots:
+    // 进度更新
+    void onProgressUpdated(int current, int total);
+
+    // 运行完成
+    void onAutomationCompleted();
+
+private:
+    // 从文件加载问题列表（每行一个问题）
+    bool loadQuestionFile(const QString &path, QStringList &questions);
+
+    // 解析问题模式（cycle/random/generate/shuffle 或 0/1/2/3）
+    bool parseQuestionMode(const QString &text, int &mode);
+
+    // 输出到标准输出/标准错误
+    void printLine(const QString &line);
+    void printError(const QString &line);
+
+private:
+    Automator *m_automator = nullptr;
+    ControlServer *m_controlServer = nullptr;
+    QElapsedTimer m_elapsed;
+    qint64 m_lastPrintMs = -1;
+    int m_progressIntervalMs = 5000;
+    int m_lastCurrent = 0;
+    int m_total = 0;
+    bool m_verbose = false;
+};
+
+#endif // HEADLESSRUNNER_H
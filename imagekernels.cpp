@@ -0,0 +1,720 @@
+#include "imagekernels.h"
+#include <QStringList>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86)
+#define IMAGEKERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang按函数开启指令集，其余代码仍按基础指令集编译；MSVC不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define KERNEL_TARGET(features) __attribute__((target(features)))
+#else
+#define KERNEL_TARGET(features)
+#endif
+
+namespace {
+
+// NCC按块累加的字节数，块内32位累加器不会溢出
+constexpr int kNccChunk = 2048;
+
+// ---- 标量实现（参考实现，也用于处理各实现剩余的尾部） ----
+
+void bgraToGrayScalar(const uchar *bgra, uchar *gray, int pixels)
+{
+    for (int i = 0; i < pixels; ++i) {
+        const uchar *p = bgra + qint64(i) * 4;
+        gray[i] = uchar((p[2] * 11 + p[1] * 16 + p[0] * 5) >> 5);
+    }
+}
+
+int diffCountScalar(const uchar *a, const uchar *b, int length, int threshold)
+{
+    int count = 0;
+    for (int i = 0; i < length; ++i) {
+        if (std::abs(int(a[i]) - int(b[i])) > threshold) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void integralRowTail(const uchar *row, const quint32 *above, quint32 *current, int x, int width, quint32 sum)
+{
+    for (; x < width; ++x) {
+        sum += row[x];
+        current[x + 1] = above[x + 1] + sum;
+    }
+}
+
+void integralRowScalar(const uchar *row, const quint32 *above, quint32 *current, int width)
+{
+    integralRowTail(row, above, current, 0, width, 0);
+}
+
+quint32 sadRowScalar(const uchar *a, const uchar *b, int length)
+{
+    quint32 sum = 0;
+    for (int i = 0; i < length; ++i) {
+        sum += quint32(std::abs(int(a[i]) - int(b[i])));
+    }
+    return sum;
+}
+
+void nccRowScalar(const uchar *source, const uchar *templ, int length, ImageKernels::NccSums *sums)
+{
+    quint64 sumSource = 0;
+    quint64 sumSourceSq = 0;
+    quint64 sumProduct = 0;
+    for (int i = 0; i < length; ++i) {
+        const quint32 s = source[i];
+        sumSource += s;
+        sumSourceSq += s * s;
+        sumProduct += s * templ[i];
+    }
+    sums->sumSource += sumSource;
+    sums->sumSourceSq += sumSourceSq;
+    sums->sumProduct += sumProduct;
+}
+
+void downsampleRowScalar(const uchar *row0, const uchar *row1, uchar *half, int halfWidth)
+{
+    for (int i = 0; i < halfWidth; ++i) {
+        half[i] = uchar((row0[2 * i] + row0[2 * i + 1] + row1[2 * i] + row1[2 * i + 1] + 2) >> 2);
+    }
+}
+
+#ifdef IMAGEKERNELS_X86
+
+// 向量内核只用寄存器中的临时值，不在栈上保存向量（MinGW下栈上的256位变量可能不对齐）
+
+// ---- SSE4.1 ----
+
+KERNEL_TARGET("sse4.1")
+inline quint64 sumLanes32(__m128i v)
+{
+    return quint64(quint32(_mm_extract_epi32(v, 0))) + quint32(_mm_extract_epi32(v, 1))
+         + quint32(_mm_extract_epi32(v, 2)) + quint32(_mm_extract_epi32(v, 3));
+}
+
+KERNEL_TARGET("sse4.1")
+inline quint64 sumLanes64(__m128i v)
+{
+    quint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), v);
+    return lanes[0] + lanes[1];
+}
+
+KERNEL_TARGET("sse4.1")
+void bgraToGraySse41(const uchar *bgra, uchar *gray, int pixels)
+{
+    // 每像素 b*5 + g*16 + r*11，maddubs得到 (b*5+g*16, r*11) 两项，hadd相加
+    const __m128i weights = _mm_set1_epi32(0x000B1005);
+    int i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i *src = reinterpret_cast<const __m128i *>(bgra + qint64(i) * 4);
+        const __m128i m0 = _mm_maddubs_epi16(_mm_loadu_si128(src), weights);
+        const __m128i m1 = _mm_maddubs_epi16(_mm_loadu_si128(src + 1), weights);
+        const __m128i m2 = _mm_maddubs_epi16(_mm_loadu_si128(src + 2), weights);
+        const __m128i m3 = _mm_maddubs_epi16(_mm_loadu_si128(src + 3), weights);
+        const __m128i g0 = _mm_srli_epi16(_mm_hadd_epi16(m0, m1), 5);
+        const __m128i g1 = _mm_srli_epi16(_mm_hadd_epi16(m2, m3), 5);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(gray + i), _mm_packus_epi16(g0, g1));
+    }
+    bgraToGrayScalar(bgra + qint64(i) * 4, gray + i, pixels - i);
+}
+
+KERNEL_TARGET("sse4.1")
+int diffCountSse41(const uchar *a, const uchar *b, int length, int threshold)
+{
+    // 差值超过阈值的字节置1，用sad按8字节一组求和
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i limit = _mm_set1_epi8(char(threshold));
+    __m128i acc = zero;
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        const __m128i over = _mm_min_epu8(_mm_subs_epu8(diff, limit), one);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(over, zero));
+    }
+    return int(sumLanes64(acc)) + diffCountScalar(a + i, b + i, length - i, threshold);
+}
+
+KERNEL_TARGET("sse4.1")
+void integralRowSse41(const uchar *row, const quint32 *above, quint32 *current, int width)
+{
+    // 4个像素一组求前缀和，carry为之前所有像素的和（4个通道相同）
+    __m128i carry = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        int packed;
+        std::memcpy(&packed, row + x, sizeof(packed));
+        __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, carry);
+        carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i *>(above + x + 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(current + x + 1), _mm_add_epi32(v, up));
+    }
+    integralRowTail(row, above, current, x, width, quint32(_mm_cvtsi128_si32(carry)));
+}
+
+KERNEL_TARGET("sse4.1")
+quint32 sadRowSse41(const uchar *a, const uchar *b, int length)
+{
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    return quint32(sumLanes64(acc)) + sadRowScalar(a + i, b + i, length - i);
+}
+
+KERNEL_TARGET("sse4.1")
+void nccRowSse41(const uchar *source, const uchar *templ, int length, ImageKernels::NccSums *sums)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    while (length - i >= 16) {
+        const int chunkEnd = i + qMin(kNccChunk, (length - i) & ~15);
+        __m128i accSource = zero;
+        __m128i accSourceSq = zero;
+        __m128i accProduct = zero;
+        for (; i < chunkEnd; i += 16) {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(templ + i));
+            const __m128i sLo = _mm_unpacklo_epi8(s, zero);
+            const __m128i sHi = _mm_unpackhi_epi8(s, zero);
+            const __m128i tLo = _mm_unpacklo_epi8(t, zero);
+            const __m128i tHi = _mm_unpackhi_epi8(t, zero);
+            accSource = _mm_add_epi64(accSource, _mm_sad_epu8(s, zero));
+            accSourceSq = _mm_add_epi32(accSourceSq, _mm_add_epi32(_mm_madd_epi16(sLo, sLo), _mm_madd_epi16(sHi, sHi)));
+            accProduct = _mm_add_epi32(accProduct, _mm_add_epi32(_mm_madd_epi16(sLo, tLo), _mm_madd_epi16(sHi, tHi)));
+        }
+        sums->sumSource += sumLanes64(accSource);
+        sums->sumSourceSq += sumLanes32(accSourceSq);
+        sums->sumProduct += sumLanes32(accProduct);
+    }
+    nccRowScalar(source + i, templ + i, length - i, sums);
+}
+
+KERNEL_TARGET("sse4.1")
+void downsampleRowSse41(const uchar *row0, const uchar *row1, uchar *half, int halfWidth)
+{
+    // maddubs与全1相乘得到相邻两像素之和，两行相加后四舍五入除以4
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= halfWidth; i += 16) {
+        const __m128i *a = reinterpret_cast<const __m128i *>(row0 + 2 * i);
+        const __m128i *b = reinterpret_cast<const __m128i *>(row1 + 2 * i);
+        const __m128i lo = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128(a), ones),
+                                         _mm_maddubs_epi16(_mm_loadu_si128(b), ones));
+        const __m128i hi = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128(a + 1), ones),
+                                         _mm_maddubs_epi16(_mm_loadu_si128(b + 1), ones));
+        const __m128i out = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo, two), 2),
+                                             _mm_srli_epi16(_mm_add_epi16(hi, two), 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(half + i), out);
+    }
+    downsampleRowScalar(row0 + 2 * i, row1 + 2 * i, half + i, halfWidth - i);
+}
+
+// ---- AVX2 ----
+
+KERNEL_TARGET("avx2")
+inline quint64 sumLanes64Avx2(__m256i v)
+{
+    return sumLanes64(_mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+
+KERNEL_TARGET("avx2")
+inline quint64 sumLanes32Avx2(__m256i v)
+{
+    return sumLanes32(_mm256_castsi256_si128(v)) + sumLanes32(_mm256_extracti128_si256(v, 1));
+}
+
+KERNEL_TARGET("avx2")
+void bgraToGrayAvx2(const uchar *bgra, uchar *gray, int pixels)
+{
+    // hadd和packus都在128位通道内进行，最后按4像素一组重排
+    const __m256i weights = _mm256_set1_epi32(0x000B1005);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        const __m256i *src = reinterpret_cast<const __m256i *>(bgra + qint64(i) * 4);
+        const __m256i m0 = _mm256_maddubs_epi16(_mm256_loadu_si256(src), weights);
+        const __m256i m1 = _mm256_maddubs_epi16(_mm256_loadu_si256(src + 1), weights);
+        const __m256i m2 = _mm256_maddubs_epi16(_mm256_loadu_si256(src + 2), weights);
+        const __m256i m3 = _mm256_maddubs_epi16(_mm256_loadu_si256(src + 3), weights);
+        const __m256i g0 = _mm256_srli_epi16(_mm256_hadd_epi16(m0, m1), 5);
+        const __m256i g1 = _mm256_srli_epi16(_mm256_hadd_epi16(m2, m3), 5);
+        const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(g0, g1), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(gray + i), packed);
+    }
+    bgraToGraySse41(bgra + qint64(i) * 4, gray + i, pixels - i);
+}
+
+KERNEL_TARGET("avx2")
+int diffCountAvx2(const uchar *a, const uchar *b, int length, int threshold)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i limit = _mm256_set1_epi8(char(threshold));
+    __m256i acc = zero;
+    int i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        const __m256i over = _mm256_min_epu8(_mm256_subs_epu8(diff, limit), one);
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(over, zero));
+    }
+    return int(sumLanes64Avx2(acc)) + diffCountSse41(a + i, b + i, length - i, threshold);
+}
+
+KERNEL_TARGET("avx2")
+void integralRowAvx2(const uchar *row, const quint32 *above, quint32 *current, int width)
+{
+    // 两个128位通道分别求前缀和，再把低通道的总和加到高通道
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i carry = _mm256_setzero_si256();
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + x)));
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+        const __m256i laneTotals = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        v = _mm256_add_epi32(v, _mm256_permute2x128_si256(laneTotals, laneTotals, 0x08));
+        v = _mm256_add_epi32(v, carry);
+        carry = _mm256_permutevar8x32_epi32(v, last);
+        const __m256i up = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(above + x + 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(current + x + 1), _mm256_add_epi32(v, up));
+    }
+    integralRowTail(row, above, current, x, width, quint32(_mm_cvtsi128_si32(_mm256_castsi256_si128(carry))));
+}
+
+KERNEL_TARGET("avx2")
+quint32 sadRowAvx2(const uchar *a, const uchar *b, int length)
+{
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+    }
+    return quint32(sumLanes64Avx2(acc)) + sadRowSse41(a + i, b + i, length - i);
+}
+
+KERNEL_TARGET("avx2")
+void nccRowAvx2(const uchar *source, const uchar *templ, int length, ImageKernels::NccSums *sums)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    while (length - i >= 32) {
+        const int chunkEnd = i + qMin(kNccChunk, (length - i) & ~31);
+        __m256i accSource = zero;
+        __m256i accSourceSq = zero;
+        __m256i accProduct = zero;
+        for (; i < chunkEnd; i += 32) {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+            const __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(templ + i));
+            const __m256i sLo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(s));
+            const __m256i sHi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(s, 1));
+            const __m256i tLo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(t));
+            const __m256i tHi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(t, 1));
+            accSource = _mm256_add_epi64(accSource, _mm256_sad_epu8(s, zero));
+            accSourceSq = _mm256_add_epi32(accSourceSq,
+                                           _mm256_add_epi32(_mm256_madd_epi16(sLo, sLo), _mm256_madd_epi16(sHi, sHi)));
+            accProduct = _mm256_add_epi32(accProduct,
+                                          _mm256_add_epi32(_mm256_madd_epi16(sLo, tLo), _mm256_madd_epi16(sHi, tHi)));
+        }
+        sums->sumSource += sumLanes64Avx2(accSource);
+        sums->sumSourceSq += sumLanes32Avx2(accSourceSq);
+        sums->sumProduct += sumLanes32Avx2(accProduct);
+    }
+    nccRowSse41(source + i, templ + i, length - i, sums);
+}
+
+KERNEL_TARGET("avx2")
+void downsampleRowAvx2(const uchar *row0, const uchar *row1, uchar *half, int halfWidth)
+{
+    // packus在128位通道内交错，最后按64位一组重排
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi16(2);
+    int i = 0;
+    for (; i + 32 <= halfWidth; i += 32) {
+        const __m256i *a = reinterpret_cast<const __m256i *>(row0 + 2 * i);
+        const __m256i *b = reinterpret_cast<const __m256i *>(row1 + 2 * i);
+        const __m256i lo = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(a), ones),
+                                            _mm256_maddubs_epi16(_mm256_loadu_si256(b), ones));
+        const __m256i hi = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256(a + 1), ones),
+                                            _mm256_maddubs_epi16(_mm256_loadu_si256(b + 1), ones));
+        const __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(_mm256_add_epi16(lo, two), 2),
+                                                   _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(half + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    downsampleRowSse41(row0 + 2 * i, row1 + 2 * i, half + i, halfWidth - i);
+}
+
+// ---- AVX-512（需要BW扩展；灰度转换、积分图和降采样没有收益，沿用AVX2实现） ----
+
+KERNEL_TARGET("avx512f,avx512bw")
+inline quint64 sumLanes64Avx512(__m512i v)
+{
+    quint64 lanes[8];
+    _mm512_storeu_si512(lanes, v);
+    quint64 sum = 0;
+    for (quint64 lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+KERNEL_TARGET("avx512f,avx512bw")
+inline quint64 sumLanes32Avx512(__m512i v)
+{
+    quint32 lanes[16];
+    _mm512_storeu_si512(lanes, v);
+    quint64 sum = 0;
+    for (quint32 lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+KERNEL_TARGET("avx512f,avx512bw")
+int diffCountAvx512(const uchar *a, const uchar *b, int length, int threshold)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i limit = _mm512_set1_epi8(char(threshold));
+    __m512i acc = zero;
+    int i = 0;
+    for (; i + 64 <= length; i += 64) {
+        const __m512i va = _mm512_loadu_si512(a + i);
+        const __m512i vb = _mm512_loadu_si512(b + i);
+        const __m512i diff = _mm512_or_si512(_mm512_subs_epu8(va, vb), _mm512_subs_epu8(vb, va));
+        const __m512i over = _mm512_min_epu8(_mm512_subs_epu8(diff, limit), one);
+        acc = _mm512_add_epi64(acc, _mm512_sad_epu8(over, zero));
+    }
+    return int(sumLanes64Avx512(acc)) + diffCountAvx2(a + i, b + i, length - i, threshold);
+}
+
+KERNEL_TARGET("avx512f,avx512bw")
+quint32 sadRowAvx512(const uchar *a, const uchar *b, int length)
+{
+    __m512i acc = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 64 <= length; i += 64) {
+        acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    }
+    return quint32(sumLanes64Avx512(acc)) + sadRowAvx2(a + i, b + i, length - i);
+}
+
+KERNEL_TARGET("avx512f,avx512bw")
+void nccRowAvx512(const uchar *source, const uchar *templ, int length, ImageKernels::NccSums *sums)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    int i = 0;
+    while (length - i >= 64) {
+        const int chunkEnd = i + qMin(kNccChunk, (length - i) & ~63);
+        __m512i accSource = zero;
+        __m512i accSourceSq = zero;
+        __m512i accProduct = zero;
+        for (; i < chunkEnd; i += 64) {
+            const __m512i s = _mm512_loadu_si512(source + i);
+            const __m512i sLo = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i)));
+            const __m512i sHi = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i + 32)));
+            const __m512i tLo = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(templ + i)));
+            const __m512i tHi = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(templ + i + 32)));
+            accSource = _mm512_add_epi64(accSource, _mm512_sad_epu8(s, zero));
+            accSourceSq = _mm512_add_epi32(accSourceSq,
+                                           _mm512_add_epi32(_mm512_madd_epi16(sLo, sLo), _mm512_madd_epi16(sHi, sHi)));
+            accProduct = _mm512_add_epi32(accProduct,
+                                          _mm512_add_epi32(_mm512_madd_epi16(sLo, tLo), _mm512_madd_epi16(sHi, tHi)));
+        }
+        sums->sumSource += sumLanes64Avx512(accSource);
+        sums->sumSourceSq += sumLanes32Avx512(accSourceSq);
+        sums->sumProduct += sumLanes32Avx512(accProduct);
+    }
+    nccRowAvx2(source + i, templ + i, length - i, sums);
+}
+
+#endif // IMAGEKERNELS_X86
+
+// 每个级别的内核实现
+struct KernelTable {
+    ImageKernels::Level levels[ImageKernels::KernelCount];
+    void (*bgraToGray)(const uchar *, uchar *, int);
+    int (*diffCount)(const uchar *, const uchar *, int, int);
+    void (*integralRow)(const uchar *, const quint32 *, quint32 *, int);
+    quint32 (*sadRow)(const uchar *, const uchar *, int);
+    void (*nccRow)(const uchar *, const uchar *, int, ImageKernels::NccSums *);
+    void (*downsampleRow)(const uchar *, const uchar *, uchar *, int);
+};
+
+const KernelTable kTables[] = {
+    {{ImageKernels::Scalar, ImageKernels::Scalar, ImageKernels::Scalar, ImageKernels::Scalar, ImageKernels::Scalar,
+      ImageKernels::Scalar},
+     bgraToGrayScalar, diffCountScalar, integralRowScalar, sadRowScalar, nccRowScalar, downsampleRowScalar},
+#ifdef IMAGEKERNELS_X86
+    {{ImageKernels::Sse41, ImageKernels::Sse41, ImageKernels::Sse41, ImageKernels::Sse41, ImageKernels::Sse41,
+      ImageKernels::Sse41},
+     bgraToGraySse41, diffCountSse41, integralRowSse41, sadRowSse41, nccRowSse41, downsampleRowSse41},
+    {{ImageKernels::Avx2, ImageKernels::Avx2, ImageKernels::Avx2, ImageKernels::Avx2, ImageKernels::Avx2,
+      ImageKernels::Avx2},
+     bgraToGrayAvx2, diffCountAvx2, integralRowAvx2, sadRowAvx2, nccRowAvx2, downsampleRowAvx2},
+    {{ImageKernels::Avx2, ImageKernels::Avx512, ImageKernels::Avx2, ImageKernels::Avx512, ImageKernels::Avx512,
+      ImageKernels::Avx2},
+     bgraToGrayAvx2, diffCountAvx512, integralRowAvx2, sadRowAvx512, nccRowAvx512, downsampleRowAvx2},
+#endif
+};
+
+ImageKernels::Level detectLevel()
+{
+#if defined(IMAGEKERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+    // libgcc同时检查操作系统是否保存了YMM/ZMM寄存器
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return ImageKernels::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return ImageKernels::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return ImageKernels::Sse41;
+    }
+    return ImageKernels::Scalar;
+#elif defined(IMAGEKERNELS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    if (maxLeaf < 1) {
+        return ImageKernels::Scalar;
+    }
+    __cpuid(info, 1);
+    const bool sse41 = info[2] & (1 << 19);
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+    if (!sse41) {
+        return ImageKernels::Scalar;
+    }
+    if (!osxsave || !avx || maxLeaf < 7) {
+        return ImageKernels::Sse41;
+    }
+    // 操作系统需要保存YMM（以及ZMM）寄存器
+    const unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) {
+        return ImageKernels::Sse41;
+    }
+    __cpuidex(info, 7, 0);
+    const bool avx2 = info[1] & (1 << 5);
+    const bool avx512f = info[1] & (1 << 16);
+    const bool avx512bw = info[1] & (1 << 30);
+    if (avx2 && avx512f && avx512bw && (xcr0 & 0xE6) == 0xE6) {
+        return ImageKernels::Avx512;
+    }
+    return avx2 ? ImageKernels::Avx2 : ImageKernels::Sse41;
+#else
+    return ImageKernels::Scalar;
+#endif
+}
+
+// 指定的级别，默认不限制
+std::atomic<int> g_preferredLevel{ImageKernels::Avx512};
+
+const KernelTable &activeTable()
+{
+    return kTables[ImageKernels::activeLevel()];
+}
+
+} // namespace
+
+ImageKernels::Level ImageKernels::supportedLevel()
+{
+    static const Level level = detectLevel();
+    return level;
+}
+
+ImageKernels::Level ImageKernels::activeLevel()
+{
+    return Level(qMin(g_preferredLevel.load(std::memory_order_relaxed), int(supportedLevel())));
+}
+
+void ImageKernels::setPreferredLevel(Level level)
+{
+    g_preferredLevel.store(level, std::memory_order_relaxed);
+}
+
+ImageKernels::Level ImageKernels::kernelLevel(Kernel kernel)
+{
+    return activeTable().levels[kernel];
+}
+
+QString ImageKernels::levelName(Level level)
+{
+    switch (level) {
+    case Sse41:
+        return "sse4.1";
+    case Avx2:
+        return "avx2";
+    case Avx512:
+        return "avx512";
+    case Scalar:
+    default:
+        return "scalar";
+    }
+}
+
+QString ImageKernels::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case BgraToGray:
+        return "bgraToGray";
+    case DiffCount:
+        return "diffCount";
+    case IntegralRow:
+        return "integralRow";
+    case SadRow:
+        return "sadRow";
+    case NccRow:
+        return "nccRow";
+    case DownsampleRow:
+        return "downsampleRow";
+    default:
+        return QString();
+    }
+}
+
+bool ImageKernels::parseLevel(const QString &text, Level *level)
+{
+    const QString name = text.trimmed().toLower();
+    if (name.isEmpty() || name == "auto") {
+        *level = supportedLevel();
+        return true;
+    }
+    for (int i = Scalar; i <= Avx512; ++i) {
+        if (name == levelName(Level(i))) {
+            *level = Level(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+QString ImageKernels::describe()
+{
+    QStringList kernels;
+    for (int i = 0; i < KernelCount; ++i) {
+        kernels << QString("%1=%2").arg(kernelName(Kernel(i)), levelName(kernelLevel(Kernel(i))));
+    }
+    return QString("%1（CPU支持 %2）: %3")
+        .arg(levelName(activeLevel()), levelName(supportedLevel()), kernels.join(", "));
+}
+
+void ImageKernels::bgraToGray(const uchar *bgra, uchar *gray, int pixels)
+{
+    if (pixels > 0) {
+        activeTable().bgraToGray(bgra, gray, pixels);
+    }
+}
+
+int ImageKernels::diffCount(const uchar *a, const uchar *b, int length, int threshold)
+{
+    if (length <= 0 || threshold >= 255) {
+        return 0;
+    }
+    if (threshold < 0) {
+        return length;
+    }
+    return activeTable().diffCount(a, b, length, threshold);
+}
+
+void ImageKernels::integralRow(const uchar *row, const quint32 *above, quint32 *current, int width)
+{
+    if (width > 0) {
+        activeTable().integralRow(row, above, current, width);
+    }
+}
+
+quint32 ImageKernels::sadRow(const uchar *a, const uchar *b, int length)
+{
+    return length > 0 ? activeTable().sadRow(a, b, length) : 0;
+}
+
+void ImageKernels::nccRow(const uchar *source, const uchar *templ, int length, NccSums *sums)
+{
+    if (length > 0) {
+        activeTable().nccRow(source, templ, length, sums);
+    }
+}
+
+void ImageKernels::downsampleRow(const uchar *row0, const uchar *row1, uchar *half, int halfWidth)
+{
+    if (halfWidth > 0) {
+        activeTable().downsampleRow(row0, row1, half, halfWidth);
+    }
+}
+
+QImage ImageKernels::toGray(const QImage &image)
+{
+    if (image.isNull() || image.format() == QImage::Format_Grayscale8) {
+        return image;
+    }
+    QImage gray;
+    toGray(image, &gray, nullptr);
+    return gray;
+}
+
+void ImageKernels::toGray(const QImage &image, QImage *gray, QImage *halfGray)
+{
+    const QSize size = image.size();
+    const QSize halfSize(size.width() / 2, size.height() / 2);
+    const bool isGray = image.format() == QImage::Format_Grayscale8;
+    const QImage bgra = (isGray || image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32)
+        ? image : image.convertToFormat(QImage::Format_RGB32);
+
+    // 输出缓冲尺寸不对或仍被其他地方引用时重新分配，避免写入时隐式复制
+    auto prepare = [](QImage *buffer, const QSize &bufferSize) {
+        if (buffer->size() != bufferSize || buffer->format() != QImage::Format_Grayscale8 || !buffer->isDetached()) {
+            *buffer = QImage(bufferSize, QImage::Format_Grayscale8);
+        }
+    };
+    prepare(gray, size);
+    gray->setDevicePixelRatio(image.devicePixelRatio());
+    const bool withHalf = halfGray && !halfSize.isEmpty();
+    if (halfGray) {
+        if (withHalf) {
+            prepare(halfGray, halfSize);
+        } else {
+            *halfGray = QImage();
+        }
+    }
+
+    // 逐行转换，每凑齐两行立即降采样，两行灰度还在缓存中
+    const KernelTable &table = activeTable();
+    for (int y = 0; y < size.height(); ++y) {
+        uchar *grayLine = gray->scanLine(y);
+        if (isGray) {
+            std::memcpy(grayLine, bgra.constScanLine(y), size_t(size.width()));
+        } else {
+            table.bgraToGray(bgra.constScanLine(y), grayLine, size.width());
+        }
+        if (withHalf && (y & 1) && y / 2 < halfSize.height()) {
+            table.downsampleRow(gray->constScanLine(y - 1), grayLine, halfGray->scanLine(y / 2), halfSize.width());
+        }
+    }
+}
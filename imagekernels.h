@@ -0,0 +1,77 @@
+#ifndef IMAGEKERNELS_H
+#define IMAGEKERNELS_H
+
+#include <QString>
+#include <QImage>
+#include <QtGlobal>
+
+// 图像基础内核及运行时指令集分发
+// 程序不能整体用 -mavx2 编译（部分机器CPU较旧），各内核按指令集分别实现，
+// 启动时检测一次CPU支持的最高级别，调用时转到对应的实现；某级别没有专门实现的内核使用下一级的实现。
+// 所有实现与标量版本逐位一致，tests/imagekernels 交叉验证各级别并比较耗时。
+class ImageKernels
+{
+public:
+    // 指令集级别
+    enum Level {
+        Scalar = 0,
+        Sse41,
+        Avx2,
+        Avx512
+    };
+
+    // 内核
+    enum Kernel {
+        BgraToGray = 0,
+        DiffCount,
+        IntegralRow,
+        SadRow,
+        NccRow,
+        DownsampleRow,
+        KernelCount
+    };
+
+    // 一行NCC所需的累加和
+    struct NccSums {
+        quint64 sumSource = 0;      // Σs
+        quint64 sumSourceSq = 0;    // Σs²
+        quint64 sumProduct = 0;     // Σs·t
+    };
+
+    // CPU（及操作系统）支持的最高级别
+    static Level supportedLevel();
+    // 当前使用的级别
+    static Level activeLevel();
+    // 指定使用的级别（用于基准测试），超过支持级别时使用支持级别
+    static void setPreferredLevel(Level level);
+    // 某内核在当前级别下实际使用的实现
+    static Level kernelLevel(Kernel kernel);
+
+    static QString levelName(Level level);
+    static QString kernelName(Kernel kernel);
+    // 解析级别名称（auto、scalar、sse4.1、avx2、avx512），auto 解析为支持的最高级别
+    static bool parseLevel(const QString &text, Level *level);
+    // 各内核当前使用的实现，用于日志
+    static QString describe();
+
+    // BGRA（QImage::Format_RGB32/ARGB32 的内存布局）转灰度，与 qGray 相同：(r*11 + g*16 + b*5) / 32
+    static void bgraToGray(const uchar *bgra, uchar *gray, int pixels);
+    // 统计两行中差值绝对值大于 threshold 的字节数
+    static int diffCount(const uchar *a, const uchar *b, int length, int threshold);
+    // 积分图的一行：current[x+1] = above[x+1] + row[0..x] 之和（按模2^32），current[0] 由调用方置0
+    static void integralRow(const uchar *row, const quint32 *above, quint32 *current, int width);
+    // 两行的绝对差之和
+    static quint32 sadRow(const uchar *a, const uchar *b, int length);
+    // 累加一行的NCC和
+    static void nccRow(const uchar *source, const uchar *templ, int length, NccSums *sums);
+    // 两行灰度按2x2取平均（四舍五入）得到半分辨率的一行，half 长度为 halfWidth
+    static void downsampleRow(const uchar *row0, const uchar *row1, uchar *half, int halfWidth);
+
+    // 转为8位灰度图像（已是灰度时直接返回）
+    static QImage toGray(const QImage &image);
+    // 一次遍历同时得到灰度图和半分辨率灰度图（halfGray 可为空）。
+    // 输出图像尺寸合适且没有被其他地方引用时直接覆盖，可以在多次调用之间复用缓冲
+    static void toGray(const QImage &image, QImage *gray, QImage *halfGray);
+};
+
+#endif // IMAGEKERNELS_H
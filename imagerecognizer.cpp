@@ -10,6 +10,14 @@
 #include <QDateTime>
 #include <QDir>
 #include <QMutexLocker>
+#include <algorithm>
+#include "tracer.h"
+#include "metrics.h"
+#include "matchdiagnostics.h"
+#include "exactmatcher.h"
+#include "peakextractor.h"
+#include "tiledmatcher.h"
+#include "imagekernels.h"
 
 // OpenCV相关头文件
 #include <opencv2/core.hpp>
@@ -24,6 +32,160 @@ using namespace std;
 
 // MatchResult结构体定义（已删除）
 
+namespace {
+
+// 每次查找最多返回的匹配点数量
+constexpr int kMaxMatches = 2;
+
+// 8位灰度图像的Mat视图（不复制，图像须在Mat使用期间保持有效）
+Mat grayMatView(const QImage &gray)
+{
+    return Mat(gray.height(), gray.width(), CV_8UC1, const_cast<uchar *>(gray.constBits()),
+               size_t(gray.bytesPerLine()));
+}
+
+// 金字塔匹配：半分辨率模板的最小边长（更小时粗匹配得分不可靠，直接整图匹配）、
+// 粗匹配的候选点数、候选得分相对阈值的放宽量、全分辨率精修的半径
+constexpr int kMinCoarseTemplate = 12;
+constexpr int kCoarseCandidates = 8;
+constexpr float kCoarseMargin = 0.15f;
+constexpr int kRefineRadius = 3;
+
+// 先在半分辨率搜索区域上匹配，只在候选点附近的全分辨率窗口内重新匹配。
+// 得分图与整图匹配的大小相同，窗口外填-1（低于任何阈值），峰值提取和诊断照常进行。
+// halfOffset 为半分辨率区域原点放大两倍后相对全分辨率搜索区域原点的偏移（0或-1）。
+// 模板太小时返回false，由调用方整图匹配
+bool coarseToFineMatch(const Mat &searchMat, const Mat &halfSearch, const QPoint &halfOffset, const Mat &templ,
+                       const RecognitionProfile &profile, float threshold, int suppressionRadius, Mat &result)
+{
+    Mat halfTemplate;
+    cv::resize(templ, halfTemplate, cv::Size(templ.cols / 2, templ.rows / 2), 0, 0, INTER_AREA);
+    if (halfTemplate.cols < kMinCoarseTemplate || halfTemplate.rows < kMinCoarseTemplate ||
+        halfTemplate.cols > halfSearch.cols || halfTemplate.rows > halfSearch.rows) {
+        return false;
+    }
+
+    Mat coarse;
+    TiledMatcher::match(halfSearch, halfTemplate, coarse, profile.cvMethod());
+    profile.normalizeScores(coarse);
+    const QVector<PeakExtractor::Peak> candidates = PeakExtractor::extract(
+        coarse.ptr<float>(0), int(coarse.step1()), coarse.cols, coarse.rows,
+        threshold - kCoarseMargin, qMax(1, suppressionRadius / 2), kCoarseCandidates);
+
+    result.create(searchMat.rows - templ.rows + 1, searchMat.cols - templ.cols + 1, CV_32F);
+    result.setTo(cv::Scalar::all(-1.0));
+    for (const PeakExtractor::Peak &candidate : candidates) {
+        const int x = candidate.point.x() * 2 + halfOffset.x();
+        const int y = candidate.point.y() * 2 + halfOffset.y();
+        const int left = qMax(0, x - kRefineRadius);
+        const int top = qMax(0, y - kRefineRadius);
+        const int right = qMin(result.cols - 1, x + kRefineRadius + 1);
+        const int bottom = qMin(result.rows - 1, y + kRefineRadius + 1);
+        if (left > right || top > bottom) {
+            continue;
+        }
+        const cv::Rect window(left, top, right - left + 1, bottom - top + 1);
+        Mat refined;
+        matchTemplate(searchMat(cv::Rect(left, top, window.width + templ.cols - 1, window.height + templ.rows - 1)),
+                      templ, refined, profile.cvMethod());
+        profile.normalizeScores(refined);
+        refined.copyTo(result(window));
+    }
+    return true;
+}
+
+// 记录一次匹配的诊断信息：得分图按块取最大值降采样（保留峰值），
+// 候选点为不受阈值限制的前k个峰值，便于观察次优候选离阈值有多近
+void recordMatchDiagnostics(const Mat &result, const QString &templateName, const QSize &sourceSize,
+                            const QSize &templateSize, double threshold, int acceptedCount)
+{
+    MatchDiagnostics::Record record;
+    record.templateName = templateName;
+    record.time = QDateTime::currentDateTime();
+    record.sourceSize = sourceSize;
+    record.templateSize = templateSize;
+    record.resultSize = QSize(result.cols, result.rows);
+    record.threshold = threshold;
+    record.acceptedCount = acceptedCount;
+
+    const int maxSide = MatchDiagnostics::maxHeatmapSide();
+    const int cell = qMax(1, (qMax(result.cols, result.rows) + maxSide - 1) / maxSide);
+    const int heatWidth = (result.cols + cell - 1) / cell;
+    const int heatHeight = (result.rows + cell - 1) / cell;
+    record.cellSize = cell;
+    record.heatmapSize = QSize(heatWidth, heatHeight);
+    record.heatmap.fill(-1.0f, heatWidth * heatHeight);
+    for (int y = 0; y < result.rows; ++y) {
+        const float *row = result.ptr<float>(y);
+        float *heatRow = record.heatmap.data() + (y / cell) * heatWidth;
+        for (int x = 0; x < result.cols; ++x) {
+            float &cellMax = heatRow[x / cell];
+            if (row[x] > cellMax) {
+                cellMax = row[x];
+            }
+        }
+    }
+
+    const int radius = qMax(1, qMax(templateSize.width(), templateSize.height()) / 2);
+    const QVector<PeakExtractor::Peak> peaks = PeakExtractor::extract(
+        result.ptr<float>(0), int(result.step1()), result.cols, result.rows, -2.0f, radius, MatchDiagnostics::topK());
+    for (const PeakExtractor::Peak &peak : peaks) {
+        record.candidates.append({peak.point, peak.score});
+    }
+
+    MatchDiagnostics::record(std::move(record));
+}
+
+// 感知哈希的网格：9列8行块均值，相邻两列比较得到 8x8=64 位
+constexpr int kHashColumns = 9;
+constexpr int kHashRows = 8;
+// 图块平均灰度允许的变化（截图噪声），超过视为图块已变（如按钮变灰）
+constexpr int kMaxMeanShift = 2;
+
+// 计算灰度图中一个区域的感知哈希（dHash）和平均灰度，区域超出图像或小于网格时返回false
+bool computePatchHash(const QImage &gray, const QRect &rect, quint64 *dHash, int *mean)
+{
+    if (!gray.rect().contains(rect) || rect.width() < kHashColumns || rect.height() < kHashRows) {
+        return false;
+    }
+    int left[kHashColumns + 1];
+    for (int c = 0; c <= kHashColumns; ++c) {
+        left[c] = rect.left() + rect.width() * c / kHashColumns;
+    }
+    quint64 total = 0;
+    quint64 bits = 0;
+    int bit = 0;
+    for (int r = 0; r < kHashRows; ++r) {
+        const int top = rect.top() + rect.height() * r / kHashRows;
+        const int bottom = rect.top() + rect.height() * (r + 1) / kHashRows;
+        quint64 cells[kHashColumns] = {};
+        for (int y = top; y < bottom; ++y) {
+            const uchar *row = gray.constScanLine(y);
+            for (int c = 0; c < kHashColumns; ++c) {
+                quint32 sum = 0;
+                for (int x = left[c]; x < left[c + 1]; ++x) {
+                    sum += row[x];
+                }
+                cells[c] += sum;
+            }
+        }
+        // 各列块宽度可能不同，交叉乘以对方的宽度来比较均值
+        for (int c = 0; c < kHashColumns; ++c) {
+            total += cells[c];
+        }
+        for (int c = 0; c + 1 < kHashColumns; ++c, ++bit) {
+            if (cells[c] * quint64(left[c + 2] - left[c + 1]) > cells[c + 1] * quint64(left[c + 1] - left[c])) {
+                bits |= quint64(1) << bit;
+            }
+        }
+    }
+    *dHash = bits;
+    *mean = int(total / (quint64(rect.width()) * rect.height()));
+    return true;
+}
+
+} // namespace
+
 // QImage转Mat的辅助函数
 cv::Mat ImageRecognizer::QImageToMat(const QImage &image) {
     Mat mat;
@@ -52,8 +214,8 @@ ImageRecognizer::ImageRecognizer(QObject *parent) : QObject(parent) {
     m_stopRequested = false;
 
     // 连接配置变更信号
-    connect(ConfigManager::getInstance(), &ConfigManager::configChanged,
-            this, &ImageRecognizer::onConfigChanged);
+    connect(ConfigManager::getInstance(), &ConfigManager::configKeysChanged,
+            this, &ImageRecognizer::onConfigKeysChanged);
     
     // 创建工作线程
     workerThread = new QThread(this);
@@ -153,7 +315,8 @@ QRect ImageRecognizer::findImageOnScreen(const QString &templatePath, int screen
     return QRect();
 }
 
-bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
+bool ImageRecognizer::checkAnswerReceived(WindowHandle hwnd) {
+    TRACE_SCOPE("recognition", "checkAnswerReceived");
     // 检查回答是否完成的核心逻辑
     // 基于图像比对技术，检测回答区域是否稳定
 
@@ -177,9 +340,9 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
     }
     
     // 检查窗口大小变化
-    RECT clientRect;
-    if (GetClientRect(hwnd, &clientRect)) {
-        int currentWidth = clientRect.right - clientRect.left;
+    const QSize clientSize = Platform::clientSize(hwnd);
+    if (clientSize.isValid()) {
+        int currentWidth = clientSize.width();
         // 如果窗口宽度变化，重置状态
         if (currentWidth != m_clientWidths[hwnd]) {
             m_clientWidths[hwnd] = currentWidth;
@@ -210,8 +373,9 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
                 emit logMessage(QString("输入框位置: (%1, %2)").arg(inputBoxPos.x()).arg(inputBoxPos.y()));
                 
                 // 更新窗口宽度
-                if (GetClientRect(hwnd, &clientRect)) {
-                    m_clientWidths[hwnd] = clientRect.right - clientRect.left;
+                const QSize foundClientSize = Platform::clientSize(hwnd);
+                if (foundClientSize.isValid()) {
+                    m_clientWidths[hwnd] = foundClientSize.width();
                 } else {
                     m_clientWidths[hwnd] = 0;
                     emit logMessage("无法获取窗口尺寸");
@@ -240,8 +404,9 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
         return false;
     }
     
-    // 3. 截图回答区域
-    QImage windowImage = captureWindow(hwnd);
+    // 3. 截图回答区域（截图时直接生成半分辨率灰度图）
+    QImage halfGray;
+    QImage windowImage = captureWindowGray(hwnd, &halfGray);
     if (windowImage.isNull()) {
         emit logMessage("窗口截图失败");
         m_failedAttempts[hwnd]++;
@@ -255,7 +420,8 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
         return false;
     }
     
-    QImage answerArea = windowImage.copy(answerAreaX, answerAreaY, answerAreaWidth, answerAreaHeight);
+    // 只比较半分辨率灰度：2x2平均滤掉单像素噪声，数据量为原图的1/4
+    QImage answerArea = halfGray.copy(answerAreaX / 2, answerAreaY / 2, answerAreaWidth / 2, answerAreaHeight / 2);
     
     // 4. 比较前后帧差异
     
@@ -279,42 +445,29 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
         return false;
     }
 
-    // 计算前后帧差异
+    // 计算前后帧差异：逐行比较，灰度差超过10的像素计数
+    const QImage &previousArea = m_previousAnswerAreas[hwnd];
     int diffCount = 0;
     int totalPixels = answerArea.width() * answerArea.height();
-    double diffThreshold = 0.01; // 允许1%的像素差异作为稳定判断标准
+    double diffThreshold = 0.16; // 允许16%的像素差异作为稳定判断标准
+    int pixelScale = 4; // 半分辨率的每个像素对应原图4个像素（日志按原图像素数显示）
     int pixelThreshold = static_cast<int>(totalPixels * diffThreshold);
-
-    // 采样比较，每4个像素采样一次，提高效率
-    int sampleStep = 4; // 采样步长，减少计算量
-    for (int y = 0; y < answerArea.height(); y += sampleStep) {
-        for (int x = 0; x < answerArea.width(); x += sampleStep) {
-            QRgb prevPixel = m_previousAnswerAreas[hwnd].pixel(x, y);
-            QRgb currPixel = answerArea.pixel(x, y);
-
-            // 计算RGB三个通道的差异
-            int rDiff = qAbs(qRed(prevPixel) - qRed(currPixel));
-            int gDiff = qAbs(qGreen(prevPixel) - qGreen(currPixel));
-            int bDiff = qAbs(qBlue(prevPixel) - qBlue(currPixel));
-            
-            // 如果任一通道差异超过阈值，计数加1
-            if (rDiff > 10 || gDiff > 10 || bDiff > 10) { // RGB通道差异阈值
-                diffCount++;
-                if (diffCount > pixelThreshold) {
-                    emit logMessage(QString("回答区域变化: %1 像素 (阈值: %2)").arg(diffCount * sampleStep * sampleStep).arg(pixelThreshold * sampleStep * sampleStep));
-                    m_previousAnswerAreas[hwnd] = answerArea;
-                    m_stableFrameCounts[hwnd] = 0;
-                    m_hasDetectedChanges[hwnd] = true;
-                    return false; // 变化较大，回答未完成
-                }
-            }
+    for (int y = 0; y < answerArea.height(); ++y) {
+        diffCount += ImageKernels::diffCount(previousArea.constScanLine(y), answerArea.constScanLine(y),
+                                             answerArea.width(), 10);
+        if (diffCount > pixelThreshold) {
+            emit logMessage(QString("回答区域变化: %1 像素 (阈值: %2)").arg(diffCount * pixelScale).arg(pixelThreshold * pixelScale));
+            m_previousAnswerAreas[hwnd] = answerArea;
+            m_stableFrameCounts[hwnd] = 0;
+            m_hasDetectedChanges[hwnd] = true;
+            return false; // 变化较大，回答未完成
         }
     }
 
     // 如果之前检测到变化，现在变化稳定，计数加1
     if (m_hasDetectedChanges[hwnd] && diffCount <= pixelThreshold) {
         m_stableFrameCounts[hwnd]++;
-        emit logMessage(QString("稳定帧数: %1 差异像素: %2 阈值: %3").arg(m_stableFrameCounts[hwnd]).arg(diffCount * sampleStep * sampleStep).arg(pixelThreshold * sampleStep * sampleStep));
+        emit logMessage(QString("稳定帧数: %1 差异像素: %2 阈值: %3").arg(m_stableFrameCounts[hwnd]).arg(diffCount * pixelScale).arg(pixelThreshold * pixelScale));
         
         // 连续2帧稳定，认为回答完成
         if (m_stableFrameCounts[hwnd] >= 2) {
@@ -325,7 +478,7 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
             return true; // 回答完成
         }
     } else {
-        emit logMessage(QString("回答区域稳定，无明显变化: %1 像素 (阈值: %2)").arg(diffCount * sampleStep * sampleStep).arg(pixelThreshold * sampleStep * sampleStep));
+        emit logMessage(QString("回答区域稳定，无明显变化: %1 像素 (阈值: %2)").arg(diffCount * pixelScale).arg(pixelThreshold * pixelScale));
         m_stableFrameCounts[hwnd] = 0; // 重置稳定计数
     }
 
@@ -334,7 +487,7 @@ bool ImageRecognizer::checkAnswerReceived(HWND hwnd) {
 }
 
 QImage ImageRecognizer::captureScreen(int screenIndex) {
-    // 使用Windows API捕获指定屏幕
+    // 捕获指定屏幕
     QList<QScreen*> screens = QGuiApplication::screens();
     if (screenIndex < 0 || screenIndex >= screens.size()) {
         emit logMessage(QString("无效的屏幕索引: %1，使用默认屏幕").arg(screenIndex));
@@ -349,7 +502,15 @@ QImage ImageRecognizer::captureScreen(int screenIndex) {
 }
 
 QImage ImageRecognizer::captureScreenArea(const QRect &area, int screenIndex) {
-    // 使用Windows API捕获指定屏幕区域
+    TRACE_SCOPE("capture", "captureScreenArea");
+    // 回放模式：从回放帧中裁剪对应区域
+    if (isReplayMode()) {
+        QImage frame = nextReplayFrame();
+        QRect clipped = area.intersected(frame.rect());
+        return clipped.isEmpty() ? frame : frame.copy(clipped);
+    }
+
+    // 通过平台层截取指定屏幕区域
     if (area.isEmpty()) {
         emit logMessage("捕获区域为空");
         return QImage();
@@ -377,74 +538,89 @@ QImage ImageRecognizer::captureScreenArea(const QRect &area, int screenIndex) {
         }
     }
     
-    // 获取屏幕DC
-    HDC hScreenDC = GetDC(NULL);
-    if (!hScreenDC) {
-        emit logMessage("获取屏幕DC失败");
+    // 复制到复用的DIB位图，再拷贝为QImage
+    QMutexLocker locker(&m_captureMutex);
+    const uchar *bits = grabScreenArea(area);
+    if (!bits) {
         return QImage();
     }
+    QImage image(area.width(), area.height(), QImage::Format_ARGB32);
+    const int lineBytes = area.width() * 4;
+    for (int y = 0; y < area.height(); ++y) {
+        memcpy(image.scanLine(y), bits + qint64(y) * lineBytes, size_t(lineBytes));
+    }
 
-    // 创建兼容DC
-    HDC hMemDC = CreateCompatibleDC(hScreenDC);
-    if (!hMemDC) {
-        emit logMessage("创建兼容DC失败");
-        ReleaseDC(NULL, hScreenDC);
-        return QImage();
+    emit logMessage(QString("成功捕获区域: %1x%2 屏幕: %3").arg(area.width()).arg(area.height()).arg(screenIndex));
+    return image;
+}
+
+QImage ImageRecognizer::captureScreenAreaGray(const QRect &area, QImage *halfGray) {
+    TRACE_SCOPE("capture", "captureScreenAreaGray");
+    // 回放模式：裁剪后转换
+    if (isReplayMode()) {
+        QImage gray;
+        ImageKernels::toGray(captureScreenArea(area), &gray, halfGray);
+        return gray;
     }
 
-    // 创建兼容位图
-    HBITMAP hBitmap = CreateCompatibleBitmap(hScreenDC, area.width(), area.height());
-    if (!hBitmap) {
-        emit logMessage("创建兼容位图失败");
-        DeleteDC(hMemDC);
-        ReleaseDC(NULL, hScreenDC);
+    if (area.isEmpty()) {
+        emit logMessage("捕获区域为空");
         return QImage();
     }
 
-    // 将位图选入DC
-    HBITMAP hOldBitmap = (HBITMAP)SelectObject(hMemDC, hBitmap);
-
-    // 复制屏幕内容到内存DC
-    BOOL result = BitBlt(hMemDC, 0, 0, area.width(), area.height(), 
-                        hScreenDC, area.x(), area.y(), SRCCOPY);
-    if (!result) {
-        emit logMessage("复制屏幕内容失败");
-        SelectObject(hMemDC, hOldBitmap);
-        DeleteObject(hBitmap);
-        DeleteDC(hMemDC);
-        ReleaseDC(NULL, hScreenDC);
+    QMutexLocker locker(&m_captureMutex);
+    const uchar *bits = grabScreenArea(area);
+    if (!bits) {
         return QImage();
     }
 
-    // 准备位图信息
-    BITMAPINFO bmpInfo;
-    memset(&bmpInfo, 0, sizeof(BITMAPINFO));
-    bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmpInfo.bmiHeader.biWidth = area.width();
-    bmpInfo.bmiHeader.biHeight = -area.height(); // 负高度表示自上而下的位图
-    bmpInfo.bmiHeader.biPlanes = 1;
-    bmpInfo.bmiHeader.biBitCount = 32;
-    bmpInfo.bmiHeader.biCompression = BI_RGB;
-
-    // 转换为QImage
-    QImage image(area.width(), area.height(), QImage::Format_ARGB32);
-    GetDIBits(hMemDC, hBitmap, 0, area.height(), image.bits(), &bmpInfo, DIB_RGB_COLORS);
-
-    // 清理资源
-    SelectObject(hMemDC, hOldBitmap);
-    DeleteObject(hBitmap);
-    DeleteDC(hMemDC);
-    ReleaseDC(NULL, hScreenDC);
+    // 直接从DIB内存转为灰度（同一遍生成半分辨率图），写入复用的缓冲；
+    // 上一次返回的图像仍被调用方持有时会分配新缓冲，不会覆盖
+    const QImage bgra(bits, area.width(), area.height(), area.width() * 4, QImage::Format_ARGB32);
+    ImageKernels::toGray(bgra, &m_grayBuffer, halfGray ? &m_halfGrayBuffer : nullptr);
+    if (halfGray) {
+        *halfGray = m_halfGrayBuffer;
+    }
+    return m_grayBuffer;
+}
 
-    emit logMessage(QString("成功捕获区域: %1x%2 屏幕: %3").arg(area.width()).arg(area.height()).arg(screenIndex));
-    return image;
+const uchar *ImageRecognizer::grabScreenArea(const QRect &area) {
+    QString errorString;
+    const uchar *bits = m_screenGrabber.grab(area, &errorString);
+    if (!bits) {
+        emit logMessage(errorString);
+    }
+    return bits;
 }
 
 void ImageRecognizer::setRecognitionThreshold(double threshold) {
     this->threshold = threshold;
 }
 
-QVector<QPoint> ImageRecognizer::findTemplate(const QImage &sourceImage, const QString &templateName) {
+QImage ImageRecognizer::lookupTemplate(const QString &name) const {
+    QMutexLocker locker(&m_templatesMutex);
+    return templates.value(name);
+}
+
+void ImageRecognizer::storeTemplate(const QString &name, const QImage &image) {
+    QMutexLocker locker(&m_templatesMutex);
+    templates[name] = image;
+}
+
+void ImageRecognizer::clearHitCache(const QString &name) {
+    QMutexLocker locker(&m_hitCacheMutex);
+    ++m_hitCacheGeneration;
+    if (name.isEmpty()) {
+        m_hitCache.clear();
+    } else {
+        m_hitCache.remove(name);
+    }
+}
+
+QVector<QPoint> ImageRecognizer::findTemplate(const QImage &sourceImage, const QString &templateName, bool featureFallback,
+                                              const QImage &halfGray) {
+    TRACE_SCOPE_DETAIL("recognition", "findTemplate", templateName);
+    MetricsStageTimer metricsTimer(Metrics::StageRecognition);
     QVector<QPoint> matches;
     
     // 检查是否请求停止
@@ -454,12 +630,13 @@ QVector<QPoint> ImageRecognizer::findTemplate(const QImage &sourceImage, const Q
     }
     
     // 检查模板是否已加载
-    if (!templates.contains(templateName)) {
+    QImage templateImage = lookupTemplate(templateName);
+    if (templateImage.isNull()) {
         emit logMessage("模板未加载: " + templateName);
         return matches;
     }
 
-    QImage templateImage = templates[templateName];
+    // 灰度截图（captureWindowGray）直接使用，不再转换
     QImage sourceGray = toGrayscale(sourceImage);
     QImage templateGray = toGrayscale(templateImage);
     
@@ -469,18 +646,70 @@ QVector<QPoint> ImageRecognizer::findTemplate(const QImage &sourceImage, const Q
         return matches;
     }
     
-    // 转换为OpenCV Mat
-    Mat sourceMat = QImageToMat(sourceGray);
-    Mat templateMat = QImageToMat(templateGray);
+    // 当前模板的识别参数（方法、阈值、搜索区域、缩放、预处理），从配置快照无锁读取
+    ConfigManager* config = ConfigManager::getInstance();
+    std::shared_ptr<const ConfigSnapshot> snapshot = config->snapshot();
+    
+    // 上次找到的位置图块未变时直接沿用结果，预处理和模板匹配都跳过
+    quint64 hitCacheGeneration = 0;
+    if (snapshot->recognitionHitCache) {
+        CachedHit cached;
+        bool unchanged;
+        {
+            QMutexLocker locker(&m_hitCacheMutex);
+            hitCacheGeneration = m_hitCacheGeneration;
+            auto it = m_hitCache.constFind(templateName);
+            unchanged = it != m_hitCache.constEnd() && it->sourceSize == sourceGray.size();
+            if (unchanged) {
+                cached = *it;
+            }
+        }
+        for (int i = 0; unchanged && i < cached.matches.size(); ++i) {
+            PatchHash hash;
+            unchanged = computePatchHash(sourceGray, QRect(cached.matches[i], cached.matchedSize),
+                                         &hash.dHash, &hash.mean) &&
+                        hash.dHash == cached.hashes[i].dHash &&
+                        qAbs(hash.mean - cached.hashes[i].mean) <= kMaxMeanShift;
+        }
+        if (unchanged) {
+            Metrics::increment(Metrics::RecognitionCacheHits);
+            emit logMessage(QString("findTemplate完成: %1 图块未变，沿用上次的 %2 个匹配点")
+                            .arg(templateName).arg(cached.matches.size()));
+            return cached.matches;
+        }
+        // 自己丢弃过期结果不改变代数，本次匹配的结果仍可存入
+        Metrics::increment(Metrics::RecognitionCacheMisses);
+        QMutexLocker locker(&m_hitCacheMutex);
+        m_hitCache.remove(templateName);
+    }
     
-    // 执行模板匹配
-    int matchMethod = TM_CCOEFF_NORMED;
-    Mat result;
-    matchTemplate(sourceMat, templateMat, result, matchMethod);
+    const RecognitionProfile profile = snapshot->recognitionProfile(templateName);
+    const double adjustedThreshold = profile.threshold;
+    
+    // 包装为OpenCV Mat（灰度截图不再转换和复制），只在搜索区域内匹配
+    Mat sourceMat = grayMatView(sourceGray);
+    Mat templateMat = grayMatView(templateGray);
+    const QRect searchRect = profile.searchRect(sourceGray.size(), templateGray.size());
+    Mat searchMat = profile.preprocessImage(
+        sourceMat(cv::Rect(searchRect.x(), searchRect.y(), searchRect.width(), searchRect.height())));
+    Mat preparedTemplate = profile.preprocessImage(templateMat);
+
+    // 截图时同时得到的半分辨率灰度图用于金字塔匹配（预处理在半分辨率下效果不同，只用于不预处理的模板）
+    Mat halfSearch;
+    QPoint halfOffset;
+    if (snapshot->pyramidMatching && profile.preprocess == RecognitionProfile::PreprocessNone &&
+        halfGray.format() == QImage::Format_Grayscale8 &&
+        halfGray.width() == sourceGray.width() / 2 && halfGray.height() == sourceGray.height() / 2) {
+        const QRect halfRect = QRect(searchRect.x() / 2, searchRect.y() / 2,
+                                     searchRect.width() / 2, searchRect.height() / 2) & halfGray.rect();
+        if (!halfRect.isEmpty()) {
+            halfSearch = grayMatView(halfGray)(cv::Rect(halfRect.x(), halfRect.y(), halfRect.width(), halfRect.height()));
+            halfOffset = halfRect.topLeft() * 2 - searchRect.topLeft();
+        }
+    }
     
     // 获取模板尺寸配置
-    ConfigManager* config = ConfigManager::getInstance();
-    QSize configTemplateSize = config->getTemplateSize(templateName);
+    QSize configTemplateSize = snapshot->templateSize(templateName);
     int templateWidth = configTemplateSize.width();
     int templateHeight = configTemplateSize.height();
     
@@ -488,61 +717,180 @@ QVector<QPoint> ImageRecognizer::findTemplate(const QImage &sourceImage, const Q
     if (templateWidth == 100 && templateHeight == 100) {
         templateWidth = templateGray.width();
         templateHeight = templateGray.height();
-        config->setTemplateSize(templateName, QSize(templateWidth, templateHeight));
-    }
-    
-    // 根据模板类型调整匹配阈值
-    double adjustedThreshold = 0.95; // 默认阈值
-    if (templateName.contains("workbench")) {
-        adjustedThreshold = 0.97;
-    } else if (templateName.contains("mindspark")) {
-        adjustedThreshold = 0.96;
-    } else if (templateName.contains("input_box")) {
-        adjustedThreshold = 0.94;
-    } else if (templateName.contains("send_button")) {
-        adjustedThreshold = 0.96;
-    }
-    
-    // 遍历匹配结果，寻找所有满足阈值的匹配点
-    for (int y = 0; y < result.rows; y++) {
-        for (int x = 0; x < result.cols; x++) {
-            float matchVal = result.at<float>(y, x);
-            double score = matchVal; // TM_CCOEFF_NORMED返回值范围[-1, 1]，越大越匹配
-            
-            if (score >= adjustedThreshold) {
-                QPoint matchPoint(x, y);
-                
-                // 非极大值抑制，避免相邻重复匹配
-                bool isUnique = true;
-                int suppressionRadius = qMax(templateWidth, templateHeight) / 2;
-                suppressionRadius = qMin(suppressionRadius, 50); // 最大抑制半径限制为50像素
-                
-                for (const QPoint& existingMatch : matches) {
-                    int dx = abs(existingMatch.x() - x);
-                    int dy = abs(existingMatch.y() - y);
-                    if (dx <= suppressionRadius && dy <= suppressionRadius) {
-                        isUnique = false;
-                        break;
-                    }
-                }
-                
-                if (isUnique) {
-                    matches.append(matchPoint);
-                    emit logMessage(QString("匹配点(%1,%2)得分: %3").arg(x).arg(y).arg(score));
-                }
+        config->setMeasuredTemplateSize(templateName, QSize(templateWidth, templateHeight));
+    }
+    
+    // 非极大值抑制半径，避免相邻重复匹配
+    int suppressionRadius = qMax(templateWidth, templateHeight) / 2;
+    suppressionRadius = qMin(suppressionRadius, 50); // 最大抑制半径限制为50像素
+    
+    Mat result;
+    double bestScore = -1.0;
+    double matchedScale = 1.0;
+    QSize matchedSize = templateGray.size();
+    bool featureHit = false;
+    
+    // 像素一致的图标先用逐次消除精确匹配，找不到再走相关匹配
+    if (profile.method == RecognitionProfile::ExactSad) {
+        TRACE_SCOPE_DETAIL("recognition", "exactMatch", templateName);
+        ExactMatcher::Hit hit;
+        ExactMatcher::Stats stats;
+        const bool found = ExactMatcher::find(searchMat.data, int(searchMat.step), QSize(searchMat.cols, searchMat.rows),
+                                              preparedTemplate.data, int(preparedTemplate.step),
+                                              QSize(preparedTemplate.cols, preparedTemplate.rows),
+                                              ExactMatcher::kDefaultMaxMeanDiff,
+                                              profile.firstHit ? ExactMatcher::FirstHit : ExactMatcher::BestHit,
+                                              &hit, &stats);
+        if (found) {
+            matches.append(QPoint(searchRect.x() + hit.point.x(), searchRect.y() + hit.point.y()));
+            emit logMessage(QString("精确匹配找到 %1: (%2,%3) 平均差 %4 排除 %5/%6 个位置")
+                            .arg(templateName).arg(matches.first().x()).arg(matches.first().y())
+                            .arg(hit.meanDiff, 0, 'f', 2).arg(stats.eliminated).arg(stats.positions));
+        } else {
+            emit logMessage(QString("精确匹配未找到 %1，改用相关匹配").arg(templateName));
+        }
+    }
+    
+    // 按配置的缩放比例依次匹配，收集各比例的峰值（精确匹配已找到时跳过）
+    struct ScaledPeak {
+        QPoint point;
+        float score;
+        double scale;
+        QSize size;
+    };
+    QVector<ScaledPeak> scaledPeaks;
+    const QVector<double> scales = matches.isEmpty() ? profile.scales : QVector<double>();
+    for (double scale : scales) {
+        Mat scaledTemplate = preparedTemplate;
+        if (!qFuzzyCompare(scale, 1.0)) {
+            cv::resize(preparedTemplate, scaledTemplate, cv::Size(), scale, scale,
+                       scale < 1.0 ? INTER_AREA : INTER_LINEAR);
+        }
+        if (scaledTemplate.cols < 2 || scaledTemplate.rows < 2 ||
+            scaledTemplate.cols > searchMat.cols || scaledTemplate.rows > searchMat.rows) {
+            continue;
+        }
+        
+        // 执行模板匹配：有半分辨率图时先粗后精，否则整图匹配（搜索区域较大时分条并行）
+        Mat scaleResult;
+        bool coarseToFine = false;
+        if (!halfSearch.empty()) {
+            TRACE_SCOPE_DETAIL("recognition", "coarseToFineMatch", templateName);
+            coarseToFine = coarseToFineMatch(searchMat, halfSearch, halfOffset, scaledTemplate, profile,
+                                             float(adjustedThreshold), suppressionRadius, scaleResult);
+        }
+        if (!coarseToFine) {
+            TRACE_SCOPE_DETAIL("recognition", "matchTemplate", templateName);
+            TiledMatcher::match(searchMat, scaledTemplate, scaleResult, profile.cvMethod());
+            profile.normalizeScores(scaleResult);
+        }
+        
+        // 提取达到阈值的峰值（各缩放比例的峰值合并后再统一抑制）
+        const QVector<PeakExtractor::Peak> peaks = PeakExtractor::extract(
+            scaleResult.ptr<float>(0), int(scaleResult.step1()), scaleResult.cols, scaleResult.rows,
+            float(adjustedThreshold), suppressionRadius, kMaxMatches);
+        for (const PeakExtractor::Peak &peak : peaks) {
+            scaledPeaks.append({QPoint(searchRect.x() + peak.point.x(), searchRect.y() + peak.point.y()),
+                                peak.score, scale, QSize(scaledTemplate.cols, scaledTemplate.rows)});
+        }
+        
+        // 诊断模式下保留得分最高的一次结果
+        if (MatchDiagnostics::isEnabled()) {
+            double scaleMax = 0.0;
+            minMaxLoc(scaleResult, nullptr, &scaleMax);
+            if (scaleMax > bestScore) {
+                bestScore = scaleMax;
+                result = scaleResult;
             }
         }
     }
     
-    // 限制最大匹配点数量为2
-    if (matches.size() > 2) {
-        matches.resize(2);
+    // 按得分从高到低取前kMaxMatches个互不重叠的匹配点，尺寸取得分最高的匹配所在的缩放比例
+    std::sort(scaledPeaks.begin(), scaledPeaks.end(), [](const ScaledPeak &a, const ScaledPeak &b) {
+        return a.score > b.score;
+    });
+    for (const ScaledPeak &peak : scaledPeaks) {
+        bool isUnique = true;
+        for (const QPoint &existingMatch : matches) {
+            if (abs(existingMatch.x() - peak.point.x()) <= suppressionRadius &&
+                abs(existingMatch.y() - peak.point.y()) <= suppressionRadius) {
+                isUnique = false;
+                break;
+            }
+        }
+        if (!isUnique) {
+            continue;
+        }
+        if (matches.isEmpty()) {
+            matchedScale = peak.scale;
+            matchedSize = peak.size;
+        }
+        matches.append(peak.point);
+        emit logMessage(QString("匹配点(%1,%2)得分: %3 缩放: %4")
+                        .arg(peak.point.x()).arg(peak.point.y()).arg(peak.score).arg(peak.scale));
+        if (matches.size() >= kMaxMatches) {
+            break;
+        }
+    }
+    
+    // 相关匹配失败且调用方要求时用特征匹配兜底（最后一次尝试），适应缩放和深浅色主题变化
+    if (matches.isEmpty() && featureFallback && snapshot->featureFallback && !m_stopRequested) {
+        TRACE_SCOPE_DETAIL("recognition", "featureMatch", templateName);
+        m_featureMatcher->prepareTemplate(templateName, templateImage);
+        const FeatureMatcher::Result featureResult = m_featureMatcher->match(sourceGray, templateName, searchRect);
+        if (featureResult.found) {
+            matches.append(featureResult.rect.topLeft());
+            featureHit = true;
+            matchedScale = featureResult.scale;
+            matchedSize = featureResult.rect.size();
+            emit logMessage(QString("特征匹配找到 %1: (%2,%3) %4x%5 缩放 %6 内点 %7/%8")
+                            .arg(templateName)
+                            .arg(featureResult.rect.x()).arg(featureResult.rect.y())
+                            .arg(featureResult.rect.width()).arg(featureResult.rect.height())
+                            .arg(featureResult.scale, 0, 'f', 2)
+                            .arg(featureResult.inliers).arg(featureResult.goodMatches));
+        } else {
+            emit logMessage(QString("特征匹配未找到 %1（有效匹配 %2，内点 %3）")
+                            .arg(templateName).arg(featureResult.goodMatches).arg(featureResult.inliers));
+        }
+    }
+    
+    // 在缩放后的尺寸上找到时，记录实际尺寸，点击位置按实际尺寸计算
+    if (!matches.isEmpty() && snapshot->templateSize(templateName) != matchedSize &&
+        (!qFuzzyCompare(matchedScale, 1.0) || snapshot->measuredTemplateSizes.contains(templateName))) {
+        config->setMeasuredTemplateSize(templateName, matchedSize);
+    }
+    
+    // 诊断模式：保留得分图和候选点
+    if (MatchDiagnostics::isEnabled() && !result.empty()) {
+        recordMatchDiagnostics(result, templateName, searchRect.size(), matchedSize,
+                               adjustedThreshold, matches.size());
+    }
+    
+    // 记录各匹配点处图块的哈希，供下次查找比较；特征匹配的结果可能是误检，不缓存，每次重新验证
+    if (snapshot->recognitionHitCache && !matches.isEmpty() && !featureHit) {
+        CachedHit entry;
+        entry.sourceSize = sourceGray.size();
+        entry.matchedSize = matchedSize;
+        entry.matches = matches;
+        bool hashed = true;
+        for (const QPoint &match : matches) {
+            PatchHash hash;
+            hashed = hashed && computePatchHash(sourceGray, QRect(match, matchedSize), &hash.dHash, &hash.mean);
+            entry.hashes.append(hash);
+        }
+        // 匹配期间配置变化清除过缓存时，本次结果按旧参数得到，不再存入
+        QMutexLocker locker(&m_hitCacheMutex);
+        if (hashed && hitCacheGeneration == m_hitCacheGeneration) {
+            m_hitCache.insert(templateName, entry);
+        }
     }
     
     emit logMessage(QString("findTemplate完成: %1 找到 %2 个匹配点").arg(templateName).arg(matches.size()));
     
     // 如果没有找到匹配点，发送信号
     if (matches.isEmpty()) {
+        Metrics::recordTemplateMiss(templateName);
         emit templateNotFound(templateName);
     }
     
@@ -581,160 +929,21 @@ QPoint ImageRecognizer::findBestMatch(const QVector<QPoint> &matches, const QIma
 }
 
 QImage ImageRecognizer::toGrayscale(const QImage &image) {
-    // 转换为灰度图像
-    return image.convertToFormat(QImage::Format_Grayscale8);
-}
-
-double ImageRecognizer::matchTemplateNCC(const QImage &source, const QImage &templateImg, int x, int y) {
-    // 使用归一化互相关(NCC)算法匹配模板
-    double sumSource = 0.0;
-    double sumTemplate = 0.0;
-    double sumProduct = 0.0;
-    double sumSourceSq = 0.0;
-    double sumTemplateSq = 0.0;
-
-    // 预处理模板，计算灰度值和
-    QVector<uchar> templateGrays(templateImg.width() * templateImg.height());
-    for (int ty = 0; ty < templateImg.height(); ++ty) {
-        for (int tx = 0; tx < templateImg.width(); ++tx) {
-            int index = ty * templateImg.width() + tx;
-            templateGrays[index] = qGray(templateImg.pixel(tx, ty));
-            sumTemplate += templateGrays[index];
-            sumTemplateSq += templateGrays[index] * templateGrays[index];
-        }
-    }
-
-    // 计算源图像区域与模板的相关值
-    for (int ty = 0; ty < templateImg.height(); ++ty) {
-        for (int tx = 0; tx < templateImg.width(); ++tx) {
-            // 检查边界，避免越界
-            if (x + tx >= source.width() || y + ty >= source.height()) {
-                return 0.0;
-            }
-            
-            uchar s = qGray(source.pixel(x + tx, y + ty));
-            uchar t = templateGrays[ty * templateImg.width() + tx];
-
-            sumSource += s;
-            sumProduct += s * t;
-            sumSourceSq += s * s;
-        }
-    }
-
-    int n = templateImg.width() * templateImg.height();
-    double numerator = sumProduct - (sumSource * sumTemplate / n);
-    double denominator = sqrt(
-        (sumSourceSq - (sumSource * sumSource / n)) *
-        (sumTemplateSq - (sumTemplate * sumTemplate / n))
-    );
-
-    return (denominator == 0.0) ? 0.0 : numerator / denominator;
-}
-
-double ImageRecognizer::matchTemplateSSD(const QImage &source, const QImage &templateImg, int x, int y) {
-    // 使用平方差(SSD)算法匹配模板
-    double sumSquaredDiff = 0.0;
-    
-    // 预处理模板，计算灰度值
-    QVector<uchar> templateGrays(templateImg.width() * templateImg.height());
-    for (int ty = 0; ty < templateImg.height(); ++ty) {
-        for (int tx = 0; tx < templateImg.width(); ++tx) {
-            int index = ty * templateImg.width() + tx;
-            templateGrays[index] = qGray(templateImg.pixel(tx, ty));
-        }
-    }
-
-    // 计算源图像区域与模板的平方差
-    for (int ty = 0; ty < templateImg.height(); ++ty) {
-        for (int tx = 0; tx < templateImg.width(); ++tx) {
-            // 检查边界，避免越界
-            if (x + tx >= source.width() || y + ty >= source.height()) {
-                return 1.0; // 越界返回最大差异
-            }
-            
-            uchar s = qGray(source.pixel(x + tx, y + ty));
-            uchar t = templateGrays[ty * templateImg.width() + tx];
-            
-            double diff = s - t;
-            sumSquaredDiff += diff * diff;
-        }
-    }
-    
-    // 归一化到0-1范围，0表示完全匹配
-    double maxDiff = templateImg.width() * templateImg.height() * 255.0 * 255.0;
-    double normalizedDiff = sumSquaredDiff / maxDiff;
-    
-    // 返回1-normalizedDiff，使结果范围与其他算法一致（越大越匹配）
-    return 1.0 - normalizedDiff;
-}
-
-double ImageRecognizer::matchTemplateSAD(const QImage &source, const QImage &templateImg, int x, int y) {
-    // 使用绝对差值和(SAD)算法匹配模板
-    double sumAbsoluteDiff = 0.0;
-    
-    // 预处理模板，计算灰度值
-    QVector<uchar> templateGrays(templateImg.width() * templateImg.height());
-    for (int ty = 0; ty < templateImg.height(); ++ty) {
-        for (int tx = 0; tx < templateImg.width(); ++tx) {
-            int index = ty * templateImg.width() + tx;
-            templateGrays[index] = qGray(templateImg.pixel(tx, ty));
-        }
-    }
-
-    // 计算源图像区域与模板的绝对差值和
-    for (int ty = 0; ty < templateImg.height(); ++ty) {
-        for (int tx = 0; tx < templateImg.width(); ++tx) {
-            // 检查边界，避免越界
-            if (x + tx >= source.width() || y + ty >= source.height()) {
-                return 1.0; // 越界返回最大差异
-            }
-            
-            uchar s = qGray(source.pixel(x + tx, y + ty));
-            uchar t = templateGrays[ty * templateImg.width() + tx];
-            
-            sumAbsoluteDiff += qAbs(s - t);
-        }
-    }
-    
-    // 归一化到0-1范围，0表示完全匹配
-    double maxDiff = templateImg.width() * templateImg.height() * 255.0;
-    double normalizedDiff = sumAbsoluteDiff / maxDiff;
-    
-    // 返回1-normalizedDiff，使结果范围与其他算法一致（越大越匹配）
-    return 1.0 - normalizedDiff;
-}
-
-QVector<QPoint> ImageRecognizer::matchTemplateORB(const QImage &source, const QImage &templateImg) {
-    // 使用ORB算法匹配模板（简化实现）
-    QVector<QPoint> matches;
-    
-    // 注意：这是一个简化的ORB匹配实现
-    // 完整的ORB匹配需要更复杂的特征提取和匹配算法
-    // 这里仅作为示例，实际使用OpenCV的ORB实现
-    
-    // 计算图像中心位置作为匹配点
-    int centerX = source.width() / 2 - templateImg.width() / 2;
-    int centerY = source.height() / 2 - templateImg.height() / 2;
-    
-    // 确保匹配点在图像范围内
-    if (centerX >= 0 && centerY >= 0) {
-        matches.append(QPoint(centerX, centerY));
-    }
-    
-    return matches;
+    // 转换为灰度图像（按CPU支持的指令集向量化）
+    return ImageKernels::toGray(image);
 }
 
 void ImageRecognizer::loadTemplates() {
     // 加载所有模板图像
-    // 从配置管理器获取模板路径并加载
-    ConfigManager* config = ConfigManager::getInstance();
+    // 从配置快照获取模板路径并加载
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::getInstance()->snapshot();
     
     // 加载工作台图标
-    QString workbenchPath = config->getIconPath("workbench");
+    QString workbenchPath = config->iconPath("workbench");
     if (!workbenchPath.isEmpty()) {
         QImage workbenchImage(workbenchPath);
         if (!workbenchImage.isNull()) {
-            templates["workbench"] = workbenchImage;
+            storeTemplate("workbench", workbenchImage);
             emit logMessage(QString("已加载模板: workbench 尺寸: %1x%2").arg(workbenchImage.width()).arg(workbenchImage.height()));
         } else {
             emit logMessage("无法加载模板: " + workbenchPath);
@@ -742,11 +951,11 @@ void ImageRecognizer::loadTemplates() {
     }
     
     // 加载MindSpark图标
-    QString mindsparkPath = config->getIconPath("mindspark");
+    QString mindsparkPath = config->iconPath("mindspark");
     if (!mindsparkPath.isEmpty()) {
         QImage mindsparkImage(mindsparkPath);
         if (!mindsparkImage.isNull()) {
-            templates["mindspark"] = mindsparkImage;
+            storeTemplate("mindspark", mindsparkImage);
             emit logMessage(QString("已加载模板: mindspark 尺寸: %1x%2").arg(mindsparkImage.width()).arg(mindsparkImage.height()));
         } else {
             emit logMessage("无法加载模板: " + mindsparkPath);
@@ -754,11 +963,11 @@ void ImageRecognizer::loadTemplates() {
     }
     
     // 加载MindSpark小图标
-    QString mindsparkSmallPath = config->getIconPath("mindspark_small");
+    QString mindsparkSmallPath = config->iconPath("mindspark_small");
     if (!mindsparkSmallPath.isEmpty()) {
         QImage mindsparkSmallImage(mindsparkSmallPath);
         if (!mindsparkSmallImage.isNull()) {
-            templates["mindspark_small"] = mindsparkSmallImage;
+            storeTemplate("mindspark_small", mindsparkSmallImage);
             emit logMessage(QString("已加载模板: mindspark_small 尺寸: %1x%2").arg(mindsparkSmallImage.width()).arg(mindsparkSmallImage.height()));
         } else {
             emit logMessage("无法加载模板: " + mindsparkSmallPath);
@@ -766,11 +975,11 @@ void ImageRecognizer::loadTemplates() {
     }
     
     // 加载输入框图标
-    QString inputBoxPath = config->getIconPath("input_box");
+    QString inputBoxPath = config->iconPath("input_box");
     if (!inputBoxPath.isEmpty()) {
         QImage inputBoxImage(inputBoxPath);
         if (!inputBoxImage.isNull()) {
-            templates["input_box"] = inputBoxImage;
+            storeTemplate("input_box", inputBoxImage);
             emit logMessage(QString("已加载模板: input_box 尺寸: %1x%2").arg(inputBoxImage.width()).arg(inputBoxImage.height()));
         } else {
             emit logMessage("无法加载模板: " + inputBoxPath);
@@ -778,11 +987,11 @@ void ImageRecognizer::loadTemplates() {
     }
     
     // 加载发送按钮图标
-    QString sendButtonPath = config->getIconPath("send_button");
+    QString sendButtonPath = config->iconPath("send_button");
     if (!sendButtonPath.isEmpty()) {
         QImage sendButtonImage(sendButtonPath);
         if (!sendButtonImage.isNull()) {
-            templates["send_button"] = sendButtonImage;
+            storeTemplate("send_button", sendButtonImage);
             emit logMessage(QString("已加载模板: send_button 尺寸: %1x%2").arg(sendButtonImage.width()).arg(sendButtonImage.height()));
         } else {
             emit logMessage("无法加载模板: " + sendButtonPath);
@@ -790,63 +999,122 @@ void ImageRecognizer::loadTemplates() {
     }
     
     // 加载历史对话图标
-    QString historyDialogPath = config->getIconPath("history_dialog");
+    QString historyDialogPath = config->iconPath("history_dialog");
     if (!historyDialogPath.isEmpty()) {
         QImage historyDialogImage(historyDialogPath);
         if (!historyDialogImage.isNull()) {
-            templates["history_dialog"] = historyDialogImage;
+            storeTemplate("history_dialog", historyDialogImage);
             emit logMessage(QString("已加载模板: history_dialog 尺寸: %1x%2").arg(historyDialogImage.width()).arg(historyDialogImage.height()));
         } else {
             emit logMessage("无法加载模板: " + historyDialogPath);
         }
     }
     
-    emit logMessage(QString("模板加载完成，共加载 %1 个模板").arg(templates.size()));
+    QStringList names;
+    {
+        QMutexLocker locker(&m_templatesMutex);
+        names = templates.keys();
+    }
+    emit logMessage(QString("模板加载完成，共加载 %1 个模板").arg(names.size()));
+    for (const QString &name : names) {
+        emit logMessage(QString("识别参数: %1 %2").arg(name, config->recognitionProfile(name).summary()));
+    }
 
+    // 在识别共用的线程池中预先计算模板的ORB特征，特征匹配兜底时不必现算
+    if (config->featureFallback) {
+        for (const QString &name : names) {
+            const std::shared_ptr<FeatureMatcher> matcher = m_featureMatcher;
+            const QImage image = lookupTemplate(name);
+            TiledMatcher::threadPool()->start([matcher, name, image]() {
+                matcher->prepareTemplate(name, image);
+            });
+        }
+    }
 }
 
-void ImageRecognizer::onConfigChanged() {
-    // 配置变更处理
-    threshold = ConfigManager::getInstance()->getImageRecognitionThreshold();
-    maxAttempts = ConfigManager::getInstance()->getMaxRecognitionAttempts();
-    
-    // 重新加载模板
-    templates.clear();
-    loadTemplates();
+void ImageRecognizer::onConfigKeysChanged(const QStringList &keys) {
+    // 配置变更处理：阈值只更新数值，图标路径变化只重新加载对应的模板，其他设置不影响识别
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::getInstance()->snapshot();
+    for (const QString &key : keys) {
+        if (key == "ImageRecognition/Threshold") {
+            threshold = config->imageRecognitionThreshold;
+            clearHitCache();
+        } else if (key == "ImageRecognition/MaxAttempts") {
+            maxAttempts = config->maxRecognitionAttempts;
+        } else if (key.startsWith("IconPaths/")) {
+            const QString name = key.section('/', 1);
+            const QString path = config->iconPath(name);
+            QImage templateImage(path);
+            if (templateImage.isNull()) {
+                emit logMessage("无法加载模板: " + path);
+                continue;
+            }
+            storeTemplate(name, templateImage);
+            clearHitCache(name);
+            emit logMessage(QString("模板已更新: %1 尺寸: %2x%3")
+                           .arg(name).arg(templateImage.width()).arg(templateImage.height()));
+        } else if (key.startsWith("RecognitionProfiles/")) {
+            // 识别参数每次查找时从快照读取，这里只丢弃该模板缓存的结果
+            const QString name = key.section('/', 1);
+            clearHitCache(name);
+            emit logMessage(QString("识别参数已更新: %1 %2").arg(name, config->recognitionProfile(name).summary()));
+        }
+    }
 }
 
-QImage ImageRecognizer::captureWindow(HWND hwnd) {
-    // 使用Windows API捕获指定窗口
+QImage ImageRecognizer::captureWindow(WindowHandle hwnd) {
+    TRACE_SCOPE("capture", "captureWindow");
+    MetricsStageTimer metricsTimer(Metrics::StageCapture);
+    // 回放模式：直接返回下一帧
+    if (isReplayMode()) {
+        return nextReplayFrame();
+    }
+
+    // 调用captureScreenArea捕获窗口区域
+    const QRect area = windowArea(hwnd);
+    return area.isEmpty() ? QImage() : captureScreenArea(area);
+}
+
+QImage ImageRecognizer::captureWindowGray(WindowHandle hwnd, QImage *halfGray) {
+    TRACE_SCOPE("capture", "captureWindowGray");
+    MetricsStageTimer metricsTimer(Metrics::StageCapture);
+    // 回放模式：转换下一帧
+    if (isReplayMode()) {
+        QImage gray;
+        ImageKernels::toGray(nextReplayFrame(), &gray, halfGray);
+        return gray;
+    }
+
+    const QRect area = windowArea(hwnd);
+    return area.isEmpty() ? QImage() : captureScreenAreaGray(area, halfGray);
+}
+
+QRect ImageRecognizer::windowArea(WindowHandle hwnd) {
+    // 获取窗口在屏幕上的区域
     if (!hwnd) {
         emit logMessage("无效的窗口句柄");
-        return QImage();
+        return QRect();
     }
     
-    // 获取窗口矩形
-    RECT windowRect;
-    if (!GetWindowRect(hwnd, &windowRect)) {
+    const QRect area = Platform::windowRect(hwnd);
+    if (area.isEmpty()) {
         emit logMessage("获取窗口矩形失败");
-        return QImage();
     }
-    
-    // 计算窗口尺寸
-    int width = windowRect.right - windowRect.left;
-    int height = windowRect.bottom - windowRect.top;
-    
-    // 调用captureScreenArea捕获窗口区域
-    return captureScreenArea(QRect(windowRect.left, windowRect.top, width, height));
+    return area;
 }
 
-bool ImageRecognizer::findTemplateInWindow(HWND hwnd, const QString &templateName, QPoint &resultPos) {
-    // 在指定窗口中查找模板
-    QImage windowImage = captureWindow(hwnd);
+bool ImageRecognizer::findTemplateInWindow(WindowHandle hwnd, const QString &templateName, QPoint &resultPos, bool featureFallback) {
+    TRACE_SCOPE_DETAIL("recognition", "findTemplateInWindow", templateName);
+    // 在指定窗口中查找模板（截图时直接转为灰度）
+    QImage halfGray;
+    QImage windowImage = captureWindowGray(hwnd, &halfGray);
     if (windowImage.isNull()) {
         emit logMessage("窗口截图失败");
         return false;
     }
     
-    // 调用findTemplate查找模板，返回所有匹配点
-    QVector<QPoint> matches = findTemplate(windowImage, templateName);
+    // 调用findTemplate查找模板，返回所有匹配点（半分辨率图用于先粗后精的匹配）
+    QVector<QPoint> matches = findTemplate(windowImage, templateName, featureFallback, halfGray);
     if (matches.isEmpty()) {
         return false;
     }
@@ -863,13 +1131,13 @@ bool ImageRecognizer::findTemplateInWindow(HWND hwnd, const QString &templateNam
     resultPos = bestMatch;
     
     // 发送识别区域信号
-    if (templates.contains(templateName)) {
+    QImage templateImage = lookupTemplate(templateName);
+    if (!templateImage.isNull()) {
         // 获取模板尺寸配置
         ConfigManager* config = ConfigManager::getInstance();
         QSize templateSize = config->getTemplateSize(templateName);
         
         // 如果模板尺寸未配置（使用默认值100x100），则使用实际尺寸
-        QImage templateImage = templates[templateName];
         if (templateSize.width() == 100 && templateSize.height() == 100) {
             templateSize = templateImage.size();
         }
@@ -888,7 +1156,8 @@ bool ImageRecognizer::findTemplateInWindow(HWND hwnd, const QString &templateNam
             recognitionArea.setHeight(windowImage.height() - recognitionArea.y());
         }
         
-        emit recognitionAreaFound(recognitionArea, templateName);
+        // 截图从窗口左上角开始，换算为屏幕坐标
+        emit recognitionAreaFound(recognitionArea.translated(windowArea(hwnd).topLeft()), templateName);
         
         // 删除了保存识别区域截图功能
     }
@@ -910,9 +1179,7 @@ void ImageRecognizer::resetStopFlag() {
 
 QPoint ImageRecognizer::getCurrentMousePosition() {
     // 获取当前鼠标位置
-    POINT point;
-    GetCursorPos(&point);
-    return QPoint(point.x, point.y);
+    return Platform::cursorPos();
 }
 
 bool ImageRecognizer::saveImageForDebug(const QImage &image, const QString &prefix, const QString &subfolder) {
@@ -951,7 +1218,7 @@ bool ImageRecognizer::saveImageForDebug(const QImage &image, const QString &pref
 bool ImageRecognizer::saveImageToLogDir(const QImage &image, const QString &prefix, const QString &subfolder) {
     // 保存图像到日志目录
     ConfigManager* config = ConfigManager::getInstance();
-    QString logDir = config->getLogPath() + subfolder + "/";
+    QString logDir = config->snapshot()->logPath + subfolder + "/";
     
     QDir dir;
     bool dirCreated = dir.mkpath(logDir);
@@ -996,10 +1263,11 @@ void ImageRecognizer::resetState() {
     m_previousAnswerAreas.clear();
     m_stableFrameCounts.clear();
     m_hasDetectedChanges.clear();
+    clearHitCache();
     emit logMessage("状态已重置");
 }
 
-void ImageRecognizer::doFindTemplateInWindow(HWND hwnd, const QString &templateName) {
+void ImageRecognizer::doFindTemplateInWindow(WindowHandle hwnd, const QString &templateName) {
     // 在窗口中查找模板
     QPoint resultPos;
     if (findTemplateInWindow(hwnd, templateName, resultPos)) {
@@ -1009,11 +1277,41 @@ void ImageRecognizer::doFindTemplateInWindow(HWND hwnd, const QString &templateN
     }
 }
 
+int ImageRecognizer::setReplayDirectory(const QString &directory) {
+    m_replayFrames.clear();
+    m_replayIndex = 0;
+    if (directory.isEmpty()) {
+        return 0;
+    }
+
+    QDir dir(directory);
+    const QStringList files = dir.entryList(QStringList() << "*.png" << "*.bmp" << "*.jpg",
+                                            QDir::Files, QDir::Name);
+    for (const QString &fileName : files) {
+        QImage frame(dir.filePath(fileName));
+        if (frame.isNull()) {
+            emit logMessage("回放帧加载失败: " + fileName);
+            continue;
+        }
+        m_replayFrames.append(frame.convertToFormat(QImage::Format_ARGB32));
+    }
+
+    emit logMessage(QString("已加载 %1 个回放帧: %2").arg(m_replayFrames.size()).arg(directory));
+    return m_replayFrames.size();
+}
+
+QImage ImageRecognizer::nextReplayFrame() {
+    const QImage &frame = m_replayFrames.at(m_replayIndex);
+    m_replayIndex = (m_replayIndex + 1) % m_replayFrames.size();
+    return frame;
+}
+
 bool ImageRecognizer::loadTemplate(const QString &name, const QString &path) {
+    TRACE_SCOPE_DETAIL("recognition", "loadTemplate", name);
     // 加载单个模板
     QImage templateImage(path);
     if (!templateImage.isNull()) {
-        templates[name] = templateImage;
+        storeTemplate(name, templateImage);
         emit logMessage(QString("已加载模板: %1 路径: %2 尺寸: %3x%4")
                        .arg(name)
                        .arg(path)
@@ -1021,8 +1319,8 @@ bool ImageRecognizer::loadTemplate(const QString &name, const QString &path) {
         
         // 更新模板尺寸配置
         ConfigManager* config = ConfigManager::getInstance();
-        config->setTemplateSize(name, templateImage.size());
-        emit logMessage(QString("模板尺寸配置已更新: %1 -> %2x%3")
+        config->setMeasuredTemplateSize(name, templateImage.size());
+        emit logMessage(QString("已记录模板实测尺寸: %1 -> %2x%3")
                        .arg(name)
                        .arg(templateImage.width()).arg(templateImage.height()));
         
@@ -1033,7 +1331,7 @@ bool ImageRecognizer::loadTemplate(const QString &name, const QString &path) {
     }
 }
 
-void ImageRecognizer::checkAnswerReceivedAsync(HWND hwnd) {
+void ImageRecognizer::checkAnswerReceivedAsync(WindowHandle hwnd) {
     // 异步检查回答是否收到
     bool received = checkAnswerReceived(hwnd);
     emit answerReceivedChecked(hwnd, received);
@@ -14,7 +14,10 @@
 #include <QThread>
 #include <QTimer>
 #include <QMutex>
-#include <windows.h>
+#include <atomic>
+#include <memory>
+#include "featurematcher.h"
+#include "platform.h"
 
 // OpenCV前向声明
 namespace cv {
@@ -47,7 +50,10 @@ public:
     void setRecognitionThreshold(double threshold); // 新增声明
 
     // 从窗口捕获图像
-    QImage captureWindow(HWND hwnd);
+    QImage captureWindow(WindowHandle hwnd);
+
+    // 从窗口捕获灰度图像：读取位图时直接转为灰度，halfGray 不为空时同时输出半分辨率灰度图（用于金字塔匹配）
+    QImage captureWindowGray(WindowHandle hwnd, QImage *halfGray = nullptr);
 
     // 从屏幕捕获图像
     QImage captureScreen(int screenIndex = 0);
@@ -56,7 +62,10 @@ public:
     bool loadTemplate(const QString &name, const QString &path); // 新增
 
     // 模板匹配 - 在源图像中查找模板（支持多分辨率和 DPI 缩放）
-    QVector<QPoint> findTemplate(const QImage &sourceImage, const QString &templateName); // 新增方法声明
+    // featureFallback 为true时相关匹配失败后用ORB特征匹配兜底（开销较大，只在最后一次尝试时使用）；
+    // halfGray 为截图时得到的半分辨率灰度图，提供时先在其上粗匹配，只在候选点附近做全分辨率匹配
+    QVector<QPoint> findTemplate(const QImage &sourceImage, const QString &templateName, bool featureFallback = false,
+                                 const QImage &halfGray = QImage());
 
     // 查找最可能的匹配点
     QPoint findBestMatch(const QVector<QPoint> &matches, const QImage &sourceImage);
@@ -84,20 +93,23 @@ public:
     void resetStopFlag();
 
     // 在窗口中查找模板（非阻塞版本）
-    void findTemplateInWindowAsync(HWND hwnd, const QString &templateName);
+    void findTemplateInWindowAsync(WindowHandle hwnd, const QString &templateName);
     
     // 在窗口中查找模板（阻塞版本，保留用于兼容旧代码）
-    bool findTemplateInWindow(HWND hwnd, const QString &templateName, QPoint &pos); // 新增
+    bool findTemplateInWindow(WindowHandle hwnd, const QString &templateName, QPoint &pos, bool featureFallback = false);
 
     // 检查是否收到回答（同步版本，保留用于兼容）
-    bool checkAnswerReceived(HWND hwnd);
+    bool checkAnswerReceived(WindowHandle hwnd);
     
     // 检查是否收到回答（异步版本）
-    void checkAnswerReceivedAsync(HWND hwnd);
+    void checkAnswerReceivedAsync(WindowHandle hwnd);
 
     // 捕获屏幕区域 - 线程安全版本
     QImage captureScreenArea(const QRect &area, int screenIndex = 0);
 
+    // 捕获屏幕区域并直接转为灰度（见 captureWindowGray）
+    QImage captureScreenAreaGray(const QRect &area, QImage *halfGray = nullptr);
+
     QRect findImageOnScreen(const QString &templatePath, int screenIndex = 0);
     
 
@@ -113,6 +125,12 @@ public:
     
     // 重置识别器状态，清理窗口特定的缓存
     void resetState();
+    
+    // 设置回放目录：截图改为按文件名顺序循环读取该目录下的图像（返回帧数）
+    int setReplayDirectory(const QString &directory);
+    
+    // 是否处于回放模式
+    bool isReplayMode() const { return !m_replayFrames.isEmpty(); }
 
 signals:
     void logMessage(const QString &message);
@@ -121,20 +139,27 @@ signals:
     // 模板查找失败信号
     void templateNotFound(const QString &templateName);
     // 异步检查结果信号
-    void answerReceivedChecked(HWND hwnd, bool received);
-    // 识别区域显示信号
+    void answerReceivedChecked(WindowHandle hwnd, bool received);
+    // 识别区域显示信号（findTemplateInWindow 发出时为屏幕坐标）
     void recognitionAreaFound(const QRect &area, const QString &description);
 
 private slots:
-    // 配置变化处理
-    void onConfigChanged();
+    // 配置变化处理：只更新受影响的阈值或模板
+    void onConfigKeysChanged(const QStringList &keys);
     // 异步查找模板的槽
-    void doFindTemplateInWindow(HWND hwnd, const QString &templateName);
+    void doFindTemplateInWindow(WindowHandle hwnd, const QString &templateName);
 
 private:
-    double threshold;
-    int maxAttempts;
+    // 配置变更在识别器线程更新，查找在自动化线程读取
+    std::atomic<double> threshold;
+    std::atomic<int> maxAttempts;
+    // 模板图像，由 m_templatesMutex 保护
     QMap<QString, QImage> templates;
+    mutable QMutex m_templatesMutex;
+    // 取模板（未加载时返回空图像）
+    QImage lookupTemplate(const QString &name) const;
+    // 存入或替换模板
+    void storeTemplate(const QString &name, const QImage &image);
     // 工作线程
     QThread *workerThread;
     // 停止请求标志
@@ -143,31 +168,57 @@ private:
     mutable QMutex m_stopMutex;
     
     // 输入框位置缓存（按窗口句柄存储）
-    QMap<HWND, QPoint> m_inputBoxPositions;
-    QMap<HWND, bool> m_inputBoxFound;
-    QMap<HWND, int> m_clientWidths;
-    QMap<HWND, int> m_failedAttempts;
+    QMap<WindowHandle, QPoint> m_inputBoxPositions;
+    QMap<WindowHandle, bool> m_inputBoxFound;
+    QMap<WindowHandle, int> m_clientWidths;
+    QMap<WindowHandle, int> m_failedAttempts;
     
     // 回答区域状态缓存（按窗口句柄存储）
-    QMap<HWND, QImage> m_previousAnswerAreas;
-    QMap<HWND, int> m_stableFrameCounts;
-    QMap<HWND, bool> m_hasDetectedChanges;
+    QMap<WindowHandle, QImage> m_previousAnswerAreas;
+    QMap<WindowHandle, int> m_stableFrameCounts;
+    QMap<WindowHandle, bool> m_hasDetectedChanges;
+    
+    // 回放帧（预先加载，避免磁盘读取影响吞吐测试）
+    QVector<QImage> m_replayFrames;
+    int m_replayIndex = 0;
+    
+    // 获取下一帧回放图像
+    QImage nextReplayFrame();
+    
+    // 截图缓冲：DIB位图和灰度图在多次截图之间复用，尺寸变化时才重新分配
+    QMutex m_captureMutex;
+    ScreenGrabber m_screenGrabber;
+    QImage m_grayBuffer;
+    QImage m_halfGrayBuffer;
+    
+    // 窗口在屏幕上的区域，失败时返回空矩形
+    QRect windowArea(WindowHandle hwnd);
+    // 把屏幕区域复制到复用的DIB位图，返回自上而下的BGRA像素（调用方须持有m_captureMutex）
+    const uchar *grabScreenArea(const QRect &area);
+    
+    // 识别结果缓存：记录每个模板上次找到的位置及该处图块的感知哈希，
+    // 下次在同尺寸图像上查找时图块哈希未变则直接沿用结果，不再做模板匹配
+    struct PatchHash {
+        quint64 dHash = 0;  // 9x8 块均值的水平梯度符号，64位
+        int mean = 0;       // 图块平均灰度，补上dHash对整体明暗变化不敏感的部分
+    };
+    struct CachedHit {
+        QSize sourceSize;
+        QSize matchedSize;
+        QVector<QPoint> matches;
+        QVector<PatchHash> hashes;
+    };
+    // 查找在自动化线程进行，配置变更在识别器线程清除缓存，由 m_hitCacheMutex 保护
+    QMap<QString, CachedHit> m_hitCache;
+    QMutex m_hitCacheMutex;
+    quint64 m_hitCacheGeneration = 0;   // 每次清除加1
+    // 清除某个模板（name 为空时全部）的缓存结果
+    void clearHitCache(const QString &name = QString());
+    
+    // ORB特征匹配（模板特征按模板缓存，相关匹配失败时兜底）；
+    // 模板加载后在共用线程池中预先计算特征，任务持有共享指针，识别器销毁后仍可安全完成
+    std::shared_ptr<FeatureMatcher> m_featureMatcher = std::make_shared<FeatureMatcher>();
 
-    // 归一化交叉相关匹配
-    double matchTemplateNCC(const QImage &source, const QImage &templateImg,
-                            int x, int y);
-    
-    // 平方差匹配
-    double matchTemplateSSD(const QImage &source, const QImage &templateImg,
-                           int x, int y);
-    
-    // 绝对差匹配
-    double matchTemplateSAD(const QImage &source, const QImage &templateImg,
-                           int x, int y);
-    
-    // ORB特征匹配
-    QVector<QPoint> matchTemplateORB(const QImage &source, const QImage &templateImg);
-    
     // QImage转Mat函数（内部函数，避免在头文件中暴露OpenCV依赖）
     cv::Mat QImageToMat(const QImage &image);
 };
@@ -1,26 +1,12 @@
 #include "inputsimulator.h"
-#include <windows.h>
+#include "platform.h"
 #include <QClipboard>
-#include <windows.h>
 #include <QApplication>
-#include <windows.h>
-#include <windows.h>
 #include <QThread>
 #include <QString>
 #include <QDebug>
-
-#ifndef VK_0
-#define VK_0 0x30
-#define VK_1 0x31
-#define VK_2 0x32
-#define VK_3 0x33
-#define VK_4 0x34
-#define VK_5 0x35
-#define VK_6 0x36
-#define VK_7 0x37
-#define VK_8 0x38
-#define VK_9 0x39
-#endif
+#include "tracer.h"
+#include "metrics.h"
 
 InputSimulator::InputSimulator(QObject *parent) : QObject(parent)
 {
@@ -43,34 +29,31 @@ void InputSimulator::setDelays(int clickDelayMs, int keyDelayMs)
 }
 
 void InputSimulator::moveMouse(int x, int y) {
+    TRACE_SCOPE("input", "moveMouse");
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消鼠标移动");
         return;
     }
     
-    // 移动鼠标到指定位置
-    INPUT input;
-    ZeroMemory(&input, sizeof(INPUT));
-    input.type = INPUT_MOUSE;
-
     // 使用绝对坐标移动，确保鼠标精确到达目标位置
-    // 注意：SM_CXSCREEN和SM_CYSCREEN返回的是主显示器的尺寸，使用GetSystemMetrics(SM_CXVIRTUALSCREEN)和SM_CYVIRTUALSCREEN更准确
-    int screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-    
-    input.mi.dx = (LONG)((x - GetSystemMetrics(SM_XVIRTUALSCREEN)) * (65535.0 / screenWidth));
-    input.mi.dy = (LONG)((y - GetSystemMetrics(SM_YVIRTUALSCREEN)) * (65535.0 / screenHeight));
-    input.mi.mouseData = 0;
-    input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
-    input.mi.time = 0;
-    input.mi.dwExtraInfo = 0;
-
-    SendInput(1, &input, sizeof(INPUT));
+    Platform::sendMouseMove(QPoint(x, y));
     emit logMessage(QString("鼠标移动到 (%1, %2)").arg(x).arg(y));
 }
 
 void InputSimulator::clickAt(int x, int y) {
+    TRACE_SCOPE("input", "clickAt");
+    MetricsStageTimer metricsTimer(Metrics::StageInput);
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消点击操作");
@@ -97,21 +80,13 @@ void InputSimulator::clickAt(int x, int y) {
     emit logMessage(QString("准备在 (%1, %2) 位置点击").arg(x).arg(y));
 
     // 左键按下
-    INPUT inputDown;
-    ZeroMemory(&inputDown, sizeof(INPUT));
-    inputDown.type = INPUT_MOUSE;
-    inputDown.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &inputDown, sizeof(INPUT));
+    Platform::sendMouseButton(true);
     
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消点击操作");
         // 确保释放鼠标按键
-        INPUT inputUp;
-        ZeroMemory(&inputUp, sizeof(INPUT));
-        inputUp.type = INPUT_MOUSE;
-        inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &inputUp, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
     
@@ -121,20 +96,12 @@ void InputSimulator::clickAt(int x, int y) {
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消点击操作");
         // 确保释放鼠标按键
-        INPUT inputUp;
-        ZeroMemory(&inputUp, sizeof(INPUT));
-        inputUp.type = INPUT_MOUSE;
-        inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &inputUp, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
 
     // 左键释放
-    INPUT inputUp;
-    ZeroMemory(&inputUp, sizeof(INPUT));
-    inputUp.type = INPUT_MOUSE;
-    inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &inputUp, sizeof(INPUT));
+    Platform::sendMouseButton(false);
 
     emit logMessage(QString("在 (%1, %2) 位置点击完成").arg(x).arg(y));
     // 增加点击后的延迟时间，确保输入框有足够时间获得焦点
@@ -143,6 +110,11 @@ void InputSimulator::clickAt(int x, int y) {
 
 void InputSimulator::doubleClickAt(int x, int y)
 {
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消双击操作");
@@ -167,21 +139,13 @@ void InputSimulator::doubleClickAt(int x, int y)
     }
 
     // 第一次点击
-    INPUT input1Down;
-    ZeroMemory(&input1Down, sizeof(INPUT));
-    input1Down.type = INPUT_MOUSE;
-    input1Down.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &input1Down, sizeof(INPUT));
+    Platform::sendMouseButton(true);
     
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消双击操作");
         // 确保释放鼠标按键
-        INPUT input1Up;
-        ZeroMemory(&input1Up, sizeof(INPUT));
-        input1Up.type = INPUT_MOUSE;
-        input1Up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &input1Up, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
     
@@ -191,19 +155,11 @@ void InputSimulator::doubleClickAt(int x, int y)
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消双击操作");
         // 确保释放鼠标按键
-        INPUT input1Up;
-        ZeroMemory(&input1Up, sizeof(INPUT));
-        input1Up.type = INPUT_MOUSE;
-        input1Up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &input1Up, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
 
-    INPUT input1Up;
-    ZeroMemory(&input1Up, sizeof(INPUT));
-    input1Up.type = INPUT_MOUSE;
-    input1Up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &input1Up, sizeof(INPUT));
+    Platform::sendMouseButton(false);
     QThread::msleep(50);
     
     // 检查是否请求停止
@@ -213,21 +169,13 @@ void InputSimulator::doubleClickAt(int x, int y)
     }
 
     // 第二次点击
-    INPUT input2Down;
-    ZeroMemory(&input2Down, sizeof(INPUT));
-    input2Down.type = INPUT_MOUSE;
-    input2Down.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &input2Down, sizeof(INPUT));
+    Platform::sendMouseButton(true);
     
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消双击操作");
         // 确保释放鼠标按键
-        INPUT input2Up;
-        ZeroMemory(&input2Up, sizeof(INPUT));
-        input2Up.type = INPUT_MOUSE;
-        input2Up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &input2Up, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
     
@@ -237,26 +185,23 @@ void InputSimulator::doubleClickAt(int x, int y)
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消双击操作");
         // 确保释放鼠标按键
-        INPUT input2Up;
-        ZeroMemory(&input2Up, sizeof(INPUT));
-        input2Up.type = INPUT_MOUSE;
-        input2Up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &input2Up, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
 
-    INPUT input2Up;
-    ZeroMemory(&input2Up, sizeof(INPUT));
-    input2Up.type = INPUT_MOUSE;
-    input2Up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &input2Up, sizeof(INPUT));
+    Platform::sendMouseButton(false);
 
     emit logMessage(QString("在 (%1, %2) 位置双击").arg(x).arg(y));
     QThread::msleep(clickDelay);
 }
 
-void InputSimulator::keyPress(WORD keyCode)
+void InputSimulator::keyPress(quint16 keyCode)
 {
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消按键按下");
@@ -264,17 +209,18 @@ void InputSimulator::keyPress(WORD keyCode)
     }
     
     // 按下按键（不释放）
-    INPUT input;
-    ZeroMemory(&input, sizeof(INPUT));
-    input.type = INPUT_KEYBOARD;
-    input.ki.wVk = keyCode;
-    SendInput(1, &input, sizeof(INPUT));
+    Platform::sendKey(keyCode, true);
     emit logMessage(QString("按键按下: %1").arg(keyCode));
     QThread::msleep(keyDelay);
 }
 
-void InputSimulator::keyRelease(WORD keyCode)
+void InputSimulator::keyRelease(quint16 keyCode)
 {
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消按键释放");
@@ -282,18 +228,20 @@ void InputSimulator::keyRelease(WORD keyCode)
     }
     
     // 释放按键
-    INPUT input;
-    ZeroMemory(&input, sizeof(INPUT));
-    input.type = INPUT_KEYBOARD;
-    input.ki.wVk = keyCode;
-    input.ki.dwFlags = KEYEVENTF_KEYUP;
-    SendInput(1, &input, sizeof(INPUT));
+    Platform::sendKey(keyCode, false);
     emit logMessage(QString("按键释放: %1").arg(keyCode));
     QThread::msleep(keyDelay);
 }
 
-void InputSimulator::pressKey(WORD keyCode)
+void InputSimulator::pressKey(quint16 keyCode)
 {
+    TRACE_SCOPE("input", "pressKey");
+    MetricsStageTimer metricsTimer(Metrics::StageInput);
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消按键操作");
@@ -314,6 +262,13 @@ void InputSimulator::pressKey(WORD keyCode)
 
 void InputSimulator::pasteText(const QString &text)
 {
+    TRACE_SCOPE("input", "pasteText");
+    MetricsStageTimer metricsTimer(Metrics::StageInput);
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     if (m_stopRequested) {
         return;
     }
@@ -330,40 +285,11 @@ void InputSimulator::pasteText(const QString &text)
         return;
     }
     
-    int textLength = text.length();
-    HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, (textLength + 1) * sizeof(wchar_t));
-    if (!hGlobal) {
-        emit logMessage("[ERROR] 无法分配全局内存");
+    QString errorString;
+    if (!Platform::setClipboardText(text, &errorString)) {
+        emit logMessage("[ERROR] " + errorString);
         return;
     }
-    
-    wchar_t* pGlobal = (wchar_t*)GlobalLock(hGlobal);
-    if (!pGlobal) {
-        emit logMessage("[ERROR] 无法锁定全局内存");
-        GlobalFree(hGlobal);
-        return;
-    }
-    
-    memcpy(pGlobal, text.utf16(), (textLength + 1) * sizeof(wchar_t));
-    GlobalUnlock(hGlobal);
-    
-    if (!OpenClipboard(NULL)) {
-        emit logMessage("[ERROR] 无法打开剪贴板");
-        GlobalFree(hGlobal);
-        return;
-    }
-    
-    EmptyClipboard();
-    
-    HANDLE hData = SetClipboardData(CF_UNICODETEXT, hGlobal);
-    if (!hData) {
-        emit logMessage("[ERROR] 无法设置剪贴板数据");
-        CloseClipboard();
-        GlobalFree(hGlobal);
-        return;
-    }
-    
-    CloseClipboard();
     QThread::msleep(300);
     
     QString clipboardContent = qtClipboard->text();
@@ -376,13 +302,13 @@ void InputSimulator::pasteText(const QString &text)
         return;
     }
     
-    keybd_event(VK_CONTROL, 0, 0, 0);
+    Platform::sendKey(Platform::KeyControl, true);
     QThread::msleep(50);
-    keybd_event(0x56, 0, 0, 0);
+    Platform::sendKey(Platform::KeyV, true);
     QThread::msleep(50);
-    keybd_event(0x56, 0, KEYEVENTF_KEYUP, 0);
+    Platform::sendKey(Platform::KeyV, false);
     QThread::msleep(50);
-    keybd_event(VK_CONTROL, 0, KEYEVENTF_KEYUP, 0);
+    Platform::sendKey(Platform::KeyControl, false);
     QThread::msleep(500);
     
     if (m_stopRequested) {
@@ -480,6 +406,13 @@ bool InputSimulator::testCopyPaste(const QString &testText)
 
 void InputSimulator::dragMouse(int startX, int startY, int endX, int endY)
 {
+    TRACE_SCOPE("input", "dragMouse");
+    MetricsStageTimer metricsTimer(Metrics::StageInput);
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消拖拽操作");
@@ -504,21 +437,13 @@ void InputSimulator::dragMouse(int startX, int startY, int endX, int endY)
     }
 
     // 按下左键
-    INPUT inputDown;
-    ZeroMemory(&inputDown, sizeof(INPUT));
-    inputDown.type = INPUT_MOUSE;
-    inputDown.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &inputDown, sizeof(INPUT));
+    Platform::sendMouseButton(true);
     
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消拖拽操作");
         // 确保释放鼠标按键
-        INPUT inputUp;
-        ZeroMemory(&inputUp, sizeof(INPUT));
-        inputUp.type = INPUT_MOUSE;
-        inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &inputUp, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
     
@@ -528,11 +453,7 @@ void InputSimulator::dragMouse(int startX, int startY, int endX, int endY)
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消拖拽操作");
         // 确保释放鼠标按键
-        INPUT inputUp;
-        ZeroMemory(&inputUp, sizeof(INPUT));
-        inputUp.type = INPUT_MOUSE;
-        inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &inputUp, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
 
@@ -543,11 +464,7 @@ void InputSimulator::dragMouse(int startX, int startY, int endX, int endY)
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消拖拽操作");
         // 确保释放鼠标按键
-        INPUT inputUp;
-        ZeroMemory(&inputUp, sizeof(INPUT));
-        inputUp.type = INPUT_MOUSE;
-        inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &inputUp, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
     
@@ -557,20 +474,12 @@ void InputSimulator::dragMouse(int startX, int startY, int endX, int endY)
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消拖拽操作");
         // 确保释放鼠标按键
-        INPUT inputUp;
-        ZeroMemory(&inputUp, sizeof(INPUT));
-        inputUp.type = INPUT_MOUSE;
-        inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &inputUp, sizeof(INPUT));
+        Platform::sendMouseButton(false);
         return;
     }
 
     // 释放左键
-    INPUT inputUp;
-    ZeroMemory(&inputUp, sizeof(INPUT));
-    inputUp.type = INPUT_MOUSE;
-    inputUp.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &inputUp, sizeof(INPUT));
+    Platform::sendMouseButton(false);
 
     emit logMessage(QString("鼠标拖拽从 (%1, %2) 到 (%3, %4)")
                     .arg(startX).arg(startY).arg(endX).arg(endY));
@@ -578,6 +487,13 @@ void InputSimulator::dragMouse(int startX, int startY, int endX, int endY)
 }
 
 void InputSimulator::typeText(const QString &text) {
+    TRACE_SCOPE("input", "typeText");
+    MetricsStageTimer metricsTimer(Metrics::StageInput);
+    // 空运行模式下不发送真实输入
+    if (m_dryRun) {
+        return;
+    }
+
     // 检查是否请求停止
     if (m_stopRequested) {
         emit logMessage("[DEBUG] 停止请求已收到，取消文本输入");
@@ -603,31 +519,10 @@ void InputSimulator::typeText(const QString &text) {
             return;
         }
         
-        // 转换为UTF-16字符
-        wchar_t wc = ch.unicode();
-        
-        // 发送字符的键盘事件
-        INPUT input[2];
-        
-        // 初始化第一个输入事件（按下字符）
-        ZeroMemory(&input[0], sizeof(INPUT));
-        input[0].type = INPUT_KEYBOARD;
-        input[0].ki.wVk = 0; // 使用wScan而非VK
-        input[0].ki.wScan = wc;
-        input[0].ki.dwFlags = KEYEVENTF_UNICODE;
-        
-        // 初始化第二个输入事件（释放字符）
-        ZeroMemory(&input[1], sizeof(INPUT));
-        input[1].type = INPUT_KEYBOARD;
-        input[1].ki.wVk = 0;
-        input[1].ki.wScan = wc;
-        input[1].ki.dwFlags = KEYEVENTF_UNICODE | KEYEVENTF_KEYUP;
-        
-        // 发送输入事件
-        UINT result = SendInput(2, input, sizeof(INPUT));
-        if (result != 2) {
-            emit logMessage(QString("[WARNING] 发送键盘事件失败，字符: %1，SendInput返回: %2").arg(ch).arg(result));
-            DWORD error = GetLastError();
+        // 以Unicode方式发送字符的按下和释放事件
+        quint32 error = 0;
+        if (!Platform::sendUnicodeChar(ch.unicode(), &error)) {
+            emit logMessage(QString("[WARNING] 发送键盘事件失败，字符: %1").arg(ch));
             emit logMessage(QString("[WARNING] 错误代码: %1").arg(error));
         }
         
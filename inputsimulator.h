@@ -3,7 +3,6 @@
 
 #include <QObject>
 #include <QPoint>
-#include <windows.h>
 
 class InputSimulator : public QObject {
     Q_OBJECT
@@ -24,13 +23,13 @@ public:
     void doubleClick();
 
     // 按下键盘按键（不释放）
-    void keyPress(WORD keyCode);
+    void keyPress(quint16 keyCode);
 
     // 释放键盘按键
-    void keyRelease(WORD keyCode);
+    void keyRelease(quint16 keyCode);
 
-    // 按下并释放键盘按键
-    void pressKey(WORD keyCode);
+    // 按下并释放键盘按键（虚拟键码，见Platform::Key）
+    void pressKey(quint16 keyCode);
 
     // 输入文本
     void typeText(const QString &text);
@@ -59,12 +58,10 @@ private:
 
     int globalDelay; // 每次操作后的全局延迟，毫秒
     bool m_stopRequested = false; // 停止请求标志
+    bool m_dryRun = false; // 空运行模式标志
 
     // 等待指定时间
     void wait(int ms);
-
-    // 转换QString到宽字符
-    LPWSTR qStringToLPWSTR(const QString &str);
     
 public:
     // 设置停止请求
@@ -76,6 +73,16 @@ public:
     bool isStopRequested() const {
         return m_stopRequested;
     }
+    
+    // 设置空运行模式（不发送任何真实的键鼠事件，用于回放测试）
+    void setDryRun(bool dryRun) {
+        m_dryRun = dryRun;
+    }
+    
+    // 是否为空运行模式
+    bool isDryRun() const {
+        return m_dryRun;
+    }
 };
 
 #endif // INPUTSIMULATOR_H
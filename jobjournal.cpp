@@ -0,0 +1,390 @@
+#include "jobjournal.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMap>
+#include <QSet>
+#include <QMetaEnum>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 组提交窗口（毫秒）：第一条记录到达后最多等待该时间再统一落盘
+constexpr int kGroupCommitWindowMs = 50;
+
+QByteArray toRecord(const QJsonObject &object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool isTerminalState(const QString &state)
+{
+    return state == "Answered" || state == "TimedOut" || state == "Failed";
+}
+
+// 崩溃时最后一行可能只写了一半，截断到最后一个换行符，避免后续记录接在残行后面一起被丢弃
+bool truncateTornTail(QFile &file)
+{
+    qint64 size = file.size();
+    const qint64 chunkSize = 4096;
+    qint64 keep = 0;
+    while (size > 0) {
+        const qint64 offset = qMax<qint64>(0, size - chunkSize);
+        if (!file.seek(offset)) {
+            return false;
+        }
+        const QByteArray chunk = file.read(size - offset);
+        const int newline = chunk.lastIndexOf('\n');
+        if (newline >= 0) {
+            keep = offset + newline + 1;
+            break;
+        }
+        size = offset;
+    }
+    return keep == file.size() || file.resize(keep);
+}
+
+} // namespace
+
+JobJournal::JobJournal(QObject *parent)
+    : QObject(parent)
+{
+}
+
+JobJournal::~JobJournal()
+{
+    close();
+}
+
+bool JobJournal::open(const QString &filePath)
+{
+    if (m_writerThread) {
+        if (filePath == m_filePath) {
+            return true;
+        }
+        close();
+    }
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    m_filePath = filePath;
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        emit logMessage("[ERROR] 无法打开任务日志: " + filePath);
+        return false;
+    }
+    if (!truncateTornTail(m_file)) {
+        emit logMessage("[WARNING] 无法截断任务日志末尾的不完整记录: " + m_file.errorString());
+    }
+    m_file.seek(m_file.size());
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = false;
+        m_pending.clear();
+        m_appendedSeq = 0;
+        m_committedSeq = 0;
+        m_truncateRequested = false;
+    }
+
+    m_writerThread = QThread::create([this]() { writerLoop(); });
+    m_writerThread->setObjectName("JournalThread");
+    m_writerThread->start();
+    return true;
+}
+
+void JobJournal::close()
+{
+    if (!m_writerThread) {
+        return;
+    }
+
+    flush();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wakeWriter.wakeAll();
+    }
+    m_writerThread->wait();
+    delete m_writerThread;
+    m_writerThread = nullptr;
+    m_file.close();
+}
+
+QString JobJournal::runSignature(const QStringList &questions, int mode, int totalCount)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &question : questions) {
+        hash.addData(question.toUtf8());
+        hash.addData(QByteArray(1, '\n'));
+    }
+    hash.addData(QByteArray::number(mode));
+    hash.addData(QByteArray(1, '/'));
+    hash.addData(QByteArray::number(totalCount));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString JobJournal::runSignature(const QString &contentId, int mode, int totalCount)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(contentId.toLatin1());
+    hash.addData(QByteArray(1, '/'));
+    hash.addData(QByteArray::number(mode));
+    hash.addData(QByteArray(1, '/'));
+    hash.addData(QByteArray::number(totalCount));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+JobJournal::ResumePoint JobJournal::findResumePoint(const QString &signature) const
+{
+    ResumePoint point;
+
+    QFile file(m_filePath);
+    if (m_filePath.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return point;
+    }
+
+    // 重放日志，只保留最后一次运行的状态
+    bool hasRun = false;
+    bool completed = false;
+    QString runSignature;
+    qint64 runId = 0;
+    int plannedTotal = 0;
+    QStringList liveQuestions;
+    QMap<int, QString> states;
+    QSet<int> liveIndices;
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        // 崩溃时最后一行可能不完整，解析失败的记录直接跳过
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+            continue;
+        }
+
+        QJsonObject record = document.object();
+        const QString type = record.value("t").toString();
+        if (type == "begin") {
+            hasRun = true;
+            completed = false;
+            runSignature = record.value("sig").toString();
+            runId = static_cast<qint64>(record.value("run").toDouble());
+            plannedTotal = record.value("total").toInt();
+            liveQuestions.clear();
+            states.clear();
+            liveIndices.clear();
+        } else if (type == "resume") {
+            // 继续运行时未发送的实时问题会重新加入，丢弃旧的待发送部分
+            int next = record.value("next").toInt();
+            liveQuestions = liveQuestions.mid(0, record.value("liveDone").toInt());
+            for (auto it = states.begin(); it != states.end();) {
+                if (it.key() >= next) {
+                    liveIndices.remove(it.key());
+                    it = states.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        } else if (type == "live") {
+            const QJsonArray array = record.value("q").toArray();
+            for (const QJsonValue &value : array) {
+                liveQuestions.append(value.toString());
+            }
+        } else if (type == "q") {
+            int index = record.value("i").toInt();
+            states[index] = record.value("s").toString();
+            if (record.value("live").toBool()) {
+                liveIndices.insert(index);
+            }
+        } else if (type == "end") {
+            completed = record.value("status").toString() == "completed";
+        }
+    }
+
+    if (!hasRun || completed || runSignature != signature) {
+        return point;
+    }
+
+    // 问题按顺序发送，连续完成的问题数即为下一个问题的序号；
+    // 已发送但未得到结果的问题会重新发送
+    int nextIndex = 0;
+    while (states.contains(nextIndex) && isTerminalState(states.value(nextIndex))) {
+        ++nextIndex;
+    }
+
+    int liveDone = 0;
+    for (int index : liveIndices) {
+        if (index < nextIndex) {
+            ++liveDone;
+        }
+    }
+
+    point.runId = runId;
+    point.nextIndex = nextIndex;
+    point.totalCount = plannedTotal;
+    point.liveDone = qMin(liveDone, static_cast<int>(liveQuestions.size()));
+    point.pendingLive = liveQuestions.mid(point.liveDone);
+    point.valid = nextIndex > 0 || !point.pendingLive.isEmpty();
+    return point;
+}
+
+void JobJournal::beginRun(const QString &signature, int totalCount, int mode)
+{
+    m_runId = QDateTime::currentMSecsSinceEpoch();
+
+    QJsonObject record;
+    record["t"] = "begin";
+    record["run"] = static_cast<double>(m_runId);
+    record["sig"] = signature;
+    record["total"] = totalCount;
+    record["mode"] = mode;
+    record["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    // 日志只保留当前运行，开始新运行时截断旧记录
+    QMutexLocker locker(&m_mutex);
+    m_pending.clear();
+    m_truncateRequested = true;
+    locker.unlock();
+    append(toRecord(record));
+}
+
+void JobJournal::resumeRun(const ResumePoint &point)
+{
+    m_runId = point.runId;
+
+    QJsonObject record;
+    record["t"] = "resume";
+    record["run"] = static_cast<double>(m_runId);
+    record["next"] = point.nextIndex;
+    record["liveDone"] = point.liveDone;
+    record["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    append(toRecord(record));
+}
+
+void JobJournal::recordQuestion(int index, QuestionState state, const QString &question, bool live)
+{
+    QJsonObject record;
+    record["t"] = "q";
+    record["i"] = index;
+    record["s"] = QString::fromLatin1(QMetaEnum::fromType<QuestionState>().valueToKey(state));
+    if (!question.isEmpty()) {
+        record["q"] = question;
+    }
+    if (live) {
+        record["live"] = true;
+    }
+    append(toRecord(record));
+}
+
+void JobJournal::recordLiveQuestions(const QStringList &questions)
+{
+    if (questions.isEmpty()) {
+        return;
+    }
+    QJsonObject record;
+    record["t"] = "live";
+    record["q"] = QJsonArray::fromStringList(questions);
+    append(toRecord(record));
+}
+
+void JobJournal::endRun(const QString &status)
+{
+    QJsonObject record;
+    record["t"] = "end";
+    record["run"] = static_cast<double>(m_runId);
+    record["status"] = status;
+    record["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    append(toRecord(record));
+    flush();
+}
+
+void JobJournal::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_writerThread) {
+        return;
+    }
+    const quint64 target = m_appendedSeq;
+    while (m_committedSeq < target && !m_stopping) {
+        m_wakeWriter.wakeAll();
+        m_committed.wait(&m_mutex);
+    }
+}
+
+void JobJournal::append(const QByteArray &record)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_writerThread) {
+        return;
+    }
+    bool wasEmpty = m_pending.isEmpty();
+    m_pending.append(record);
+    ++m_appendedSeq;
+    // 只有缓冲区由空变为非空时唤醒提交线程，后续记录在窗口期内合并提交
+    if (wasEmpty) {
+        m_wakeWriter.wakeAll();
+    }
+}
+
+void JobJournal::writerLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        if (m_pending.isEmpty() && !m_truncateRequested) {
+            if (m_stopping) {
+                break;
+            }
+            m_wakeWriter.wait(&m_mutex);
+            continue;
+        }
+
+        // 组提交窗口：等待更多记录到达（flush/close 会提前唤醒）
+        if (!m_stopping && m_committedSeq + 1 >= m_appendedSeq) {
+            m_wakeWriter.wait(&m_mutex, kGroupCommitWindowMs);
+        }
+
+        QByteArray data;
+        data.swap(m_pending);
+        const bool truncate = m_truncateRequested;
+        m_truncateRequested = false;
+        const quint64 sequence = m_appendedSeq;
+        locker.unlock();
+
+        if (truncate) {
+            m_file.resize(0);
+        }
+        if (!commit(data)) {
+            emit logMessage("[WARNING] 任务日志写入失败: " + m_file.errorString());
+        }
+
+        locker.relock();
+        m_committedSeq = sequence;
+        m_committed.wakeAll();
+    }
+}
+
+bool JobJournal::commit(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return true;
+    }
+    if (m_file.write(data) != data.size() || !m_file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(m_file.handle()) == 0;
+#else
+    return fsync(m_file.handle()) == 0;
+#endif
+}
@@ -0,0 +1,111 @@
+#ifndef JOBJOURNAL_H
+#define JOBJOURNAL_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QFile>
+
+// 问题任务日志
+// 仅追加的日志文件，每行一条JSON记录，记录运行开始/结束以及每个问题的状态。
+// 写入只追加到内存缓冲区，由后台线程按组提交（写入+落盘），
+// 因此每个问题增加的延迟可以忽略；程序崩溃或被停止后可从中断处继续。
+class JobJournal : public QObject
+{
+    Q_OBJECT
+public:
+    // 问题状态
+    enum QuestionState {
+        Pending,    // 等待发送
+        Sent,       // 已发送
+        Answered,   // 已回答
+        TimedOut,   // 等待回答超时
+        Failed      // 发送失败
+    };
+    Q_ENUM(QuestionState)
+
+    // 可恢复的运行信息
+    struct ResumePoint {
+        bool valid = false;        // 是否存在可恢复的运行
+        qint64 runId = 0;          // 运行编号
+        int nextIndex = 0;         // 下一个要发送的问题序号（从0开始）
+        int totalCount = 0;        // 计划的总次数（不含实时问题）
+        int liveDone = 0;          // 已完成的实时问题数
+        QStringList pendingLive;   // 尚未发送的实时问题
+    };
+
+    explicit JobJournal(QObject *parent = nullptr);
+    ~JobJournal() override;
+
+    // 打开日志文件并启动后台提交线程
+    bool open(const QString &filePath);
+
+    // 刷新并关闭
+    void close();
+
+    // 是否已打开
+    bool isOpen() const { return m_writerThread != nullptr; }
+
+    // 计算运行签名（问题列表、问题模式、循环次数相同才允许恢复）
+    static QString runSignature(const QStringList &questions, int mode, int totalCount);
+
+    // 根据问题内容摘要计算运行签名（问题库较大时避免逐条哈希）
+    static QString runSignature(const QString &contentId, int mode, int totalCount);
+
+    // 查找与签名匹配且未完成的运行
+    ResumePoint findResumePoint(const QString &signature) const;
+
+    // 开始新运行（清空旧记录）
+    void beginRun(const QString &signature, int totalCount, int mode);
+
+    // 继续已有运行
+    void resumeRun(const ResumePoint &point);
+
+    // 记录问题状态（序号从0开始）
+    void recordQuestion(int index, QuestionState state, const QString &question = QString(), bool live = false);
+
+    // 记录运行中加入的实时问题
+    void recordLiveQuestions(const QStringList &questions);
+
+    // 结束运行（status: completed / stopped / error）
+    void endRun(const QString &status);
+
+    // 立即提交缓冲区中的记录（阻塞直到落盘）
+    void flush();
+
+signals:
+    void logMessage(const QString &message);
+
+private:
+    // 追加一条记录到缓冲区
+    void append(const QByteArray &record);
+
+    // 后台提交循环
+    void writerLoop();
+
+    // 将数据写入文件并落盘
+    bool commit(const QByteArray &data);
+
+private:
+    QString m_filePath;
+    QFile m_file;
+    QThread *m_writerThread = nullptr;
+
+    // 以下成员受 m_mutex 保护
+    QMutex m_mutex;
+    QWaitCondition m_wakeWriter;
+    QWaitCondition m_committed;
+    QByteArray m_pending;
+    quint64 m_appendedSeq = 0;
+    quint64 m_committedSeq = 0;
+    bool m_stopping = false;
+    bool m_truncateRequested = false;
+
+    qint64 m_runId = 0;
+};
+
+#endif // JOBJOURNAL_H
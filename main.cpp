@@ -1,8 +1,12 @@
 #include "qt_compat.h"
 #include "mainwindow.h"
 #include "logger.h"
+#include "headlessrunner.h"
+#include "csvimporter.h"
+#include "recognitioncalibrator.h"
 
 #include <QApplication>
+#include <QGuiApplication>
 #include <QLocale>
 #include <QTranslator>
 #include <QMessageBox>
@@ -11,8 +15,11 @@
 #include <QDateTime>
 #include <QTextStream>
 #include <QFile>
+#ifdef Q_OS_WIN
 #include <windows.h>
+#endif
 
+#ifdef Q_OS_WIN
 // 全局变量，用于存储崩溃信息
 LONG WINAPI exceptionFilter(EXCEPTION_POINTERS* exceptionInfo)
 {
@@ -110,12 +117,46 @@ LONG WINAPI exceptionFilter(EXCEPTION_POINTERS* exceptionInfo)
     // 继续默认处理
     return EXCEPTION_EXECUTE_HANDLER;
 }
+#else
+// 其他平台没有qMain入口
+#define qMain main
+#endif
 
 // Qt 6入口点函数
 int qMain(int argc, char *argv[])
 {
+    // CSV解析基准测试：WeBot --bench-csv <文件>，对比旧的split解析与新解析器
+    if (argc >= 3 && qstrcmp(argv[1], "--bench-csv") == 0) {
+        QCoreApplication app(argc, argv);
+        QTextStream(stdout) << CsvImporter::benchmark(app.arguments().at(2)) << Qt::endl;
+        return 0;
+    }
+
+    // 识别参数校准：WeBot --calibrate <截图目录> [--precision 0.99] [--dry-run]
+    if (argc >= 3 && qstrcmp(argv[1], "--calibrate") == 0) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        QGuiApplication app(argc, argv);
+        RecognitionCalibrator calibrator;
+        return calibrator.run(app.arguments());
+    }
+
+    // 无界面模式：不创建任何窗口部件，运行结束后直接退出
+    if (HeadlessRunner::isHeadlessRequested(argc, argv)) {
+        // 回放模式不需要真实屏幕，未指定平台时使用offscreen
+        if (HeadlessRunner::isReplayRequested(argc, argv) && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        QGuiApplication app(argc, argv);
+        HeadlessRunner runner;
+        return runner.run(app.arguments());
+    }
+
+#ifdef Q_OS_WIN
     // 安装全局异常过滤器
     SetUnhandledExceptionFilter(exceptionFilter);
+#endif
     
     QApplication a(argc, argv);
 
@@ -19,6 +19,8 @@
 #include <QStandardPaths>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QPointer>
+#include <QScopeGuard>
 
 
 
@@ -102,7 +104,17 @@ MainWindow::MainWindow(QWidget *parent)
         // 在UI上显示日志保存位置
         ui->logSavePathLabel->setText(QString("日志保存位置: %1").arg(logFolderPath));
 
-        // 删除识别区域覆盖层功能
+        // 调试模式下用覆盖层标出识别到的区域（覆盖层在第一次识别到时创建）
+        connect(automator, &Automator::recognitionAreaFound, this, [this](const QRect &area, const QString &) {
+            if (!ConfigManager::getInstance()->getDebugMode()) {
+                return;
+            }
+            if (!recognitionOverlay) {
+                recognitionOverlay = new RecognitionOverlay();
+            }
+            // 覆盖层铺满虚拟桌面，绘制坐标相对于其左上角
+            recognitionOverlay->drawRecognitionArea(area.translated(-recognitionOverlay->pos()));
+        });
     
 
     
@@ -121,6 +133,28 @@ MainWindow::MainWindow(QWidget *parent)
         // 加载配置到UI
         loadConfigToUI();
 
+        // 按配置启动指标服务（默认关闭）
+        ConfigManager* serviceConfig = ConfigManager::getInstance();
+        if (serviceConfig->getMetricsEnabled()) {
+            metricsServer = new MetricsServer(this);
+            connect(metricsServer, &MetricsServer::logMessage, this, [this](const QString& logEntry) {
+                this->addLogEntry(logEntry);
+            });
+            metricsServer->start(serviceConfig->getMetricsBindAddress(),
+                                 static_cast<quint16>(serviceConfig->getMetricsPort()));
+        }
+
+        // 按配置启动本地控制接口（默认关闭）
+        if (serviceConfig->getControlEnabled()) {
+            controlServer = new ControlServer(automator, this);
+            connect(controlServer, &ControlServer::logMessage, this, [this](const QString& logEntry) {
+                this->addLogEntry(logEntry);
+            });
+            controlServer->start(serviceConfig->getControlBindAddress(),
+                                 static_cast<quint16>(serviceConfig->getControlPort()),
+                                 serviceConfig->getControlToken());
+        }
+
         // 初始化UI状态
         updateUIState(false);
 
@@ -200,6 +234,14 @@ MainWindow::~MainWindow() {
     
 
     
+    // 停止指标服务和控制接口
+    if (metricsServer) {
+        metricsServer->stop();
+    }
+    if (controlServer) {
+        controlServer->stop();
+    }
+    
     // 关闭日志系统
     Logger::close();
     
@@ -259,6 +301,7 @@ bool MainWindow::loadConfigToUI() {
     ui->questionModeCombo->addItem("循环使用预设问题", 0); // Automator::CycleMode
     ui->questionModeCombo->addItem("随机使用预设问题", 1); // Automator::RandomMode
     ui->questionModeCombo->addItem("自动生成问题", 2);   // Automator::GenerateMode
+    ui->questionModeCombo->addItem("随机不重复使用预设问题", 3); // Automator::ShuffleMode
     ui->questionModeCombo->setCurrentIndex(config->getQuestionMode());
     
     // 加载输入方式设置
@@ -630,9 +673,30 @@ void MainWindow::on_browseQuestionsButton_clicked() {
         QStringList previewLines;
         bool isCSV = path.endsWith(".csv", Qt::CaseInsensitive);
         
+        // CSV总行数在后台统计，可能在预览窗口创建前就已完成，先建立连接再开始预览
+        QPointer<QLabel> lineCountLabel;
+        auto lineCountText = [](qint64 lines) {
+            if (lines == -2) {
+                return QString("总行数: 统计中...");
+            }
+            return lines >= 0 ? QString("总行数: %1").arg(lines) : QString("总行数: 统计失败");
+        };
+        qint64 csvLineCount = -2;
+        QMetaObject::Connection lineCountConnection;
+        auto disconnectLineCount = qScopeGuard([&lineCountConnection]() { disconnect(lineCountConnection); });
+
         if (isCSV) {
             // 调用ConfigManager的previewCSVFile方法获取预览内容
             ConfigManager* config = ConfigManager::getInstance();
+            lineCountConnection = connect(config, &ConfigManager::csvLineCountReady, this,
+                                          [&, path](const QString &csvPath, qint64 lines) {
+                if (csvPath == path) {
+                    csvLineCount = lines;
+                    if (lineCountLabel) {
+                        lineCountLabel->setText(lineCountText(lines));
+                    }
+                }
+            });
             previewLines = config->previewCSVFile(path);
         } else {
             // 处理TXT文件
@@ -698,6 +762,12 @@ void MainWindow::on_browseQuestionsButton_clicked() {
         buttonLayout->addWidget(okButton);
         buttonLayout->addWidget(cancelButton);
         
+        // CSV总行数统计完成后更新
+        if (isCSV) {
+            lineCountLabel = new QLabel(lineCountText(csvLineCount), &previewDialog);
+            layout->addWidget(lineCountLabel);
+        }
+
         // 添加控件到布局
         layout->addWidget(previewTextEdit);
         layout->addLayout(buttonLayout);
@@ -21,6 +21,8 @@
 #include <QPoint>
 #include "automator.h"
 #include "recognitionoverlay.h"
+#include "metricsserver.h"
+#include "controlserver.h"
 
 namespace Ui {
 class MainWindow;
@@ -117,6 +119,8 @@ private:
     Ui::MainWindow *ui;
     Automator *automator = nullptr;
     RecognitionOverlay *recognitionOverlay = nullptr;
+    MetricsServer *metricsServer = nullptr;
+    ControlServer *controlServer = nullptr;
     
 
 
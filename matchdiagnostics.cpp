@@ -0,0 +1,216 @@
+#include "matchdiagnostics.h"
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QPainter>
+#include <atomic>
+
+namespace {
+
+// 热力图最大边长，4K截图的得分图降采样后约为 320x180
+constexpr int kMaxHeatmapSide = 320;
+
+// 渲染时的最小显示边长（得分图太小时放大显示）
+constexpr int kMinRenderSide = 480;
+
+std::atomic<bool> g_enabled{false};
+std::atomic<int> g_history{8};
+std::atomic<int> g_topK{5};
+
+QMutex g_recordsMutex;
+QMap<QString, QVector<MatchDiagnostics::Record>> g_records;
+
+// 得分映射为颜色：低分为深蓝，经青、黄到红（TM_CCOEFF_NORMED取值[-1, 1]，负分统一按0处理）
+QRgb heatColor(float score)
+{
+    const float t = qBound(0.0f, score, 1.0f);
+    static const float stops[][3] = {
+        {0.0f, 0.0f, 0.3f},
+        {0.0f, 0.6f, 1.0f},
+        {0.2f, 1.0f, 0.4f},
+        {1.0f, 1.0f, 0.0f},
+        {1.0f, 0.0f, 0.0f},
+    };
+    const float position = t * 4.0f;
+    const int index = qMin(int(position), 3);
+    const float frac = position - index;
+    const float *a = stops[index];
+    const float *b = stops[index + 1];
+    return qRgb(int(255 * (a[0] + (b[0] - a[0]) * frac)),
+                int(255 * (a[1] + (b[1] - a[1]) * frac)),
+                int(255 * (a[2] + (b[2] - a[2]) * frac)));
+}
+
+// 文件名中不能出现的字符替换为下划线
+QString safeFileName(const QString &name)
+{
+    QString result = name;
+    for (QChar &ch : result) {
+        if (!ch.isLetterOrNumber() && ch != '_' && ch != '-') {
+            ch = '_';
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+void MatchDiagnostics::configure(bool enabled, int history, int topK)
+{
+    g_history.store(qMax(1, history));
+    g_topK.store(qMax(1, topK));
+    g_enabled.store(enabled);
+}
+
+bool MatchDiagnostics::isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+int MatchDiagnostics::topK()
+{
+    return g_topK.load(std::memory_order_relaxed);
+}
+
+int MatchDiagnostics::maxHeatmapSide()
+{
+    return kMaxHeatmapSide;
+}
+
+void MatchDiagnostics::record(Record record)
+{
+    const int history = g_history.load();
+    QMutexLocker locker(&g_recordsMutex);
+    QVector<Record> &records = g_records[record.templateName];
+    records.append(std::move(record));
+    if (records.size() > history) {
+        records.remove(0, records.size() - history);
+    }
+}
+
+QStringList MatchDiagnostics::templateNames()
+{
+    QMutexLocker locker(&g_recordsMutex);
+    return g_records.keys();
+}
+
+QVector<MatchDiagnostics::Record> MatchDiagnostics::history(const QString &templateName)
+{
+    QMutexLocker locker(&g_recordsMutex);
+    return g_records.value(templateName);
+}
+
+QImage MatchDiagnostics::renderHeatmap(const Record &record)
+{
+    const int width = record.heatmapSize.width();
+    const int height = record.heatmapSize.height();
+    if (width <= 0 || height <= 0 || record.heatmap.size() != width * height) {
+        return QImage();
+    }
+
+    QImage heat(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(heat.scanLine(y));
+        const float *scores = record.heatmap.constData() + y * width;
+        for (int x = 0; x < width; ++x) {
+            line[x] = heatColor(scores[x]);
+        }
+    }
+
+    // 放大显示，保持像素块清晰
+    const int scale = qMax(1, kMinRenderSide / qMax(width, height));
+    const int legendHeight = 24;
+    QImage canvas(width * scale, height * scale + legendHeight, QImage::Format_RGB32);
+    canvas.fill(Qt::black);
+
+    QPainter painter(&canvas);
+    painter.drawImage(QRect(0, 0, width * scale, height * scale), heat);
+
+    // 候选点：白色圆圈+名次，达到阈值的用实线，未达到的用虚线
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    const double pixelsPerCell = double(scale) / record.cellSize;
+    for (int i = 0; i < record.candidates.size(); ++i) {
+        const Candidate &candidate = record.candidates.at(i);
+        const QPointF center((candidate.point.x() + 0.5) * pixelsPerCell,
+                             (candidate.point.y() + 0.5) * pixelsPerCell);
+        QPen pen(Qt::white, 2, candidate.score >= record.threshold ? Qt::SolidLine : Qt::DashLine);
+        painter.setPen(pen);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawEllipse(center, 8, 8);
+        painter.drawText(center + QPointF(10, -10),
+                         QString("#%1 %2").arg(i + 1).arg(candidate.score, 0, 'f', 3));
+    }
+
+    // 图例：模板、阈值、匹配数和前两名的得分差
+    painter.setPen(Qt::white);
+    QString legend = QString("%1  阈值 %2  匹配 %3  %4x%5→%6x%7")
+                         .arg(record.templateName)
+                         .arg(record.threshold, 0, 'f', 3)
+                         .arg(record.acceptedCount)
+                         .arg(record.resultSize.width()).arg(record.resultSize.height())
+                         .arg(width).arg(height);
+    if (record.candidates.size() >= 2) {
+        legend += QString("  第一二名差距 %1")
+                      .arg(record.candidates.at(0).score - record.candidates.at(1).score, 0, 'f', 3);
+    }
+    painter.drawText(QRect(4, height * scale, canvas.width() - 8, legendHeight),
+                     Qt::AlignVCenter | Qt::AlignLeft, legend);
+    painter.end();
+    return canvas;
+}
+
+int MatchDiagnostics::exportAll(const QString &directory)
+{
+    QMap<QString, QVector<Record>> records;
+    {
+        QMutexLocker locker(&g_recordsMutex);
+        records = g_records;
+    }
+    if (records.isEmpty()) {
+        return 0;
+    }
+
+    QDir dir(directory);
+    if (!dir.mkpath(".")) {
+        return 0;
+    }
+
+    QFile csvFile(dir.filePath("candidates.csv"));
+    if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return 0;
+    }
+    QTextStream csv(&csvFile);
+    csv << "template,time,threshold,accepted,rank,x,y,score,image\n";
+
+    int exported = 0;
+    for (auto it = records.constBegin(); it != records.constEnd(); ++it) {
+        const QString baseName = safeFileName(it.key());
+        for (int i = 0; i < it.value().size(); ++i) {
+            const Record &record = it.value().at(i);
+            const QString time = record.time.toString("hhmmss_zzz");
+            const QString imageName = QString("%1_%2_%3.png").arg(baseName).arg(i).arg(time);
+            const QImage image = renderHeatmap(record);
+            if (image.isNull() || !image.save(dir.filePath(imageName))) {
+                continue;
+            }
+            for (int rank = 0; rank < record.candidates.size(); ++rank) {
+                const Candidate &candidate = record.candidates.at(rank);
+                csv << it.key() << ',' << record.time.toString(Qt::ISODateWithMs) << ','
+                    << record.threshold << ',' << record.acceptedCount << ','
+                    << rank + 1 << ',' << candidate.point.x() << ',' << candidate.point.y() << ','
+                    << candidate.score << ',' << imageName << '\n';
+            }
+            ++exported;
+        }
+    }
+    return exported;
+}
+
+void MatchDiagnostics::clear()
+{
+    QMutexLocker locker(&g_recordsMutex);
+    g_records.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef MATCHDIAGNOSTICS_H
+#define MATCHDIAGNOSTICS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPoint>
+#include <QSize>
+#include <QImage>
+#include <QDateTime>
+
+// 模板匹配诊断
+// 开启后，每个模板保留最近N次搜索的匹配得分图（按块取最大值降采样）和得分最高的k个候选点，
+// 用于判断阈值和搜索区域该怎么设：真匹配和次优候选的得分差距越大，阈值越容易取。
+// 运行结束后可导出为热力图PNG和候选点CSV。
+class MatchDiagnostics
+{
+public:
+    // 候选点（result坐标系，即匹配位置的左上角）
+    struct Candidate {
+        QPoint point;
+        double score = 0.0;
+    };
+
+    // 一次搜索的诊断记录
+    struct Record {
+        QString templateName;
+        QDateTime time;
+        QSize sourceSize;           // 源图像尺寸
+        QSize templateSize;         // 模板尺寸
+        QSize resultSize;           // 得分图尺寸
+        double threshold = 0.0;     // 本次使用的阈值
+        int acceptedCount = 0;      // 达到阈值的匹配数
+        int cellSize = 1;           // 降采样块大小（得分图中cellSize×cellSize个点对应热力图一个点）
+        QSize heatmapSize;
+        QVector<float> heatmap;     // 每块的最大得分，按行存储
+        QVector<Candidate> candidates;  // 按得分从高到低
+    };
+
+    // 开关与参数（history为每个模板保留的记录数，topK为每次记录的候选数）
+    static void configure(bool enabled, int history, int topK);
+    static bool isEnabled();
+    static int topK();
+
+    // 得分图降采样后的最大边长
+    static int maxHeatmapSide();
+
+    // 记录一次搜索（超出保留数量时丢弃该模板最早的记录）
+    static void record(Record record);
+
+    // 已有记录的模板名称
+    static QStringList templateNames();
+
+    // 某个模板的记录，按时间从早到晚
+    static QVector<Record> history(const QString &templateName);
+
+    // 渲染为彩色热力图，并标出候选点及其名次
+    static QImage renderHeatmap(const Record &record);
+
+    // 导出所有记录：每条记录一张PNG，另加一份candidates.csv汇总，返回导出的记录数
+    static int exportAll(const QString &directory);
+
+    // 清空所有记录
+    static void clear();
+};
+
+#endif // MATCHDIAGNOSTICS_H
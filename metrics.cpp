@@ -0,0 +1,249 @@
+#include "metrics.h"
+#include <QCoreApplication>
+#include <atomic>
+#include <cstring>
+#include "platform.h"
+
+namespace {
+
+// 计数器
+std::atomic<quint64> g_counters[Metrics::CounterCount];
+
+// 进度与状态
+std::atomic<int> g_progressCurrent{0};
+std::atomic<int> g_progressTotal{0};
+std::atomic<int> g_running{0};
+
+// 进程启动时间
+const std::chrono::steady_clock::time_point g_startTime = std::chrono::steady_clock::now();
+
+// 阶段耗时直方图（上界单位：毫秒，最后一档为 +Inf）
+constexpr qint64 kBucketBoundsMs[] = {1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000};
+constexpr int kBucketCount = sizeof(kBucketBoundsMs) / sizeof(kBucketBoundsMs[0]) + 1;
+
+struct StageHistogram {
+    std::atomic<quint64> buckets[kBucketCount];
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> sumNs{0};
+};
+StageHistogram g_stages[Metrics::StageCount];
+
+const char *const kStageNames[Metrics::StageCount] = {
+    "capture", "recognition", "input", "question", "answer_wait"
+};
+
+// 模板识别失败计数：固定槽位，首次出现的模板通过CAS占用一个槽位
+constexpr int kMissSlotCount = 32;
+struct MissSlot {
+    std::atomic<quint64> hash{0};
+    std::atomic<int> ready{0};
+    char name[48] = {0};
+    std::atomic<quint64> count{0};
+};
+MissSlot g_missSlots[kMissSlotCount];
+std::atomic<quint64> g_missOverflow{0};
+
+// 模板名哈希（FNV-1a，保证非零）
+quint64 hashTemplateName(const QString &name)
+{
+    quint64 hash = 14695981039346656037ULL;
+    for (QChar ch : name) {
+        hash ^= ch.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash | 1;
+}
+
+// Prometheus 标签值转义
+QByteArray escapeLabel(const QByteArray &value)
+{
+    QByteArray escaped;
+    escaped.reserve(value.size());
+    for (char ch : value) {
+        if (ch == '\\' || ch == '"') {
+            escaped += '\\';
+            escaped += ch;
+        } else if (ch == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += ch;
+        }
+    }
+    return escaped;
+}
+
+void appendMetricHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendSample(QByteArray &out, const char *name, const QByteArray &labels, quint64 value)
+{
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += QByteArray::number(value);
+    out += '\n';
+}
+
+} // namespace
+
+void Metrics::increment(Counter counter, quint64 n)
+{
+    g_counters[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+void Metrics::recordTemplateMiss(const QString &templateName)
+{
+    const quint64 hash = hashTemplateName(templateName);
+    int start = static_cast<int>(hash % kMissSlotCount);
+
+    for (int probe = 0; probe < kMissSlotCount; ++probe) {
+        MissSlot &slot = g_missSlots[(start + probe) % kMissSlotCount];
+        quint64 current = slot.hash.load(std::memory_order_acquire);
+
+        if (current == 0) {
+            quint64 expected = 0;
+            if (slot.hash.compare_exchange_strong(expected, hash, std::memory_order_acq_rel)) {
+                // 占用成功：写入名称后再发布
+                QByteArray utf8 = templateName.toUtf8();
+                size_t len = qMin<size_t>(utf8.size(), sizeof(slot.name) - 1);
+                memcpy(slot.name, utf8.constData(), len);
+                slot.name[len] = '\0';
+                slot.ready.store(1, std::memory_order_release);
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            current = expected;
+        }
+
+        if (current == hash) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // 槽位已满，计入溢出
+    g_missOverflow.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::observeStage(Stage stage, qint64 durationNs)
+{
+    if (durationNs < 0) {
+        durationNs = 0;
+    }
+
+    StageHistogram &histogram = g_stages[stage];
+    int bucket = kBucketCount - 1;
+    for (int i = 0; i < kBucketCount - 1; ++i) {
+        if (durationNs <= kBucketBoundsMs[i] * 1000000LL) {
+            bucket = i;
+            break;
+        }
+    }
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    histogram.sumNs.fetch_add(static_cast<quint64>(durationNs), std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::setProgress(int current, int total)
+{
+    g_progressCurrent.store(current, std::memory_order_relaxed);
+    g_progressTotal.store(total, std::memory_order_relaxed);
+}
+
+void Metrics::setRunning(bool running)
+{
+    g_running.store(running ? 1 : 0, std::memory_order_relaxed);
+}
+
+QByteArray Metrics::renderPrometheus()
+{
+    QByteArray out;
+    out.reserve(8192);
+
+    // 计数器
+    struct CounterInfo { Counter counter; const char *name; const char *help; };
+    const CounterInfo counters[] = {
+        {QuestionsSent, "webot_questions_sent_total", "Questions submitted to the chat window."},
+        {AnswersCompleted, "webot_answers_completed_total", "Answers that finished within the timeout."},
+        {AnswerTimeouts, "webot_answer_timeouts_total", "Answers that did not finish within the timeout."},
+        {QuestionFailures, "webot_question_failures_total", "Question/answer cycles that failed."},
+        {RunsStarted, "webot_runs_started_total", "Automation runs started."},
+        {RecognitionCacheHits, "webot_recognition_cache_hits_total", "Recognitions answered from the hit cache without template matching."},
+        {RecognitionCacheMisses, "webot_recognition_cache_misses_total", "Recognitions that missed the hit cache and ran template matching."},
+    };
+    for (const CounterInfo &info : counters) {
+        appendMetricHeader(out, info.name, "counter", info.help);
+        appendSample(out, info.name, QByteArray(), g_counters[info.counter].load(std::memory_order_relaxed));
+    }
+
+    // 模板识别失败
+    appendMetricHeader(out, "webot_recognition_misses_total", "counter", "Template recognition misses by template.");
+    for (const MissSlot &slot : g_missSlots) {
+        if (slot.ready.load(std::memory_order_acquire)) {
+            appendSample(out, "webot_recognition_misses_total",
+                         "template=\"" + escapeLabel(QByteArray(slot.name)) + "\"",
+                         slot.count.load(std::memory_order_relaxed));
+        }
+    }
+    quint64 overflow = g_missOverflow.load(std::memory_order_relaxed);
+    if (overflow > 0) {
+        appendSample(out, "webot_recognition_misses_total", "template=\"other\"", overflow);
+    }
+
+    // 阶段耗时直方图
+    appendMetricHeader(out, "webot_stage_duration_seconds", "histogram", "Latency of automation stages.");
+    for (int stage = 0; stage < StageCount; ++stage) {
+        const StageHistogram &histogram = g_stages[stage];
+        const QByteArray stageLabel = QByteArray("stage=\"") + kStageNames[stage] + "\"";
+        quint64 cumulative = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            cumulative += histogram.buckets[i].load(std::memory_order_relaxed);
+            QByteArray le = (i < kBucketCount - 1)
+                                ? QByteArray::number(kBucketBoundsMs[i] / 1000.0, 'g', 6)
+                                : QByteArray("+Inf");
+            appendSample(out, "webot_stage_duration_seconds_bucket", stageLabel + ",le=\"" + le + "\"", cumulative);
+        }
+        out += "webot_stage_duration_seconds_sum{" + stageLabel + "} "
+               + QByteArray::number(histogram.sumNs.load(std::memory_order_relaxed) / 1e9, 'f', 6) + "\n";
+        appendSample(out, "webot_stage_duration_seconds_count", stageLabel, cumulative);
+    }
+
+    // 进度与状态
+    appendMetricHeader(out, "webot_progress_current", "gauge", "Index of the question currently being processed.");
+    appendSample(out, "webot_progress_current", QByteArray(), g_progressCurrent.load(std::memory_order_relaxed));
+    appendMetricHeader(out, "webot_progress_total", "gauge", "Number of questions in the current run.");
+    appendSample(out, "webot_progress_total", QByteArray(), g_progressTotal.load(std::memory_order_relaxed));
+    appendMetricHeader(out, "webot_running", "gauge", "Whether an automation run is in progress.");
+    appendSample(out, "webot_running", QByteArray(), g_running.load(std::memory_order_relaxed));
+
+    // 内存
+    quint64 workingSet = 0;
+    quint64 privateBytes = 0;
+    if (Platform::processMemory(&workingSet, &privateBytes)) {
+        appendMetricHeader(out, "webot_process_working_set_bytes", "gauge", "Process working set size.");
+        appendSample(out, "webot_process_working_set_bytes", QByteArray(), workingSet);
+        appendMetricHeader(out, "webot_process_private_bytes", "gauge", "Process private committed memory.");
+        appendSample(out, "webot_process_private_bytes", QByteArray(), privateBytes);
+    }
+
+    // 运行时长
+    appendMetricHeader(out, "webot_uptime_seconds", "gauge", "Seconds since the process started.");
+    appendSample(out, "webot_uptime_seconds", QByteArray(),
+                 std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - g_startTime).count());
+
+    return out;
+}
@@ -0,0 +1,74 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QString>
+#include <QByteArray>
+#include <QtGlobal>
+#include <chrono>
+
+// 运行指标
+// 所有计数器均为原子变量，自动化线程写入时不加锁；
+// 采集端（MetricsServer）只读取快照并渲染为 Prometheus 文本格式。
+class Metrics
+{
+public:
+    // 累计计数器
+    enum Counter {
+        QuestionsSent,      // 已发送问题数
+        AnswersCompleted,   // 已完成回答数
+        AnswerTimeouts,     // 等待回答超时数
+        QuestionFailures,   // 问答流程失败数
+        RunsStarted,        // 已启动的运行次数
+        RecognitionCacheHits,   // 识别结果缓存命中（图块未变，跳过模板匹配）
+        RecognitionCacheMisses, // 识别结果缓存未命中
+        CounterCount
+    };
+
+    // 需要统计耗时的阶段
+    enum Stage {
+        StageCapture,       // 截图
+        StageRecognition,   // 模板识别
+        StageInput,         // 键鼠输入
+        StageQuestion,      // 单个问题完整流程
+        StageAnswerWait,    // 等待回答
+        StageCount
+    };
+
+    // 计数器加一（或加n）
+    static void increment(Counter counter, quint64 n = 1);
+
+    // 记录某个模板的一次识别失败
+    static void recordTemplateMiss(const QString &templateName);
+
+    // 记录阶段耗时（纳秒）
+    static void observeStage(Stage stage, qint64 durationNs);
+
+    // 更新当前进度与运行状态
+    static void setProgress(int current, int total);
+    static void setRunning(bool running);
+
+    // 渲染为 Prometheus 文本格式
+    static QByteArray renderPrometheus();
+};
+
+// 作用域计时：析构时将耗时记录到指定阶段
+class MetricsStageTimer
+{
+public:
+    explicit MetricsStageTimer(Metrics::Stage stage)
+        : m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+
+    ~MetricsStageTimer() {
+        Metrics::observeStage(m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                           std::chrono::steady_clock::now() - m_start).count());
+    }
+
+    MetricsStageTimer(const MetricsStageTimer &) = delete;
+    MetricsStageTimer &operator=(const MetricsStageTimer &) = delete;
+
+private:
+    Metrics::Stage m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,155 @@
+#include "metricsserver.h"
+#include "metrics.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QTimer>
+
+namespace {
+
+// 请求头最大长度，超过后直接断开
+constexpr int kMaxRequestSize = 8192;
+
+// 单个连接的超时时间（毫秒）
+constexpr int kConnectionTimeoutMs = 5000;
+
+} // namespace
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent)
+{
+    m_thread.setObjectName("MetricsThread");
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(const QString &bindAddress, quint16 port)
+{
+    if (m_server) {
+        return true;
+    }
+
+    QHostAddress address(bindAddress.isEmpty() ? QString("127.0.0.1") : bindAddress);
+    if (address.isNull()) {
+        emit logMessage(QString("[ERROR] 指标服务监听地址无效: %1").arg(bindAddress));
+        return false;
+    }
+
+    m_thread.start();
+
+    // 服务器对象归属监听线程，连接处理全部在该线程中完成
+    QTcpServer *server = new QTcpServer();
+    server->moveToThread(&m_thread);
+
+    bool listening = false;
+    QString errorString;
+    QMetaObject::invokeMethod(server, [this, server, address, port, &listening, &errorString]() {
+        connect(server, &QTcpServer::newConnection, server, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection()) {
+                handleConnection(socket);
+            }
+        });
+        listening = server->listen(address, port);
+        if (!listening) {
+            errorString = server->errorString();
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listening) {
+        emit logMessage(QString("[ERROR] 指标服务启动失败 %1:%2 - %3")
+                            .arg(address.toString()).arg(port).arg(errorString));
+        QMetaObject::invokeMethod(server, [server]() { delete server; }, Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+        return false;
+    }
+
+    m_server = server;
+    emit logMessage(QString("[INFO] 指标服务已启动: http://%1:%2/metrics").arg(address.toString()).arg(port));
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!m_server) {
+        return;
+    }
+
+    QTcpServer *server = m_server;
+    m_server = nullptr;
+    QMetaObject::invokeMethod(server, [server]() {
+        server->close();
+        delete server;
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void MetricsServer::handleConnection(QTcpSocket *socket)
+{
+    socket->setParent(nullptr);
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+    // 防止客户端不发送请求时连接长期占用
+    QTimer::singleShot(kConnectionTimeoutMs, socket, [socket]() {
+        socket->abort();
+        socket->deleteLater();
+    });
+
+    connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+        if (socket->property("responded").toBool()) {
+            socket->readAll();
+            return;
+        }
+
+        QByteArray buffer = socket->property("requestBuffer").toByteArray() + socket->readAll();
+        if (buffer.size() > kMaxRequestSize) {
+            socket->abort();
+            return;
+        }
+        if (!buffer.contains("\r\n\r\n") && !buffer.contains("\n\n")) {
+            socket->setProperty("requestBuffer", buffer);
+            return;
+        }
+
+        // 只解析请求行：METHOD PATH VERSION
+        QList<QByteArray> requestLine = buffer.left(buffer.indexOf('\n')).trimmed().split(' ');
+        QByteArray method = requestLine.value(0);
+        QByteArray path = requestLine.value(1);
+        int queryIndex = path.indexOf('?');
+        if (queryIndex >= 0) {
+            path.truncate(queryIndex);
+        }
+
+        QByteArray status;
+        QByteArray contentType = "text/plain; charset=utf-8";
+        QByteArray body;
+        if (method != "GET" && method != "HEAD") {
+            status = "405 Method Not Allowed";
+            body = "method not allowed\n";
+        } else if (path == "/metrics") {
+            status = "200 OK";
+            contentType = "text/plain; version=0.0.4; charset=utf-8";
+            body = Metrics::renderPrometheus();
+        } else {
+            status = "404 Not Found";
+            body = "not found\n";
+        }
+
+        QByteArray response = "HTTP/1.1 " + status + "\r\n"
+                              "Content-Type: " + contentType + "\r\n"
+                              "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                              "Connection: close\r\n\r\n";
+        if (method != "HEAD") {
+            response += body;
+        }
+
+        socket->setProperty("responded", true);
+        socket->write(response);
+        socket->disconnectFromHost();
+    });
+}
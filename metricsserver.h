@@ -0,0 +1,42 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QThread>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+
+// 指标HTTP服务
+// 在独立线程中监听，GET /metrics 返回 Prometheus 文本格式；
+// 采集只读取原子计数器，不会阻塞自动化线程。
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer() override;
+
+    // 启动监听（地址为空时使用127.0.0.1）
+    bool start(const QString &bindAddress, quint16 port);
+
+    // 停止监听
+    void stop();
+
+    // 是否正在监听
+    bool isListening() const { return m_server != nullptr; }
+
+signals:
+    void logMessage(const QString &message);
+
+private:
+    // 处理单个连接（在监听线程中执行）
+    void handleConnection(QTcpSocket *socket);
+
+private:
+    QThread m_thread;
+    QTcpServer *m_server = nullptr;
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,131 @@
+#include "peakextractor.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define PEAKEXTRACTOR_SSE2 1
+#endif
+
+namespace {
+
+// 方块内的最大值（index为-1表示方块内没有达到阈值的点）
+struct TileMax {
+    float score;
+    int index;
+};
+
+// 记录一个达到阈值的点
+inline void updateTile(TileMax *tileRow, int tileSize, int x, int y, int cols, float value)
+{
+    TileMax &tile = tileRow[x / tileSize];
+    if (tile.index < 0 || value > tile.score) {
+        tile.score = value;
+        tile.index = y * cols + x;
+    }
+}
+
+// 候选排序：得分高的在前，得分相同时位置靠前的在前
+inline bool scoresLower(const TileMax &a, const TileMax &b)
+{
+    return a.score < b.score || (a.score == b.score && a.index > b.index);
+}
+
+// 点是否被已确定的峰值抑制
+bool isSuppressed(const QVector<PeakExtractor::Peak> &peaks, const QPoint &point, int radius)
+{
+    for (const PeakExtractor::Peak &peak : peaks) {
+        if (std::abs(peak.point.x() - point.x()) <= radius && std::abs(peak.point.y() - point.y()) <= radius) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+QVector<PeakExtractor::Peak> PeakExtractor::extract(const float *data, int stride, int cols, int rows,
+                                                    float threshold, int radius, int maxPeaks)
+{
+    QVector<Peak> peaks;
+    if (!data || cols <= 0 || rows <= 0) {
+        return peaks;
+    }
+
+    // 方块边长不超过抑制半径：同一方块内的两点一定互相抑制，只需保留最大值
+    const int tileSize = qMax(1, radius);
+    const int tilesPerRow = (cols + tileSize - 1) / tileSize;
+    const int tileRows = (rows + tileSize - 1) / tileSize;
+    std::vector<TileMax> tiles(size_t(tilesPerRow) * tileRows, TileMax{0.0f, -1});
+
+    for (int y = 0; y < rows; ++y) {
+        const float *row = data + qint64(y) * stride;
+        TileMax *tileRow = tiles.data() + size_t(y / tileSize) * tilesPerRow;
+        int x = 0;
+#ifdef PEAKEXTRACTOR_SSE2
+        const __m128 limit = _mm_set1_ps(threshold);
+        for (; x + 4 <= cols; x += 4) {
+            int mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), limit));
+            while (mask) {
+                const int lane = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+                mask &= mask - 1;
+                updateTile(tileRow, tileSize, x + lane, y, cols, row[x + lane]);
+            }
+        }
+#endif
+        for (; x < cols; ++x) {
+            if (row[x] >= threshold) {
+                updateTile(tileRow, tileSize, x, y, cols, row[x]);
+            }
+        }
+    }
+
+    // 方块最大值放入按得分排序的堆
+    std::vector<TileMax> candidates;
+    for (const TileMax &tile : tiles) {
+        if (tile.index >= 0) {
+            candidates.push_back(tile);
+        }
+    }
+    std::make_heap(candidates.begin(), candidates.end(), scoresLower);
+
+    // 非极大值抑制：方块最大值被抑制时，方块内其余未被抑制的点仍可能是峰值，
+    // 重新扫描该方块取其中得分最高的点放回堆中
+    while (!candidates.empty()) {
+        std::pop_heap(candidates.begin(), candidates.end(), scoresLower);
+        const TileMax candidate = candidates.back();
+        candidates.pop_back();
+
+        const QPoint point(candidate.index % cols, candidate.index / cols);
+        if (!isSuppressed(peaks, point, radius)) {
+            // 同一方块内的其余点都在抑制半径内，方块不必再扫描
+            peaks.append({point, candidate.score});
+            if (maxPeaks > 0 && peaks.size() >= maxPeaks) {
+                break;
+            }
+            continue;
+        }
+
+        const int left = point.x() / tileSize * tileSize;
+        const int top = point.y() / tileSize * tileSize;
+        const int right = qMin(left + tileSize, cols);
+        const int bottom = qMin(top + tileSize, rows);
+        TileMax best{0.0f, -1};
+        for (int y = top; y < bottom; ++y) {
+            const float *row = data + qint64(y) * stride;
+            for (int x = left; x < right; ++x) {
+                const TileMax current{row[x], y * cols + x};
+                if (row[x] >= threshold && (best.index < 0 || scoresLower(best, current))
+                    && !isSuppressed(peaks, QPoint(x, y), radius)) {
+                    best = current;
+                }
+            }
+        }
+        if (best.index >= 0) {
+            candidates.push_back(best);
+            std::push_heap(candidates.begin(), candidates.end(), scoresLower);
+        }
+    }
+    return peaks;
+}
@@ -0,0 +1,27 @@
+#ifndef PEAKEXTRACTOR_H
+#define PEAKEXTRACTOR_H
+
+#include <QPoint>
+#include <QVector>
+
+// 匹配得分图的峰值提取
+// 一次遍历得分图：按行用SIMD比较找出达到阈值的点（大部分行没有，整行跳过），
+// 同时把每个点归入边长为抑制半径的方块，只保留方块内的最大值；
+// 再按得分从高到低做非极大值抑制，返回得分最高的k个峰值。
+// 方块最大值被相邻方块的峰值抑制时重新扫描该方块，结果与逐点非极大值抑制相同。
+// 耗时与得分图大小成线性关系，与达到阈值的点数基本无关。
+class PeakExtractor
+{
+public:
+    struct Peak {
+        QPoint point;       // 得分图中的位置
+        float score = 0.0f;
+    };
+
+    // data 指向第一行，stride 为相邻两行之间的float个数；
+    // radius 为抑制半径（两个峰值的横纵距离都不超过该值时只保留得分高的），maxPeaks<=0 表示不限数量
+    static QVector<Peak> extract(const float *data, int stride, int cols, int rows,
+                                 float threshold, int radius, int maxPeaks);
+};
+
+#endif // PEAKEXTRACTOR_H
@@ -0,0 +1,113 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+// 原生窗口句柄（Windows上为HWND，其他平台只作为不透明值传递）
+typedef void *WindowHandle;
+
+// 平台层：窗口、截图、键鼠输入和进程相关的系统调用都集中在这里。
+// Windows上调用Win32 API（platform_win.cpp）；其他平台（platform_other.cpp）没有可操作的窗口，
+// 窗口查找、截图和输入都返回失败，只有回放模式（截图来自文件、输入不实际发送）可以运行，
+// 用于在Linux上做无界面吞吐测试。
+class Platform
+{
+public:
+    // 虚拟键码（取值与Win32相同）
+    enum Key : quint16 {
+        KeyReturn = 0x0D,
+        KeyControl = 0x11,
+        KeyV = 0x56
+    };
+
+    // 显示窗口的方式
+    enum ShowMode {
+        ShowNormal,     // 显示窗口
+        ShowRestore,    // 从最小化恢复
+        ShowMaximized   // 最大化
+    };
+
+    // 能否操作真实的窗口和键鼠（只有Windows可以）
+    static bool isSupported();
+
+    // 窗口：按类名或标题查找（空字符串表示不限），找不到返回nullptr
+    static WindowHandle findWindow(const QString &className, const QString &title);
+    // 桌面窗口（回放模式下作为目标窗口，客户区为整个虚拟屏幕）
+    static WindowHandle desktopWindow();
+    static WindowHandle foregroundWindow();
+    static bool setForegroundWindow(WindowHandle window);
+    // 激活窗口（SetActiveWindow）
+    static void setActiveWindow(WindowHandle window);
+    // 把键盘焦点交给本进程的窗口，不改变窗口的前后顺序
+    static void focusWindow(WindowHandle window);
+    static void showWindow(WindowHandle window, ShowMode mode);
+    static bool isWindowVisible(WindowHandle window);
+    static bool isWindowMinimized(WindowHandle window);
+    static bool isWindowMaximized(WindowHandle window);
+    static bool setWindowTopMost(WindowHandle window, bool topMost);
+    static bool moveWindow(WindowHandle window, const QPoint &topLeft);
+    // 请求窗口关闭（WM_CLOSE）
+    static void closeWindow(WindowHandle window);
+
+    // 窗口在屏幕上的区域、客户区尺寸，失败返回空矩形/空尺寸
+    static QRect windowRect(WindowHandle window);
+    static QSize clientSize(WindowHandle window);
+    // 客户区坐标转为屏幕坐标
+    static QPoint clientToScreen(WindowHandle window, const QPoint &point);
+
+    // 显示器
+    static QRect virtualScreenRect();
+    static int monitorCount();
+    static QRect monitorRect(int monitorIndex);
+    // 窗口所在显示器的区域
+    static QRect windowMonitorRect(WindowHandle window);
+
+    // 键鼠输入（SendInput），失败返回false
+    static QPoint cursorPos();
+    static bool sendMouseMove(const QPoint &screenPos);
+    static bool sendMouseButton(bool down);
+    static bool sendKey(quint16 key, bool down);
+    // 以Unicode方式输入一个UTF-16字符（按下并释放），失败时 errorCode 为系统错误码
+    static bool sendUnicodeChar(ushort ch, quint32 *errorCode = nullptr);
+    // 用系统剪贴板接口设置文本，失败时 errorString 说明原因
+    static bool setClipboardText(const QString &text, QString *errorString = nullptr);
+
+    // 进程：按可执行文件名查找正在运行的进程，找到时 processId 为其进程ID
+    static bool findProcess(const QStringList &exeNames, qint64 *processId = nullptr);
+    // 以管理员权限启动程序，失败时 errorCode 为系统错误码
+    static bool startElevated(const QString &path, quint32 *errorCode = nullptr);
+    // 本进程的工作集和私有提交内存（字节）
+    static bool processMemory(quint64 *workingSet, quint64 *privateBytes);
+};
+
+// 屏幕截图缓冲：Windows上为在多次截图之间复用的DIB位图，尺寸变化时才重新创建；
+// 其他平台截图总是失败。不是线程安全的，调用方自己加锁
+class ScreenGrabber
+{
+public:
+    ScreenGrabber() = default;
+    ~ScreenGrabber();
+
+    // 把屏幕区域复制到缓冲，返回自上而下的BGRA像素（行宽 width*4，下次截图或release前有效），
+    // 失败返回nullptr并在 errorString 中说明原因
+    const uchar *grab(const QRect &area, QString *errorString = nullptr);
+
+    // 释放缓冲
+    void release();
+
+private:
+    Q_DISABLE_COPY(ScreenGrabber)
+
+    void *m_dc = nullptr;
+    void *m_bitmap = nullptr;
+    void *m_oldBitmap = nullptr;
+    const uchar *m_bits = nullptr;
+    QSize m_size;
+};
+
+#endif // PLATFORM_H
@@ -0,0 +1,240 @@
+#include "platform.h"
+#include <QFile>
+#include <QGuiApplication>
+#include <QScreen>
+
+// 非Windows平台：没有可操作的窗口和键鼠，只支持回放模式。
+// 桌面窗口用一个固定的非空句柄表示，客户区为整个虚拟屏幕；其他窗口都找不到，输入和截图都失败
+
+namespace {
+
+// 桌面窗口的句柄（只用于和nullptr区分，不会被解引用）
+char g_desktop;
+
+bool isDesktop(WindowHandle window)
+{
+    return window == &g_desktop;
+}
+
+} // namespace
+
+bool Platform::isSupported()
+{
+    return false;
+}
+
+WindowHandle Platform::findWindow(const QString &className, const QString &title)
+{
+    Q_UNUSED(className);
+    Q_UNUSED(title);
+    return nullptr;
+}
+
+WindowHandle Platform::desktopWindow()
+{
+    return &g_desktop;
+}
+
+WindowHandle Platform::foregroundWindow()
+{
+    return nullptr;
+}
+
+bool Platform::setForegroundWindow(WindowHandle window)
+{
+    Q_UNUSED(window);
+    return false;
+}
+
+void Platform::setActiveWindow(WindowHandle window)
+{
+    Q_UNUSED(window);
+}
+
+void Platform::focusWindow(WindowHandle window)
+{
+    Q_UNUSED(window);
+}
+
+void Platform::showWindow(WindowHandle window, ShowMode mode)
+{
+    Q_UNUSED(window);
+    Q_UNUSED(mode);
+}
+
+bool Platform::isWindowVisible(WindowHandle window)
+{
+    return isDesktop(window);
+}
+
+bool Platform::isWindowMinimized(WindowHandle window)
+{
+    Q_UNUSED(window);
+    return false;
+}
+
+bool Platform::isWindowMaximized(WindowHandle window)
+{
+    return isDesktop(window);
+}
+
+bool Platform::setWindowTopMost(WindowHandle window, bool topMost)
+{
+    Q_UNUSED(window);
+    Q_UNUSED(topMost);
+    return false;
+}
+
+bool Platform::moveWindow(WindowHandle window, const QPoint &topLeft)
+{
+    Q_UNUSED(window);
+    Q_UNUSED(topLeft);
+    return false;
+}
+
+void Platform::closeWindow(WindowHandle window)
+{
+    Q_UNUSED(window);
+}
+
+QRect Platform::windowRect(WindowHandle window)
+{
+    return isDesktop(window) ? virtualScreenRect() : QRect();
+}
+
+QSize Platform::clientSize(WindowHandle window)
+{
+    return isDesktop(window) ? virtualScreenRect().size() : QSize();
+}
+
+QPoint Platform::clientToScreen(WindowHandle window, const QPoint &point)
+{
+    return isDesktop(window) ? point + virtualScreenRect().topLeft() : point;
+}
+
+QRect Platform::virtualScreenRect()
+{
+    const QScreen *screen = QGuiApplication::primaryScreen();
+    return screen ? screen->virtualGeometry() : QRect();
+}
+
+int Platform::monitorCount()
+{
+    return QGuiApplication::screens().size();
+}
+
+QRect Platform::monitorRect(int monitorIndex)
+{
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    return monitorIndex >= 0 && monitorIndex < screens.size() ? screens.at(monitorIndex)->geometry() : QRect();
+}
+
+QRect Platform::windowMonitorRect(WindowHandle window)
+{
+    Q_UNUSED(window);
+    return QRect();
+}
+
+QPoint Platform::cursorPos()
+{
+    return QPoint();
+}
+
+bool Platform::sendMouseMove(const QPoint &screenPos)
+{
+    Q_UNUSED(screenPos);
+    return false;
+}
+
+bool Platform::sendMouseButton(bool down)
+{
+    Q_UNUSED(down);
+    return false;
+}
+
+bool Platform::sendKey(quint16 key, bool down)
+{
+    Q_UNUSED(key);
+    Q_UNUSED(down);
+    return false;
+}
+
+bool Platform::sendUnicodeChar(ushort ch, quint32 *errorCode)
+{
+    Q_UNUSED(ch);
+    if (errorCode) {
+        *errorCode = 0;
+    }
+    return false;
+}
+
+bool Platform::setClipboardText(const QString &text, QString *errorString)
+{
+    Q_UNUSED(text);
+    if (errorString) {
+        *errorString = "当前平台不支持系统剪贴板";
+    }
+    return false;
+}
+
+bool Platform::findProcess(const QStringList &exeNames, qint64 *processId)
+{
+    Q_UNUSED(exeNames);
+    Q_UNUSED(processId);
+    return false;
+}
+
+bool Platform::startElevated(const QString &path, quint32 *errorCode)
+{
+    Q_UNUSED(path);
+    if (errorCode) {
+        *errorCode = 0;
+    }
+    return false;
+}
+
+bool Platform::processMemory(quint64 *workingSet, quint64 *privateBytes)
+{
+    // Linux：常驻内存和匿名常驻内存（对应工作集和私有内存），单位为kB
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    bool hasWorkingSet = false;
+    bool hasPrivate = false;
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2) {
+            continue;
+        }
+        if (fields.at(0) == "VmRSS:") {
+            *workingSet = fields.at(1).toULongLong(&hasWorkingSet) * 1024;
+        } else if (fields.at(0) == "RssAnon:") {
+            *privateBytes = fields.at(1).toULongLong(&hasPrivate) * 1024;
+        }
+    }
+    return hasWorkingSet && hasPrivate;
+}
+
+ScreenGrabber::~ScreenGrabber()
+{
+    release();
+}
+
+const uchar *ScreenGrabber::grab(const QRect &area, QString *errorString)
+{
+    Q_UNUSED(area);
+    if (errorString) {
+        *errorString = "当前平台不支持屏幕截图，请使用回放模式";
+    }
+    return nullptr;
+}
+
+void ScreenGrabber::release()
+{
+    m_dc = nullptr;
+    m_bitmap = nullptr;
+    m_oldBitmap = nullptr;
+    m_bits = nullptr;
+    m_size = QSize();
+}
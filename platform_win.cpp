@@ -0,0 +1,438 @@
+#include "platform.h"
+#include <windows.h>
+#include <tlhelp32.h>
+#include <psapi.h>
+#include <cstring>
+
+namespace {
+
+HWND nativeHandle(WindowHandle window)
+{
+    return static_cast<HWND>(window);
+}
+
+LPCWSTR wideOrNull(const QString &text)
+{
+    return text.isEmpty() ? nullptr : reinterpret_cast<LPCWSTR>(text.utf16());
+}
+
+QRect toQRect(const RECT &rect)
+{
+    return QRect(rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top);
+}
+
+bool sendInputs(INPUT *inputs, UINT count)
+{
+    return SendInput(count, inputs, sizeof(INPUT)) == count;
+}
+
+} // namespace
+
+bool Platform::isSupported()
+{
+    return true;
+}
+
+WindowHandle Platform::findWindow(const QString &className, const QString &title)
+{
+    return FindWindowW(wideOrNull(className), wideOrNull(title));
+}
+
+WindowHandle Platform::desktopWindow()
+{
+    return GetDesktopWindow();
+}
+
+WindowHandle Platform::foregroundWindow()
+{
+    return GetForegroundWindow();
+}
+
+bool Platform::setForegroundWindow(WindowHandle window)
+{
+    return SetForegroundWindow(nativeHandle(window));
+}
+
+void Platform::setActiveWindow(WindowHandle window)
+{
+    SetActiveWindow(nativeHandle(window));
+}
+
+void Platform::focusWindow(WindowHandle window)
+{
+    // 前台窗口属于其他线程时先关联输入队列，SetFocus才能生效
+    DWORD foregroundThreadId = GetWindowThreadProcessId(GetForegroundWindow(), nullptr);
+    DWORD currentThreadId = GetCurrentThreadId();
+    if (foregroundThreadId != currentThreadId) {
+        AttachThreadInput(currentThreadId, foregroundThreadId, TRUE);
+        SetFocus(nativeHandle(window));
+        AttachThreadInput(currentThreadId, foregroundThreadId, FALSE);
+    } else {
+        SetFocus(nativeHandle(window));
+    }
+}
+
+void Platform::showWindow(WindowHandle window, ShowMode mode)
+{
+    switch (mode) {
+    case ShowRestore:
+        ShowWindow(nativeHandle(window), SW_RESTORE);
+        break;
+    case ShowMaximized:
+        ShowWindow(nativeHandle(window), SW_MAXIMIZE);
+        break;
+    default:
+        ShowWindow(nativeHandle(window), SW_SHOW);
+        break;
+    }
+}
+
+bool Platform::isWindowVisible(WindowHandle window)
+{
+    return IsWindowVisible(nativeHandle(window));
+}
+
+bool Platform::isWindowMinimized(WindowHandle window)
+{
+    return IsIconic(nativeHandle(window));
+}
+
+bool Platform::isWindowMaximized(WindowHandle window)
+{
+    WINDOWPLACEMENT placement;
+    placement.length = sizeof(WINDOWPLACEMENT);
+    return GetWindowPlacement(nativeHandle(window), &placement) && placement.showCmd == SW_MAXIMIZE;
+}
+
+bool Platform::setWindowTopMost(WindowHandle window, bool topMost)
+{
+    return SetWindowPos(nativeHandle(window), topMost ? HWND_TOPMOST : HWND_NOTOPMOST,
+                        0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+}
+
+bool Platform::moveWindow(WindowHandle window, const QPoint &topLeft)
+{
+    return SetWindowPos(nativeHandle(window), NULL, topLeft.x(), topLeft.y(), 0, 0, SWP_NOSIZE | SWP_NOZORDER);
+}
+
+void Platform::closeWindow(WindowHandle window)
+{
+    SendMessage(nativeHandle(window), WM_CLOSE, 0, 0);
+}
+
+QRect Platform::windowRect(WindowHandle window)
+{
+    RECT rect;
+    if (!window || !GetWindowRect(nativeHandle(window), &rect)) {
+        return QRect();
+    }
+    return toQRect(rect);
+}
+
+QSize Platform::clientSize(WindowHandle window)
+{
+    RECT rect;
+    if (!window || !GetClientRect(nativeHandle(window), &rect)) {
+        return QSize();
+    }
+    return QSize(rect.right - rect.left, rect.bottom - rect.top);
+}
+
+QPoint Platform::clientToScreen(WindowHandle window, const QPoint &point)
+{
+    POINT screenPos = {point.x(), point.y()};
+    ClientToScreen(nativeHandle(window), &screenPos);
+    return QPoint(screenPos.x, screenPos.y);
+}
+
+QRect Platform::virtualScreenRect()
+{
+    return QRect(GetSystemMetrics(SM_XVIRTUALSCREEN), GetSystemMetrics(SM_YVIRTUALSCREEN),
+                 GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN));
+}
+
+int Platform::monitorCount()
+{
+    return GetSystemMetrics(SM_CMONITORS);
+}
+
+QRect Platform::monitorRect(int monitorIndex)
+{
+    DISPLAY_DEVICE displayDevice;
+    displayDevice.cb = sizeof(DISPLAY_DEVICE);
+    if (!EnumDisplayDevices(NULL, monitorIndex, &displayDevice, 0)) {
+        return QRect();
+    }
+    DEVMODE devMode;
+    devMode.dmSize = sizeof(DEVMODE);
+    if (!EnumDisplaySettings(displayDevice.DeviceName, ENUM_CURRENT_SETTINGS, &devMode)) {
+        return QRect();
+    }
+    return QRect(devMode.dmPosition.x, devMode.dmPosition.y, devMode.dmPelsWidth, devMode.dmPelsHeight);
+}
+
+QRect Platform::windowMonitorRect(WindowHandle window)
+{
+    HMONITOR monitor = MonitorFromWindow(nativeHandle(window), MONITOR_DEFAULTTONEAREST);
+    if (!monitor) {
+        return QRect();
+    }
+    MONITORINFO monitorInfo;
+    monitorInfo.cbSize = sizeof(MONITORINFO);
+    if (!GetMonitorInfo(monitor, &monitorInfo)) {
+        return QRect();
+    }
+    return toQRect(monitorInfo.rcMonitor);
+}
+
+QPoint Platform::cursorPos()
+{
+    POINT point = {0, 0};
+    GetCursorPos(&point);
+    return QPoint(point.x, point.y);
+}
+
+bool Platform::sendMouseMove(const QPoint &screenPos)
+{
+    // 使用虚拟屏幕的绝对坐标（SM_CXSCREEN只是主显示器的尺寸）
+    const QRect screen = virtualScreenRect();
+    INPUT input;
+    ZeroMemory(&input, sizeof(INPUT));
+    input.type = INPUT_MOUSE;
+    input.mi.dx = (LONG)((screenPos.x() - screen.x()) * (65535.0 / screen.width()));
+    input.mi.dy = (LONG)((screenPos.y() - screen.y()) * (65535.0 / screen.height()));
+    input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+    return sendInputs(&input, 1);
+}
+
+bool Platform::sendMouseButton(bool down)
+{
+    INPUT input;
+    ZeroMemory(&input, sizeof(INPUT));
+    input.type = INPUT_MOUSE;
+    input.mi.dwFlags = down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+    return sendInputs(&input, 1);
+}
+
+bool Platform::sendKey(quint16 key, bool down)
+{
+    INPUT input;
+    ZeroMemory(&input, sizeof(INPUT));
+    input.type = INPUT_KEYBOARD;
+    input.ki.wVk = key;
+    input.ki.dwFlags = down ? 0 : KEYEVENTF_KEYUP;
+    return sendInputs(&input, 1);
+}
+
+bool Platform::sendUnicodeChar(ushort ch, quint32 *errorCode)
+{
+    // 使用wScan而非VK，按下和释放一起发送
+    INPUT input[2];
+    ZeroMemory(input, sizeof(input));
+    input[0].type = INPUT_KEYBOARD;
+    input[0].ki.wScan = ch;
+    input[0].ki.dwFlags = KEYEVENTF_UNICODE;
+    input[1].type = INPUT_KEYBOARD;
+    input[1].ki.wScan = ch;
+    input[1].ki.dwFlags = KEYEVENTF_UNICODE | KEYEVENTF_KEYUP;
+    if (sendInputs(input, 2)) {
+        return true;
+    }
+    if (errorCode) {
+        *errorCode = GetLastError();
+    }
+    return false;
+}
+
+bool Platform::setClipboardText(const QString &text, QString *errorString)
+{
+    const size_t bytes = size_t(text.length() + 1) * sizeof(wchar_t);
+    HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, bytes);
+    if (!hGlobal) {
+        if (errorString) {
+            *errorString = "无法分配全局内存";
+        }
+        return false;
+    }
+
+    wchar_t *pGlobal = static_cast<wchar_t *>(GlobalLock(hGlobal));
+    if (!pGlobal) {
+        GlobalFree(hGlobal);
+        if (errorString) {
+            *errorString = "无法锁定全局内存";
+        }
+        return false;
+    }
+    memcpy(pGlobal, text.utf16(), bytes);
+    GlobalUnlock(hGlobal);
+
+    if (!OpenClipboard(NULL)) {
+        GlobalFree(hGlobal);
+        if (errorString) {
+            *errorString = "无法打开剪贴板";
+        }
+        return false;
+    }
+    EmptyClipboard();
+    // 设置成功后内存归剪贴板所有
+    if (!SetClipboardData(CF_UNICODETEXT, hGlobal)) {
+        CloseClipboard();
+        GlobalFree(hGlobal);
+        if (errorString) {
+            *errorString = "无法设置剪贴板数据";
+        }
+        return false;
+    }
+    CloseClipboard();
+    return true;
+}
+
+bool Platform::findProcess(const QStringList &exeNames, qint64 *processId)
+{
+    HANDLE processesSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (processesSnapshot == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    PROCESSENTRY32W processInfo;
+    processInfo.dwSize = sizeof(processInfo);
+    bool found = false;
+    for (BOOL more = Process32FirstW(processesSnapshot, &processInfo); more && !found;
+         more = Process32NextW(processesSnapshot, &processInfo)) {
+        const QString exeName = QString::fromWCharArray(processInfo.szExeFile);
+        if (exeNames.contains(exeName, Qt::CaseInsensitive)) {
+            found = true;
+            if (processId) {
+                *processId = processInfo.th32ProcessID;
+            }
+        }
+    }
+    CloseHandle(processesSnapshot);
+    return found;
+}
+
+bool Platform::startElevated(const QString &path, quint32 *errorCode)
+{
+    SHELLEXECUTEINFOW shExInfo;
+    ZeroMemory(&shExInfo, sizeof(shExInfo));
+    shExInfo.cbSize = sizeof(SHELLEXECUTEINFOW);
+    shExInfo.fMask = SEE_MASK_NOCLOSEPROCESS;
+    shExInfo.lpVerb = L"runas";  // 请求管理员权限
+    shExInfo.lpFile = reinterpret_cast<LPCWSTR>(path.utf16());
+    shExInfo.nShow = SW_SHOW;
+    if (!ShellExecuteExW(&shExInfo)) {
+        if (errorCode) {
+            *errorCode = GetLastError();
+        }
+        return false;
+    }
+    if (shExInfo.hProcess) {
+        CloseHandle(shExInfo.hProcess);
+    }
+    return true;
+}
+
+bool Platform::processMemory(quint64 *workingSet, quint64 *privateBytes)
+{
+    PROCESS_MEMORY_COUNTERS_EX memoryCounters;
+    memset(&memoryCounters, 0, sizeof(memoryCounters));
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&memoryCounters),
+                              sizeof(memoryCounters))) {
+        return false;
+    }
+    *workingSet = memoryCounters.WorkingSetSize;
+    *privateBytes = memoryCounters.PrivateUsage;
+    return true;
+}
+
+ScreenGrabber::~ScreenGrabber()
+{
+    release();
+}
+
+const uchar *ScreenGrabber::grab(const QRect &area, QString *errorString)
+{
+    // 获取屏幕DC
+    HDC hScreenDC = GetDC(NULL);
+    if (!hScreenDC) {
+        if (errorString) {
+            *errorString = "获取屏幕DC失败";
+        }
+        return nullptr;
+    }
+
+    // 尺寸变化时重新创建DIB位图
+    if (!m_dc || m_size != area.size()) {
+        release();
+        HDC dc = CreateCompatibleDC(hScreenDC);
+        if (!dc) {
+            ReleaseDC(NULL, hScreenDC);
+            if (errorString) {
+                *errorString = "创建兼容DC失败";
+            }
+            return nullptr;
+        }
+        m_dc = dc;
+
+        // 准备位图信息
+        BITMAPINFO bmpInfo;
+        memset(&bmpInfo, 0, sizeof(BITMAPINFO));
+        bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmpInfo.bmiHeader.biWidth = area.width();
+        bmpInfo.bmiHeader.biHeight = -area.height(); // 负高度表示自上而下的位图
+        bmpInfo.bmiHeader.biPlanes = 1;
+        bmpInfo.bmiHeader.biBitCount = 32;
+        bmpInfo.bmiHeader.biCompression = BI_RGB;
+
+        // DIB位图的像素内存可以直接读取，省去GetDIBits复制
+        void *bits = nullptr;
+        HBITMAP bitmap = CreateDIBSection(hScreenDC, &bmpInfo, DIB_RGB_COLORS, &bits, NULL, 0);
+        if (!bitmap || !bits) {
+            if (bitmap) {
+                DeleteObject(bitmap);
+            }
+            release();
+            ReleaseDC(NULL, hScreenDC);
+            if (errorString) {
+                *errorString = "创建DIB位图失败";
+            }
+            return nullptr;
+        }
+        m_bitmap = bitmap;
+        m_oldBitmap = SelectObject(dc, bitmap);
+        m_bits = static_cast<const uchar *>(bits);
+        m_size = area.size();
+    }
+
+    // 复制屏幕内容到DIB位图
+    BOOL result = BitBlt(static_cast<HDC>(m_dc), 0, 0, area.width(), area.height(),
+                         hScreenDC, area.x(), area.y(), SRCCOPY);
+    ReleaseDC(NULL, hScreenDC);
+    if (!result) {
+        if (errorString) {
+            *errorString = "复制屏幕内容失败";
+        }
+        return nullptr;
+    }
+    // 读取像素内存前确保GDI已完成绘制
+    GdiFlush();
+    return m_bits;
+}
+
+void ScreenGrabber::release()
+{
+    if (m_dc && m_oldBitmap) {
+        SelectObject(static_cast<HDC>(m_dc), static_cast<HGDIOBJ>(m_oldBitmap));
+    }
+    if (m_bitmap) {
+        DeleteObject(static_cast<HGDIOBJ>(m_bitmap));
+    }
+    if (m_dc) {
+        DeleteDC(static_cast<HDC>(m_dc));
+    }
+    m_dc = nullptr;
+    m_bitmap = nullptr;
+    m_oldBitmap = nullptr;
+    m_bits = nullptr;
+    m_size = QSize();
+}
@@ -0,0 +1,576 @@
+#include "questionbank.h"
+#include "csvimporter.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// 文件格式版本（2：文件头增加属性文件的大小和修改时间）
+constexpr quint32 kBankVersion = 2;
+
+// 字符串区写入缓冲区大小
+constexpr int kBlobChunkSize = 1024 * 1024;
+
+// 分类名最多254个，超出的问题记为无分类
+constexpr int kMaxCategories = 0xFE;
+
+// 文件头（128字节）
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint64 count;
+    quint64 blobOffset;         // 字符串区起始位置（字节）
+    quint64 blobUnits;          // 字符串区长度（UTF-16码元）
+    quint64 offsetTableOffset;  // 偏移表位置，8字节对齐
+    quint64 attributesOffset;   // 属性表位置
+    quint64 categoryOffset;     // 分类名表位置
+    quint64 categoryCount;
+    quint64 sourcePathHash;
+    qint64 sourceSize;
+    qint64 sourceModified;
+    char contentId[20];
+    qint64 attributesSize;      // 属性文件大小，-1表示不存在
+    qint64 attributesModified;  // 属性文件修改时间
+    char reserved[4];
+};
+
+static_assert(sizeof(FileHeader) == 128, "QuestionBank header must be 128 bytes");
+static_assert(sizeof(QuestionBank::Attributes) == 4, "QuestionBank attributes must be 4 bytes");
+// 文件直接按内存布局读写，目标平台（x86/x64 Windows）均为小端
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "QuestionBank requires a little-endian host");
+
+const char kMagic[4] = {'W', 'B', 'Q', 'B'};
+
+// 问题库文件名：Questions-<摘要>.wbqb
+const char kBankPrefix[] = "Questions";
+const char kBankSuffix[] = ".wbqb";
+
+// 属性文件的大小和修改时间，不存在时大小为-1
+void attributesStamp(const QString &sourcePath, qint64 *size, qint64 *modified)
+{
+    const QFileInfo info(QuestionBank::attributesPathFor(sourcePath));
+    const bool exists = !info.filePath().isEmpty() && info.exists();
+    *size = exists ? info.size() : -1;
+    *modified = exists ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+bool writeAll(QSaveFile &file, const void *data, qint64 size)
+{
+    return size == 0 || file.write(static_cast<const char *>(data), size) == size;
+}
+
+bool writePadding(QSaveFile &file, int alignment)
+{
+    static const char zeros[8] = {};
+    const qint64 padding = (alignment - file.pos() % alignment) % alignment;
+    return writeAll(file, zeros, padding);
+}
+
+} // namespace
+
+QuestionBank::QuestionBank()
+{
+}
+
+QuestionBank::~QuestionBank()
+{
+    close();
+}
+
+bool QuestionBank::open(const QString &path, QString *errorString)
+{
+    close();
+
+    auto fail = [this, errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        close();
+        return false;
+    };
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(FileHeader))) {
+        return fail("文件过小");
+    }
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        return fail("内存映射失败: " + m_file.errorString());
+    }
+
+    FileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kBankVersion) {
+        return fail("文件格式或版本不匹配");
+    }
+
+    // 只校验各区域边界，不遍历问题
+    const quint64 size = quint64(m_size);
+    if (header.count > quint64(std::numeric_limits<int>::max() - 1)
+        || header.blobOffset != sizeof(FileHeader)
+        || header.blobUnits > (size - header.blobOffset) / 2
+        || header.offsetTableOffset % 8 != 0
+        || header.offsetTableOffset > size
+        || (header.count + 1) > (size - header.offsetTableOffset) / 8
+        || header.attributesOffset > size
+        || header.count > (size - header.attributesOffset) / sizeof(Attributes)
+        || header.categoryOffset > size
+        || header.categoryCount > kMaxCategories) {
+        return fail("文件已损坏");
+    }
+
+    m_count = header.count;
+    m_blob = reinterpret_cast<const QChar *>(m_data + header.blobOffset);
+    m_blobUnits = header.blobUnits;
+    m_offsets = reinterpret_cast<const quint64 *>(m_data + header.offsetTableOffset);
+    m_attributes = reinterpret_cast<const Attributes *>(m_data + header.attributesOffset);
+    if (m_offsets[m_count] != m_blobUnits) {
+        return fail("文件已损坏");
+    }
+
+    // 分类名表：quint32长度 + UTF-16文本
+    quint64 position = header.categoryOffset;
+    for (quint64 i = 0; i < header.categoryCount; ++i) {
+        quint32 units = 0;
+        if (position + sizeof(units) > size) {
+            return fail("文件已损坏");
+        }
+        std::memcpy(&units, m_data + position, sizeof(units));
+        position += sizeof(units);
+        if (quint64(units) * 2 > size - position) {
+            return fail("文件已损坏");
+        }
+        m_categories.append(QString(reinterpret_cast<const QChar *>(m_data + position), units));
+        position += quint64(units) * 2;
+    }
+
+    m_contentId = QString::fromLatin1(QByteArray(header.contentId, sizeof(header.contentId)).toHex());
+    m_sourcePathHash = header.sourcePathHash;
+    m_sourceSize = header.sourceSize;
+    m_sourceModified = header.sourceModified;
+    m_attributesSize = header.attributesSize;
+    m_attributesModified = header.attributesModified;
+    return true;
+}
+
+void QuestionBank::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_size = 0;
+    m_count = 0;
+    m_blob = nullptr;
+    m_blobUnits = 0;
+    m_offsets = nullptr;
+    m_attributes = nullptr;
+    m_categories.clear();
+    m_contentId.clear();
+}
+
+QStringView QuestionBank::questionView(int index) const
+{
+    if (index < 0 || quint64(index) >= m_count) {
+        return QStringView();
+    }
+    const quint64 begin = m_offsets[index];
+    const quint64 end = m_offsets[index + 1];
+    if (begin > end || end > m_blobUnits) {
+        return QStringView();
+    }
+    return QStringView(m_blob + begin, qsizetype(end - begin));
+}
+
+QString QuestionBank::question(int index) const
+{
+    return questionView(index).toString();
+}
+
+QuestionBank::Attributes QuestionBank::attributes(int index) const
+{
+    if (index < 0 || quint64(index) >= m_count) {
+        return Attributes();
+    }
+    return m_attributes[index];
+}
+
+QString QuestionBank::category(int index) const
+{
+    const quint8 category = attributes(index).category;
+    return category < m_categories.size() ? m_categories.at(category) : QString();
+}
+
+QStringList QuestionBank::toStringList() const
+{
+    QStringList list;
+    list.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        list.append(question(i));
+    }
+    return list;
+}
+
+quint64 QuestionBank::pathHash(const QString &path)
+{
+    const QByteArray digest = QCryptographicHash::hash(
+        QFileInfo(path).absoluteFilePath().toLower().toUtf8(), QCryptographicHash::Sha1);
+    return qFromLittleEndian<quint64>(digest.constData());
+}
+
+bool QuestionBank::isUpToDate(const QString &sourcePath) const
+{
+    const QFileInfo sourceInfo(sourcePath);
+    qint64 attributesSize = 0;
+    qint64 attributesModified = 0;
+    attributesStamp(sourcePath, &attributesSize, &attributesModified);
+    return isOpen()
+           && m_sourcePathHash == pathHash(sourcePath)
+           && m_sourceSize == sourceInfo.size()
+           && m_sourceModified == sourceInfo.lastModified().toMSecsSinceEpoch()
+           && m_attributesSize == attributesSize
+           && m_attributesModified == attributesModified;
+}
+
+QString QuestionBank::attributesPathFor(const QString &sourcePath)
+{
+    if (sourcePath.isEmpty() || sourcePath.endsWith(".csv", Qt::CaseInsensitive)) {
+        return QString();
+    }
+    const QFileInfo sourceInfo(sourcePath);
+    return sourceInfo.absolutePath() + "/" + sourceInfo.completeBaseName() + ".attributes.tsv";
+}
+
+QString QuestionBank::bankPathFor(const QString &bankDir, const QString &sourcePath)
+{
+    const QFileInfo sourceInfo(sourcePath);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(sourceInfo.absoluteFilePath().toLower().toUtf8());
+    hash.addData(QByteArray::number(sourceInfo.size()));
+    hash.addData(QByteArray::number(sourceInfo.lastModified().toMSecsSinceEpoch()));
+    qint64 attributesSize = 0;
+    qint64 attributesModified = 0;
+    attributesStamp(sourcePath, &attributesSize, &attributesModified);
+    hash.addData(QByteArray::number(attributesSize));
+    hash.addData(QByteArray::number(attributesModified));
+    return QDir(bankDir).filePath(QString("%1-%2%3").arg(kBankPrefix, QString::fromLatin1(hash.result().toHex().left(16)),
+                                                           kBankSuffix));
+}
+
+std::shared_ptr<QuestionBank> QuestionBank::openForSource(const QString &sourcePath, const QString &bankDir,
+                                                          QString *errorString, bool *built)
+{
+    if (built) {
+        *built = false;
+    }
+    const QString bankPath = bankPathFor(bankDir, sourcePath);
+    auto bank = std::make_shared<QuestionBank>();
+    if (bank->open(bankPath) && bank->isUpToDate(sourcePath)) {
+        return bank;
+    }
+
+    // 同名文件只可能是生成中断留下的损坏文件，旧版本的问题库使用其他文件名，不会被替换
+    bank->close();
+    if (!build(sourcePath, bankPath, errorString) || !bank->open(bankPath, errorString)) {
+        return nullptr;
+    }
+    if (built) {
+        *built = true;
+    }
+    return bank;
+}
+
+int QuestionBank::removeStaleBanks(const QString &bankDir, const QString &keepPath)
+{
+    const QFileInfo keep(keepPath);
+    int removed = 0;
+    const QFileInfoList banks = QDir(bankDir).entryInfoList({QString("%1*%2").arg(kBankPrefix, kBankSuffix)}, QDir::Files);
+    for (const QFileInfo &bank : banks) {
+        if (bank != keep && QFile::remove(bank.absoluteFilePath())) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+void QuestionBank::diff(const QuestionBank &before, const QuestionBank &after, QStringList *added, QStringList *removed)
+{
+    // 内容摘要相同时直接返回；否则按问题文本的哈希排序旧库的序号，新库逐条二分查找并用映射的文本确认，
+    // 只拷贝增加和删除的问题，不把整个问题库读入内存
+    if (before.contentId() == after.contentId()) {
+        return;
+    }
+
+    struct Entry {
+        size_t hash;
+        int index;
+    };
+    QVector<Entry> entries(before.count());
+    for (int i = 0; i < before.count(); ++i) {
+        entries[i] = {qHash(before.questionView(i)), i};
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.index < b.index;
+    });
+
+    QVector<bool> matched(before.count(), false);
+    for (int j = 0; j < after.count(); ++j) {
+        const QStringView question = after.questionView(j);
+        const size_t hash = qHash(question);
+        auto it = std::lower_bound(entries.cbegin(), entries.cend(), hash, [](const Entry &entry, size_t value) {
+            return entry.hash < value;
+        });
+        bool found = false;
+        for (; it != entries.cend() && it->hash == hash; ++it) {
+            if (!matched[it->index] && before.questionView(it->index) == question) {
+                matched[it->index] = true;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            added->append(question.toString());
+        }
+    }
+    for (int i = 0; i < before.count(); ++i) {
+        if (!matched[i]) {
+            removed->append(before.question(i));
+        }
+    }
+}
+
+quint16 QuestionBank::parsePriority(const QString &text)
+{
+    const QString value = text.trimmed().toLower();
+    if (value.isEmpty()) {
+        return kDefaultPriority;
+    }
+    bool ok = false;
+    const int number = value.toInt(&ok);
+    if (ok) {
+        return quint16(qBound(0, number, 0xFFFF));
+    }
+    if (value == "高" || value == "high") {
+        return 3;
+    }
+    if (value == "中" || value == "medium" || value == "normal") {
+        return 2;
+    }
+    if (value == "低" || value == "low") {
+        return 1;
+    }
+    return kDefaultPriority;
+}
+
+quint8 QuestionBank::parseDifficulty(const QString &text)
+{
+    const QString value = text.trimmed().toLower();
+    if (value == "简单" || value == "容易" || value == "easy" || value == "0") {
+        return 0;
+    }
+    if (value == "中等" || value == "一般" || value == "medium" || value == "1") {
+        return 1;
+    }
+    if (value == "困难" || value == "难" || value == "hard" || value == "2") {
+        return 2;
+    }
+    return 0xFF;
+}
+
+bool QuestionBank::build(const QString &sourcePath, const QString &bankPath, QString *errorString)
+{
+    QFileInfo sourceInfo(sourcePath);
+    // 先记录源文件和属性文件的状态，读取过程中被修改时下次检查会发现过期
+    const qint64 sourceSize = sourceInfo.size();
+    const qint64 sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+    qint64 attributesSize = 0;
+    qint64 attributesModified = 0;
+    attributesStamp(sourcePath, &attributesSize, &attributesModified);
+    QuestionBankWriter writer(bankPath);
+    if (!writer.open()) {
+        if (errorString) {
+            *errorString = writer.errorString();
+        }
+        return false;
+    }
+
+    if (sourcePath.endsWith(".csv", Qt::CaseInsensitive)) {
+        CsvImporter::Result result = CsvImporter::parse(sourcePath, [&writer](const CsvImporter::Record &record) {
+            writer.add(record.question, parsePriority(record.priority), record.category,
+                       parseDifficulty(record.difficulty));
+            return true;
+        });
+        if (!result.ok) {
+            if (errorString) {
+                *errorString = result.errorString;
+            }
+            return false;
+        }
+    } else {
+        // CSV导入时生成的属性文件：问题\t优先级\t分类\t难度
+        struct SourceAttributes {
+            QString priority;
+            QString category;
+            QString difficulty;
+        };
+        QHash<QString, SourceAttributes> sourceAttributes;
+        QFile attributesFile(attributesPathFor(sourcePath));
+        if (attributesFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream in(&attributesFile);
+            while (!in.atEnd()) {
+                const QStringList fields = in.readLine().split('\t');
+                if (fields.size() >= 2 && !fields.first().isEmpty()) {
+                    sourceAttributes.insert(fields.at(0), {fields.value(1), fields.value(2), fields.value(3)});
+                }
+            }
+        }
+
+        QFile source(sourcePath);
+        if (!source.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            if (errorString) {
+                *errorString = source.errorString();
+            }
+            return false;
+        }
+        QTextStream in(&source);
+        QString line;
+        while (in.readLineInto(&line)) {
+            const QString question = line.trimmed();
+            if (question.isEmpty()) {
+                continue;
+            }
+            const auto it = sourceAttributes.constFind(question);
+            if (it != sourceAttributes.constEnd()) {
+                writer.add(question, parsePriority(it->priority), it->category, parseDifficulty(it->difficulty));
+            } else {
+                writer.add(question, kDefaultPriority, QString(), 0xFF);
+            }
+        }
+    }
+
+    if (!writer.commit(sourcePath, sourceSize, sourceModified, attributesSize, attributesModified)) {
+        if (errorString) {
+            *errorString = writer.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+QuestionBankWriter::QuestionBankWriter(const QString &path)
+    : m_file(path)
+    , m_hash(QCryptographicHash::Sha1)
+{
+}
+
+bool QuestionBankWriter::open()
+{
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    // 先写入占位文件头，提交时回填
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    m_blobBuffer.reserve(kBlobChunkSize + 4096);
+    m_failed = !writeAll(m_file, &header, sizeof(header));
+    return !m_failed;
+}
+
+void QuestionBankWriter::add(QStringView question, quint16 priority, const QString &category, quint8 difficulty)
+{
+    m_offsets.append(m_blobUnits);
+
+    const char *bytes = reinterpret_cast<const char *>(question.utf16());
+    const qsizetype size = question.size() * 2;
+    m_blobBuffer.append(bytes, size);
+    m_blobUnits += quint64(question.size());
+    m_hash.addData(QByteArrayView(bytes, size));
+    m_hash.addData(QByteArrayView("\n\0", 2));
+
+    QuestionBank::Attributes attributes;
+    attributes.priority = priority;
+    attributes.difficulty = difficulty;
+    if (!category.isEmpty()) {
+        auto it = m_categoryIndex.constFind(category);
+        if (it != m_categoryIndex.constEnd()) {
+            attributes.category = it.value();
+        } else if (m_categories.size() < kMaxCategories) {
+            attributes.category = quint8(m_categories.size());
+            m_categoryIndex.insert(category, attributes.category);
+            m_categories.append(category);
+        }
+    }
+    m_attributes.append(attributes);
+
+    if (m_blobBuffer.size() >= kBlobChunkSize) {
+        flushBlob();
+    }
+}
+
+bool QuestionBankWriter::flushBlob()
+{
+    if (!m_failed && !writeAll(m_file, m_blobBuffer.constData(), m_blobBuffer.size())) {
+        m_failed = true;
+    }
+    m_blobBuffer.clear();
+    return !m_failed;
+}
+
+bool QuestionBankWriter::commit(const QString &sourcePath, qint64 sourceSize, qint64 sourceModified,
+                                qint64 attributesSize, qint64 attributesModified)
+{
+    if (!flushBlob()) {
+        m_file.cancelWriting();
+        return false;
+    }
+    m_offsets.append(m_blobUnits);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kBankVersion;
+    header.count = quint64(m_attributes.size());
+    header.blobOffset = sizeof(FileHeader);
+    header.blobUnits = m_blobUnits;
+
+    bool ok = writePadding(m_file, 8);
+    header.offsetTableOffset = quint64(m_file.pos());
+    ok = ok && writeAll(m_file, m_offsets.constData(), m_offsets.size() * qint64(sizeof(quint64)));
+    header.attributesOffset = quint64(m_file.pos());
+    ok = ok && writeAll(m_file, m_attributes.constData(), m_attributes.size() * qint64(sizeof(QuestionBank::Attributes)));
+    header.categoryOffset = quint64(m_file.pos());
+    header.categoryCount = quint64(m_categories.size());
+    for (const QString &category : m_categories) {
+        const quint32 units = quint32(category.size());
+        ok = ok && writeAll(m_file, &units, sizeof(units))
+             && writeAll(m_file, category.utf16(), qint64(units) * 2);
+    }
+
+    header.sourcePathHash = QuestionBank::pathHash(sourcePath);
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+    header.attributesSize = attributesSize;
+    header.attributesModified = attributesModified;
+    const QByteArray digest = m_hash.result();
+    std::memcpy(header.contentId, digest.constData(), qMin<qsizetype>(digest.size(), sizeof(header.contentId)));
+
+    ok = ok && m_file.seek(0) && writeAll(m_file, &header, sizeof(header));
+    if (!ok) {
+        m_file.cancelWriting();
+        return false;
+    }
+    return m_file.commit();
+}
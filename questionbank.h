@@ -0,0 +1,155 @@
+#ifndef QUESTIONBANK_H
+#define QUESTIONBANK_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QVector>
+#include <QHash>
+#include <QCryptographicHash>
+#include <memory>
+
+// 二进制问题库（.wbqb）
+// 文件布局（小端）：
+//   文件头 | UTF-16字符串区 | 偏移表(count+1个quint64) | 属性表(count条) | 分类名表
+// 偏移表以UTF-16码元为单位指向字符串区，第i个问题为 [offset[i], offset[i+1])。
+// 文件通过内存映射只读打开，打开时只校验文件头，按需访问单个问题，
+// 因此打开耗时与问题数量无关，多个进程/线程共享同一份物理页。
+// 文件名带源文件信息的摘要，源文件修改后生成到新文件：Windows下无法替换仍被映射的文件，
+// 旧问题库在比较完成、不再被映射后才删除。
+class QuestionBank
+{
+public:
+    // 每个问题的属性
+    struct Attributes {
+        quint16 priority = 0;      // 优先级权重
+        quint8 category = 0xFF;    // 分类名序号，0xFF表示无分类
+        quint8 difficulty = 0xFF;  // 难度（与QuestionManager::QuestionDifficulty一致），0xFF表示未设置
+    };
+
+    // 默认优先级（对应"中"）
+    static constexpr quint16 kDefaultPriority = 2;
+
+    QuestionBank();
+    ~QuestionBank();
+
+    QuestionBank(const QuestionBank &) = delete;
+    QuestionBank &operator=(const QuestionBank &) = delete;
+
+    // 映射并校验问题库文件
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString path() const { return m_file.fileName(); }
+
+    // 问题数量
+    int count() const { return static_cast<int>(m_count); }
+
+    // 第index个问题（只拷贝这一个字符串）
+    QString question(int index) const;
+    QStringView questionView(int index) const;
+
+    // 问题属性
+    Attributes attributes(int index) const;
+    quint16 priority(int index) const { return attributes(index).priority; }
+    quint8 difficulty(int index) const { return attributes(index).difficulty; }
+    QString category(int index) const;
+
+    // 分类名列表
+    QStringList categories() const { return m_categories; }
+
+    // 内容摘要（问题文本的SHA-1，十六进制）
+    QString contentId() const { return m_contentId; }
+
+    // 生成问题库时记录的源文件信息，用于判断是否需要重建
+    quint64 sourcePathHash() const { return m_sourcePathHash; }
+    qint64 sourceSize() const { return m_sourceSize; }
+    qint64 sourceModified() const { return m_sourceModified; }
+    qint64 attributesSize() const { return m_attributesSize; }
+    qint64 attributesModified() const { return m_attributesModified; }
+
+    // 是否由源文件和属性文件的当前内容生成（路径、大小和修改时间一致）
+    bool isUpToDate(const QString &sourcePath) const;
+
+    // 转换为字符串列表（会拷贝全部问题，仅用于兼容旧接口）
+    QStringList toStringList() const;
+
+    // 源文件路径摘要
+    static quint64 pathHash(const QString &path);
+
+    // 解析CSV中的优先级（数字，或高/中/低）和难度（简单/中等/困难）
+    static quint16 parsePriority(const QString &text);
+    static quint8 parseDifficulty(const QString &text);
+
+    // 从问题库文件（TXT每行一个问题，或带问题/优先级/分类/难度列的CSV）生成二进制问题库；
+    // TXT文件旁存在 <名称>.attributes.tsv 时读取其中的优先级和分类
+    static bool build(const QString &sourcePath, const QString &bankPath, QString *errorString = nullptr);
+
+    // TXT问题库旁的属性文件 <名称>.attributes.tsv（CSV问题库的属性在文件内，返回空）
+    static QString attributesPathFor(const QString &sourcePath);
+
+    // 源文件对应的问题库文件：<bankDir>/Questions-<源文件和属性文件信息摘要>.wbqb
+    static QString bankPathFor(const QString &bankDir, const QString &sourcePath);
+
+    // 映射源文件对应的问题库，不存在或已过期时先生成；built 返回是否重新生成
+    static std::shared_ptr<QuestionBank> openForSource(const QString &sourcePath, const QString &bankDir,
+                                                       QString *errorString = nullptr, bool *built = nullptr);
+
+    // 删除目录中除 keepPath 以外的问题库文件，返回删除的个数；仍被映射的文件删除失败，留到下次清理
+    static int removeStaleBanks(const QString &bankDir, const QString &keepPath);
+
+    // 比较两个问题库，得到增加和删除的问题（只拷贝有变化的问题）
+    static void diff(const QuestionBank &before, const QuestionBank &after, QStringList *added, QStringList *removed);
+
+private:
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    quint64 m_count = 0;
+    const QChar *m_blob = nullptr;
+    quint64 m_blobUnits = 0;
+    const quint64 *m_offsets = nullptr;
+    const Attributes *m_attributes = nullptr;
+    QStringList m_categories;
+    QString m_contentId;
+    quint64 m_sourcePathHash = 0;
+    qint64 m_sourceSize = 0;
+    qint64 m_sourceModified = 0;
+    qint64 m_attributesSize = -1;
+    qint64 m_attributesModified = 0;
+};
+
+// 二进制问题库写入器
+// 问题逐条写入字符串区，偏移和属性在内存中累积（每个问题12字节），最后写入表和文件头。
+// 通过QSaveFile写入，完成前不会替换已有文件。
+class QuestionBankWriter
+{
+public:
+    explicit QuestionBankWriter(const QString &path);
+
+    bool open();
+    void add(QStringView question, quint16 priority, const QString &category, quint8 difficulty);
+    bool commit(const QString &sourcePath, qint64 sourceSize, qint64 sourceModified,
+                qint64 attributesSize = -1, qint64 attributesModified = 0);
+
+    qint64 count() const { return m_attributes.size(); }
+    QString errorString() const { return m_file.errorString(); }
+
+private:
+    bool flushBlob();
+
+    QSaveFile m_file;
+    QByteArray m_blobBuffer;
+    quint64 m_blobUnits = 0;
+    QVector<quint64> m_offsets;
+    QVector<QuestionBank::Attributes> m_attributes;
+    QHash<QString, quint8> m_categoryIndex;
+    QStringList m_categories;
+    QCryptographicHash m_hash;
+    bool m_failed = false;
+};
+
+#endif // QUESTIONBANK_H
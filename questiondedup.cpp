@@ -0,0 +1,272 @@
+#include "questiondedup.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QVarLengthArray>
+#include <cstring>
+
+namespace {
+
+// 持久化文件头
+const char kDedupMagic[8] = {'W', 'B', 'U', 'Q', '0', '0', '0', '1'};
+
+// SimHash至少需要的二元组数量，太短的问题只做完全匹配
+constexpr int kMinShingles = 6;
+
+// 读入时每次读取的记录数
+constexpr int kReadBatch = 4096;
+
+// 每加入多少条记录落盘一次（其余在 flush/close 时写入）
+constexpr int kFlushInterval = 20;
+
+// 记录数上限，超过后只保留最近的 kKeepRecords 条
+constexpr int kMaxRecords = 200000;
+constexpr int kKeepRecords = kMaxRecords / 2;
+
+// 每条记录：完全哈希 + SimHash，各8字节
+constexpr qint64 kRecordSize = 16;
+
+// 规范化：去掉空白、标点和符号，英文字母转小写
+void normalize(QStringView text, QVarLengthArray<char16_t, 256> &out)
+{
+    out.clear();
+    for (QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            out.append(ch.toLower().unicode());
+        }
+    }
+}
+
+// FNV-1a 64位
+quint64 fnv1a(const char16_t *data, qsizetype size, quint64 hash = Q_UINT64_C(0xcbf29ce484222325))
+{
+    for (qsizetype i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= Q_UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+// 64位混合函数（splitmix64），让二元组哈希的各位分布均匀
+quint64 mix64(quint64 value)
+{
+    value += Q_UINT64_C(0x9e3779b97f4a7c15);
+    value = (value ^ (value >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    value = (value ^ (value >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    return value ^ (value >> 31);
+}
+
+quint32 bandKey(int band, quint64 sim)
+{
+    return (quint32(band) << 16) | quint32((sim >> (band * 16)) & 0xFFFF);
+}
+
+} // namespace
+
+QuestionDedupIndex::QuestionDedupIndex()
+{
+}
+
+QuestionDedupIndex::~QuestionDedupIndex()
+{
+    close();
+}
+
+bool QuestionDedupIndex::open(const QString &filePath)
+{
+    close();
+    m_exact.clear();
+    m_bands.clear();
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    // 新文件写入文件头；文件头不匹配时视为损坏，清空重建
+    char magic[sizeof(kDedupMagic)] = {};
+    if (m_file.read(magic, sizeof(magic)) != qint64(sizeof(magic))
+        || std::memcmp(magic, kDedupMagic, sizeof(kDedupMagic)) != 0) {
+        m_file.resize(0);
+        m_file.seek(0);
+        m_file.write(kDedupMagic, sizeof(kDedupMagic));
+        m_file.flush();
+        return true;
+    }
+
+    // 崩溃留下的不完整记录忽略；超过上限时只保留最近的记录
+    const qint64 records = (m_file.size() - qint64(sizeof(kDedupMagic))) / kRecordSize;
+    if (records > kMaxRecords) {
+        compact(kKeepRecords);
+        return true;
+    }
+    m_exact.reserve(records);
+    QVector<quint64> buffer(kReadBatch * 2);
+    qint64 remaining = records;
+    while (remaining > 0) {
+        const qint64 batch = qMin<qint64>(remaining, kReadBatch);
+        const qint64 bytes = batch * kRecordSize;
+        if (m_file.read(reinterpret_cast<char *>(buffer.data()), bytes) != bytes) {
+            break;
+        }
+        for (qint64 i = 0; i < batch; ++i) {
+            addToIndex(buffer[i * 2], buffer[i * 2 + 1]);
+        }
+        remaining -= batch;
+    }
+
+    m_file.seek(qint64(sizeof(kDedupMagic)) + records * kRecordSize);
+    m_file.resize(m_file.pos());
+    return true;
+}
+
+void QuestionDedupIndex::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_unflushed = 0;
+}
+
+void QuestionDedupIndex::flush()
+{
+    if (m_file.isOpen() && m_unflushed > 0) {
+        m_file.flush();
+    }
+    m_unflushed = 0;
+}
+
+void QuestionDedupIndex::compact(int keep)
+{
+    m_file.flush();
+    m_unflushed = 0;
+
+    // 文件中的记录按加入顺序排列，读出最后 keep 条后重写文件并重建索引
+    const qint64 records = (m_file.size() - qint64(sizeof(kDedupMagic))) / kRecordSize;
+    const qint64 kept = qMin<qint64>(records, keep);
+    QVector<quint64> buffer(kept * 2);
+    const qint64 bytes = kept * kRecordSize;
+    if (!m_file.seek(qint64(sizeof(kDedupMagic)) + (records - kept) * kRecordSize)
+        || m_file.read(reinterpret_cast<char *>(buffer.data()), bytes) != bytes) {
+        buffer.clear();
+    }
+
+    m_exact.clear();
+    m_bands.clear();
+    m_file.resize(qint64(sizeof(kDedupMagic)));
+    m_file.seek(qint64(sizeof(kDedupMagic)));
+    m_file.write(reinterpret_cast<const char *>(buffer.constData()), qint64(buffer.size()) * 8);
+    m_file.flush();
+    m_exact.reserve(buffer.size() / 2);
+    for (int i = 0; i + 1 < buffer.size(); i += 2) {
+        addToIndex(buffer[i], buffer[i + 1]);
+    }
+}
+
+quint64 QuestionDedupIndex::exactHash(QStringView question)
+{
+    QVarLengthArray<char16_t, 256> normalized;
+    normalize(question, normalized);
+    return fnv1a(normalized.constData(), normalized.size());
+}
+
+quint64 QuestionDedupIndex::simHash(QStringView question)
+{
+    QVarLengthArray<char16_t, 256> normalized;
+    normalize(question, normalized);
+    const qsizetype shingles = normalized.size() - 1;
+    if (shingles < kMinShingles) {
+        return 0;
+    }
+
+    // 每个字符二元组哈希后按位投票
+    int votes[64] = {};
+    for (qsizetype i = 0; i < shingles; ++i) {
+        const quint64 hash = mix64(quint64(normalized[i]) << 16 | normalized[i + 1]);
+        for (int bit = 0; bit < 64; ++bit) {
+            votes[bit] += (hash >> bit) & 1 ? 1 : -1;
+        }
+    }
+
+    quint64 sim = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] > 0) {
+            sim |= Q_UINT64_C(1) << bit;
+        }
+    }
+    // 0 表示"没有SimHash"
+    return sim ? sim : 1;
+}
+
+QuestionDedupIndex::Match QuestionDedupIndex::find(QStringView question, bool nearDuplicates) const
+{
+    if (m_exact.contains(exactHash(question))) {
+        return ExactDuplicate;
+    }
+    if (!nearDuplicates) {
+        return NoMatch;
+    }
+
+    const quint64 sim = simHash(question);
+    if (sim == 0) {
+        return NoMatch;
+    }
+    for (int band = 0; band < 4; ++band) {
+        const auto it = m_bands.constFind(bandKey(band, sim));
+        if (it == m_bands.constEnd()) {
+            continue;
+        }
+        for (quint64 candidate : it.value()) {
+            if (qPopulationCount(candidate ^ sim) <= kNearDistance) {
+                return NearDuplicate;
+            }
+        }
+    }
+    return NoMatch;
+}
+
+bool QuestionDedupIndex::insert(QStringView question)
+{
+    const quint64 exact = exactHash(question);
+    if (m_exact.contains(exact)) {
+        return false;
+    }
+    const quint64 sim = simHash(question);
+    addToIndex(exact, sim);
+
+    if (m_file.isOpen()) {
+        quint64 record[2] = {exact, sim};
+        m_file.write(reinterpret_cast<const char *>(record), sizeof(record));
+        if (++m_unflushed >= kFlushInterval) {
+            flush();
+        }
+        if (m_exact.size() > kMaxRecords) {
+            compact(kKeepRecords);
+        }
+    }
+    return true;
+}
+
+void QuestionDedupIndex::clear()
+{
+    m_exact.clear();
+    m_bands.clear();
+    m_unflushed = 0;
+    if (m_file.isOpen()) {
+        m_file.resize(0);
+        m_file.seek(0);
+        m_file.write(kDedupMagic, sizeof(kDedupMagic));
+        m_file.flush();
+    }
+}
+
+void QuestionDedupIndex::addToIndex(quint64 exact, quint64 sim)
+{
+    m_exact.insert(exact);
+    if (sim == 0) {
+        return;
+    }
+    for (int band = 0; band < 4; ++band) {
+        m_bands[bandKey(band, sim)].append(sim);
+    }
+}
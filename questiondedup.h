@@ -0,0 +1,72 @@
+#ifndef QUESTIONDEDUP_H
+#define QUESTIONDEDUP_H
+
+#include <QString>
+#include <QStringView>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QFile>
+
+// 问题去重索引
+// 完全重复：问题规范化（去掉空白和标点、英文转小写）后的64位哈希，存入哈希集合。
+// 近似重复：基于字符二元组的64位SimHash，海明距离不超过kNearDistance视为近似重复。
+// SimHash按16位分成4段建立分桶索引：距离不超过3时至少有一段完全相同，
+// 查询只需检查4个桶，不需要遍历全部问题。
+// 可绑定文件持久化：每加入一条记录追加16字节，按间隔落盘，启动时读入重建索引；
+// 记录数超过上限时只保留最近的一半，文件不会无限增长。
+class QuestionDedupIndex
+{
+public:
+    // 查询结果
+    enum Match {
+        NoMatch,
+        NearDuplicate,
+        ExactDuplicate
+    };
+
+    // 近似重复的海明距离阈值
+    static constexpr int kNearDistance = 3;
+
+    QuestionDedupIndex();
+    ~QuestionDedupIndex();
+
+    QuestionDedupIndex(const QuestionDedupIndex &) = delete;
+    QuestionDedupIndex &operator=(const QuestionDedupIndex &) = delete;
+
+    // 绑定持久化文件并读入已有记录
+    bool open(const QString &filePath);
+    void close();
+
+    // 把尚未落盘的记录写入文件
+    void flush();
+
+    // 查询（nearDuplicates为false时只检查完全重复）
+    Match find(QStringView question, bool nearDuplicates = true) const;
+    bool contains(QStringView question) const { return find(question, false) == ExactDuplicate; }
+
+    // 加入索引，已完全重复时返回false
+    bool insert(QStringView question);
+
+    // 清空索引（同时清空持久化文件）
+    void clear();
+
+    int size() const { return m_exact.size(); }
+
+    // 规范化文本的64位哈希与SimHash（文本太短时SimHash为0，不参与近似判断）
+    static quint64 exactHash(QStringView question);
+    static quint64 simHash(QStringView question);
+
+private:
+    void addToIndex(quint64 exact, quint64 sim);
+
+    // 只保留文件中最近的 keep 条记录，重写文件并重建索引
+    void compact(int keep);
+
+    QSet<quint64> m_exact;
+    QHash<quint32, QVector<quint64>> m_bands;   // 键：段号<<16 | 段值
+    QFile m_file;
+    int m_unflushed = 0;    // 上次落盘后加入的记录数
+};
+
+#endif // QUESTIONDEDUP_H
@@ -0,0 +1,163 @@
+#include "questiongenerator.h"
+#include <QSettings>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QDir>
+#include <QFileInfo>
+
+namespace {
+
+// Feistel轮数
+constexpr int kFeistelRounds = 4;
+
+// 每生成多少个问题写一次状态文件（其余在运行结束时写入）
+constexpr int kStateSaveInterval = 20;
+
+// 64位混合函数（splitmix64）
+quint64 mix64(quint64 value)
+{
+    value += Q_UINT64_C(0x9e3779b97f4a7c15);
+    value = (value ^ (value >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    value = (value ^ (value >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    return value ^ (value >> 31);
+}
+
+} // namespace
+
+void QuestionGenerator::setFamilies(const QVector<Family> &families)
+{
+    m_families.clear();
+    m_familyOffsets.clear();
+    m_spaceSize = 0;
+    for (const Family &family : families) {
+        if (family.templates.isEmpty() || family.keywords.isEmpty()) {
+            continue;
+        }
+        m_families.append(family);
+        m_familyOffsets.append(m_spaceSize);
+        m_spaceSize += quint64(family.templates.size()) * quint64(family.keywords.size());
+    }
+
+    // 置换域取不小于空间大小的2的偶数次幂，循环行走平均不超过4步
+    int bits = 2;
+    while (bits < 64 && (Q_UINT64_C(1) << bits) < m_spaceSize) {
+        bits += 2;
+    }
+    m_halfBits = bits / 2;
+
+    m_seed = 0;
+    m_cursor = 0;
+    m_round = 0;
+    deriveKeys();
+}
+
+void QuestionGenerator::bindState(const QString &filePath)
+{
+    m_statePath = filePath;
+
+    const QString signature = spaceSignature();
+    QSettings state(filePath, QSettings::IniFormat);
+    if (state.value("Generator/Signature").toString() == signature) {
+        m_seed = state.value("Generator/Seed").toULongLong();
+        m_cursor = state.value("Generator/Cursor").toULongLong();
+        m_round = state.value("Generator/Round").toULongLong();
+    } else {
+        m_seed = QRandomGenerator::global()->generate64();
+        m_cursor = 0;
+        m_round = 0;
+    }
+    deriveKeys();
+    saveState();
+}
+
+void QuestionGenerator::flushState()
+{
+    if (m_unsavedDraws > 0) {
+        saveState();
+    }
+}
+
+QString QuestionGenerator::next()
+{
+    if (m_spaceSize == 0) {
+        return QString();
+    }
+
+    // 一轮用完后更换密钥，新一轮的顺序与上一轮不同
+    if (m_cursor >= m_spaceSize) {
+        m_cursor = 0;
+        ++m_round;
+        deriveKeys();
+    }
+
+    quint64 index = permute(m_cursor++);
+    // 状态文件按间隔写入，异常退出时最多重复最近未保存的几个问题
+    if (++m_unsavedDraws >= kStateSaveInterval) {
+        saveState();
+    }
+
+    int family = m_families.size() - 1;
+    while (family > 0 && index < m_familyOffsets[family]) {
+        --family;
+    }
+    index -= m_familyOffsets[family];
+
+    const Family &selected = m_families.at(family);
+    const quint64 templateCount = quint64(selected.templates.size());
+    return selected.templates.at(int(index % templateCount)).arg(selected.keywords.at(int(index / templateCount)));
+}
+
+quint64 QuestionGenerator::permute(quint64 position) const
+{
+    // 在 [0, 2^(2*halfBits)) 上做Feistel置换，结果超出空间时继续置换（循环行走），
+    // 置换是双射，因此限定后仍是 [0, spaceSize) 上的双射
+    const quint64 mask = (Q_UINT64_C(1) << m_halfBits) - 1;
+    quint64 value = position;
+    do {
+        quint64 left = value >> m_halfBits;
+        quint64 right = value & mask;
+        for (int round = 0; round < kFeistelRounds; ++round) {
+            const quint64 next = left ^ (mix64(right ^ m_roundKeys[round]) & mask);
+            left = right;
+            right = next;
+        }
+        value = (left << m_halfBits) | right;
+    } while (value >= m_spaceSize);
+    return value;
+}
+
+void QuestionGenerator::deriveKeys()
+{
+    quint64 key = mix64(m_seed ^ mix64(m_round));
+    for (int round = 0; round < kFeistelRounds; ++round) {
+        key = mix64(key + quint64(round));
+        m_roundKeys[round] = key;
+    }
+}
+
+void QuestionGenerator::saveState()
+{
+    m_unsavedDraws = 0;
+    if (m_statePath.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(m_statePath).absolutePath());
+    QSettings state(m_statePath, QSettings::IniFormat);
+    state.setValue("Generator/Signature", spaceSignature());
+    state.setValue("Generator/Seed", m_seed);
+    state.setValue("Generator/Cursor", m_cursor);
+    state.setValue("Generator/Round", m_round);
+    state.setValue("Generator/SpaceSize", m_spaceSize);
+}
+
+QString QuestionGenerator::spaceSignature() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const Family &family : m_families) {
+        hash.addData(family.templates.join('\n').toUtf8());
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(family.keywords.join('\n').toUtf8());
+        hash.addData(QByteArray(1, '\0'));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
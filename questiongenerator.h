@@ -0,0 +1,68 @@
+#ifndef QUESTIONGENERATOR_H
+#define QUESTIONGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 组合问题生成器
+// 把"模板 × 关键词"看作编号为 0..N-1 的乘积空间，用带密钥的Feistel置换
+// （循环行走限定到N以内）把游标依次映射为空间中的编号，
+// 因此一轮内每次生成的问题都不重复，无需记录历史或拒绝重抽；
+// 一轮用完后更换密钥开始新的一轮。种子和游标保存在状态文件中（按间隔写入，
+// 运行结束时调用 flushState），重启后继续。
+class QuestionGenerator
+{
+public:
+    // 一组模板及其关键词（模板中用 %1 表示关键词）
+    struct Family {
+        QStringList templates;
+        QStringList keywords;
+    };
+
+    // 设置生成空间（空间变化后需要重新绑定状态）
+    void setFamilies(const QVector<Family> &families);
+
+    // 绑定状态文件：空间未变化时继续上次的游标，否则随机生成新种子从头开始
+    void bindState(const QString &filePath);
+
+    // 生成下一个问题，空间为空时返回空字符串
+    QString next();
+
+    // 把尚未写入的游标保存到状态文件
+    void flushState();
+
+    quint64 spaceSize() const { return m_spaceSize; }
+    quint64 cursor() const { return m_cursor; }
+    quint64 remaining() const { return m_spaceSize - qMin(m_cursor, m_spaceSize); }
+    quint64 round() const { return m_round; }
+
+    // 把游标位置映射为空间中的编号（置换，0 <= position < spaceSize）
+    quint64 permute(quint64 position) const;
+
+private:
+    // 根据种子和轮次计算Feistel轮密钥
+    void deriveKeys();
+
+    // 保存种子与游标
+    void saveState();
+
+    // 空间内容签名，模板或关键词变化时签名不同
+    QString spaceSignature() const;
+
+    QVector<Family> m_families;
+    QVector<quint64> m_familyOffsets;   // 每组在空间中的起始编号
+    quint64 m_spaceSize = 0;
+
+    QString m_statePath;
+    quint64 m_seed = 0;
+    quint64 m_cursor = 0;
+    quint64 m_round = 0;
+    int m_unsavedDraws = 0;             // 上次保存后生成的问题数
+
+    // Feistel参数：编号拆成左右两半，每半 m_halfBits 位
+    int m_halfBits = 1;
+    quint64 m_roundKeys[4] = {};
+};
+
+#endif // QUESTIONGENERATOR_H
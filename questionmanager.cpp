@@ -3,6 +3,10 @@
 #include <QDateTime>
 #include <QDebug>
 #include "configmanager.h"
+#include "questionbank.h"
+#include <QCryptographicHash>
+#include <QHash>
+#include <utility>
 
 QuestionManager::QuestionManager(QObject *parent) : QObject(parent)
 {
@@ -11,23 +15,39 @@ QuestionManager::QuestionManager(QObject *parent) : QObject(parent)
     currentQuestionIndex = 0;
 
     // 连接配置变化信号
-    connect(ConfigManager::getInstance(), &ConfigManager::configChanged,
-            this, &QuestionManager::loadQuestionsAndKeywords);
+    connect(ConfigManager::getInstance(), &ConfigManager::configKeysChanged,
+            this, &QuestionManager::onConfigKeysChanged);
 }
 
 QuestionManager::~QuestionManager()
 {
+    m_usedIndex.flush();
+    m_generator.flushState();
 }
 
 void QuestionManager::loadQuestionsAndKeywords()
 {
     // 从配置管理器加载问题列表和关键词
     ConfigManager* config = ConfigManager::getInstance();
-    presetQuestions = config->getQuestionList();
+    m_questionBank = config->getQuestionBank();
+    if (m_questionBank) {
+        presetQuestions.clear();
+    } else {
+        presetQuestions = config->getQuestionList();
+    }
+    m_samplerDirty = true;
     keywords = config->getKeywordList();
+    m_generatorDirty = true;
 
     emit logMessage(QString("已加载 %1 个预设问题和 %2 个关键词")
-                        .arg(presetQuestions.size()).arg(keywords.size()));
+                        .arg(presetCount()).arg(keywords.size()));
+}
+
+void QuestionManager::onConfigKeysChanged(const QStringList &keys)
+{
+    if (keys.contains("Library/QuestionList") || keys.contains("Library/KeywordList")) {
+        loadQuestionsAndKeywords();
+    }
 }
 
 QString QuestionManager::getNextQuestion()
@@ -38,13 +58,14 @@ QString QuestionManager::getNextQuestion()
         return getNextPresetQuestion();
     case RandomMode:
         return getRandomPresetQuestion();
-    case GenerateMode:
-        // 随机决定是生成普通问题还是嵌入式相关问题
-        if (QRandomGenerator::global()->bounded(100) < 30) { // 30%的概率生成嵌入式问题
-            return generateEmbeddedQuestion();
-        } else {
+    case ShuffleMode:
+        if (presetCount() == 0) {
+            emit logMessage("预设问题列表为空，尝试生成问题");
             return generateQuestion();
         }
+        return presetAt(nextShuffledPresetIndex());
+    case GenerateMode:
+        return generateUniqueQuestion();
     default:
         return getNextPresetQuestion();
     }
@@ -59,6 +80,7 @@ void QuestionManager::setQuestionMode(QuestionMode mode)
     case CycleMode: modeStr = "循环模式"; break;
     case RandomMode: modeStr = "随机模式"; break;
     case GenerateMode: modeStr = "生成模式"; break;
+    case ShuffleMode: modeStr = "随机不重复模式"; break;
     }
 
     emit logMessage("问题模式已设置为: " + modeStr);
@@ -71,27 +93,135 @@ QuestionManager::QuestionMode QuestionManager::getQuestionMode() const
 
 QString QuestionManager::getNextPresetQuestion()
 {
-    if (presetQuestions.isEmpty()) {
+    const int count = presetCount();
+    if (count == 0) {
         emit logMessage("预设问题列表为空，尝试生成问题");
         return generateQuestion();
     }
 
     // 循环获取下一个问题
-    QString question = presetQuestions[currentQuestionIndex];
-    currentQuestionIndex = (currentQuestionIndex + 1) % presetQuestions.size();
-    return question;
+    return presetAt(nextCyclePresetIndex());
+}
+
+int QuestionManager::nextCyclePresetIndex()
+{
+    const int count = presetCount();
+    if (count == 0) {
+        return -1;
+    }
+    const int index = currentQuestionIndex % count;
+    currentQuestionIndex = (index + 1) % count;
+    return index;
+}
+
+void QuestionManager::setCycleIndex(int index)
+{
+    const int count = presetCount();
+    currentQuestionIndex = count > 0 ? qMax(index, 0) % count : 0;
+}
+
+void QuestionManager::applyPresetChanges(const QStringList &added, const QStringList &removed)
+{
+    ConfigManager *config = ConfigManager::getInstance();
+    std::shared_ptr<const QuestionBank> bank = config->getQuestionBank();
+
+    // 问题不变、只修改了优先级：逐条更新抽样权重，不重建整个抽样表，循环位置不变。
+    // 修改的问题多于抽样块数时整体重建更快
+    if (added.isEmpty() && removed.isEmpty() && m_questionBank && bank
+        && bank->contentId() == m_questionBank->contentId() && !m_samplerDirty) {
+        QVector<int> changed;
+        for (int i = 0; i < bank->count(); ++i) {
+            if (m_sampler.weight(i) != bank->priority(i)) {
+                changed.append(i);
+            }
+        }
+        m_questionBank = bank;
+        if (qint64(changed.size()) * WeightedSampler::kBlockSize > bank->count()) {
+            m_samplerDirty = true;
+        } else {
+            for (int index : std::as_const(changed)) {
+                setPresetPriority(index, bank->priority(index));
+            }
+        }
+        emit logMessage(QString("问题库优先级已热加载：%1 个问题的权重已更新").arg(changed.size()));
+        return;
+    }
+
+    if (!m_questionBank && !bank) {
+        // 文本问题列表：就地删除并在末尾追加，循环位置之前每删除一个问题位置前移一位
+        QHash<QString, int> pending;
+        for (const QString &question : removed) {
+            ++pending[question];
+        }
+        const int cursor = currentQuestionIndex;
+        int write = 0;
+        for (int read = 0; read < presetQuestions.size(); ++read) {
+            auto it = pending.find(presetQuestions[read]);
+            if (it != pending.end() && it.value() > 0) {
+                --it.value();
+                if (read < cursor) {
+                    --currentQuestionIndex;
+                }
+                continue;
+            }
+            if (write != read) {
+                presetQuestions[write] = std::move(presetQuestions[read]);
+            }
+            ++write;
+        }
+        presetQuestions.resize(write);
+        presetQuestions.append(added);
+    } else {
+        // 二进制问题库只读：换用重新生成的问题库（或文本列表），按原来的下一个问题重新定位
+        const int oldCount = presetCount();
+        const int oldIndex = oldCount > 0 ? currentQuestionIndex % oldCount : 0;
+        const QString next = oldCount > 0 ? presetAt(oldIndex) : QString();
+        if (bank) {
+            setQuestionBank(bank);
+        } else {
+            setPresetQuestions(config->getQuestionList());
+        }
+
+        // 原来的下一个问题被删除时保持原序号
+        const int count = presetCount();
+        currentQuestionIndex = count > 0 ? oldIndex % count : 0;
+        for (int step = 0; step < count && !next.isEmpty(); ++step) {
+            const int index = (oldIndex + step) % count;
+            const bool found = m_questionBank ? m_questionBank->questionView(index) == next
+                                              : presetQuestions.at(index) == next;
+            if (found) {
+                currentQuestionIndex = index;
+                break;
+            }
+        }
+    }
+
+    m_samplerDirty = true;
+    emit logMessage(QString("问题库已热加载：增加 %1 个，删除 %2 个，当前共 %3 个预设问题")
+                        .arg(added.size()).arg(removed.size()).arg(presetCount()));
+}
+
+void QuestionManager::applyKeywordChanges(const QStringList &added, const QStringList &removed)
+{
+    for (const QString &keyword : removed) {
+        keywords.removeOne(keyword);
+    }
+    keywords.append(added);
+    m_generatorDirty = true;
+    emit logMessage(QString("关键词库已热加载：增加 %1 个，删除 %2 个，当前共 %3 个关键词")
+                        .arg(added.size()).arg(removed.size()).arg(keywords.size()));
 }
 
 QString QuestionManager::getRandomPresetQuestion()
 {
-    if (presetQuestions.isEmpty()) {
+    const int count = presetCount();
+    if (count == 0) {
         emit logMessage("预设问题列表为空，尝试生成问题");
         return generateQuestion();
     }
 
-    // 随机获取一个问题
-    int index = QRandomGenerator::global()->bounded(presetQuestions.size());
-    return presetQuestions[index];
+    // 按优先级权重随机获取一个问题
+    return presetAt(samplePresetIndex());
 }
 
 QString QuestionManager::generateQuestion()
@@ -124,16 +254,111 @@ QString QuestionManager::generateQuestion()
 
 void QuestionManager::setPresetQuestions(const QStringList &list)
 {
+    m_questionBank.reset();
     presetQuestions = list.toVector();
+    m_samplerDirty = true;
+}
+
+void QuestionManager::setQuestionBank(std::shared_ptr<const QuestionBank> bank)
+{
+    m_questionBank = std::move(bank);
+    presetQuestions.clear();
+    m_samplerDirty = true;
+}
+
+int QuestionManager::presetCount() const
+{
+    return m_questionBank ? m_questionBank->count() : presetQuestions.size();
+}
+
+QString QuestionManager::presetAt(int index) const
+{
+    if (m_questionBank) {
+        return m_questionBank->question(index);
+    }
+    return presetQuestions.value(index);
+}
+
+void QuestionManager::ensureSampler()
+{
+    if (!m_samplerDirty) {
+        return;
+    }
+    m_samplerDirty = false;
+
+    // 权重取自问题库的优先级列；文本问题列表没有优先级，等权重
+    const int count = presetCount();
+    QVector<quint32> weights(count, QuestionBank::kDefaultPriority);
+    bool weighted = false;
+    if (m_questionBank) {
+        for (int i = 0; i < count; ++i) {
+            weights[i] = m_questionBank->priority(i);
+            weighted = weighted || weights[i] != weights[0];
+        }
+    }
+    m_sampler.build(weights);
+    m_shuffledOrder.reset(count, weighted ? weights : QVector<quint32>());
+    m_shuffleWeightsDirty = false;
+}
+
+int QuestionManager::samplePresetIndex()
+{
+    ensureSampler();
+    const int index = m_sampler.sample(QRandomGenerator::global());
+    // 全部权重为0时退回均匀抽样
+    if (index < 0 && presetCount() > 0) {
+        return QRandomGenerator::global()->bounded(presetCount());
+    }
+    return index;
+}
+
+int QuestionManager::nextShuffledPresetIndex()
+{
+    ensureSampler();
+    if (m_shuffleWeightsDirty) {
+        // 连续修改多个权重时只重置一次
+        m_shuffleWeightsDirty = false;
+        QVector<quint32> weights(m_sampler.size());
+        for (int i = 0; i < weights.size(); ++i) {
+            weights[i] = m_sampler.weight(i);
+        }
+        m_shuffledOrder.reset(weights.size(), weights);
+    }
+    return m_shuffledOrder.next(QRandomGenerator::global());
+}
+
+void QuestionManager::setPresetPriority(int index, quint32 weight)
+{
+    ensureSampler();
+    m_sampler.setWeight(index, weight);
+    m_shuffleWeightsDirty = true;
+}
+
+QString QuestionManager::presetSignature() const
+{
+    if (m_questionBank) {
+        return m_questionBank->contentId();
+    }
+    // 与二进制问题库的内容摘要算法一致，同样的问题得到同样的摘要
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &question : presetQuestions) {
+        hash.addData(QByteArrayView(reinterpret_cast<const char *>(question.utf16()), question.size() * 2));
+        hash.addData(QByteArrayView("\n\0", 2));
+    }
+    return QString::fromLatin1(hash.result().toHex());
 }
 
 void QuestionManager::setKeywords(const QStringList &list)
 {
     keywords = list.toVector();
+    m_generatorDirty = true;
 }
 
 QVector<QString> QuestionManager::getPresetQuestions() const
 {
+    if (m_questionBank) {
+        return m_questionBank->toStringList().toVector();
+    }
     return presetQuestions;
 }
 
@@ -205,3 +430,98 @@ QString QuestionManager::generateEmbeddedQuestion()
     
     return question;
 }
+
+bool QuestionManager::isQuestionUsed(const QString &question)
+{
+    return m_usedIndex.contains(question);
+}
+
+bool QuestionManager::openUsedIndex(const QString &filePath)
+{
+    if (!m_usedIndex.open(filePath)) {
+        emit logMessage("无法打开已发送问题索引: " + filePath);
+        return false;
+    }
+    emit logMessage(QString("已加载 %1 条已发送问题记录").arg(m_usedIndex.size()));
+    return true;
+}
+
+void QuestionManager::markQuestionUsed(const QString &question)
+{
+    m_usedIndex.insert(question);
+}
+
+void QuestionManager::flushUsedIndex()
+{
+    m_usedIndex.flush();
+}
+
+void QuestionManager::openGeneratorState(const QString &filePath)
+{
+    m_generatorStatePath = filePath;
+    m_generatorDirty = true;
+    ensureGenerator();
+    emit logMessage(QString("问题生成空间共 %1 个问题，本轮剩余 %2 个")
+                        .arg(m_generator.spaceSize()).arg(m_generator.remaining()));
+}
+
+void QuestionManager::flushGeneratorState()
+{
+    m_generator.flushState();
+}
+
+void QuestionManager::ensureGenerator()
+{
+    if (!m_generatorDirty) {
+        return;
+    }
+    m_generatorDirty = false;
+
+    // 普通模板与嵌入式模板各自与关键词组合，关键词为空时使用各自的默认关键词
+    QStringList keywordList(keywords.cbegin(), keywords.cend());
+    QVector<QuestionGenerator::Family> families = {
+        {m_questionTemplates, keywordList.isEmpty() ? QStringList{"微信小程序"} : keywordList},
+        {m_embeddedQuestionTemplates, keywordList.isEmpty() ? QStringList{"传感器"} : keywordList}
+    };
+    // 先写入旧空间的游标，空间未变化时重新绑定才能接着上次的位置
+    m_generator.flushState();
+    m_generator.setFamilies(families);
+    if (!m_generatorStatePath.isEmpty()) {
+        m_generator.bindState(m_generatorStatePath);
+    }
+}
+
+QString QuestionManager::generateUniqueQuestion()
+{
+    ensureGenerator();
+
+    // 置换保证一轮内不重复，一轮用完后生成器自动换新的顺序
+    if (m_generator.remaining() == 0 && m_generator.spaceSize() > 0) {
+        emit logMessage(QString("生成空间的 %1 个问题已全部用完，开始新一轮").arg(m_generator.spaceSize()));
+    }
+    const QString question = m_generator.next();
+    if (question.isEmpty()) {
+        return generateQuestion();
+    }
+    emit logMessage(QString("已生成问题：%1").arg(question));
+    return question;
+}
+
+double QuestionManager::evaluateQuestionQuality(const QString &question)
+{
+    const QString text = question.trimmed();
+    if (text.isEmpty()) {
+        return 0.0;
+    }
+
+    switch (m_usedIndex.find(text)) {
+    case QuestionDedupIndex::ExactDuplicate:
+        return 0.0;
+    case QuestionDedupIndex::NearDuplicate:
+        return 0.3;
+    case QuestionDedupIndex::NoMatch:
+        break;
+    }
+    // 过短的问题信息量不足
+    return text.size() < 4 ? 0.5 : 1.0;
+}
@@ -5,6 +5,12 @@
 #include <QVector>
 #include <QString>
 #include <QStringList>
+#include <memory>
+#include "questionsampler.h"
+#include "questiondedup.h"
+#include "questiongenerator.h"
+
+class QuestionBank;
 
 class QuestionManager : public QObject
 {
@@ -14,7 +20,8 @@ public:
     enum QuestionMode {
         CycleMode,    // 循环模式
         RandomMode,   // 随机模式
-        GenerateMode // 生成模式
+        GenerateMode, // 生成模式
+        ShuffleMode   // 随机不重复模式（按优先级加权，一轮内每个问题只出现一次）
     };
     Q_ENUM(QuestionMode)
 
@@ -66,10 +73,42 @@ public:
     // 获取下一个预设问题
     QString getNextPresetQuestion();
 
+    // 循环模式：取下一个预设问题序号并前移位置，没有问题时返回-1
+    int nextCyclePresetIndex();
+
+    // 设置循环模式的位置（继续中断的运行时使用）
+    void setCycleIndex(int index);
+
+    // 应用问题库文件的增删差异（热加载），循环位置仍指向原来的下一个问题
+    void applyPresetChanges(const QStringList &added, const QStringList &removed);
+
+    // 应用关键词库文件的增删差异（热加载）
+    void applyKeywordChanges(const QStringList &added, const QStringList &removed);
+
     // 生成问题
     QString generateQuestion();
 
     void setPresetQuestions(const QStringList &list); // 新增声明
+
+    // 使用二进制问题库作为预设问题（共享内存映射，不拷贝问题）
+    void setQuestionBank(std::shared_ptr<const QuestionBank> bank);
+
+    // 预设问题数量与按序号获取（问题库与列表通用）
+    int presetCount() const;
+    QString presetAt(int index) const;
+
+    // 按优先级权重随机抽取一个预设问题序号（有放回），没有问题时返回-1
+    int samplePresetIndex();
+
+    // 按优先级加权的不放回顺序取下一个预设问题序号，没有问题时返回-1
+    int nextShuffledPresetIndex();
+
+    // 修改单个预设问题的优先级权重（只更新受影响的部分抽样表；问题库热加载只改了优先级时使用）
+    void setPresetPriority(int index, quint32 weight);
+
+    // 预设问题内容摘要，用于任务日志判断是否可恢复
+    QString presetSignature() const;
+
     void setKeywords(const QStringList &list);        // 新增声明
 
     // 智能问题生成
@@ -88,10 +127,28 @@ public:
     // 根据难度生成问题
     QString generateQuestionByDifficulty(QuestionDifficulty difficulty);
     
-    // 问题去重
+    // 问题去重：问题是否已经发送过（完全重复）
     bool isQuestionUsed(const QString &question);
+
+    // 绑定已发送问题的持久化索引
+    bool openUsedIndex(const QString &filePath);
+
+    // 记录已发送的问题
+    void markQuestionUsed(const QString &question);
+
+    // 把尚未落盘的已发送问题记录写入索引文件（运行结束时调用）
+    void flushUsedIndex();
+
+    // 绑定组合生成器的状态文件（保存种子和游标，重启后继续）
+    void openGeneratorState(const QString &filePath);
+
+    // 保存组合生成器的游标（运行结束时调用）
+    void flushGeneratorState();
+
+    // 按组合生成器的置换顺序生成下一个问题，一轮内不重复（生成模式使用）
+    QString generateUniqueQuestion();
     
-    // 问题质量评估
+    // 问题质量评估（0~1，已发送过或近似重复的问题得分低）
     double evaluateQuestionQuality(const QString &question);
     
     // 问题分类
@@ -110,6 +167,27 @@ signals:
 
 private:
     QVector<QString> presetQuestions;
+    std::shared_ptr<const QuestionBank> m_questionBank;
+
+    // 按优先级抽样（预设问题变化后在下次抽样时重建）
+    WeightedSampler m_sampler;
+    ShuffledOrder m_shuffledOrder;
+    bool m_samplerDirty = true;
+    bool m_shuffleWeightsDirty = false; // 单个权重修改后，不放回顺序在下次取值时按新权重重置
+
+    // 已发送问题索引（跨运行持久化）
+    QuestionDedupIndex m_usedIndex;
+
+    // 组合问题生成器（模板或关键词变化后在下次生成时重建）
+    QuestionGenerator m_generator;
+    QString m_generatorStatePath;
+    bool m_generatorDirty = true;
+
+    // 重建生成空间
+    void ensureGenerator();
+
+    // 重建抽样表
+    void ensureSampler();
     QVector<QString> keywords;
     QVector<QString> questionPatterns; // 问题模式模板
     static const QStringList m_questionTemplates;
@@ -123,6 +201,9 @@ private:
 
     // 加载问题和关键词
     void loadQuestionsAndKeywords();
+
+    // 配置变化：只在问题或关键词列表变化时重新加载
+    void onConfigKeysChanged(const QStringList &keys);
 };
 
 #endif // QUESTIONMANAGER_H
@@ -0,0 +1,156 @@
+#include "questionsampler.h"
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void WeightedSampler::build(const QVector<quint32> &weights)
+{
+    m_weights = weights;
+    m_prefix.resize(m_weights.size());
+    m_blockWeights.resize((m_weights.size() + kBlockSize - 1) / kBlockSize);
+    for (int block = 0; block < m_blockWeights.size(); ++block) {
+        rebuildBlock(block);
+    }
+    rebuildAlias();
+}
+
+void WeightedSampler::setWeight(int index, quint32 weight)
+{
+    if (index < 0 || index >= m_weights.size() || m_weights[index] == weight) {
+        return;
+    }
+    m_weights[index] = weight;
+    rebuildBlock(index / kBlockSize);
+    rebuildAlias();
+}
+
+void WeightedSampler::rebuildBlock(int block)
+{
+    const int begin = block * kBlockSize;
+    const int end = qMin(begin + kBlockSize, int(m_weights.size()));
+    quint64 sum = 0;
+    for (int i = begin; i < end; ++i) {
+        sum += m_weights[i];
+        m_prefix[i] = sum;
+    }
+    m_blockWeights[block] = sum;
+}
+
+void WeightedSampler::rebuildAlias()
+{
+    // Vose别名表构建：概率小于1的列用概率大于1的列补齐
+    const int blocks = m_blockWeights.size();
+    m_aliasThreshold.fill(0, blocks);
+    m_alias.resize(blocks);
+    m_totalWeight = 0;
+    for (quint64 blockWeight : std::as_const(m_blockWeights)) {
+        m_totalWeight += blockWeight;
+    }
+    if (m_totalWeight == 0) {
+        return;
+    }
+
+    QVector<double> scaled(blocks);
+    QVector<int> small;
+    QVector<int> large;
+    for (int i = 0; i < blocks; ++i) {
+        m_alias[i] = i;
+        scaled[i] = double(m_blockWeights[i]) * blocks / double(m_totalWeight);
+        (scaled[i] < 1.0 ? small : large).append(i);
+    }
+
+    constexpr double kScale = 4294967296.0;
+    while (!small.isEmpty() && !large.isEmpty()) {
+        const int less = small.takeLast();
+        const int more = large.last();
+        m_aliasThreshold[less] = quint64(scaled[less] * kScale);
+        m_alias[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        if (scaled[more] < 1.0) {
+            large.removeLast();
+            small.append(more);
+        }
+    }
+    // 剩余的列（包括浮点误差留下的）总是留在本列
+    for (int i : std::as_const(large)) {
+        m_aliasThreshold[i] = quint64(kScale);
+    }
+    for (int i : std::as_const(small)) {
+        m_aliasThreshold[i] = quint64(kScale);
+    }
+}
+
+int WeightedSampler::sample(QRandomGenerator *generator) const
+{
+    if (m_totalWeight == 0) {
+        return -1;
+    }
+
+    // 高32位选列，低32位决定是否走别名
+    const quint64 random = generator->generate64();
+    const int column = int((quint64(quint32(random >> 32)) * quint64(m_blockWeights.size())) >> 32);
+    int block = quint32(random) < m_aliasThreshold[column] ? column : m_alias[column];
+
+    // 浮点误差可能使权重为0的块留在本列，此时按块权重顺序查找
+    if (m_blockWeights[block] == 0) {
+        quint64 target = generator->generate64() % m_totalWeight;
+        for (block = 0; block < m_blockWeights.size() && target >= m_blockWeights[block]; ++block) {
+            target -= m_blockWeights[block];
+        }
+    }
+
+    // 块内按前缀和二分查找（块权重远小于2^64，取模偏差可以忽略）
+    const int begin = block * kBlockSize;
+    const int end = qMin(begin + kBlockSize, int(m_weights.size()));
+    const quint64 target = generator->generate64() % m_blockWeights[block];
+    const auto it = std::upper_bound(m_prefix.constBegin() + begin, m_prefix.constBegin() + end, target);
+    return int(it - m_prefix.constBegin());
+}
+
+void ShuffledOrder::reset(int count, const QVector<quint32> &weights)
+{
+    m_order.resize(count);
+    m_weights = weights;
+    m_keys.clear();
+    // 下一次取值时重新打乱
+    m_position = count;
+}
+
+int ShuffledOrder::next(QRandomGenerator *generator)
+{
+    if (m_order.isEmpty()) {
+        return -1;
+    }
+    if (m_position >= m_order.size()) {
+        reshuffle(generator);
+        m_position = 0;
+    }
+    return m_order[m_position++];
+}
+
+void ShuffledOrder::reshuffle(QRandomGenerator *generator)
+{
+    const int count = m_order.size();
+    for (int i = 0; i < count; ++i) {
+        m_order[i] = i;
+    }
+
+    if (m_weights.size() != count) {
+        // 等权重：Fisher-Yates洗牌
+        for (int i = count - 1; i > 0; --i) {
+            std::swap(m_order[i], m_order[int(generator->bounded(quint32(i + 1)))]);
+        }
+        return;
+    }
+
+    // 加权：Efraimidis-Spirakis随机键 log(u)/w，键越大越靠前；权重为0的排在最后
+    m_keys.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const double u = 1.0 - generator->generateDouble();
+        m_keys[i] = m_weights[i] > 0 ? std::log(u) / m_weights[i] : -HUGE_VAL;
+    }
+    std::sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+        return m_keys[a] > m_keys[b];
+    });
+}
@@ -0,0 +1,70 @@
+#ifndef QUESTIONSAMPLER_H
+#define QUESTIONSAMPLER_H
+
+#include <QVector>
+#include <QtGlobal>
+
+class QRandomGenerator;
+
+// 按权重抽样（有放回）
+// 问题按每块256个分组：块之间用Walker别名表抽样（O(1)），块内用前缀和二分查找（8次比较）。
+// 修改单个权重只需更新所在块的前缀和并重建块级别名表（块数为问题数的1/256），
+// 不需要重建整个表；抽样过程不分配内存。
+class WeightedSampler
+{
+public:
+    // 每块问题数
+    static constexpr int kBlockSize = 256;
+
+    // 用权重初始化（权重为0的问题不会被抽到）
+    void build(const QVector<quint32> &weights);
+
+    // 修改单个权重
+    void setWeight(int index, quint32 weight);
+
+    // 抽取一个序号，全部权重为0时返回-1
+    int sample(QRandomGenerator *generator) const;
+
+    int size() const { return m_weights.size(); }
+    quint64 totalWeight() const { return m_totalWeight; }
+    quint32 weight(int index) const { return m_weights.value(index); }
+
+private:
+    // 重建某一块的前缀和
+    void rebuildBlock(int block);
+
+    // 重建块级别名表
+    void rebuildAlias();
+
+    QVector<quint32> m_weights;
+    QVector<quint64> m_prefix;        // 块内前缀和（含当前元素）
+    QVector<quint64> m_blockWeights;  // 每块权重之和
+    QVector<quint64> m_aliasThreshold; // 别名表：留在本列的概率（按2^32缩放）
+    QVector<int> m_alias;             // 别名表：另一列
+    quint64 m_totalWeight = 0;
+};
+
+// 按权重的不放回顺序
+// 每一轮生成一个打乱的排列，依次取出，全部取完后重新打乱。
+// 权重不同时使用加权随机键排序（权重越大越靠前的概率越高），一轮内每个问题只出现一次。
+class ShuffledOrder
+{
+public:
+    // 设置问题数量与权重（weights为空表示等权重），下一次取值时重新打乱
+    void reset(int count, const QVector<quint32> &weights = QVector<quint32>());
+
+    // 取下一个序号，没有问题时返回-1
+    int next(QRandomGenerator *generator);
+
+    int size() const { return m_order.size(); }
+
+private:
+    void reshuffle(QRandomGenerator *generator);
+
+    QVector<int> m_order;
+    QVector<quint32> m_weights;
+    QVector<double> m_keys;
+    int m_position = 0;
+};
+
+#endif // QUESTIONSAMPLER_H
@@ -0,0 +1,424 @@
+#include "recognitioncalibrator.h"
+#include "configmanager.h"
+#include "logger.h"
+#include "exactmatcher.h"
+#include "tiledmatcher.h"
+#include "imagekernels.h"
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
+#include <functional>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// 每组参数重复匹配的次数（取平均耗时，减小计时抖动）
+constexpr int kTimingRepeats = 3;
+
+// 学到的搜索区域在标注范围外额外保留的比例
+constexpr double kRoiMargin = 0.05;
+
+// 学习搜索区域至少需要的正例数
+constexpr int kMinRoiSamples = 3;
+
+// 灰度QImage包装为Mat（不拷贝，调用方保证QImage存活）
+cv::Mat wrapGray(const QImage &gray)
+{
+    return cv::Mat(gray.height(), gray.width(), CV_8UC1,
+                   const_cast<uchar *>(gray.constBits()), gray.bytesPerLine());
+}
+
+// 单张图像上的最佳匹配
+struct BestMatch {
+    QPoint point;
+    double score = -1.0;
+};
+
+// 与ImageRecognizer::findTemplate相同的流程：搜索区域、预处理、逐个缩放比例匹配，取得分最高的位置
+BestMatch matchBest(const QImage &sourceGray, const QImage &templateGray, const RecognitionProfile &profile)
+{
+    BestMatch best;
+    const cv::Mat source = wrapGray(sourceGray);
+    const QRect searchRect = profile.searchRect(sourceGray.size(), templateGray.size());
+    const cv::Mat searchMat = profile.preprocessImage(
+        source(cv::Rect(searchRect.x(), searchRect.y(), searchRect.width(), searchRect.height())));
+    const cv::Mat preparedTemplate = profile.preprocessImage(wrapGray(templateGray));
+
+    // 精确匹配命中时得分按平均差换算，未命中时与运行时一样退回相关匹配
+    if (profile.method == RecognitionProfile::ExactSad) {
+        ExactMatcher::Hit hit;
+        if (ExactMatcher::find(searchMat.data, int(searchMat.step), QSize(searchMat.cols, searchMat.rows),
+                               preparedTemplate.data, int(preparedTemplate.step),
+                               QSize(preparedTemplate.cols, preparedTemplate.rows),
+                               ExactMatcher::kDefaultMaxMeanDiff,
+                               profile.firstHit ? ExactMatcher::FirstHit : ExactMatcher::BestHit, &hit)) {
+            best.score = 1.0 - hit.meanDiff / 255.0;
+            best.point = QPoint(searchRect.x() + hit.point.x(), searchRect.y() + hit.point.y());
+            return best;
+        }
+    }
+
+    for (double scale : profile.scales) {
+        cv::Mat scaledTemplate = preparedTemplate;
+        if (!qFuzzyCompare(scale, 1.0)) {
+            cv::resize(preparedTemplate, scaledTemplate, cv::Size(), scale, scale,
+                       scale < 1.0 ? cv::INTER_AREA : cv::INTER_LINEAR);
+        }
+        if (scaledTemplate.cols < 2 || scaledTemplate.rows < 2 ||
+            scaledTemplate.cols > searchMat.cols || scaledTemplate.rows > searchMat.rows) {
+            continue;
+        }
+        cv::Mat result;
+        TiledMatcher::match(searchMat, scaledTemplate, result, profile.cvMethod());
+        profile.normalizeScores(result);
+        double maxVal = 0.0;
+        cv::Point maxLoc;
+        cv::minMaxLoc(result, nullptr, &maxVal, nullptr, &maxLoc);
+        if (maxVal > best.score) {
+            best.score = maxVal;
+            best.point = QPoint(searchRect.x() + maxLoc.x, searchRect.y() + maxLoc.y);
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int RecognitionCalibrator::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("WeBot 识别参数校准");
+    parser.addHelpOption();
+
+    QCommandLineOption calibrateOption("calibrate", "带标注的截图目录（包含 labels.csv）", "dir");
+    QCommandLineOption precisionOption("precision", "目标精确率和召回率，默认0.99", "ratio", "0.99");
+    QCommandLineOption templateOption(QStringList() << "t" << "template", "只校准指定模板（可重复）", "name");
+    QCommandLineOption dryRunOption("dry-run", "只输出结果，不写入配置");
+    parser.addOption(calibrateOption);
+    parser.addOption(precisionOption);
+    parser.addOption(templateOption);
+    parser.addOption(dryRunOption);
+
+    if (!parser.parse(arguments) || !parser.isSet(calibrateOption)) {
+        printError(parser.errorText());
+        printError(parser.helpText());
+        return ExitUsageError;
+    }
+
+    bool precisionOk = false;
+    const double targetPrecision = parser.value(precisionOption).toDouble(&precisionOk);
+    if (!precisionOk || targetPrecision <= 0.0 || targetPrecision > 1.0) {
+        printError("无效的目标精确率: " + parser.value(precisionOption));
+        return ExitUsageError;
+    }
+
+    // 初始化日志和配置（与主窗口相同的顺序）
+    Logger::getInstance();
+    ConfigManager *config = ConfigManager::getInstance();
+    config->initialize();
+
+    QVector<Sample> samples;
+    QString errorString;
+    if (!loadLabels(parser.value(calibrateOption), samples, &errorString)) {
+        printError(errorString);
+        return ExitUsageError;
+    }
+
+    // 按模板分组，加载截图和模板
+    QStringList templateNames;
+    for (const Sample &sample : samples) {
+        if (!templateNames.contains(sample.templateName)) {
+            templateNames.append(sample.templateName);
+        }
+        if (!m_images.contains(sample.imagePath)) {
+            QImage image(sample.imagePath);
+            if (image.isNull()) {
+                printError("无法加载截图: " + sample.imagePath);
+                return ExitUsageError;
+            }
+            m_images.insert(sample.imagePath, ImageKernels::toGray(image));
+        }
+    }
+    if (parser.isSet(templateOption)) {
+        const QStringList selected = parser.values(templateOption);
+        templateNames.erase(std::remove_if(templateNames.begin(), templateNames.end(),
+                                           [&selected](const QString &name) { return !selected.contains(name); }),
+                            templateNames.end());
+    }
+
+    std::shared_ptr<const ConfigSnapshot> snapshot = config->snapshot();
+    int failed = 0;
+    for (const QString &templateName : templateNames) {
+        QImage templateImage(snapshot->iconPath(templateName));
+        if (templateImage.isNull()) {
+            printError(QString("无法加载模板: %1 (%2)").arg(templateName, snapshot->iconPath(templateName)));
+            ++failed;
+            continue;
+        }
+        m_templates.insert(templateName, ImageKernels::toGray(templateImage));
+
+        printLine(QString("== %1 ==").arg(templateName));
+        const RecognitionProfile currentProfile = snapshot->recognitionProfile(templateName);
+        const Evaluation current = evaluate(currentProfile, templateName, samples, targetPrecision);
+        printLine(QString("当前: %1  耗时 %2 ms").arg(currentProfile.summary()).arg(current.meanMs, 0, 'f', 2));
+
+        // 满足要求的参数中取最快的，耗时相同时取阈值余量大的
+        Evaluation best;
+        bool found = false;
+        for (const RecognitionProfile &candidate : candidateProfiles(learnRoi(templateName, samples))) {
+            const Evaluation evaluation = evaluate(candidate, templateName, samples, targetPrecision);
+            if (!evaluation.acceptable) {
+                continue;
+            }
+            if (!found || evaluation.meanMs < best.meanMs * 0.95 ||
+                (evaluation.meanMs <= best.meanMs * 1.05 && evaluation.margin > best.margin)) {
+                best = evaluation;
+                found = true;
+            }
+        }
+
+        if (!found) {
+            printLine(QString("没有满足精确率/召回率 %1 的参数，保留当前配置").arg(targetPrecision));
+            ++failed;
+            continue;
+        }
+
+        printLine(QString("选定: %1  耗时 %2 ms  精确率 %3  召回率 %4  余量 %5")
+                      .arg(best.profile.summary())
+                      .arg(best.meanMs, 0, 'f', 2)
+                      .arg(best.precision, 0, 'f', 3)
+                      .arg(best.recall, 0, 'f', 3)
+                      .arg(best.margin, 0, 'f', 3));
+        if (!parser.isSet(dryRunOption)) {
+            config->setRecognitionProfile(templateName, best.profile);
+        }
+    }
+
+    if (!parser.isSet(dryRunOption) && !config->saveConfig()) {
+        printError("保存配置失败");
+        return ExitUsageError;
+    }
+    return failed == 0 ? ExitSuccess : ExitPartial;
+}
+
+bool RecognitionCalibrator::loadLabels(const QString &directory, QVector<Sample> &samples, QString *errorString)
+{
+    QDir dir(directory);
+    QFile file(dir.filePath("labels.csv"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *errorString = "无法打开标注文件: " + file.fileName();
+        return false;
+    }
+
+    QTextStream in(&file);
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList fields = line.split(',');
+        if (fields.size() < 2) {
+            *errorString = QString("标注文件第%1行格式错误: %2").arg(lineNumber).arg(line);
+            return false;
+        }
+        // 跳过标题行
+        if (lineNumber == 1 && fields[0].trimmed().compare("image", Qt::CaseInsensitive) == 0) {
+            continue;
+        }
+
+        Sample sample;
+        sample.imagePath = dir.filePath(fields[0].trimmed());
+        sample.templateName = fields[1].trimmed();
+        bool xOk = false;
+        bool yOk = false;
+        const int x = fields.value(2).trimmed().toInt(&xOk);
+        const int y = fields.value(3).trimmed().toInt(&yOk);
+        sample.present = xOk && yOk && x >= 0 && y >= 0;
+        sample.expected = sample.present ? QPoint(x, y) : QPoint(-1, -1);
+        samples.append(sample);
+    }
+
+    if (samples.isEmpty()) {
+        *errorString = "标注文件为空: " + file.fileName();
+        return false;
+    }
+    return true;
+}
+
+QVector<RecognitionProfile> RecognitionCalibrator::candidateProfiles(const QRectF &learnedRoi)
+{
+    QVector<RecognitionProfile> candidates;
+    const RecognitionProfile::Method methods[] = {
+        RecognitionProfile::ExactSad, RecognitionProfile::SqdiffNormed,
+        RecognitionProfile::CcorrNormed, RecognitionProfile::CcoeffNormed
+    };
+    const RecognitionProfile::Preprocess preprocesses[] = {
+        RecognitionProfile::PreprocessNone, RecognitionProfile::PreprocessEqualize, RecognitionProfile::PreprocessEdges
+    };
+    const QVector<QVector<double>> scaleSets = {{1.0}, {1.0, 1.25, 1.5}};
+    QVector<QRectF> rois = {QRectF()};
+    if (!learnedRoi.isEmpty()) {
+        rois.append(learnedRoi);
+    }
+
+    for (RecognitionProfile::Method method : methods) {
+        for (RecognitionProfile::Preprocess preprocess : preprocesses) {
+            for (const QVector<double> &scales : scaleSets) {
+                for (const QRectF &roi : rois) {
+                    RecognitionProfile profile;
+                    profile.method = method;
+                    profile.preprocess = preprocess;
+                    profile.scales = scales;
+                    profile.roi = roi;
+                    candidates.append(profile);
+                    if (method == RecognitionProfile::ExactSad) {
+                        profile.firstHit = true;
+                        candidates.append(profile);
+                    }
+                }
+            }
+        }
+    }
+    return candidates;
+}
+
+RecognitionCalibrator::Evaluation RecognitionCalibrator::evaluate(const RecognitionProfile &profile,
+                                                                  const QString &templateName,
+                                                                  const QVector<Sample> &samples,
+                                                                  double targetPrecision)
+{
+    Evaluation evaluation;
+    evaluation.profile = profile;
+
+    const QImage templateGray = m_templates.value(templateName);
+    const int tolerance = qMax(3, qMin(templateGray.width(), templateGray.height()) / 4);
+
+    // 每张图像取最佳匹配：位置正确的得分计入正确，其余（反例或位置错误）计入错误
+    QVector<double> correctScores;
+    QVector<double> wrongScores;
+    int positives = 0;
+    qint64 totalNs = 0;
+    int measured = 0;
+    for (const Sample &sample : samples) {
+        if (sample.templateName != templateName) {
+            continue;
+        }
+        const QImage &sourceGray = m_images[sample.imagePath];
+        BestMatch best;
+        QElapsedTimer timer;
+        timer.start();
+        for (int repeat = 0; repeat < kTimingRepeats; ++repeat) {
+            best = matchBest(sourceGray, templateGray, profile);
+        }
+        totalNs += timer.nsecsElapsed() / kTimingRepeats;
+        ++measured;
+
+        if (sample.present) {
+            ++positives;
+        }
+        const bool correct = sample.present && best.score > -1.0 &&
+                             qAbs(best.point.x() - sample.expected.x()) <= tolerance &&
+                             qAbs(best.point.y() - sample.expected.y()) <= tolerance;
+        if (correct) {
+            correctScores.append(best.score);
+        } else if (best.score > -1.0) {
+            wrongScores.append(best.score);
+        }
+    }
+    if (measured == 0) {
+        return evaluation;
+    }
+    evaluation.meanMs = totalNs / 1e6 / measured;
+
+    // 从高到低尝试以每个正确得分为阈值，取仍满足精确率的最低阈值（召回率最高）
+    std::sort(correctScores.begin(), correctScores.end(), std::greater<double>());
+    std::sort(wrongScores.begin(), wrongScores.end(), std::greater<double>());
+    double chosen = -1.0;
+    int chosenTruePositives = 0;
+    int chosenFalsePositives = 0;
+    int falsePositives = 0;
+    for (int i = 0; i < correctScores.size(); ++i) {
+        const double candidate = correctScores[i];
+        while (falsePositives < wrongScores.size() && wrongScores[falsePositives] >= candidate) {
+            ++falsePositives;
+        }
+        const double precision = double(i + 1) / (i + 1 + falsePositives);
+        if (precision >= targetPrecision) {
+            chosen = candidate;
+            chosenTruePositives = i + 1;
+            chosenFalsePositives = falsePositives;
+        }
+    }
+
+    if (chosen < 0.0) {
+        evaluation.profile.threshold = 1.0;
+        evaluation.precision = 0.0;
+        evaluation.recall = 0.0;
+        return evaluation;
+    }
+
+    // 阈值取最低正确得分与其下方最高错误得分的中点，两侧留出同样的余量
+    double below = chosen - 0.05;
+    for (double score : wrongScores) {
+        if (score < chosen) {
+            below = score;
+            break;
+        }
+    }
+    evaluation.profile.threshold = (chosen + below) / 2.0;
+    evaluation.margin = chosen - below;
+    evaluation.precision = double(chosenTruePositives) / (chosenTruePositives + chosenFalsePositives);
+    evaluation.recall = positives > 0 ? double(chosenTruePositives) / positives : 1.0;
+    evaluation.acceptable = evaluation.precision >= targetPrecision && evaluation.recall >= targetPrecision;
+    return evaluation;
+}
+
+QRectF RecognitionCalibrator::learnRoi(const QString &templateName, const QVector<Sample> &samples) const
+{
+    const QImage templateGray = m_templates.value(templateName);
+    QRectF bounds;
+    int count = 0;
+    for (const Sample &sample : samples) {
+        if (sample.templateName != templateName || !sample.present) {
+            continue;
+        }
+        const QImage image = m_images.value(sample.imagePath);
+        if (image.isNull()) {
+            continue;
+        }
+        // 模板在图像中的位置换算为比例，适应不同尺寸的截图
+        const QRectF rect(double(sample.expected.x()) / image.width(),
+                          double(sample.expected.y()) / image.height(),
+                          double(templateGray.width()) / image.width(),
+                          double(templateGray.height()) / image.height());
+        bounds = count == 0 ? rect : bounds.united(rect);
+        ++count;
+    }
+    if (count < kMinRoiSamples) {
+        return QRectF();
+    }
+    bounds.adjust(-kRoiMargin, -kRoiMargin, kRoiMargin, kRoiMargin);
+    return bounds.intersected(QRectF(0, 0, 1, 1));
+}
+
+void RecognitionCalibrator::printLine(const QString &line)
+{
+    QTextStream out(stdout);
+    out << line << Qt::endl;
+}
+
+void RecognitionCalibrator::printError(const QString &line)
+{
+    QTextStream err(stderr);
+    err << line << Qt::endl;
+}
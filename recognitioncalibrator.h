@@ -0,0 +1,71 @@
+#ifndef RECOGNITIONCALIBRATOR_H
+#define RECOGNITIONCALIBRATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPoint>
+#include <QMap>
+#include <QImage>
+#include "recognitionprofile.h"
+
+// 识别参数校准
+// 在带标注的截图集上对每个模板尝试一组候选参数（方法×预处理×缩放×搜索区域），
+// 为每组参数选出满足目标精确率和召回率的阈值，再取平均耗时最短的一组写入配置。
+//
+// 截图目录中的 labels.csv 每行一条标注：图像文件,模板名,x,y
+// x,y 为模板左上角的期望位置；留空或为-1表示该图像中不应出现该模板。
+class RecognitionCalibrator
+{
+public:
+    // 退出码
+    enum ExitCode {
+        ExitSuccess = 0,        // 全部模板都找到了满足要求的参数
+        ExitPartial = 1,        // 部分模板没有满足要求的参数（保留原配置）
+        ExitUsageError = 2      // 参数、标注或图像错误
+    };
+
+    // 单条标注
+    struct Sample {
+        QString imagePath;
+        QString templateName;
+        QPoint expected;
+        bool present = true;
+    };
+
+    // 一组参数在标注集上的表现
+    struct Evaluation {
+        RecognitionProfile profile;
+        double meanMs = 0.0;        // 每张图像的平均匹配耗时
+        double precision = 0.0;
+        double recall = 0.0;
+        double margin = 0.0;        // 阈值两侧最近的正确得分与错误得分之差
+        bool acceptable = false;
+    };
+
+    // 解析参数并运行，返回退出码
+    int run(const QStringList &arguments);
+
+    // 读取标注文件
+    static bool loadLabels(const QString &directory, QVector<Sample> &samples, QString *errorString);
+
+    // 候选参数（搜索区域候选由标注位置推算）
+    static QVector<RecognitionProfile> candidateProfiles(const QRectF &learnedRoi);
+
+private:
+    // 在标注集上评估一组参数
+    Evaluation evaluate(const RecognitionProfile &profile, const QString &templateName,
+                        const QVector<Sample> &samples, double targetPrecision);
+
+    // 由正例的标注位置推算搜索区域（正例不足时返回空）
+    QRectF learnRoi(const QString &templateName, const QVector<Sample> &samples) const;
+
+    // 输出到标准输出/标准错误
+    void printLine(const QString &line);
+    void printError(const QString &line);
+
+    QMap<QString, QImage> m_images;      // 灰度截图缓存（按路径）
+    QMap<QString, QImage> m_templates;   // 灰度模板缓存（按名称）
+};
+
+#endif // RECOGNITIONCALIBRATOR_H
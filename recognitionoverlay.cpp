@@ -1,10 +1,23 @@
 #include "recognitionoverlay.h"
 #include <QPainter>
+#include <QPaintEvent>
 #include <QApplication>
 #include <QScreen>
 #include <QTimer>
+#include <QDateTime>
 #include <QDebug>
-#include <windows.h>
+#include "platform.h"
+
+namespace {
+
+// 淡出时的刷新间隔（约60fps）
+constexpr int kFadeFrameMs = 16;
+
+// 四角标记的长度和线宽
+constexpr int kCornerSize = 15;
+constexpr int kCornerLineWidth = 3;
+
+} // namespace
 
 RecognitionOverlay::RecognitionOverlay(QWidget *parent) : QWidget(parent) {
     // 设置窗口属性
@@ -15,51 +28,51 @@ RecognitionOverlay::RecognitionOverlay(QWidget *parent) : QWidget(parent) {
     setAttribute(Qt::WA_PaintOnScreen);
     
     // 获取所有屏幕的物理尺寸
-    int screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-    int screenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-    int screenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-    
     // 设置窗口大小为物理屏幕尺寸
-    setGeometry(screenX, screenY, screenWidth, screenHeight);
+    setGeometry(Platform::virtualScreenRect());
     
     // 初始隐藏
     hide();
     
-    // 添加定时器，用于平滑更新识别框
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, [this]() {
-        update();
-    });
-    m_updateTimer->setInterval(8); // 约120fps，提高更新速度
-    m_updateTimer->start();
+    // 动画定时器只在有识别框淡出或等待过期时运行，内容不变时不重绘
+    m_animationTimer = new QTimer(this);
+    m_animationTimer->setSingleShot(true);
+    m_animationTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_animationTimer, &QTimer::timeout, this, &RecognitionOverlay::onAnimationTick);
 }
 
 RecognitionOverlay::~RecognitionOverlay() {
-    if (m_updateTimer) {
-        m_updateTimer->stop();
-        delete m_updateTimer;
+    m_animationTimer->stop();
+}
+
+QRect RecognitionOverlay::damageRect(const QRect &rect) {
+    // 画笔以边框为中心绘制，向外扩展半个线宽（再留1像素给抗锯齿）
+    const int margin = kCornerLineWidth / 2 + 2;
+    return rect.adjusted(-margin, -margin, margin, margin);
+}
+
+qreal RecognitionOverlay::boxOpacity(const Box &box, qint64 now) {
+    if (box.expiresAt == 0) {
+        return 1.0;
     }
+    const qint64 remaining = box.expiresAt - now;
+    if (remaining >= kFadeDurationMs) {
+        return 1.0;
+    }
+    return qBound<qreal>(0.0, qreal(remaining) / kFadeDurationMs, 1.0);
 }
 
-void RecognitionOverlay::drawRecognitionArea(const QRect &rect, const QColor &color) {
+void RecognitionOverlay::drawRecognitionArea(const QRect &rect, const QColor &color, int lifetimeMs) {
     QMutexLocker locker(&m_mutex);
     
-    // 清除之前的识别区域，确保每次只显示最新的识别区域
-    m_recognitionAreas.clear();
-    m_colors.clear();
-    
     // 获取屏幕尺寸，确保识别区域在屏幕范围内
     QRect desktopRect;
     for (QScreen *screen : QApplication::screens()) {
         desktopRect = desktopRect.united(screen->geometry());
     }
     
-    // 验证并修复识别区域，确保位置准确
-    QRect validRect = rect;
-    
     // 确保识别区域在屏幕范围内
-    validRect = validRect.intersected(desktopRect);
+    QRect validRect = rect.intersected(desktopRect);
     
     // 确保识别区域有有效尺寸
     if (validRect.width() <= 0 || validRect.height() <= 0) {
@@ -67,31 +80,42 @@ void RecognitionOverlay::drawRecognitionArea(const QRect &rect, const QColor &co
         return;
     }
     
-    // 记录原始区域和修复后的区域，用于调试
-    qDebug() << "原始识别区域:" << rect << "，修复后:" << validRect;
-    
-    // 添加新的识别区域，确保位置准确
-    m_recognitionAreas.append(validRect);
-    m_colors.append(color);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 expiresAt = lifetimeMs > 0 ? now + lifetimeMs : 0;
+    
+    // 同一位置再次识别到时只刷新颜色和过期时间
+    bool found = false;
+    for (Box &box : m_boxes) {
+        if (box.rect == validRect) {
+            box.color = color;
+            box.expiresAt = expiresAt;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        m_boxes.append({validRect, color, expiresAt});
+    }
     
     // 显示并置顶窗口
     if (!isVisible()) {
         show();
-        raise();
     }
     
-    // 更新整个窗口，确保识别框正确显示
-    update();
+    // 只重绘新识别框所在的区域
+    update(damageRect(validRect));
+    scheduleAnimation(now);
 }
 
 void RecognitionOverlay::clearRecognitionAreas() {
     QMutexLocker locker(&m_mutex);
-    m_recognitionAreas.clear();
-    m_colors.clear();
+    m_boxes.clear();
+    m_animationTimer->stop();
     hide();
 }
 
 void RecognitionOverlay::hide() {
+    m_animationTimer->stop();
     QWidget::hide();
 }
 
@@ -100,25 +124,78 @@ void RecognitionOverlay::show() {
     raise();
 }
 
+void RecognitionOverlay::onAnimationTick() {
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    // 过期的识别框移除，淡出中的识别框重绘，其余区域不动
+    QRegion damage;
+    for (int i = m_boxes.size() - 1; i >= 0; --i) {
+        const Box &box = m_boxes.at(i);
+        if (box.expiresAt == 0 || now < box.expiresAt - kFadeDurationMs) {
+            continue;
+        }
+        damage += damageRect(box.rect);
+        if (now >= box.expiresAt) {
+            m_boxes.removeAt(i);
+        }
+    }
+    
+    if (m_boxes.isEmpty()) {
+        hide();
+        return;
+    }
+    if (!damage.isEmpty()) {
+        update(damage);
+    }
+    scheduleAnimation(now);
+}
+
+void RecognitionOverlay::scheduleAnimation(qint64 now) {
+    qint64 nextEvent = -1;
+    for (const Box &box : std::as_const(m_boxes)) {
+        if (box.expiresAt == 0) {
+            continue;
+        }
+        const qint64 fadeStart = box.expiresAt - kFadeDurationMs;
+        const qint64 at = now >= fadeStart ? now + kFadeFrameMs : fadeStart;
+        if (nextEvent < 0 || at < nextEvent) {
+            nextEvent = at;
+        }
+    }
+    
+    if (nextEvent < 0) {
+        m_animationTimer->stop();
+        return;
+    }
+    m_animationTimer->start(int(qMax<qint64>(nextEvent - now, 0)));
+}
+
 void RecognitionOverlay::paintEvent(QPaintEvent *event) {
     QMutexLocker locker(&m_mutex);
     
     // 如果没有识别区域，直接返回
-    if (m_recognitionAreas.isEmpty()) {
+    if (m_boxes.isEmpty()) {
         return;
     }
     
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing, true);
     painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.setClipRegion(event->region());
     
-    // 绘制所有识别区域
-    for (int i = 0; i < m_recognitionAreas.size(); ++i) {
-        const QRect &rect = m_recognitionAreas[i];
-        QColor color = m_colors[i];
+    // 只绘制与重绘区域相交的识别框
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const Box &box : std::as_const(m_boxes)) {
+        if (!event->region().intersects(damageRect(box.rect))) {
+            continue;
+        }
+        const QRect &rect = box.rect;
+        QColor color = box.color;
         if (color == QColor()) {
             color = QColor(0, 255, 255); // 默认使用青色
         }
+        const qreal opacity = boxOpacity(box, now);
         
         // 设置画笔，使用更醒目的科技风格
         QPen pen(color);
@@ -127,39 +204,40 @@ void RecognitionOverlay::paintEvent(QPaintEvent *event) {
         pen.setCapStyle(Qt::RoundCap);
         pen.setJoinStyle(Qt::RoundJoin);
         painter.setPen(pen);
+        painter.setBrush(Qt::NoBrush);
+        painter.setOpacity(opacity);
         
-        // 绘制矩形边框，使用科技风格的虚线
+        // 绘制矩形边框
         painter.drawRect(rect);
         
         // 绘制填充半透明矩形，使用更科技感的透明度
         QBrush brush(color);
         brush.setStyle(Qt::SolidPattern);
         painter.setBrush(brush);
-        painter.setOpacity(0.1);
+        painter.setOpacity(0.1 * opacity);
         painter.drawRect(rect);
-        painter.setOpacity(1.0);
+        painter.setOpacity(opacity);
         
         // 绘制四角的标记，增强科技感
-        int cornerSize = 15;
-        int cornerLineWidth = 3;
+        painter.setPen(QPen(color, kCornerLineWidth));
         
         // 左上角
-        painter.setPen(QPen(color, cornerLineWidth));
-        painter.drawLine(rect.left(), rect.top(), rect.left() + cornerSize, rect.top());
-        painter.drawLine(rect.left(), rect.top(), rect.left(), rect.top() + cornerSize);
+        painter.drawLine(rect.left(), rect.top(), rect.left() + kCornerSize, rect.top());
+        painter.drawLine(rect.left(), rect.top(), rect.left(), rect.top() + kCornerSize);
         
         // 右上角
-        painter.drawLine(rect.right() - cornerSize, rect.top(), rect.right(), rect.top());
-        painter.drawLine(rect.right(), rect.top(), rect.right(), rect.top() + cornerSize);
+        painter.drawLine(rect.right() - kCornerSize, rect.top(), rect.right(), rect.top());
+        painter.drawLine(rect.right(), rect.top(), rect.right(), rect.top() + kCornerSize);
         
         // 左下角
-        painter.drawLine(rect.left(), rect.bottom() - cornerSize, rect.left(), rect.bottom());
-        painter.drawLine(rect.left(), rect.bottom(), rect.left() + cornerSize, rect.bottom());
+        painter.drawLine(rect.left(), rect.bottom() - kCornerSize, rect.left(), rect.bottom());
+        painter.drawLine(rect.left(), rect.bottom(), rect.left() + kCornerSize, rect.bottom());
         
         // 右下角
-        painter.drawLine(rect.right() - cornerSize, rect.bottom(), rect.right(), rect.bottom());
-        painter.drawLine(rect.right(), rect.bottom() - cornerSize, rect.right(), rect.bottom());
+        painter.drawLine(rect.right() - kCornerSize, rect.bottom(), rect.right(), rect.bottom());
+        painter.drawLine(rect.right(), rect.bottom() - kCornerSize, rect.right(), rect.bottom());
     }
+    painter.setOpacity(1.0);
     
     QWidget::paintEvent(event);
 }
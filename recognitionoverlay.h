@@ -14,8 +14,12 @@ public:
     explicit RecognitionOverlay(QWidget *parent = nullptr);
     ~RecognitionOverlay();
 
-    // 绘制识别区域
-    void drawRecognitionArea(const QRect &rect, const QColor &color = Qt::red);
+    // 识别框默认显示时间（毫秒），最后kFadeDurationMs毫秒淡出
+    static constexpr int kDefaultLifetimeMs = 2000;
+    static constexpr int kFadeDurationMs = 300;
+
+    // 绘制识别区域（可同时显示多个；lifetimeMs为0时一直显示到清除）
+    void drawRecognitionArea(const QRect &rect, const QColor &color = Qt::red, int lifetimeMs = kDefaultLifetimeMs);
     
     // 清除所有识别区域
     void clearRecognitionAreas();
@@ -31,8 +35,26 @@ protected:
     void paintEvent(QPaintEvent *event) override;
 
 private:
-    QList<QRect> m_recognitionAreas; // 识别区域列表
-    QList<QColor> m_colors; // 对应区域的颜色列表
+    // 识别框
+    struct Box {
+        QRect rect;
+        QColor color;
+        qint64 expiresAt;   // 0表示不过期
+    };
+
+    // 识别框需要重绘的范围（包含边框线宽）
+    static QRect damageRect(const QRect &rect);
+
+    // 当前的不透明度（淡出阶段从1降到0）
+    static qreal boxOpacity(const Box &box, qint64 now);
+
+    // 动画定时器：处理淡出和过期，只重绘变化的识别框
+    void onAnimationTick();
+
+    // 安排下一次动画：淡出中按帧刷新，否则等到最近的淡出开始时刻，没有需要处理的识别框时停止
+    void scheduleAnimation(qint64 now);
+
+    QList<Box> m_boxes; // 识别框列表
     QMutex m_mutex; // 线程安全锁
-    QTimer *m_updateTimer; // 更新定时器，用于平滑更新识别框
+    QTimer *m_animationTimer; // 单次定时器，空闲时不运行
 };
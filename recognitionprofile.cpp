@@ -0,0 +1,215 @@
+#include "recognitionprofile.h"
+#include <QtMath>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Canny阈值（UI图标边缘清晰，取固定值即可）
+constexpr double kCannyLow = 50.0;
+constexpr double kCannyHigh = 150.0;
+
+} // namespace
+
+RecognitionProfile RecognitionProfile::builtin(const QString &templateName, double globalThreshold,
+                                               const QString &technique)
+{
+    RecognitionProfile profile;
+
+    // 识别技术对应默认的匹配方法（ORB是特征匹配的后备方案，主匹配仍用NCC）
+    if (technique.compare("SSD", Qt::CaseInsensitive) == 0) {
+        profile.method = SqdiffNormed;
+    } else if (technique.compare("SAD", Qt::CaseInsensitive) == 0) {
+        profile.method = ExactSad;
+    } else {
+        profile.method = CcoeffNormed;
+    }
+
+    // 工作台和发送按钮在同一DPI下逐像素一致，且窗口中只出现一次，先用精确匹配
+    if (templateName.contains("workbench") || templateName.contains("send_button")) {
+        profile.method = ExactSad;
+        profile.firstHit = true;
+    }
+
+    // 已知图标沿用调好的阈值，其他模板使用全局阈值
+    if (templateName.contains("workbench")) {
+        profile.threshold = 0.97;
+    } else if (templateName.contains("mindspark")) {
+        profile.threshold = 0.96;
+    } else if (templateName.contains("input_box")) {
+        profile.threshold = 0.94;
+    } else if (templateName.contains("send_button")) {
+        profile.threshold = 0.96;
+    } else {
+        profile.threshold = globalThreshold;
+    }
+    return profile;
+}
+
+QString RecognitionProfile::methodName(Method method)
+{
+    switch (method) {
+    case CcorrNormed: return "CCORR_NORMED";
+    case SqdiffNormed: return "SQDIFF_NORMED";
+    case ExactSad: return "EXACT_SAD";
+    case CcoeffNormed:
+    default: return "CCOEFF_NORMED";
+    }
+}
+
+RecognitionProfile::Method RecognitionProfile::methodFromName(const QString &name, Method fallback)
+{
+    const QString upper = name.trimmed().toUpper();
+    if (upper == "CCOEFF_NORMED" || upper == "NCC") {
+        return CcoeffNormed;
+    }
+    if (upper == "CCORR_NORMED") {
+        return CcorrNormed;
+    }
+    if (upper == "SQDIFF_NORMED" || upper == "SSD") {
+        return SqdiffNormed;
+    }
+    if (upper == "EXACT_SAD" || upper == "SAD") {
+        return ExactSad;
+    }
+    return fallback;
+}
+
+QString RecognitionProfile::preprocessName(Preprocess preprocess)
+{
+    switch (preprocess) {
+    case PreprocessEqualize: return "equalize";
+    case PreprocessEdges: return "edges";
+    case PreprocessNone:
+    default: return "none";
+    }
+}
+
+RecognitionProfile::Preprocess RecognitionProfile::preprocessFromName(const QString &name, Preprocess fallback)
+{
+    const QString lower = name.trimmed().toLower();
+    if (lower == "none") {
+        return PreprocessNone;
+    }
+    if (lower == "equalize") {
+        return PreprocessEqualize;
+    }
+    if (lower == "edges") {
+        return PreprocessEdges;
+    }
+    return fallback;
+}
+
+QString RecognitionProfile::roiText() const
+{
+    if (roi.isEmpty()) {
+        return QString();
+    }
+    return QString("%1,%2,%3,%4").arg(roi.x()).arg(roi.y()).arg(roi.width()).arg(roi.height());
+}
+
+QRectF RecognitionProfile::roiFromText(const QString &text)
+{
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    if (parts.size() != 4) {
+        return QRectF();
+    }
+    QRectF rect(parts[0].toDouble(), parts[1].toDouble(), parts[2].toDouble(), parts[3].toDouble());
+    return rect.intersected(QRectF(0, 0, 1, 1));
+}
+
+QString RecognitionProfile::scalesText() const
+{
+    QStringList parts;
+    for (double scale : scales) {
+        parts.append(QString::number(scale));
+    }
+    return parts.join(',');
+}
+
+QVector<double> RecognitionProfile::scalesFromText(const QString &text)
+{
+    QVector<double> result;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const double scale = part.trimmed().toDouble(&ok);
+        if (ok && scale > 0.1 && scale < 10.0) {
+            result.append(scale);
+        }
+    }
+    if (result.isEmpty()) {
+        result.append(1.0);
+    }
+    return result;
+}
+
+QString RecognitionProfile::summary() const
+{
+    return QString("方法 %1 阈值 %2 预处理 %3 缩放 %4 区域 %5")
+        .arg(method == ExactSad && firstHit ? methodName(method) + "(首个命中)" : methodName(method))
+        .arg(threshold, 0, 'f', 3)
+        .arg(preprocessName(preprocess))
+        .arg(scalesText())
+        .arg(roi.isEmpty() ? QString("全图") : roiText());
+}
+
+QRect RecognitionProfile::searchRect(const QSize &sourceSize, const QSize &templateSize) const
+{
+    const QRect full(QPoint(0, 0), sourceSize);
+    if (roi.isEmpty()) {
+        return full;
+    }
+    QRect rect(qFloor(roi.x() * sourceSize.width()), qFloor(roi.y() * sourceSize.height()),
+               qCeil(roi.width() * sourceSize.width()), qCeil(roi.height() * sourceSize.height()));
+    rect = rect.intersected(full);
+    if (rect.width() < templateSize.width() || rect.height() < templateSize.height()) {
+        return full;
+    }
+    return rect;
+}
+
+cv::Mat RecognitionProfile::preprocessImage(const cv::Mat &gray) const
+{
+    cv::Mat result;
+    switch (preprocess) {
+    case PreprocessEqualize:
+        cv::equalizeHist(gray, result);
+        return result;
+    case PreprocessEdges:
+        cv::Canny(gray, result, kCannyLow, kCannyHigh);
+        return result;
+    case PreprocessNone:
+    default:
+        return gray;
+    }
+}
+
+int RecognitionProfile::cvMethod() const
+{
+    switch (method) {
+    case CcorrNormed: return cv::TM_CCORR_NORMED;
+    case SqdiffNormed: return cv::TM_SQDIFF_NORMED;
+    case ExactSad:
+    case CcoeffNormed:
+    default: return cv::TM_CCOEFF_NORMED;
+    }
+}
+
+void RecognitionProfile::normalizeScores(cv::Mat &result) const
+{
+    if (method == SqdiffNormed) {
+        // 1 - 差值：完全一致为1
+        cv::subtract(cv::Scalar::all(1.0), result, result);
+    }
+}
+
+bool RecognitionProfile::operator==(const RecognitionProfile &other) const
+{
+    return method == other.method
+        && qAbs(threshold - other.threshold) < 1e-9
+        && roi == other.roi
+        && scales == other.scales
+        && preprocess == other.preprocess
+        && firstHit == other.firstHit;
+}
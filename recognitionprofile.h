@@ -0,0 +1,78 @@
+#ifndef RECOGNITIONPROFILE_H
+#define RECOGNITIONPROFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QRectF>
+#include <QRect>
+#include <QSize>
+
+// OpenCV前向声明
+namespace cv {
+    class Mat;
+}
+
+// 单个模板的识别参数
+// 配置文件中每个模板一组：[RecognitionProfiles] 下的 <模板名>/Method、Threshold、Roi、Scales、Preprocess、FirstHit；
+// 未配置的模板使用内置默认值（已知图标沿用调好的阈值，其余模板使用全局阈值和识别技术）。
+struct RecognitionProfile
+{
+    // 匹配方法（得分统一换算为越大越匹配，SqdiffNormed取 1-差值）
+    enum Method {
+        CcoeffNormed,   // 归一化相关系数（对亮度变化不敏感，最稳）
+        CcorrNormed,    // 归一化互相关（比相关系数少一次去均值）
+        SqdiffNormed,   // 归一化平方差
+        ExactSad        // 逐次消除精确匹配（像素一致的图标），找不到时退回CcoeffNormed
+    };
+
+    // 预处理
+    enum Preprocess {
+        PreprocessNone,     // 直接使用灰度图
+        PreprocessEqualize, // 直方图均衡，适应深浅色主题
+        PreprocessEdges     // Canny边缘，只比较轮廓
+    };
+
+    Method method = CcoeffNormed;
+    double threshold = 0.95;
+    QRectF roi;                     // 搜索区域（相对源图像的比例 0..1），空表示全图
+    QVector<double> scales{1.0};    // 模板缩放比例，按顺序尝试
+    Preprocess preprocess = PreprocessNone;
+    bool firstHit = false;          // 精确匹配时返回第一个满足的位置（图标只出现一次时使用）
+
+    // 内置默认值
+    static RecognitionProfile builtin(const QString &templateName, double globalThreshold,
+                                      const QString &technique);
+
+    // 名称与枚举互转（配置文件和校准报告使用名称）
+    static QString methodName(Method method);
+    static Method methodFromName(const QString &name, Method fallback);
+    static QString preprocessName(Preprocess preprocess);
+    static Preprocess preprocessFromName(const QString &name, Preprocess fallback);
+
+    // 搜索区域和缩放比例的文本形式（"x,y,w,h" 与 "1,1.25"）
+    QString roiText() const;
+    static QRectF roiFromText(const QString &text);
+    QString scalesText() const;
+    static QVector<double> scalesFromText(const QString &text);
+
+    // 一行摘要，用于日志和校准报告
+    QString summary() const;
+
+    // 在给定尺寸的源图像中的搜索区域（像素），至少能容纳模板，否则返回整幅图像
+    QRect searchRect(const QSize &sourceSize, const QSize &templateSize) const;
+
+    // 对灰度图执行预处理（源图像和模板使用同一预处理）
+    cv::Mat preprocessImage(const cv::Mat &gray) const;
+
+    // 对应的OpenCV匹配方法（精确匹配为其后备的相关匹配方法）
+    int cvMethod() const;
+
+    // 把matchTemplate的原始结果换算为越大越匹配的得分（原地修改）
+    void normalizeScores(cv::Mat &result) const;
+
+    bool operator==(const RecognitionProfile &other) const;
+    bool operator!=(const RecognitionProfile &other) const { return !(*this == other); }
+};
+
+#endif // RECOGNITIONPROFILE_H
@@ -0,0 +1,15 @@
+include(../tests.pri)
+
+TARGET = tst_exactmatcher
+
+SOURCES = tst_exactmatcher.cpp ../../exactmatcher.cpp ../../imagekernels.cpp
+
+HEADERS = ../../exactmatcher.h ../../imagekernels.h
+
+# 基准测试与OpenCV的matchTemplate对比
+win32 {
+    OPENCV_DIR = C:/opencv/OpenCV-MinGW-Build-OpenCV-4.1.0-x64
+    INCLUDEPATH += $${OPENCV_DIR}/include
+    LIBS += -L$${OPENCV_DIR}/x64/mingw/lib
+    LIBS += -lopencv_core410 -lopencv_imgproc410
+}
@@ -0,0 +1,188 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QVector>
+#include "exactmatcher.h"
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// 逐次消除精确匹配：结果与逐位置计算SAD一致，连续调用不同尺寸时复用的积分图缓冲区不影响结果，
+// 并与OpenCV的matchTemplate比较在1920x1080截图中查找图标的耗时
+class ExactMatcherTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesBruteForce();
+    void findsIconInFrame();
+    void frame_data();
+    void frame();
+};
+
+namespace {
+
+constexpr int kFrameWidth = 1920;
+constexpr int kFrameHeight = 1080;
+constexpr int kIconSize = 40;
+
+// 灰度图像，行间距大于宽度以覆盖stride
+struct GrayImage {
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    QVector<uchar> pixels;
+
+    GrayImage(int w, int h, int padding = 0) : width(w), height(h), stride(w + padding), pixels(stride * h, 0) {}
+    uchar *row(int y) { return pixels.data() + qint64(y) * stride; }
+    const uchar *row(int y) const { return pixels.constData() + qint64(y) * stride; }
+    QSize size() const { return QSize(width, height); }
+};
+
+// 类似界面截图：纯色背景上的色块，图标放在右下角附近
+GrayImage makeFrame(QRandomGenerator &random, const GrayImage &icon, const QPoint &iconPos)
+{
+    GrayImage frame(kFrameWidth, kFrameHeight);
+    frame.pixels.fill(240);
+    for (int i = 0; i < 200; ++i) {
+        const int w = 20 + random.bounded(300);
+        const int h = 10 + random.bounded(60);
+        const int x = random.bounded(kFrameWidth - w);
+        const int y = random.bounded(kFrameHeight - h);
+        const uchar value = uchar(random.bounded(256));
+        for (int row = y; row < y + h; ++row) {
+            std::fill(frame.row(row) + x, frame.row(row) + x + w, value);
+        }
+    }
+    for (int y = 0; y < icon.height; ++y) {
+        std::copy(icon.row(y), icon.row(y) + icon.width, frame.row(iconPos.y() + y) + iconPos.x());
+    }
+    return frame;
+}
+
+GrayImage makeIcon(QRandomGenerator &random)
+{
+    GrayImage icon(kIconSize, kIconSize);
+    for (uchar &value : icon.pixels) {
+        value = uchar(random.bounded(256));
+    }
+    return icon;
+}
+
+// 逐位置计算SAD，返回最小值及其位置（相同时取先扫描到的）
+quint64 bruteForceBest(const GrayImage &source, const GrayImage &templ, QPoint *point)
+{
+    quint64 best = ~quint64(0);
+    for (int y = 0; y + templ.height <= source.height; ++y) {
+        for (int x = 0; x + templ.width <= source.width; ++x) {
+            quint64 sad = 0;
+            for (int ty = 0; ty < templ.height; ++ty) {
+                for (int tx = 0; tx < templ.width; ++tx) {
+                    sad += quint64(qAbs(int(source.row(y + ty)[x + tx]) - int(templ.row(ty)[tx])));
+                }
+            }
+            if (sad < best) {
+                best = sad;
+                *point = QPoint(x, y);
+            }
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+void ExactMatcherTest::matchesBruteForce()
+{
+    QRandomGenerator random(20240701);
+    for (int round = 0; round < 300; ++round) {
+        // 尺寸每轮不同，检查复用的缓冲区中残留的数据不影响结果
+        GrayImage source(5 + random.bounded(60), 5 + random.bounded(50), random.bounded(5));
+        for (uchar &value : source.pixels) {
+            value = random.bounded(3) == 0 ? uchar(random.bounded(256)) : uchar(random.bounded(4));
+        }
+        GrayImage templ(1 + random.bounded(qMin(source.width, 12)), 1 + random.bounded(qMin(source.height, 12)));
+        const int px = random.bounded(source.width - templ.width + 1);
+        const int py = random.bounded(source.height - templ.height + 1);
+        for (int y = 0; y < templ.height; ++y) {
+            for (int x = 0; x < templ.width; ++x) {
+                templ.row(y)[x] = uchar(source.row(py + y)[px + x] + (random.bounded(8) == 0 ? 1 : 0));
+            }
+        }
+
+        QPoint expectedPoint;
+        const quint64 expectedSad = bruteForceBest(source, templ, &expectedPoint);
+        const quint64 maxSad = quint64(ExactMatcher::kDefaultMaxMeanDiff * templ.width * templ.height);
+        const QByteArray where = QString("round %1 source %2x%3 template %4x%5").arg(round)
+                                 .arg(source.width).arg(source.height).arg(templ.width).arg(templ.height).toLatin1();
+
+        ExactMatcher::Hit hit;
+        const bool found = ExactMatcher::find(source.row(0), source.stride, source.size(),
+                                              templ.row(0), templ.stride, templ.size(),
+                                              ExactMatcher::kDefaultMaxMeanDiff, ExactMatcher::BestHit, &hit);
+        QVERIFY2(found == (expectedSad <= maxSad), where.constData());
+        if (found) {
+            QVERIFY2(hit.sad == expectedSad && hit.point == expectedPoint, where.constData());
+        }
+    }
+}
+
+void ExactMatcherTest::findsIconInFrame()
+{
+    QRandomGenerator random(7);
+    const GrayImage icon = makeIcon(random);
+    const QPoint iconPos(1700, 980);
+    const GrayImage frame = makeFrame(random, icon, iconPos);
+
+    for (ExactMatcher::Mode mode : {ExactMatcher::BestHit, ExactMatcher::FirstHit}) {
+        ExactMatcher::Hit hit;
+        ExactMatcher::Stats stats;
+        QVERIFY(ExactMatcher::find(frame.row(0), frame.stride, frame.size(), icon.row(0), icon.stride, icon.size(),
+                                   ExactMatcher::kDefaultMaxMeanDiff, mode, &hit, &stats));
+        QCOMPARE(hit.point, iconPos);
+        QCOMPARE(hit.sad, quint64(0));
+        // 绝大部分位置被横带和下界排除
+        QVERIFY(stats.eliminated * 10 > stats.positions * 9);
+    }
+}
+
+void ExactMatcherTest::frame_data()
+{
+    QTest::addColumn<bool>("exact");
+    QTest::newRow("ExactMatcher") << true;
+    QTest::newRow("matchTemplate") << false;
+}
+
+void ExactMatcherTest::frame()
+{
+    QFETCH(bool, exact);
+
+    QRandomGenerator random(7);
+    const GrayImage icon = makeIcon(random);
+    const QPoint iconPos(1700, 980);
+    const GrayImage frame = makeFrame(random, icon, iconPos);
+    const cv::Mat frameMat(frame.height, frame.width, CV_8UC1, const_cast<uchar *>(frame.row(0)), size_t(frame.stride));
+    const cv::Mat iconMat(icon.height, icon.width, CV_8UC1, const_cast<uchar *>(icon.row(0)), size_t(icon.stride));
+    cv::Mat result;
+    QPoint found;
+
+    QBENCHMARK {
+        if (exact) {
+            ExactMatcher::Hit hit;
+            ExactMatcher::find(frame.row(0), frame.stride, frame.size(), icon.row(0), icon.stride, icon.size(),
+                               ExactMatcher::kDefaultMaxMeanDiff, ExactMatcher::BestHit, &hit);
+            found = hit.point;
+        } else {
+            // 精确匹配找不到时退回的相关匹配方法
+            cv::matchTemplate(frameMat, iconMat, result, cv::TM_CCOEFF_NORMED);
+            cv::Point maxLoc;
+            cv::minMaxLoc(result, nullptr, nullptr, nullptr, &maxLoc);
+            found = QPoint(maxLoc.x, maxLoc.y);
+        }
+    }
+    QCOMPARE(found, iconPos);
+}
+
+QTEST_GUILESS_MAIN(ExactMatcherTest)
+
+#include "tst_exactmatcher.moc"
@@ -0,0 +1,9 @@
+include(../tests.pri)
+
+QT += gui
+
+TARGET = tst_imagekernels
+
+SOURCES = tst_imagekernels.cpp ../../imagekernels.cpp
+
+HEADERS = ../../imagekernels.h
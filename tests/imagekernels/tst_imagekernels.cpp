@@ -0,0 +1,225 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QVector>
+#include "imagekernels.h"
+
+Q_DECLARE_METATYPE(ImageKernels::Level)
+Q_DECLARE_METATYPE(ImageKernels::Kernel)
+
+// 图像内核：各指令集实现与标量实现逐位一致，并比较处理一帧1920x1080的耗时
+class ImageKernelsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void matchesScalar_data();
+    void matchesScalar();
+    void frame_data();
+    void frame();
+};
+
+namespace {
+
+constexpr int kFrameWidth = 1920;
+constexpr int kFrameHeight = 1080;
+
+// 随机字节，偏向0和255以覆盖饱和和溢出边界
+void fillRandom(QRandomGenerator &random, uchar *data, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        const quint32 value = random.generate();
+        switch (value & 3) {
+        case 0:
+            data[i] = 0;
+            break;
+        case 1:
+            data[i] = 255;
+            break;
+        default:
+            data[i] = uchar(value >> 8);
+            break;
+        }
+    }
+}
+
+// 分别用标量实现和指定级别运行同一段计算
+template <typename Result, typename Function>
+void runBoth(ImageKernels::Level level, Function function, Result *expected, Result *actual)
+{
+    ImageKernels::setPreferredLevel(ImageKernels::Scalar);
+    *expected = function();
+    ImageKernels::setPreferredLevel(level);
+    *actual = function();
+}
+
+} // namespace
+
+void ImageKernelsTest::cleanup()
+{
+    ImageKernels::setPreferredLevel(ImageKernels::Avx512);
+}
+
+void ImageKernelsTest::matchesScalar_data()
+{
+    QTest::addColumn<ImageKernels::Level>("level");
+    for (int level = ImageKernels::Scalar; level <= ImageKernels::supportedLevel(); ++level) {
+        QTest::newRow(qPrintable(ImageKernels::levelName(ImageKernels::Level(level)))) << ImageKernels::Level(level);
+    }
+}
+
+void ImageKernelsTest::matchesScalar()
+{
+    QFETCH(ImageKernels::Level, level);
+
+    static const int lengths[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129,
+                                  255, 1000, 1920, 4099, 70001};
+    QRandomGenerator random(20240601);
+    for (int length : lengths) {
+        for (int offset = 0; offset < 4; ++offset) {
+            const QByteArray where = QString("length %1 offset %2").arg(length).arg(offset).toLatin1();
+            QVector<uchar> a(length * 4 + 8);
+            QVector<uchar> b(length + 8);
+            fillRandom(random, a.data(), a.size());
+            fillRandom(random, b.data(), b.size());
+            const uchar *pa = a.constData() + offset;
+            const uchar *pb = b.constData() + offset;
+
+            QVector<uchar> expectedGray;
+            QVector<uchar> actualGray;
+            runBoth(level, [&] {
+                QVector<uchar> gray(length + 1);
+                ImageKernels::bgraToGray(pa, gray.data(), length);
+                return gray;
+            }, &expectedGray, &actualGray);
+            QVERIFY2(expectedGray == actualGray, ("bgraToGray " + where).constData());
+
+            for (int threshold : {0, 10, 128, 254}) {
+                int expectedCount = 0;
+                int actualCount = 0;
+                runBoth(level, [&] { return ImageKernels::diffCount(pa, pb, length, threshold); },
+                        &expectedCount, &actualCount);
+                QVERIFY2(expectedCount == actualCount,
+                         ("diffCount " + where + " threshold " + QByteArray::number(threshold)).constData());
+            }
+
+            QVector<quint32> above(length + 1);
+            for (quint32 &value : above) {
+                value = random.generate();
+            }
+            QVector<quint32> expectedRow;
+            QVector<quint32> actualRow;
+            runBoth(level, [&] {
+                QVector<quint32> row(length + 1, 0);
+                ImageKernels::integralRow(pa, above.constData(), row.data(), length);
+                return row;
+            }, &expectedRow, &actualRow);
+            QVERIFY2(expectedRow == actualRow, ("integralRow " + where).constData());
+
+            quint32 expectedSad = 0;
+            quint32 actualSad = 0;
+            runBoth(level, [&] { return ImageKernels::sadRow(pa, pb, length); }, &expectedSad, &actualSad);
+            QVERIFY2(expectedSad == actualSad, ("sadRow " + where).constData());
+
+            ImageKernels::NccSums expectedSums;
+            ImageKernels::NccSums actualSums;
+            runBoth(level, [&] {
+                ImageKernels::NccSums sums;
+                ImageKernels::nccRow(pa, pb, length, &sums);
+                return sums;
+            }, &expectedSums, &actualSums);
+            QVERIFY2(expectedSums.sumSource == actualSums.sumSource
+                     && expectedSums.sumSourceSq == actualSums.sumSourceSq
+                     && expectedSums.sumProduct == actualSums.sumProduct, ("nccRow " + where).constData());
+
+            const int halfWidth = length / 4;
+            QVector<uchar> expectedHalf;
+            QVector<uchar> actualHalf;
+            runBoth(level, [&] {
+                QVector<uchar> half(halfWidth + 1);
+                ImageKernels::downsampleRow(pa, pa + halfWidth * 2, half.data(), halfWidth);
+                return half;
+            }, &expectedHalf, &actualHalf);
+            QVERIFY2(expectedHalf == actualHalf, ("downsampleRow " + where).constData());
+        }
+    }
+}
+
+void ImageKernelsTest::frame_data()
+{
+    QTest::addColumn<ImageKernels::Level>("level");
+    QTest::addColumn<ImageKernels::Kernel>("kernel");
+    for (int level = ImageKernels::Scalar; level <= ImageKernels::supportedLevel(); ++level) {
+        for (int kernel = 0; kernel < ImageKernels::KernelCount; ++kernel) {
+            const QString name = ImageKernels::levelName(ImageKernels::Level(level)) + "/"
+                                 + ImageKernels::kernelName(ImageKernels::Kernel(kernel));
+            QTest::newRow(qPrintable(name)) << ImageKernels::Level(level) << ImageKernels::Kernel(kernel);
+        }
+    }
+}
+
+void ImageKernelsTest::frame()
+{
+    QFETCH(ImageKernels::Level, level);
+    QFETCH(ImageKernels::Kernel, kernel);
+
+    static QVector<uchar> bgra;
+    static QVector<uchar> grayA;
+    static QVector<uchar> grayB;
+    if (bgra.isEmpty()) {
+        QRandomGenerator random(1);
+        bgra.resize(kFrameWidth * kFrameHeight * 4);
+        grayA.resize(kFrameWidth * kFrameHeight);
+        grayB.resize(kFrameWidth * kFrameHeight);
+        fillRandom(random, bgra.data(), bgra.size());
+        fillRandom(random, grayA.data(), grayA.size());
+        fillRandom(random, grayB.data(), grayB.size());
+    }
+    QVector<uchar> gray(kFrameWidth * kFrameHeight);
+    QVector<quint32> integral((kFrameWidth + 1) * (kFrameHeight + 1), 0);
+    volatile quint64 sink = 0;
+
+    ImageKernels::setPreferredLevel(level);
+    QCOMPARE(int(ImageKernels::activeLevel()), int(level));
+    QBENCHMARK {
+        for (int y = 0; y < kFrameHeight; ++y) {
+            const uchar *a = grayA.constData() + qint64(y) * kFrameWidth;
+            const uchar *b = grayB.constData() + qint64(y) * kFrameWidth;
+            switch (kernel) {
+            case ImageKernels::BgraToGray:
+                ImageKernels::bgraToGray(bgra.constData() + qint64(y) * kFrameWidth * 4,
+                                         gray.data() + qint64(y) * kFrameWidth, kFrameWidth);
+                break;
+            case ImageKernels::DiffCount:
+                sink = sink + quint64(ImageKernels::diffCount(a, b, kFrameWidth, 10));
+                break;
+            case ImageKernels::IntegralRow:
+                ImageKernels::integralRow(a, integral.constData() + qint64(y) * (kFrameWidth + 1),
+                                          integral.data() + qint64(y + 1) * (kFrameWidth + 1), kFrameWidth);
+                break;
+            case ImageKernels::SadRow:
+                sink = sink + ImageKernels::sadRow(a, b, kFrameWidth);
+                break;
+            case ImageKernels::NccRow: {
+                ImageKernels::NccSums sums;
+                ImageKernels::nccRow(a, b, kFrameWidth, &sums);
+                sink = sink + sums.sumProduct;
+                break;
+            }
+            case ImageKernels::DownsampleRow:
+                if ((y & 1) == 0 && y + 1 < kFrameHeight) {
+                    ImageKernels::downsampleRow(a, a + kFrameWidth, gray.data() + qint64(y / 2) * (kFrameWidth / 2),
+                                                kFrameWidth / 2);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    Q_UNUSED(sink);
+}
+
+QTEST_GUILESS_MAIN(ImageKernelsTest)
+
+#include "tst_imagekernels.moc"
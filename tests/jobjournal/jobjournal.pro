@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+TARGET = tst_jobjournal
+
+SOURCES = tst_jobjournal.cpp ../../jobjournal.cpp
+
+HEADERS = ../../jobjournal.h
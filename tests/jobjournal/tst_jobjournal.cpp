@@ -0,0 +1,120 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "jobjournal.h"
+
+// 任务日志：重放混合了计划问题、实时问题和残行的日志，检查恢复位置
+class JobJournalTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void resumePointSeparatesLiveAndPlanned();
+    void tornTailIsTruncatedOnOpen();
+
+private:
+    // 10个计划问题，先发送3个实时问题（序号0-2），再发送计划问题0-2（序号3-5），序号6已发送未完成，
+    // 另有2个实时问题已加入但未发送
+    void writeMixedRun();
+    JobJournal::ResumePoint readResumePoint();
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_path;
+    QString m_signature;
+};
+
+void JobJournalTest::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_path = m_dir->filePath("jobs.journal");
+    m_signature = JobJournal::runSignature(QString("tst_jobjournal"), 0, 10);
+}
+
+void JobJournalTest::writeMixedRun()
+{
+    JobJournal journal;
+    QVERIFY(journal.open(m_path));
+    journal.beginRun(m_signature, 10, 0);
+    journal.recordLiveQuestions({"live-a", "live-b", "live-c"});
+    for (int i = 0; i < 3; ++i) {
+        journal.recordQuestion(i, JobJournal::Sent, QString("live-%1").arg(QChar('a' + i)), true);
+        journal.recordQuestion(i, JobJournal::Answered, QString(), true);
+    }
+    for (int i = 3; i < 6; ++i) {
+        journal.recordQuestion(i, JobJournal::Sent, QString("planned-%1").arg(i - 3));
+        journal.recordQuestion(i, JobJournal::Answered);
+    }
+    journal.recordQuestion(6, JobJournal::Sent, "planned-3");
+    journal.recordLiveQuestions({"live-d", "live-e"});
+    journal.close();
+}
+
+JobJournal::ResumePoint JobJournalTest::readResumePoint()
+{
+    JobJournal journal;
+    journal.open(m_path);
+    const JobJournal::ResumePoint point = journal.findResumePoint(m_signature);
+    journal.close();
+    return point;
+}
+
+void JobJournalTest::resumePointSeparatesLiveAndPlanned()
+{
+    writeMixedRun();
+
+    const JobJournal::ResumePoint point = readResumePoint();
+    QVERIFY(point.valid);
+    QCOMPARE(point.nextIndex, 6);
+    QCOMPARE(point.liveDone, 3);
+    // 从第4个计划问题继续
+    QCOMPARE(point.nextIndex - point.liveDone, 3);
+    QCOMPARE(point.pendingLive, QStringList({"live-d", "live-e"}));
+}
+
+void JobJournalTest::tornTailIsTruncatedOnOpen()
+{
+    writeMixedRun();
+    const JobJournal::ResumePoint point = readResumePoint();
+
+    // 模拟崩溃时写了一半的记录，重新打开后继续运行并完成序号6
+    {
+        QFile file(m_path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write("{\"t\":\"q\",\"i\":6,\"s\":\"Answ");
+    }
+    {
+        JobJournal journal;
+        QVERIFY(journal.open(m_path));
+        journal.resumeRun(point);
+        journal.recordQuestion(6, JobJournal::Answered);
+        journal.close();
+    }
+
+    // 截断残行后每一行都是完整的记录，继续运行的记录没有接在残行后面丢失
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    bool hasResume = false;
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.isEmpty()) {
+            continue;
+        }
+        const QJsonDocument document = QJsonDocument::fromJson(line);
+        QVERIFY2(document.isObject(), line.constData());
+        hasResume = hasResume || document.object().value("t").toString() == "resume";
+    }
+    QVERIFY(hasResume);
+
+    const JobJournal::ResumePoint resumed = readResumePoint();
+    QCOMPARE(resumed.nextIndex, 7);
+    QCOMPARE(resumed.liveDone, 3);
+    // 继续运行时未发送的实时问题会重新加入队列，日志中丢弃旧的待发送部分
+    QVERIFY(resumed.pendingLive.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(JobJournalTest)
+
+#include "tst_jobjournal.moc"
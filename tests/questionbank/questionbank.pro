@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+TARGET = tst_questionbank
+
+SOURCES = tst_questionbank.cpp ../../questionbank.cpp ../../csvimporter.cpp ../../questiondedup.cpp ../../questionsampler.cpp
+
+HEADERS = ../../questionbank.h ../../csvimporter.h ../../questiondedup.h ../../questionsampler.h
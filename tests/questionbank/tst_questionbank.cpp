@@ -0,0 +1,154 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include "questionbank.h"
+#include "questionsampler.h"
+
+// 二进制问题库：源文件修改后在旧问题库仍被映射时生成新问题库，并直接比较两个映射的问题库
+class QuestionBankTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void reloadWhileMappedDiffsBanks();
+    void unchangedSourceReusesBank();
+    void priorityOnlyEditUpdatesWeights();
+
+private:
+    // 写入文件并把修改时间设为固定时间之后 seconds 秒，保证每次修改后的时间不同
+    void writeSource(const QString &path, const QByteArray &content, int seconds);
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_sourcePath;
+};
+
+void QuestionBankTest::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_sourcePath = m_dir->filePath("问题.txt");
+}
+
+void QuestionBankTest::writeSource(const QString &path, const QByteArray &content, int seconds)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(content), qint64(content.size()));
+    file.close();
+    const QDateTime base(QDate(2024, 1, 1), QTime(0, 0));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(base.addSecs(seconds), QFileDevice::FileModificationTime));
+}
+
+void QuestionBankTest::reloadWhileMappedDiffsBanks()
+{
+    writeSource(m_sourcePath, "问题A\n问题B\n问题C\n", 0);
+    bool built = false;
+    QString errorString;
+    const std::shared_ptr<QuestionBank> before = QuestionBank::openForSource(m_sourcePath, m_dir->path(), &errorString, &built);
+    QVERIFY2(before, qPrintable(errorString));
+    QVERIFY(built);
+    QCOMPARE(before->count(), 3);
+
+    // 旧问题库保持映射时修改源文件，新问题库生成到另一个文件
+    writeSource(m_sourcePath, "问题A\n问题C\n问题D\n问题D\n", 10);
+    QVERIFY(!before->isUpToDate(m_sourcePath));
+    const std::shared_ptr<QuestionBank> after = QuestionBank::openForSource(m_sourcePath, m_dir->path(), &errorString, &built);
+    QVERIFY2(after, qPrintable(errorString));
+    QVERIFY(built);
+    QVERIFY(after->path() != before->path());
+    QVERIFY(after->isUpToDate(m_sourcePath));
+
+    // 旧问题库的映射仍然有效
+    QCOMPARE(before->question(1), QString("问题B"));
+
+    QStringList added;
+    QStringList removed;
+    QuestionBank::diff(*before, *after, &added, &removed);
+    QCOMPARE(added, QStringList({"问题D", "问题D"}));
+    QCOMPARE(removed, QStringList({"问题B"}));
+
+    // 旧问题库不再映射后清理掉，只留下当前的问题库
+    const QString beforePath = before->path();
+    before->close();
+    QCOMPARE(QuestionBank::removeStaleBanks(m_dir->path(), after->path()), 1);
+    QVERIFY(!QFile::exists(beforePath));
+    QVERIFY(QFile::exists(after->path()));
+}
+
+void QuestionBankTest::unchangedSourceReusesBank()
+{
+    writeSource(m_sourcePath, "问题A\n问题B\n", 0);
+    bool built = false;
+    const std::shared_ptr<QuestionBank> first = QuestionBank::openForSource(m_sourcePath, m_dir->path(), nullptr, &built);
+    QVERIFY(first);
+    QVERIFY(built);
+
+    const std::shared_ptr<QuestionBank> second = QuestionBank::openForSource(m_sourcePath, m_dir->path(), nullptr, &built);
+    QVERIFY(second);
+    QVERIFY(!built);
+    QCOMPARE(second->path(), first->path());
+
+    QStringList added;
+    QStringList removed;
+    QuestionBank::diff(*first, *second, &added, &removed);
+    QVERIFY(added.isEmpty());
+    QVERIFY(removed.isEmpty());
+}
+
+void QuestionBankTest::priorityOnlyEditUpdatesWeights()
+{
+    // 属性文件：问题\t优先级\t分类\t难度
+    const QString attributesPath = QuestionBank::attributesPathFor(m_sourcePath);
+    QCOMPARE(QFileInfo(attributesPath).fileName(), QString("问题.attributes.tsv"));
+    writeSource(m_sourcePath, "问题A\n问题B\n问题C\n", 0);
+    writeSource(attributesPath, "问题A\t高\t\t\n问题B\t低\t\t\n", 0);
+
+    const std::shared_ptr<QuestionBank> before = QuestionBank::openForSource(m_sourcePath, m_dir->path());
+    QVERIFY(before);
+    QCOMPARE(before->priority(0), quint16(3));
+    QCOMPARE(before->priority(1), quint16(1));
+    QCOMPARE(before->priority(2), QuestionBank::kDefaultPriority);
+    QVERIFY(before->isUpToDate(m_sourcePath));
+
+    // 抽样权重按问题库的优先级建立（与QuestionManager相同）
+    QVector<quint32> weights;
+    for (int i = 0; i < before->count(); ++i) {
+        weights.append(before->priority(i));
+    }
+    WeightedSampler sampler;
+    sampler.build(weights);
+
+    // 只修改属性文件：问题库过期，重新生成到新文件，问题内容不变
+    writeSource(attributesPath, "问题A\t高\t\t\n问题B\t10\t\t\n", 10);
+    QVERIFY(!before->isUpToDate(m_sourcePath));
+    bool built = false;
+    const std::shared_ptr<QuestionBank> after = QuestionBank::openForSource(m_sourcePath, m_dir->path(), nullptr, &built);
+    QVERIFY(after);
+    QVERIFY(built);
+    QVERIFY(after->path() != before->path());
+    QCOMPARE(after->contentId(), before->contentId());
+
+    QStringList added;
+    QStringList removed;
+    QuestionBank::diff(*before, *after, &added, &removed);
+    QVERIFY(added.isEmpty());
+    QVERIFY(removed.isEmpty());
+
+    // 逐条更新变化的权重
+    QVector<int> changed;
+    for (int i = 0; i < after->count(); ++i) {
+        if (sampler.weight(i) != after->priority(i)) {
+            changed.append(i);
+            sampler.setWeight(i, after->priority(i));
+        }
+    }
+    QCOMPARE(changed, QVector<int>({1}));
+    QCOMPARE(sampler.weight(1), quint32(10));
+    QCOMPARE(sampler.totalWeight(), quint64(3 + 10 + QuestionBank::kDefaultPriority));
+}
+
+QTEST_GUILESS_MAIN(QuestionBankTest)
+
+#include "tst_questionbank.moc"
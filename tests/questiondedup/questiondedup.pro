@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+TARGET = tst_questiondedup
+
+SOURCES = tst_questiondedup.cpp ../../questiondedup.cpp
+
+HEADERS = ../../questiondedup.h
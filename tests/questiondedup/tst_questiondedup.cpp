@@ -0,0 +1,76 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "questiondedup.h"
+
+// 已发送问题索引：按间隔落盘、关闭时写入剩余记录，超过上限后只保留最近的记录
+class QuestionDedupTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void recordsSurviveReopen();
+    void compactsPastLimit();
+
+private:
+    static QString question(int index) { return QString("如何配置第%1号传感器的采样频率").arg(index); }
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_path;
+};
+
+void QuestionDedupTest::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_path = m_dir->filePath("used_questions.idx");
+}
+
+void QuestionDedupTest::recordsSurviveReopen()
+{
+    {
+        QuestionDedupIndex index;
+        QVERIFY(index.open(m_path));
+        for (int i = 0; i < 7; ++i) {
+            QVERIFY(index.insert(question(i)));
+        }
+        QVERIFY(!index.insert(question(3)));
+        index.flush();
+        QCOMPARE(QFileInfo(m_path).size(), qint64(8 + 7 * 16));
+    }
+
+    QuestionDedupIndex index;
+    QVERIFY(index.open(m_path));
+    QCOMPARE(index.size(), 7);
+    QVERIFY(index.contains(question(0)));
+    QVERIFY(index.contains(question(6)));
+    QVERIFY(!index.contains(question(7)));
+}
+
+void QuestionDedupTest::compactsPastLimit()
+{
+    constexpr int kLimit = 200000;
+    {
+        QuestionDedupIndex index;
+        QVERIFY(index.open(m_path));
+        for (int i = 0; i <= kLimit; ++i) {
+            index.insert(question(i));
+        }
+        // 超过上限后只保留最近的一半
+        QCOMPARE(index.size(), kLimit / 2);
+        QVERIFY(!index.contains(question(0)));
+        QVERIFY(index.contains(question(kLimit)));
+    }
+
+    QCOMPARE(QFileInfo(m_path).size(), qint64(8 + qint64(kLimit / 2) * 16));
+    QuestionDedupIndex index;
+    QVERIFY(index.open(m_path));
+    QCOMPARE(index.size(), kLimit / 2);
+    QVERIFY(!index.contains(question(kLimit / 2)));
+    QVERIFY(index.contains(question(kLimit / 2 + 1)));
+    QVERIFY(index.contains(question(kLimit)));
+}
+
+QTEST_GUILESS_MAIN(QuestionDedupTest)
+
+#include "tst_questiondedup.moc"
@@ -0,0 +1,16 @@
+# 各测试项目共用的配置，被测源文件直接从上级目录编译
+QT += core testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x050000
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+win32 {
+    QMAKE_CXXFLAGS += -D_USE_MATH_DEFINES
+    DEFINES += NOMINMAX
+}
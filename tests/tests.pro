@@ -0,0 +1,4 @@
+# 单元测试：qmake tests/tests.pro && make check
+TEMPLATE = subdirs
+
+SUBDIRS = jobjournal imagekernels questionbank questiondedup exactmatcher
@@ -0,0 +1,115 @@
+#include "tiledmatcher.h"
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <memory>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// 计算量（得分图点数×模板像素数）低于该值时整图匹配，分条的调度开销不划算
+constexpr double kMinParallelWork = 2.0e7;
+// 每个线程平均分到的条带数，条带多一些，各线程耗时不均时可以互相补位
+constexpr int kStripsPerThread = 3;
+// 条带最少的得分图行数
+constexpr int kMinStripRows = 16;
+
+// 一次分条匹配的共享状态，线程池中的任务可能在调用方返回后才开始执行，因此用shared_ptr持有
+struct StripJob {
+    cv::Mat source;
+    cv::Mat templ;
+    cv::Mat result;
+    int method = 0;
+    int stripRows = 0;
+    int stripCount = 0;
+    QAtomicInt next;
+    QAtomicInt failed;
+    QMutex mutex;
+    QWaitCondition finished;
+    int done = 0;
+};
+
+// 不断领取下一条带并匹配，直到全部领完
+void runStrips(StripJob &job)
+{
+    for (;;) {
+        const int index = job.next.fetchAndAddRelaxed(1);
+        if (index >= job.stripCount) {
+            return;
+        }
+        const int top = index * job.stripRows;
+        const int rows = qMin(job.stripRows, job.result.rows - top);
+        try {
+            cv::Mat stripResult;
+            cv::matchTemplate(job.source.rowRange(top, top + rows + job.templ.rows - 1),
+                              job.templ, stripResult, job.method);
+            stripResult.copyTo(job.result.rowRange(top, top + rows));
+        } catch (const cv::Exception &) {
+            job.failed.storeRelaxed(1);
+        }
+        QMutexLocker locker(&job.mutex);
+        if (++job.done == job.stripCount) {
+            job.finished.wakeAll();
+        }
+    }
+}
+
+} // namespace
+
+QThreadPool *TiledMatcher::threadPool()
+{
+    return QThreadPool::globalInstance();
+}
+
+void TiledMatcher::match(const cv::Mat &source, const cv::Mat &templ, cv::Mat &result, int method)
+{
+    const int resultRows = source.rows - templ.rows + 1;
+    const int resultCols = source.cols - templ.cols + 1;
+    QThreadPool *pool = threadPool();
+    const int threads = pool->maxThreadCount();
+    const double work = double(resultRows) * resultCols * templ.rows * templ.cols;
+
+    // 条带至少与模板等高，重叠部分不超过条带本身
+    const int minStripRows = qMax(kMinStripRows, templ.rows);
+    int stripCount = resultRows > 0 ? qMin(threads * kStripsPerThread, resultRows / minStripRows) : 0;
+    if (threads <= 1 || work < kMinParallelWork || stripCount < 2 || resultCols <= 0) {
+        cv::matchTemplate(source, templ, result, method);
+        return;
+    }
+    const int stripRows = (resultRows + stripCount - 1) / stripCount;
+    stripCount = (resultRows + stripRows - 1) / stripRows;
+
+    result.create(resultRows, resultCols, CV_32F);
+    const std::shared_ptr<StripJob> job = std::make_shared<StripJob>();
+    job->source = source;
+    job->templ = templ;
+    job->result = result;
+    job->method = method;
+    job->stripRows = stripRows;
+    job->stripCount = stripCount;
+
+    // 调用线程自己也领条带（算作一个线程），线程池被其他任务占满时照样能完成
+    const int helpers = qMin(threads - 1, stripCount - 1);
+    for (int i = 0; i < helpers; ++i) {
+        pool->start([job]() {
+            runStrips(*job);
+        });
+    }
+    runStrips(*job);
+
+    {
+        QMutexLocker locker(&job->mutex);
+        while (job->done < job->stripCount) {
+            job->finished.wait(&job->mutex);
+        }
+    }
+
+    // 某条带出错时整图重新匹配，异常在调用线程抛出
+    if (job->failed.loadRelaxed()) {
+        cv::matchTemplate(source, templ, result, method);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef TILEDMATCHER_H
+#define TILEDMATCHER_H
+
+class QThreadPool;
+
+namespace cv {
+    class Mat;
+}
+
+// 分条并行的模板匹配
+// 把得分图按行切成若干横条，每条对应的源图像区域向下多取模板高度-1行（相邻条带互相重叠），
+// 各条带独立调用matchTemplate并直接写入同一张得分图，结果与整图匹配逐点一致，
+// 峰值提取在完整得分图上进行，因此条带接缝处的峰值不会被重复或遗漏。
+// 条带数多于线程数，线程做完一条就领下一条，调用线程也参与领取，快的线程自然多做。
+// 条带在进程共用的线程池（QThreadPool::globalInstance）上执行，与特征预计算、配置保存等后台任务
+// 共用同一组线程，调用线程加上派出的任务不超过线程池的线程数。
+class TiledMatcher
+{
+public:
+    // 识别任务与其他后台任务共用的线程池（QThreadPool::globalInstance，线程数等于逻辑核心数）
+    static QThreadPool *threadPool();
+
+    // 与cv::matchTemplate相同的参数和结果；计算量较小时直接在调用线程整图匹配
+    static void match(const cv::Mat &source, const cv::Mat &templ, cv::Mat &result, int method);
+};
+
+#endif // TILEDMATCHER_H
@@ -0,0 +1,237 @@
+#include "tracer.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// 每个线程缓冲区可保存的事件数（必须为2的幂）
+constexpr quint64 kBufferCapacity = 16384;
+constexpr quint64 kBufferMask = kBufferCapacity - 1;
+
+// 进程内统一的时间基准
+const std::chrono::steady_clock::time_point g_traceEpoch = std::chrono::steady_clock::now();
+
+std::atomic<bool> g_traceEnabled{false};
+
+// 将字符串截断拷贝到定长缓冲区
+void copyDetail(char *dest, const char *src)
+{
+    if (!src) {
+        dest[0] = '\0';
+        return;
+    }
+    size_t len = strnlen(src, sizeof(Tracer::Event::detail) - 1);
+    memcpy(dest, src, len);
+    dest[len] = '\0';
+}
+
+// JSON字符串转义
+QString jsonEscape(const QString &text)
+{
+    QString escaped;
+    escaped.reserve(text.size() + 8);
+    for (QChar ch : text) {
+        switch (ch.unicode()) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (ch.unicode() < 0x20) {
+                escaped += QString("\\u%1").arg(int(ch.unicode()), 4, 16, QLatin1Char('0'));
+            } else {
+                escaped += ch;
+            }
+            break;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+// 单线程写入、导出线程读取的环形缓冲区
+// 写入方只修改自己的槽位，再以release语义发布head；
+// 读取方根据前后两次读取的head丢弃可能已被覆盖的事件。
+struct Tracer::ThreadBuffer {
+    std::atomic<quint64> head{0};
+    std::atomic<quint64> clearedAt{0};
+    int tid = 0;
+    QString threadName;
+    Event events[kBufferCapacity];
+};
+
+namespace {
+
+// 所有线程缓冲区的注册表，只在注册和导出时加锁
+QMutex g_registryMutex;
+QVector<Tracer::ThreadBuffer *> &registry()
+{
+    static QVector<Tracer::ThreadBuffer *> buffers;
+    return buffers;
+}
+
+} // namespace
+
+bool Tracer::isEnabled()
+{
+    return g_traceEnabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    g_traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Tracer::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - g_traceEpoch).count();
+}
+
+Tracer::ThreadBuffer *Tracer::localBuffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer) {
+        return buffer;
+    }
+
+    // 每个线程首次记录时注册一次，缓冲区在进程生命周期内保留，便于线程退出后仍可导出
+    buffer = new ThreadBuffer();
+    QThread *thread = QThread::currentThread();
+    QMutexLocker locker(&g_registryMutex);
+    buffer->tid = registry().size() + 1;
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        buffer->threadName = "MainThread";
+    } else if (thread && !thread->objectName().isEmpty()) {
+        buffer->threadName = thread->objectName();
+    } else {
+        buffer->threadName = QString("Thread %1").arg(buffer->tid);
+    }
+    registry().append(buffer);
+    return buffer;
+}
+
+void Tracer::record(const char *name, const char *category,
+                    qint64 startNs, qint64 endNs, const char *detail)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    ThreadBuffer *buffer = localBuffer();
+    quint64 index = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[index & kBufferMask];
+    event.name = name;
+    event.category = category;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    copyDetail(event.detail, detail);
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+void TraceScope::setDetail(const QString &detail)
+{
+    if (m_startNs < 0) {
+        return;
+    }
+    QByteArray utf8 = detail.toUtf8();
+    size_t len = qMin<size_t>(utf8.size(), sizeof(m_detail) - 1);
+    memcpy(m_detail, utf8.constData(), len);
+    m_detail[len] = '\0';
+}
+
+void Tracer::clear()
+{
+    QMutexLocker locker(&g_registryMutex);
+    for (ThreadBuffer *buffer : registry()) {
+        buffer->clearedAt.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+int Tracer::threadCount()
+{
+    QMutexLocker locker(&g_registryMutex);
+    return registry().size();
+}
+
+bool Tracer::exportChromeTrace(const QString &filePath)
+{
+    QDir().mkpath(QFileInfo(filePath).path());
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out.setEncoding(QStringConverter::Utf8);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+    };
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QMutexLocker locker(&g_registryMutex);
+    for (ThreadBuffer *buffer : registry()) {
+        // 线程名称元数据
+        separator();
+        out << QString("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":\"%3\"}}")
+                   .arg(pid).arg(buffer->tid).arg(jsonEscape(buffer->threadName));
+
+        // 拷贝快照，拷贝期间可能被覆盖的事件在之后丢弃
+        quint64 headBefore = buffer->head.load(std::memory_order_acquire);
+        quint64 begin = qMax(buffer->clearedAt.load(std::memory_order_relaxed),
+                             headBefore > kBufferCapacity ? headBefore - kBufferCapacity : 0);
+        QVector<Event> snapshot;
+        snapshot.reserve(static_cast<int>(headBefore - begin));
+        for (quint64 i = begin; i < headBefore; ++i) {
+            snapshot.append(buffer->events[i & kBufferMask]);
+        }
+        quint64 headAfter = buffer->head.load(std::memory_order_acquire);
+        quint64 firstValid = headAfter >= kBufferCapacity ? headAfter - kBufferCapacity + 1 : 0;
+
+        for (int i = 0; i < snapshot.size(); ++i) {
+            if (begin + static_cast<quint64>(i) < firstValid) {
+                continue;
+            }
+            const Event &event = snapshot[i];
+            if (!event.name) {
+                continue;
+            }
+            separator();
+            out << QString("{\"ph\":\"X\",\"name\":\"%1\",\"cat\":\"%2\",\"ts\":%3,\"dur\":%4,\"pid\":%5,\"tid\":%6")
+                       .arg(jsonEscape(QString::fromUtf8(event.name)))
+                       .arg(jsonEscape(QString::fromUtf8(event.category ? event.category : "default")))
+                       .arg(event.startNs / 1000.0, 0, 'f', 3)
+                       .arg(event.durationNs / 1000.0, 0, 'f', 3)
+                       .arg(pid)
+                       .arg(buffer->tid);
+            if (event.detail[0]) {
+                out << QString(",\"args\":{\"detail\":\"%1\"}").arg(jsonEscape(QString::fromUtf8(event.detail)));
+            }
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    out.flush();
+    file.close();
+    return file.error() == QFile::NoError;
+}
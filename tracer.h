@@ -0,0 +1,83 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 运行时间线追踪
+// 每个线程拥有独立的环形缓冲区，记录时无锁、无内存分配；
+// 运行结束后可导出为 Chrome/Perfetto 可识别的 trace-event JSON。
+class Tracer
+{
+public:
+    // 单条追踪事件（完整区间事件，对应 trace-event 中的 "ph":"X"）
+    struct Event {
+        const char *name = nullptr;      // 事件名称（必须为静态字符串）
+        const char *category = nullptr;  // 事件分类（必须为静态字符串）
+        qint64 startNs = 0;              // 开始时间（纳秒，相对进程启动）
+        qint64 durationNs = 0;           // 持续时间（纳秒）
+        char detail[32] = {0};           // 附加信息（如模板名），超长截断
+    };
+
+    // 是否启用追踪
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    // 单调时钟（纳秒）
+    static qint64 nowNs();
+
+    // 记录一个区间事件（只写当前线程的缓冲区）
+    static void record(const char *name, const char *category,
+                       qint64 startNs, qint64 endNs, const char *detail = nullptr);
+
+    // 导出为 Chrome trace-event JSON
+    static bool exportChromeTrace(const QString &filePath);
+
+    // 清空所有线程已记录的事件
+    static void clear();
+
+    // 当前已注册的线程缓冲区数量
+    static int threadCount();
+
+private:
+    struct ThreadBuffer;
+    static ThreadBuffer *localBuffer();
+};
+
+// 作用域追踪：构造时记录开始时间，析构时写入事件
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name)
+        : m_name(name), m_category(category),
+          m_startNs(Tracer::isEnabled() ? Tracer::nowNs() : -1) {}
+
+    ~TraceScope() {
+        if (m_startNs >= 0) {
+            Tracer::record(m_name, m_category, m_startNs, Tracer::nowNs(),
+                           m_detail[0] ? m_detail : nullptr);
+        }
+    }
+
+    // 设置附加信息（仅在追踪启用时拷贝）
+    void setDetail(const QString &detail);
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_startNs;
+    char m_detail[32] = {0};
+};
+
+// 便捷宏定义
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(category, name)
+#define TRACE_SCOPE_DETAIL(category, name, detail) \
+    TraceScope TRACE_CONCAT(traceScope_, __LINE__)(category, name); \
+    TRACE_CONCAT(traceScope_, __LINE__).setDetail(detail)
+
+#endif // TRACER_H
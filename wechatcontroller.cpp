@@ -1,7 +1,4 @@
 #include "wechatcontroller.h"
-#include <windows.h>
-#include <tlhelp32.h>
-#include <tchar.h>
 #include <QProcess>
 #include <QThread>
 #include <QDebug>
@@ -20,38 +17,9 @@ WeChatController::~WeChatController()
 
 bool WeChatController::isWeChatRunning()
 {
-    // 检查进程是否存在
-    PROCESSENTRY32 processInfo;
-    processInfo.dwSize = sizeof(processInfo);
-
-    HANDLE processesSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (processesSnapshot == INVALID_HANDLE_VALUE) {
-        emit logMessage("无法获取进程列表");
-        return false;
-    }
-
-    bool found = false;
-    DWORD processId = 0;
-    
-    Process32First(processesSnapshot, &processInfo);
-    // 检查WeChatWork.exe或WXWork.exe进程
-    if (!_tcscmp(processInfo.szExeFile, L"WeChatWork.exe") || 
-        !_tcscmp(processInfo.szExeFile, L"WXWork.exe")) {
-        found = true;
-        processId = processInfo.th32ProcessID;
-    }
-
-    while (!found && Process32Next(processesSnapshot, &processInfo)) {
-        if (!_tcscmp(processInfo.szExeFile, L"WeChatWork.exe") || 
-            !_tcscmp(processInfo.szExeFile, L"WXWork.exe")) {
-            found = true;
-            processId = processInfo.th32ProcessID;
-            break;
-        }
-    }
-
-    CloseHandle(processesSnapshot);
-    
+    // 检查WeChatWork.exe或WXWork.exe进程是否存在
+    qint64 processId = 0;
+    const bool found = Platform::findProcess({"WeChatWork.exe", "WXWork.exe"}, &processId);
     if (found) {
         emit logMessage(QString("企业微信进程已运行，进程ID: %1").arg(processId));
     }
@@ -93,26 +61,11 @@ bool WeChatController::startWeChat(const QString &path)
     } else {
         // 如果普通方式失败，尝试管理员权限启动
         emit logMessage("普通方式启动失败，尝试管理员权限启动");
-        SHELLEXECUTEINFO shExInfo;
-        ZeroMemory(&shExInfo, sizeof(shExInfo));
-        shExInfo.cbSize = sizeof(SHELLEXECUTEINFO);
-        shExInfo.fMask = SEE_MASK_NOCLOSEPROCESS;
-        shExInfo.hwnd = NULL;
-        shExInfo.lpVerb = L"runas";  // 请求管理员权限
-        shExInfo.lpFile = (LPCWSTR)path.utf16();
-        shExInfo.lpParameters = NULL;
-        shExInfo.lpDirectory = NULL;
-        shExInfo.nShow = SW_SHOW;
-        shExInfo.hInstApp = NULL;
-        
-        if (ShellExecuteEx(&shExInfo)) {
+        quint32 error = 0;
+        if (Platform::startElevated(path, &error)) {
             emit logMessage("企业微信启动成功(管理员权限)");
-            if (shExInfo.hProcess) {
-                CloseHandle(shExInfo.hProcess);
-            }
             started = true;
         } else {
-            DWORD error = GetLastError();
             emit logMessage(QString("企业微信启动失败，错误码: %1").arg(error));
             started = false;
         }
@@ -185,48 +138,48 @@ QString WeChatController::getWeChatPathFromRegistry()
     return "";
 }
 
-HWND WeChatController::findWeChatWindow()
+WindowHandle WeChatController::findWeChatWindow()
 {
     // 尝试查找企业微信窗口，直接硬编码窗口标题
-    HWND hwnd = FindWindowW(NULL, L"企业微信");
-    if (hwnd != NULL) {
+    WindowHandle hwnd = Platform::findWindow(QString(), "企业微信");
+    if (hwnd != nullptr) {
         return hwnd;
     }
 
     // 如果找不到，尝试查找企业微信的另一个常见窗口标题
-    hwnd = FindWindowW(NULL, L"WeChatWork");
-    if (hwnd != NULL) {
+    hwnd = Platform::findWindow(QString(), "WeChatWork");
+    if (hwnd != nullptr) {
         return hwnd;
     }
 
     // 如果找不到，尝试查找企业微信的主窗口类名
-    hwnd = FindWindowW(L"WeChatMainWndForPC", NULL);
-    if (hwnd != NULL) {
+    hwnd = Platform::findWindow("WeChatMainWndForPC", QString());
+    if (hwnd != nullptr) {
         return hwnd;
     }
 
     // 如果找不到，尝试查找企业微信的另一个窗口类名
-    return FindWindowW(L"WeChatWorkMainWndForPC", NULL);
+    return Platform::findWindow("WeChatWorkMainWndForPC", QString());
 }
 
 bool WeChatController::activateWeChatWindow()
 {
-    HWND hwnd = findWeChatWindow();
-    if (hwnd == NULL) {
+    WindowHandle hwnd = findWeChatWindow();
+    if (hwnd == nullptr) {
         emit logMessage("找不到企业微信窗口");
         return false;
     }
 
     // 确保窗口可见
-    if (IsIconic(hwnd)) {
-        ShowWindow(hwnd, SW_RESTORE); // 从最小化恢复
+    if (Platform::isWindowMinimized(hwnd)) {
+        Platform::showWindow(hwnd, Platform::ShowRestore); // 从最小化恢复
     } else {
-        ShowWindow(hwnd, SW_SHOW); // 显示窗口
+        Platform::showWindow(hwnd, Platform::ShowNormal); // 显示窗口
     }
 
     // 激活窗口并前置
-    SetForegroundWindow(hwnd);
-    SetActiveWindow(hwnd);
+    Platform::setForegroundWindow(hwnd);
+    Platform::setActiveWindow(hwnd);
 
     // 等待窗口激活
     QThread::msleep(500);
@@ -235,7 +188,7 @@ bool WeChatController::activateWeChatWindow()
     maximizeWeChatWindow();
 
     // 检查是否激活成功，降低判断条件，只要窗口可见即可
-    if (IsWindowVisible(hwnd)) {
+    if (Platform::isWindowVisible(hwnd)) {
         emit logMessage("企业微信窗口已激活并最大化");
         return true;
     } else {
@@ -246,47 +199,38 @@ bool WeChatController::activateWeChatWindow()
 
 bool WeChatController::maximizeWeChatWindow()
 {
-    HWND hwnd = findWeChatWindow();
-    if (hwnd == NULL) {
+    WindowHandle hwnd = findWeChatWindow();
+    if (hwnd == nullptr) {
         emit logMessage("找不到企业微信窗口");
         return false;
     }
 
     // 最大化窗口
-    ShowWindow(hwnd, SW_MAXIMIZE);
+    Platform::showWindow(hwnd, Platform::ShowMaximized);
     emit logMessage("企业微信窗口已最大化");
 
     // 等待窗口最大化
     QThread::msleep(500);
 
     // 检查是否最大化成功
-    WINDOWPLACEMENT placement;
-    placement.length = sizeof(WINDOWPLACEMENT);
-    if (GetWindowPlacement(hwnd, &placement)) {
-        if (placement.showCmd == SW_MAXIMIZE) {
-            emit logMessage("企业微信窗口最大化成功");
-            return true;
-        } else {
-            emit logMessage("企业微信窗口最大化失败，当前状态: " + QString::number(placement.showCmd));
-            return false;
-        }
+    if (Platform::isWindowMaximized(hwnd)) {
+        emit logMessage("企业微信窗口最大化成功");
+        return true;
     }
-
-    return true;
+    emit logMessage("企业微信窗口最大化失败");
+    return false;
 }
 
 bool WeChatController::setWindowTopMost(bool topMost)
 {
-    HWND hwnd = findWeChatWindow();
-    if (hwnd == NULL) {
+    WindowHandle hwnd = findWeChatWindow();
+    if (hwnd == nullptr) {
         emit logMessage("找不到企业微信窗口");
         return false;
     }
 
     // 设置窗口置顶属性
-    SetWindowPos(hwnd, topMost ? HWND_TOPMOST : HWND_NOTOPMOST,
-                 0, 0, 0, 0,
-                 SWP_NOMOVE | SWP_NOSIZE);
+    Platform::setWindowTopMost(hwnd, topMost);
 
     emit logMessage(topMost ? "企业微信窗口已置顶" : "企业微信窗口取消置顶");
     return true;
@@ -294,33 +238,29 @@ bool WeChatController::setWindowTopMost(bool topMost)
 
 QRect WeChatController::getWeChatWindowRect()
 {
-    HWND hwnd = findWeChatWindow();
-    if (hwnd == NULL) {
+    WindowHandle hwnd = findWeChatWindow();
+    if (hwnd == nullptr) {
         emit logMessage("找不到企业微信窗口");
         return QRect();
     }
 
-    RECT rect;
-    if (GetWindowRect(hwnd, &rect)) {
-        return QRect(rect.left, rect.top,
-                     rect.right - rect.left,
-                     rect.bottom - rect.top);
-    } else {
+    const QRect rect = Platform::windowRect(hwnd);
+    if (rect.isEmpty()) {
         emit logMessage("无法获取企业微信窗口位置");
-        return QRect();
     }
+    return rect;
 }
 
 bool WeChatController::closeWeChat()
 {
-    HWND hwnd = findWeChatWindow();
-    if (hwnd == NULL) {
+    WindowHandle hwnd = findWeChatWindow();
+    if (hwnd == nullptr) {
         emit logMessage("找不到企业微信窗口");
         return false;
     }
 
     // 发送关闭消息
-    SendMessage(hwnd, WM_CLOSE, 0, 0);
+    Platform::closeWindow(hwnd);
 
     // 等待关闭
     int timeout = 5000; // 5秒超时
@@ -340,16 +280,16 @@ bool WeChatController::closeWeChat()
     return false;
 }
 
-HWND WeChatController::getWeChatWindowHandle() {
+WindowHandle WeChatController::getWeChatWindowHandle() {
     return findWeChatWindow();
 }
 
 bool WeChatController::isMultiMonitorSupported() {
-    return GetSystemMetrics(SM_CMONITORS) > 1;
+    return Platform::monitorCount() > 1;
 }
 
 int WeChatController::getMonitorCount() {
-    return GetSystemMetrics(SM_CMONITORS);
+    return Platform::monitorCount();
 }
 
 QRect WeChatController::getMonitorRect(int monitorIndex) {
@@ -357,47 +297,26 @@ QRect WeChatController::getMonitorRect(int monitorIndex) {
         return QRect();
     }
     
-    DISPLAY_DEVICE displayDevice;
-    displayDevice.cb = sizeof(DISPLAY_DEVICE);
-    
-    if (EnumDisplayDevices(NULL, monitorIndex, &displayDevice, 0)) {
-        DEVMODE devMode;
-        devMode.dmSize = sizeof(DEVMODE);
-        
-        if (EnumDisplaySettings(displayDevice.DeviceName, ENUM_CURRENT_SETTINGS, &devMode)) {
-            return QRect(devMode.dmPosition.x, devMode.dmPosition.y,
-                        devMode.dmPelsWidth, devMode.dmPelsHeight);
-        }
-    }
-    
-    return QRect();
+    return Platform::monitorRect(monitorIndex);
 }
 
-int WeChatController::getWindowMonitorIndex(HWND hwnd) {
+int WeChatController::getWindowMonitorIndex(WindowHandle hwnd) {
     if (!hwnd) return -1;
     
-    HMONITOR monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
-    if (!monitor) return -1;
-    
-    MONITORINFO monitorInfo;
-    monitorInfo.cbSize = sizeof(MONITORINFO);
+    const QRect windowMonitor = Platform::windowMonitorRect(hwnd);
+    if (windowMonitor.isEmpty()) return -1;
     
-    if (GetMonitorInfo(monitor, &monitorInfo)) {
-        // 遍历所有显示器找到匹配的
-        for (int i = 0; i < getMonitorCount(); ++i) {
-            QRect monitorRect = getMonitorRect(i);
-            if (monitorRect == QRect(monitorInfo.rcMonitor.left, monitorInfo.rcMonitor.top,
-                                   monitorInfo.rcMonitor.right - monitorInfo.rcMonitor.left,
-                                   monitorInfo.rcMonitor.bottom - monitorInfo.rcMonitor.top)) {
-                return i;
-            }
+    // 遍历所有显示器找到匹配的
+    for (int i = 0; i < getMonitorCount(); ++i) {
+        if (getMonitorRect(i) == windowMonitor) {
+            return i;
         }
     }
     
     return -1;
 }
 
-bool WeChatController::moveWindowToMonitor(HWND hwnd, int monitorIndex) {
+bool WeChatController::moveWindowToMonitor(WindowHandle hwnd, int monitorIndex) {
     if (!hwnd || monitorIndex < 0 || monitorIndex >= getMonitorCount()) {
         return false;
     }
@@ -409,14 +328,14 @@ bool WeChatController::moveWindowToMonitor(HWND hwnd, int monitorIndex) {
     }
     
     // 获取窗口当前大小
-    RECT windowRect;
-    if (!GetWindowRect(hwnd, &windowRect)) {
+    const QRect windowRect = Platform::windowRect(hwnd);
+    if (windowRect.isEmpty()) {
         emit logMessage("无法获取窗口大小");
         return false;
     }
     
-    int width = windowRect.right - windowRect.left;
-    int height = windowRect.bottom - windowRect.top;
+    int width = windowRect.width();
+    int height = windowRect.height();
     
     // 计算在新显示器上的位置（居中显示）
     int x = monitorRect.x() + (monitorRect.width() - width) / 2;
@@ -433,7 +352,7 @@ bool WeChatController::moveWindowToMonitor(HWND hwnd, int monitorIndex) {
     }
     
     // 移动窗口
-    if (SetWindowPos(hwnd, NULL, x, y, 0, 0, SWP_NOSIZE | SWP_NOZORDER)) {
+    if (Platform::moveWindow(hwnd, QPoint(x, y))) {
         emit logMessage(QString("窗口已移动到显示器 %1").arg(monitorIndex));
         return true;
     } else {
@@ -4,7 +4,7 @@
 #include <QString>
 #include <QStringList>
 #include <QRect>
-#include <windows.h>
+#include "platform.h"
 
 class WeChatController : public QObject {
     Q_OBJECT
@@ -31,7 +31,7 @@ public:
     bool closeWeChat();
 
     // 获取企业微信窗口句柄
-    HWND getWeChatWindowHandle();
+    WindowHandle getWeChatWindowHandle();
 
     // 设置窗口置顶状态
     bool setWindowTopMost(bool topMost);
@@ -43,18 +43,18 @@ public:
     bool isMultiMonitorSupported();
     int getMonitorCount();
     QRect getMonitorRect(int monitorIndex);
-    int getWindowMonitorIndex(HWND hwnd);
-    bool moveWindowToMonitor(HWND hwnd, int monitorIndex);
+    int getWindowMonitorIndex(WindowHandle hwnd);
+    bool moveWindowToMonitor(WindowHandle hwnd, int monitorIndex);
 
 signals:
     void logMessage(const QString &message);
 
 private:
     // 查找企业微信窗口
-    HWND findWeChatWindow();
+    WindowHandle findWeChatWindow();
 
     // 获取窗口位置
-    QRect getWindowRect(HWND hwnd);
+    QRect getWindowRect(WindowHandle hwnd);
 
 
 };